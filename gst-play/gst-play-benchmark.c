@@ -0,0 +1,494 @@
+/* GStreamer command line playback testing utility - decode benchmark
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Decodes every playlist entry as fast as possible with playbin and
+ * fakesinks that do not synchronise to the clock. The time until the
+ * pipeline prerolled and until the first decoded frame arrived is measured
+ * from the start of the run, the frame and sample rates over the time from
+ * PLAYING to EOS. The frames and samples that arrived while prerolling are
+ * not included in the rates.
+ *
+ * A run fails if it does not preroll within PREROLL_TIMEOUT or nothing is
+ * decoded for STALL_TIMEOUT.
+ *
+ * CPU time and peak RSS are only available for the whole process, so they
+ * are reported for all runs together.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gst-play-benchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef G_OS_UNIX
+#include <sys/time.h>
+#include <sys/resource.h>
+#endif
+
+#include <gst/gst.h>
+
+GST_DEBUG_CATEGORY_EXTERN (play_debug);
+#define GST_CAT_DEFAULT play_debug
+
+#define PREROLL_TIMEOUT (30 * GST_SECOND)
+#define STALL_TIMEOUT (10 * GST_SECOND)
+
+typedef struct
+{
+  const gchar *uri;
+  guint repetition;
+
+  gchar *error;
+
+  /* In microseconds from the start of the run, or -1 */
+  gint64 start;
+  gint64 preroll;
+  gint64 first_video;
+  gint64 first_audio;
+  /* From PLAYING to EOS */
+  gint64 decode;
+
+  guint64 video_frames;
+  guint64 audio_samples;
+  /* Counts when PLAYING was reached, the rates only use the difference */
+  guint64 preroll_video_frames;
+  guint64 preroll_audio_samples;
+  /* Bytes per audio frame of the current caps */
+  guint audio_bpf;
+  /* Buffers of both sinks, to detect stalls */
+  volatile gint buffers;
+} BenchmarkRun;
+
+typedef struct
+{
+  BenchmarkRun *runs;
+  guint n_runs;
+  volatile gint next_run;
+} Benchmark;
+
+typedef struct
+{
+  gint64 wall;
+  gint64 user;
+  gint64 system;
+  glong peak_rss;               /* KiB, or -1 */
+} BenchmarkUsage;
+
+static void
+benchmark_get_usage (BenchmarkUsage * usage)
+{
+#ifdef G_OS_UNIX
+  struct rusage ru;
+#endif
+
+  usage->wall = g_get_monotonic_time ();
+  usage->user = usage->system = 0;
+  usage->peak_rss = -1;
+
+#ifdef G_OS_UNIX
+  if (getrusage (RUSAGE_SELF, &ru) == 0) {
+    usage->user = (gint64) ru.ru_utime.tv_sec * G_USEC_PER_SEC
+        + ru.ru_utime.tv_usec;
+    usage->system = (gint64) ru.ru_stime.tv_sec * G_USEC_PER_SEC
+        + ru.ru_stime.tv_usec;
+#ifdef __APPLE__
+    /* in bytes instead of KiB */
+    usage->peak_rss = ru.ru_maxrss / 1024;
+#else
+    usage->peak_rss = ru.ru_maxrss;
+#endif
+  }
+#endif
+}
+
+/* Bytes per frame of raw audio caps, parsing format names like S16LE or
+ * S24_32BE as libgstaudio is not linked */
+static guint
+audio_caps_get_bpf (GstCaps * caps)
+{
+  const GstStructure *s;
+  const gchar *format, *width;
+  gint channels = 0;
+
+  s = gst_caps_get_structure (caps, 0);
+  format = gst_structure_get_string (s, "format");
+  if (!format || !gst_structure_get_int (s, "channels", &channels))
+    return 0;
+
+  width = strchr (format, '_');
+  width = width ? width + 1 : format + 1;
+
+  return atoi (width) / 8 * channels;
+}
+
+static GstPadProbeReturn
+video_probe_cb (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  BenchmarkRun *run = user_data;
+
+  if (run->first_video < 0)
+    run->first_video = g_get_monotonic_time () - run->start;
+  run->video_frames++;
+  g_atomic_int_inc (&run->buffers);
+
+  return GST_PAD_PROBE_OK;
+}
+
+static GstPadProbeReturn
+audio_probe_cb (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  BenchmarkRun *run = user_data;
+  GstEvent *event;
+  GstCaps *caps;
+
+  if (GST_PAD_PROBE_INFO_TYPE (info) & GST_PAD_PROBE_TYPE_BUFFER) {
+    if (run->first_audio < 0)
+      run->first_audio = g_get_monotonic_time () - run->start;
+    if (run->audio_bpf > 0)
+      run->audio_samples +=
+          gst_buffer_get_size (GST_PAD_PROBE_INFO_BUFFER (info)) /
+          run->audio_bpf;
+    g_atomic_int_inc (&run->buffers);
+  } else {
+    event = GST_PAD_PROBE_INFO_EVENT (info);
+    if (GST_EVENT_TYPE (event) == GST_EVENT_CAPS) {
+      gst_event_parse_caps (event, &caps);
+      run->audio_bpf = audio_caps_get_bpf (caps);
+    }
+  }
+
+  return GST_PAD_PROBE_OK;
+}
+
+static GstElement *
+benchmark_make_sink (BenchmarkRun * run, gboolean video)
+{
+  GstElement *sink;
+  GstPad *pad;
+
+  sink = gst_element_factory_make ("fakesink", NULL);
+  if (!sink)
+    return NULL;
+
+  g_object_set (sink, "sync", FALSE, NULL);
+  pad = gst_element_get_static_pad (sink, "sink");
+  if (video)
+    gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER, video_probe_cb, run,
+        NULL);
+  else
+    gst_pad_add_probe (pad,
+        GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM,
+        audio_probe_cb, run, NULL);
+  gst_object_unref (pad);
+
+  return sink;
+}
+
+/* Waits up to @timeout for one of @types and returns TRUE if it arrived.
+ * Errors are stored in the run */
+static gboolean
+benchmark_wait (BenchmarkRun * run, GstBus * bus, GstMessageType types,
+    GstClockTime timeout)
+{
+  GstMessage *msg;
+  GError *err = NULL;
+
+  msg = gst_bus_timed_pop_filtered (bus, timeout, types | GST_MESSAGE_ERROR);
+  if (msg == NULL)
+    return FALSE;
+  if (GST_MESSAGE_TYPE (msg) != GST_MESSAGE_ERROR) {
+    gst_message_unref (msg);
+    return TRUE;
+  }
+
+  gst_message_parse_error (msg, &err, NULL);
+  run->error = g_strdup (err->message);
+  g_clear_error (&err);
+  gst_message_unref (msg);
+
+  return FALSE;
+}
+
+static void
+benchmark_run (BenchmarkRun * run)
+{
+  GstElement *playbin, *video_sink, *audio_sink;
+  GstStateChangeReturn ret;
+  GstBus *bus;
+  gint64 playing;
+  gint buffers;
+
+  run->preroll = run->first_video = run->first_audio = run->decode = -1;
+
+  playbin = gst_element_factory_make ("playbin", NULL);
+  video_sink = benchmark_make_sink (run, TRUE);
+  audio_sink = benchmark_make_sink (run, FALSE);
+  if (!playbin || !video_sink || !audio_sink) {
+    run->error = g_strdup ("Could not create playbin or fakesink");
+    if (playbin)
+      gst_object_unref (playbin);
+    if (video_sink)
+      gst_object_unref (video_sink);
+    if (audio_sink)
+      gst_object_unref (audio_sink);
+    return;
+  }
+
+  g_object_set (playbin, "uri", run->uri, "video-sink", video_sink,
+      "audio-sink", audio_sink, NULL);
+  bus = gst_element_get_bus (playbin);
+
+  GST_DEBUG ("Benchmarking %s", run->uri);
+
+  run->start = g_get_monotonic_time ();
+  ret = gst_element_set_state (playbin, GST_STATE_PAUSED);
+  if (ret == GST_STATE_CHANGE_FAILURE) {
+    /* the error, if any, is already on the bus */
+    benchmark_wait (run, bus, 0, 0);
+    if (!run->error)
+      run->error = g_strdup ("Failed to start pipeline");
+    goto done;
+  }
+  if (ret != GST_STATE_CHANGE_NO_PREROLL
+      && !benchmark_wait (run, bus, GST_MESSAGE_ASYNC_DONE, PREROLL_TIMEOUT)) {
+    if (!run->error)
+      run->error = g_strdup ("Timed out while prerolling");
+    goto done;
+  }
+  run->preroll = g_get_monotonic_time () - run->start;
+
+  /* the sinks are blocked in preroll, so the counts are stable */
+  run->preroll_video_frames = run->video_frames;
+  run->preroll_audio_samples = run->audio_samples;
+
+  playing = g_get_monotonic_time ();
+  gst_element_set_state (playbin, GST_STATE_PLAYING);
+  do {
+    buffers = g_atomic_int_get (&run->buffers);
+    if (benchmark_wait (run, bus, GST_MESSAGE_EOS, STALL_TIMEOUT)) {
+      run->decode = g_get_monotonic_time () - playing;
+      break;
+    }
+  } while (!run->error && g_atomic_int_get (&run->buffers) != buffers);
+
+  if (run->decode < 0 && !run->error)
+    run->error = g_strdup ("Timed out, nothing was decoded");
+
+done:
+  gst_element_set_state (playbin, GST_STATE_NULL);
+  gst_object_unref (bus);
+  gst_object_unref (playbin);
+}
+
+static gpointer
+benchmark_thread (gpointer user_data)
+{
+  Benchmark *benchmark = user_data;
+  guint i;
+
+  while ((i = g_atomic_int_add (&benchmark->next_run, 1)) <
+      benchmark->n_runs)
+    benchmark_run (&benchmark->runs[i]);
+
+  return NULL;
+}
+
+static gdouble
+per_second (guint64 count, gint64 usecs)
+{
+  return usecs > 0 ? count * (gdouble) G_USEC_PER_SEC / usecs : 0.0;
+}
+
+static void
+benchmark_print_run (BenchmarkRun * run)
+{
+  gint64 first_frame;
+
+  if (run->error) {
+    g_print ("%s [%u]: ERROR %s\n", run->uri, run->repetition, run->error);
+    return;
+  }
+
+  first_frame = run->first_video >= 0 ? run->first_video : run->first_audio;
+  g_print ("%s [%u]:\n", run->uri, run->repetition);
+  g_print ("  preroll: %.1f ms, first frame: %.1f ms, decode: %.1f ms\n",
+      run->preroll / 1000.0, first_frame / 1000.0, run->decode / 1000.0);
+  g_print ("  video: %" G_GUINT64_FORMAT " frames, %.1f frames/s\n",
+      run->video_frames, per_second (run->video_frames -
+          run->preroll_video_frames, run->decode));
+  g_print ("  audio: %" G_GUINT64_FORMAT " samples, %.0f samples/s\n",
+      run->audio_samples, per_second (run->audio_samples -
+          run->preroll_audio_samples, run->decode));
+}
+
+static void
+json_append_string (GString * json, const gchar * str)
+{
+  g_string_append_c (json, '"');
+  for (; *str; str++) {
+    if (*str == '"' || *str == '\\')
+      g_string_append_printf (json, "\\%c", *str);
+    else if ((guchar) * str < 0x20)
+      g_string_append_printf (json, "\\u%04x", (guchar) * str);
+    else
+      g_string_append_c (json, *str);
+  }
+  g_string_append_c (json, '"');
+}
+
+static void
+json_append_ms (GString * json, const gchar * name, gint64 usecs)
+{
+  if (usecs >= 0)
+    g_string_append_printf (json, ", \"%s\": %.3f", name, usecs / 1000.0);
+  else
+    g_string_append_printf (json, ", \"%s\": null", name);
+}
+
+static gchar *
+benchmark_to_json (Benchmark * benchmark, guint jobs, BenchmarkUsage * start,
+    BenchmarkUsage * end)
+{
+  GString *json;
+  BenchmarkRun *run;
+  guint i;
+
+  json = g_string_new ("{\n");
+  g_string_append_printf (json, "  \"jobs\": %u,\n", jobs);
+  g_string_append_printf (json, "  \"wall_ms\": %.3f,\n",
+      (end->wall - start->wall) / 1000.0);
+  g_string_append_printf (json, "  \"user_ms\": %.3f,\n",
+      (end->user - start->user) / 1000.0);
+  g_string_append_printf (json, "  \"system_ms\": %.3f,\n",
+      (end->system - start->system) / 1000.0);
+  g_string_append_printf (json, "  \"peak_rss_kib\": %ld,\n", end->peak_rss);
+  g_string_append (json, "  \"runs\": [");
+
+  for (i = 0; i < benchmark->n_runs; i++) {
+    run = &benchmark->runs[i];
+
+    g_string_append (json, i > 0 ? ",\n    {" : "\n    {");
+    g_string_append (json, "\"uri\": ");
+    json_append_string (json, run->uri);
+    g_string_append_printf (json, ", \"repetition\": %u", run->repetition);
+    if (run->error) {
+      g_string_append (json, ", \"error\": ");
+      json_append_string (json, run->error);
+    } else {
+      json_append_ms (json, "preroll_ms", run->preroll);
+      json_append_ms (json, "first_video_ms", run->first_video);
+      json_append_ms (json, "first_audio_ms", run->first_audio);
+      json_append_ms (json, "decode_ms", run->decode);
+      g_string_append_printf (json, ", \"video_frames\": %" G_GUINT64_FORMAT,
+          run->video_frames);
+      g_string_append_printf (json, ", \"video_fps\": %.3f",
+          per_second (run->video_frames - run->preroll_video_frames,
+              run->decode));
+      g_string_append_printf (json, ", \"audio_samples\": %"
+          G_GUINT64_FORMAT, run->audio_samples);
+      g_string_append_printf (json, ", \"audio_samples_per_second\": %.3f",
+          per_second (run->audio_samples - run->preroll_audio_samples,
+              run->decode));
+    }
+    g_string_append_c (json, '}');
+  }
+  g_string_append (json, "\n  ]\n}\n");
+
+  return g_string_free (json, FALSE);
+}
+
+/* Runs every entry of @playlist @repeat times, @jobs at a time. Prints
+ * the results and writes them as JSON to @json_file, or prints them if it
+ * is NULL. Returns FALSE if any run failed */
+gboolean
+gst_play_benchmark (GstPlayPlaylist * playlist, guint repeat, guint jobs,
+    const gchar * json_file)
+{
+  BenchmarkUsage start, end;
+  Benchmark benchmark = { NULL, };
+  GThread **threads;
+  GError *err = NULL;
+  guint length, n_failed = 0, i;
+  gchar **uris, *json;
+
+  repeat = MAX (repeat, 1);
+  jobs = MAX (jobs, 1);
+
+  /* returns once the playlist is complete */
+  gst_play_playlist_wait (playlist, G_MAXUINT);
+  length = gst_play_playlist_get_length (playlist);
+
+  uris = g_new0 (gchar *, length + 1);
+  for (i = 0; i < length; i++)
+    uris[i] = gst_play_playlist_get (playlist, i);
+
+  benchmark.n_runs = length * repeat;
+  benchmark.runs = g_new0 (BenchmarkRun, benchmark.n_runs);
+  for (i = 0; i < benchmark.n_runs; i++) {
+    benchmark.runs[i].uri = uris[i % length];
+    benchmark.runs[i].repetition = i / length;
+  }
+
+  jobs = MIN (jobs, MAX (benchmark.n_runs, 1));
+  g_print ("Benchmarking %u URIs %u times with %u jobs\n\n", length, repeat,
+      jobs);
+
+  benchmark_get_usage (&start);
+  threads = g_new (GThread *, jobs);
+  for (i = 0; i < jobs; i++)
+    threads[i] = g_thread_new ("benchmark", benchmark_thread, &benchmark);
+  for (i = 0; i < jobs; i++)
+    g_thread_join (threads[i]);
+  g_free (threads);
+  benchmark_get_usage (&end);
+
+  for (i = 0; i < benchmark.n_runs; i++) {
+    benchmark_print_run (&benchmark.runs[i]);
+    if (benchmark.runs[i].error)
+      n_failed++;
+  }
+
+  g_print ("\n%u runs, %u failed\n", benchmark.n_runs, n_failed);
+  g_print ("wall: %.1f ms, CPU: %.1f ms (user %.1f ms, system %.1f ms)\n",
+      (end.wall - start.wall) / 1000.0,
+      (end.user - start.user + end.system - start.system) / 1000.0,
+      (end.user - start.user) / 1000.0, (end.system - start.system) / 1000.0);
+  if (end.peak_rss >= 0)
+    g_print ("peak RSS: %ld KiB\n", end.peak_rss);
+
+  json = benchmark_to_json (&benchmark, jobs, &start, &end);
+  if (json_file == NULL) {
+    g_print ("\n%s", json);
+  } else if (!g_file_set_contents (json_file, json, -1, &err)) {
+    g_printerr ("Could not write benchmark results: %s\n", err->message);
+    g_clear_error (&err);
+  }
+  g_free (json);
+
+  for (i = 0; i < benchmark.n_runs; i++)
+    g_free (benchmark.runs[i].error);
+  g_free (benchmark.runs);
+  g_strfreev (uris);
+
+  return n_failed == 0;
+}
@@ -0,0 +1,704 @@
+/* GStreamer command line playback testing utility - playlist helpers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* The playlist is built in a thread while the first entries are already
+ * played. Directories are scanned by a pool of threads, preferring the
+ * directories that are needed next, and their sorted entries are added in
+ * depth-first order, so the order does not depend on the scheduling. The
+ * pool only scans ahead until a limited number of entries waits to be
+ * added.
+ *
+ * The URIs are stored one after another, each as the length of the prefix
+ * it shares with the previous one and the remaining bytes. Every
+ * BLOCK_SIZE-th URI is stored completely, so that any URI can be restored
+ * from the start of its block.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gst-play-playlist.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <gio/gio.h>
+#include <glib/gstdio.h>
+#include <gst/gst.h>
+
+GST_DEBUG_CATEGORY_EXTERN (play_debug);
+#define GST_CAT_DEFAULT play_debug
+
+#define BLOCK_SIZE 16
+#define SCAN_THREADS 8
+/* Entries of scanned directories that may wait to be added */
+#define MAX_PENDING_ENTRIES 65536
+/* Bytes read from a file whose type is not clear from its name */
+#define SNIFF_SIZE 4096
+
+typedef enum
+{
+  DIR_QUEUED,
+  DIR_SCANNING,
+  DIR_SCANNED
+} DirState;
+
+typedef struct _DirNode DirNode;
+
+typedef struct
+{
+  gchar *name;
+  gchar *key;                   /* Only set while sorting */
+  DirNode *dir;                 /* NULL for files */
+} DirEntry;
+
+struct _DirNode
+{
+  volatile gint refcount;
+  gchar *path;
+
+  /* Position in the depth-first order, the index of the node and all its
+   * parents in their directory */
+  guint *rank;
+  guint depth;
+
+  /* Protected by the playlist lock */
+  DirState state;
+  GArray *entries;
+};
+
+struct _GstPlayPlaylist
+{
+  GMutex lock;
+  GCond cond;
+
+  /* Protected by lock */
+  GByteArray *data;
+  GArray *blocks;               /* Offset of every BLOCK_SIZE-th URI */
+  GString *last;
+  guint length;
+  gboolean complete;
+  guint pending;                /* Entries of scanned directories */
+  /* See gst_play_playlist_notify() */
+  guint notify_index;
+  GstPlayPlaylistFunc notify_func;
+  gpointer notify_data;
+  guint notify_source;
+
+  volatile gint cancelled;
+
+  /* Only used by the builder thread */
+  GThread *builder;
+  GThreadPool *pool;
+  guint n_roots;
+  gchar *playlist_file;
+  gchar **filenames;
+};
+
+static DirNode *
+dir_node_new (const gchar * path, DirNode * parent, guint index)
+{
+  DirNode *node;
+
+  node = g_slice_new0 (DirNode);
+  node->refcount = 1;
+  node->path = g_strdup (path);
+  node->depth = parent ? parent->depth + 1 : 1;
+  node->rank = g_new (guint, node->depth);
+  if (parent)
+    memcpy (node->rank, parent->rank, parent->depth * sizeof (guint));
+  node->rank[node->depth - 1] = index;
+  node->state = DIR_QUEUED;
+
+  return node;
+}
+
+static DirNode *
+dir_node_ref (DirNode * node)
+{
+  g_atomic_int_inc (&node->refcount);
+  return node;
+}
+
+static void
+dir_node_unref (DirNode * node)
+{
+  guint i;
+
+  if (!g_atomic_int_dec_and_test (&node->refcount))
+    return;
+
+  if (node->entries) {
+    for (i = 0; i < node->entries->len; i++) {
+      DirEntry *e = &g_array_index (node->entries, DirEntry, i);
+
+      g_free (e->name);
+      if (e->dir)
+        dir_node_unref (e->dir);
+    }
+    g_array_free (node->entries, TRUE);
+  }
+  g_free (node->rank);
+  g_free (node->path);
+  g_slice_free (DirNode, node);
+}
+
+/* Scans the directories that come first in the playlist first */
+static gint
+dir_node_compare (gconstpointer a, gconstpointer b, gpointer user_data)
+{
+  const DirNode *na = a, *nb = b;
+  guint i;
+
+  for (i = 0; i < na->depth && i < nb->depth; i++) {
+    if (na->rank[i] != nb->rank[i])
+      return na->rank[i] < nb->rank[i] ? -1 : 1;
+  }
+
+  return (na->depth > nb->depth) - (na->depth < nb->depth);
+}
+
+static gint
+dir_entry_compare (gconstpointer a, gconstpointer b)
+{
+  const DirEntry *ea = a, *eb = b;
+
+  return strcmp (ea->key, eb->key);
+}
+
+static gboolean
+is_media_content_type (const gchar * type)
+{
+  static const gchar *media_types[] = {
+    "application/ogg", "application/x-ogg", "application/mxf",
+    "application/vnd.rn-realmedia", "application/x-matroska",
+    "application/x-flash-video", NULL
+  };
+  gboolean ret;
+  gchar *mime;
+  guint i;
+
+  /* Let the player decide about files nothing is known about */
+  if (g_content_type_is_unknown (type))
+    return TRUE;
+
+  mime = g_content_type_get_mime_type (type);
+  if (!mime)
+    return TRUE;
+
+  ret = g_str_has_prefix (mime, "audio/") || g_str_has_prefix (mime, "video/");
+  for (i = 0; !ret && media_types[i]; i++)
+    ret = strcmp (mime, media_types[i]) == 0;
+  g_free (mime);
+
+  return ret;
+}
+
+/* Usually the name is enough, the file is only read if its type is not
+ * clear from it */
+static gboolean
+is_media_file (const gchar * path, const gchar * name)
+{
+  guchar data[SNIFF_SIZE];
+  gboolean uncertain, ret;
+  gchar *type;
+  gsize len = 0;
+  FILE *f;
+
+  type = g_content_type_guess (name, NULL, 0, &uncertain);
+  if (uncertain) {
+    g_free (type);
+    f = g_fopen (path, "rb");
+    if (f) {
+      len = fread (data, 1, sizeof (data), f);
+      fclose (f);
+    }
+    type = g_content_type_guess (name, data, len, &uncertain);
+  }
+
+  ret = is_media_content_type (type);
+  GST_LOG ("%s: %s%s", path, type, ret ? "" : ", skipped");
+  g_free (type);
+
+  return ret;
+}
+
+/* Reads the entries of @node, sorts them and queues its subdirectories */
+static void
+dir_scan (GstPlayPlaylist * self, DirNode * node)
+{
+  const gchar *name;
+  GArray *entries;
+  DirEntry entry;
+  gchar *path;
+  GDir *dir;
+  guint i, index = 0;
+
+  entries = g_array_new (FALSE, FALSE, sizeof (DirEntry));
+
+  dir = g_dir_open (node->path, 0, NULL);
+  while (dir && (name = g_dir_read_name (dir))
+      && !g_atomic_int_get (&self->cancelled)) {
+    path = g_build_filename (node->path, name, NULL);
+    entry.dir = NULL;
+    if (g_file_test (path, G_FILE_TEST_IS_DIR))
+      entry.dir = dir_node_new (path, node, 0);
+    else if (!is_media_file (path, name)) {
+      g_free (path);
+      continue;
+    }
+    g_free (path);
+
+    entry.name = g_strdup (name);
+    entry.key = g_utf8_collate_key_for_filename (name, -1);
+    g_array_append_val (entries, entry);
+  }
+  if (dir)
+    g_dir_close (dir);
+
+  g_array_sort (entries, dir_entry_compare);
+  for (i = 0; i < entries->len; i++) {
+    DirEntry *e = &g_array_index (entries, DirEntry, i);
+
+    g_free (e->key);
+    e->key = NULL;
+    if (e->dir)
+      e->dir->rank[e->dir->depth - 1] = index++;
+  }
+
+  GST_DEBUG ("Scanned %s: %u entries", node->path, entries->len);
+
+  g_mutex_lock (&self->lock);
+  node->entries = entries;
+  node->state = DIR_SCANNED;
+  self->pending += entries->len;
+  g_cond_broadcast (&self->cond);
+  g_mutex_unlock (&self->lock);
+
+  for (i = 0; i < entries->len; i++) {
+    DirEntry *e = &g_array_index (entries, DirEntry, i);
+
+    if (e->dir)
+      g_thread_pool_push (self->pool, dir_node_ref (e->dir), NULL);
+  }
+}
+
+static void
+scan_func (gpointer data, gpointer user_data)
+{
+  GstPlayPlaylist *self = user_data;
+  DirNode *node = data;
+
+  g_mutex_lock (&self->lock);
+  while (node->state == DIR_QUEUED && self->pending >= MAX_PENDING_ENTRIES
+      && !g_atomic_int_get (&self->cancelled))
+    g_cond_wait (&self->cond, &self->lock);
+
+  /* The builder can also scan the directory itself when it needs it */
+  if (node->state != DIR_QUEUED || g_atomic_int_get (&self->cancelled)) {
+    g_mutex_unlock (&self->lock);
+    dir_node_unref (node);
+    return;
+  }
+  node->state = DIR_SCANNING;
+  g_mutex_unlock (&self->lock);
+
+  dir_scan (self, node);
+  dir_node_unref (node);
+}
+
+static gboolean
+notify_cb (gpointer user_data)
+{
+  GstPlayPlaylist *self = user_data;
+  GstPlayPlaylistFunc func;
+  gpointer data;
+
+  g_mutex_lock (&self->lock);
+  func = self->notify_func;
+  data = self->notify_data;
+  self->notify_func = NULL;
+  self->notify_data = NULL;
+  self->notify_source = 0;
+  g_mutex_unlock (&self->lock);
+
+  if (func)
+    func (data);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Schedules the pending notification once its entry is available */
+static void
+check_notify_locked (GstPlayPlaylist * self)
+{
+  if (self->notify_func && self->notify_source == 0
+      && (self->notify_index < self->length || self->complete))
+    self->notify_source = g_idle_add (notify_cb, self);
+}
+
+static void
+put_varint (GByteArray * data, gsize value)
+{
+  guint8 byte;
+
+  do {
+    byte = value & 0x7f;
+    value >>= 7;
+    if (value)
+      byte |= 0x80;
+    g_byte_array_append (data, &byte, 1);
+  } while (value);
+}
+
+static gsize
+get_varint (const guint8 ** p)
+{
+  gsize value = 0;
+  guint shift = 0;
+
+  do {
+    value |= (gsize) (**p & 0x7f) << shift;
+    shift += 7;
+  } while (*(*p)++ & 0x80);
+
+  return value;
+}
+
+static void
+playlist_append (GstPlayPlaylist * self, const gchar * uri)
+{
+  gsize len, prefix = 0, offset;
+
+  GST_LOG ("Playlist[%u]: %s", self->length, uri);
+
+  len = strlen (uri);
+
+  g_mutex_lock (&self->lock);
+  if (self->length % BLOCK_SIZE == 0) {
+    offset = self->data->len;
+    g_array_append_val (self->blocks, offset);
+  } else {
+    while (prefix < len && prefix < self->last->len
+        && uri[prefix] == self->last->str[prefix])
+      prefix++;
+  }
+
+  put_varint (self->data, prefix);
+  put_varint (self->data, len - prefix);
+  g_byte_array_append (self->data, (const guint8 *) uri + prefix,
+      len - prefix);
+  g_string_assign (self->last, uri);
+  self->length++;
+  g_cond_broadcast (&self->cond);
+  check_notify_locked (self);
+  g_mutex_unlock (&self->lock);
+}
+
+/* Adds the files of @node and its subdirectories. The entries are released
+ * while going, so only the directories on the path to the current one and
+ * the ones that are scanned ahead are kept in memory */
+static void
+playlist_add_dir (GstPlayPlaylist * self, DirNode * node)
+{
+  GArray *entries = NULL;
+  gchar *path, *uri;
+  guint i;
+
+  g_mutex_lock (&self->lock);
+  if (node->state == DIR_QUEUED) {
+    node->state = DIR_SCANNING;
+    g_mutex_unlock (&self->lock);
+    dir_scan (self, node);
+    g_mutex_lock (&self->lock);
+  }
+  while (node->state != DIR_SCANNED && !g_atomic_int_get (&self->cancelled))
+    g_cond_wait (&self->cond, &self->lock);
+  if (node->state == DIR_SCANNED) {
+    entries = node->entries;
+    node->entries = NULL;
+  }
+  g_mutex_unlock (&self->lock);
+
+  if (!entries)
+    return;
+
+  for (i = 0; i < entries->len; i++) {
+    DirEntry *e = &g_array_index (entries, DirEntry, i);
+
+    if (e->dir) {
+      if (!g_atomic_int_get (&self->cancelled))
+        playlist_add_dir (self, e->dir);
+      dir_node_unref (e->dir);
+    } else if (!g_atomic_int_get (&self->cancelled)) {
+      path = g_build_filename (node->path, e->name, NULL);
+      uri = gst_filename_to_uri (path, NULL);
+      if (uri)
+        playlist_append (self, uri);
+      g_free (uri);
+      g_free (path);
+    }
+    g_free (e->name);
+  }
+
+  g_mutex_lock (&self->lock);
+  self->pending -= entries->len;
+  g_cond_broadcast (&self->cond);
+  g_mutex_unlock (&self->lock);
+
+  g_array_free (entries, TRUE);
+}
+
+static void
+playlist_add (GstPlayPlaylist * self, const gchar * filename)
+{
+  DirNode *node;
+  gchar *uri;
+
+  if (gst_uri_is_valid (filename)) {
+    playlist_append (self, filename);
+    return;
+  }
+
+  if (g_file_test (filename, G_FILE_TEST_IS_DIR)) {
+    node = dir_node_new (filename, NULL, self->n_roots++);
+    playlist_add_dir (self, node);
+    dir_node_unref (node);
+    return;
+  }
+
+  uri = gst_filename_to_uri (filename, NULL);
+  if (uri != NULL)
+    playlist_append (self, uri);
+  else
+    g_warning ("Could not make URI out of filename '%s'", filename);
+  g_free (uri);
+}
+
+/* Reads the playlist file line by line instead of loading it at once */
+static void
+playlist_add_file (GstPlayPlaylist * self, const gchar * location)
+{
+  GDataInputStream *data;
+  GFileInputStream *stream;
+  GError *err = NULL;
+  GFile *file;
+  gchar *line;
+
+  file = g_file_new_for_path (location);
+  stream = g_file_read (file, NULL, &err);
+  g_object_unref (file);
+  if (!stream) {
+    g_printerr ("Could not read playlist: %s\n", err->message);
+    g_clear_error (&err);
+    return;
+  }
+
+  data = g_data_input_stream_new (G_INPUT_STREAM (stream));
+  while (!g_atomic_int_get (&self->cancelled)
+      && (line = g_data_input_stream_read_line (data, NULL, NULL, &err))) {
+    if (line[0] != '\0')
+      playlist_add (self, line);
+    g_free (line);
+  }
+  if (err) {
+    g_printerr ("Could not read playlist: %s\n", err->message);
+    g_clear_error (&err);
+  }
+
+  g_object_unref (data);
+  g_object_unref (stream);
+}
+
+static gpointer
+build_func (gpointer user_data)
+{
+  GstPlayPlaylist *self = user_data;
+  guint i;
+
+  self->pool = g_thread_pool_new (scan_func, self, SCAN_THREADS, FALSE, NULL);
+  g_thread_pool_set_sort_function (self->pool, dir_node_compare, NULL);
+
+  if (self->playlist_file)
+    playlist_add_file (self, self->playlist_file);
+
+  for (i = 0; self->filenames && self->filenames[i]; i++) {
+    if (g_atomic_int_get (&self->cancelled))
+      break;
+    GST_LOG ("command line argument: %s", self->filenames[i]);
+    playlist_add (self, self->filenames[i]);
+  }
+
+  /* All directories were scanned, only ones that were scanned by the
+   * builder itself can still be queued */
+  g_thread_pool_free (self->pool, FALSE, TRUE);
+  self->pool = NULL;
+
+  g_mutex_lock (&self->lock);
+  self->complete = TRUE;
+  g_cond_broadcast (&self->cond);
+  check_notify_locked (self);
+  g_mutex_unlock (&self->lock);
+
+  GST_DEBUG ("Playlist complete: %u entries in %u bytes", self->length,
+      self->data->len);
+
+  return NULL;
+}
+
+GstPlayPlaylist *
+gst_play_playlist_new (void)
+{
+  GstPlayPlaylist *self;
+
+  self = g_new0 (GstPlayPlaylist, 1);
+  g_mutex_init (&self->lock);
+  g_cond_init (&self->cond);
+  self->data = g_byte_array_new ();
+  self->blocks = g_array_new (FALSE, FALSE, sizeof (gsize));
+  self->last = g_string_new (NULL);
+
+  return self;
+}
+
+void
+gst_play_playlist_free (GstPlayPlaylist * self)
+{
+  g_atomic_int_set (&self->cancelled, TRUE);
+  g_mutex_lock (&self->lock);
+  g_cond_broadcast (&self->cond);
+  g_mutex_unlock (&self->lock);
+
+  if (self->builder)
+    g_thread_join (self->builder);
+
+  if (self->notify_source)
+    g_source_remove (self->notify_source);
+
+  g_free (self->playlist_file);
+  g_strfreev (self->filenames);
+  g_byte_array_unref (self->data);
+  g_array_free (self->blocks, TRUE);
+  g_string_free (self->last, TRUE);
+  g_cond_clear (&self->cond);
+  g_mutex_clear (&self->lock);
+  g_free (self);
+}
+
+/* Adds the lines of @playlist_file and then @filenames in a thread. Files
+ * in directories are only added if they can contain media */
+void
+gst_play_playlist_build (GstPlayPlaylist * self, const gchar * playlist_file,
+    gchar ** filenames)
+{
+  g_return_if_fail (self->builder == NULL);
+
+  self->playlist_file = g_strdup (playlist_file);
+  self->filenames = g_strdupv (filenames);
+  self->builder = g_thread_new ("playlist-builder", build_func, self);
+}
+
+guint
+gst_play_playlist_get_length (GstPlayPlaylist * self)
+{
+  guint length;
+
+  g_mutex_lock (&self->lock);
+  length = self->length;
+  g_mutex_unlock (&self->lock);
+
+  return length;
+}
+
+gboolean
+gst_play_playlist_is_complete (GstPlayPlaylist * self)
+{
+  gboolean complete;
+
+  g_mutex_lock (&self->lock);
+  complete = self->complete;
+  g_mutex_unlock (&self->lock);
+
+  return complete;
+}
+
+/* Waits until the entry at @index was added. Returns FALSE if the
+ * playlist was completed without it */
+gboolean
+gst_play_playlist_wait (GstPlayPlaylist * self, guint index)
+{
+  gboolean ret;
+
+  g_mutex_lock (&self->lock);
+  while (index >= self->length && !self->complete)
+    g_cond_wait (&self->cond, &self->lock);
+  ret = index < self->length;
+  g_mutex_unlock (&self->lock);
+
+  return ret;
+}
+
+/* Calls @func from the default main context once the entry at @index was
+ * added or the playlist is complete, which can be right away. Replaces
+ * the previous notification, a NULL @func only cancels it */
+void
+gst_play_playlist_notify (GstPlayPlaylist * self, guint index,
+    GstPlayPlaylistFunc func, gpointer user_data)
+{
+  g_mutex_lock (&self->lock);
+  if (self->notify_source) {
+    g_source_remove (self->notify_source);
+    self->notify_source = 0;
+  }
+  self->notify_index = index;
+  self->notify_func = func;
+  self->notify_data = user_data;
+  check_notify_locked (self);
+  g_mutex_unlock (&self->lock);
+}
+
+/* Returns a copy of the URI at @index, or NULL */
+gchar *
+gst_play_playlist_get (GstPlayPlaylist * self, guint index)
+{
+  const guint8 *p;
+  GString *uri;
+  gsize prefix, len;
+  guint i;
+
+  g_mutex_lock (&self->lock);
+  if (index >= self->length) {
+    g_mutex_unlock (&self->lock);
+    return NULL;
+  }
+
+  uri = g_string_new (NULL);
+  p = self->data->data + g_array_index (self->blocks, gsize,
+      index / BLOCK_SIZE);
+  for (i = index - index % BLOCK_SIZE; i <= index; i++) {
+    prefix = get_varint (&p);
+    len = get_varint (&p);
+    g_string_truncate (uri, prefix);
+    g_string_append_len (uri, (const gchar *) p, len);
+    p += len;
+  }
+  g_mutex_unlock (&self->lock);
+
+  return g_string_free (uri, FALSE);
+}
@@ -0,0 +1,40 @@
+/* GStreamer command line playback testing utility - playlist helpers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef __GST_PLAY_PLAYLIST_INCLUDED__
+#define __GST_PLAY_PLAYLIST_INCLUDED__
+
+#include <glib.h>
+
+typedef struct _GstPlayPlaylist GstPlayPlaylist;
+
+typedef void (*GstPlayPlaylistFunc) (gpointer user_data);
+
+GstPlayPlaylist * gst_play_playlist_new (void);
+void gst_play_playlist_free (GstPlayPlaylist * playlist);
+
+void gst_play_playlist_build (GstPlayPlaylist * playlist,
+    const gchar * playlist_file, gchar ** filenames);
+
+guint gst_play_playlist_get_length (GstPlayPlaylist * playlist);
+gboolean gst_play_playlist_is_complete (GstPlayPlaylist * playlist);
+gboolean gst_play_playlist_wait (GstPlayPlaylist * playlist, guint index);
+void gst_play_playlist_notify (GstPlayPlaylist * playlist, guint index,
+    GstPlayPlaylistFunc func, gpointer user_data);
+gchar * gst_play_playlist_get (GstPlayPlaylist * playlist, guint index);
+
+#endif /* __GST_PLAY_PLAYLIST_INCLUDED__ */
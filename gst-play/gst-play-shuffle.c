@@ -0,0 +1,165 @@
+/* GStreamer command line playback testing utility - shuffle helpers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Maps playback positions to playlist indices without storing the order.
+ *
+ * The positions are split into epochs of EPOCH_SIZE, 2 * EPOCH_SIZE,
+ * 4 * EPOCH_SIZE, ... entries and each epoch is permuted on its own by a
+ * Feistel network keyed with the seed and the epoch. The network permutes
+ * the smallest domain of an even number of bits that contains the epoch,
+ * positions outside of the epoch are mapped again until they are inside
+ * ("cycle walking"), which takes less than four rounds on average.
+ *
+ * An epoch can be played as soon as all its entries were added to the
+ * playlist, or the playlist is complete, so playback can start long before
+ * a large playlist was scanned. Because the epochs do not depend on when
+ * entries were added, the same seed always gives the same order.
+ *
+ * If the length of the playlist is known before playback starts, all
+ * positions form a single epoch so that every entry can come first.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gst-play-shuffle.h"
+
+#define EPOCH_SIZE 1024
+#define FEISTEL_ROUNDS 4
+
+struct _GstPlayShuffle
+{
+  guint64 seed;
+  guint length;                 /* 0 while the playlist is growing */
+};
+
+/* splitmix64 finalizer */
+static guint64
+mix (guint64 x)
+{
+  x ^= x >> 30;
+  x *= G_GUINT64_CONSTANT (0xbf58476d1ce4e5b9);
+  x ^= x >> 27;
+  x *= G_GUINT64_CONSTANT (0x94d049bb133111eb);
+  x ^= x >> 31;
+
+  return x;
+}
+
+static guint32
+feistel (guint64 key, guint half_bits, guint32 x)
+{
+  guint32 mask = (1U << half_bits) - 1;
+  guint32 l = x >> half_bits, r = x & mask, t;
+  guint i;
+
+  for (i = 0; i < FEISTEL_ROUNDS; i++) {
+    t = l ^ (mix (key ^ ((guint64) i << 32 | r)) & mask);
+    l = r;
+    r = t;
+  }
+
+  return (l << half_bits) | r;
+}
+
+/* Returns the epoch of @pos and its first and end position */
+static guint
+get_epoch (GstPlayShuffle * self, guint pos, guint64 * start, guint64 * end)
+{
+  guint epoch;
+
+  if (self->length) {
+    *start = 0;
+    *end = self->length;
+    return 0;
+  }
+
+  epoch = g_bit_storage (pos / EPOCH_SIZE + 1) - 1;
+  *start = (((guint64) 1 << epoch) - 1) * EPOCH_SIZE;
+  *end = *start + ((guint64) EPOCH_SIZE << epoch);
+
+  /* Keys of the growing epochs start at 1 */
+  return epoch + 1;
+}
+
+GstPlayShuffle *
+gst_play_shuffle_new (guint64 seed)
+{
+  GstPlayShuffle *self;
+
+  self = g_new0 (GstPlayShuffle, 1);
+  self->seed = seed;
+
+  return self;
+}
+
+void
+gst_play_shuffle_free (GstPlayShuffle * self)
+{
+  g_free (self);
+}
+
+/* Shuffles all @length entries as one, for playlists that are complete
+ * before the first position was looked up */
+void
+gst_play_shuffle_set_length (GstPlayShuffle * self, guint length)
+{
+  self->length = length;
+}
+
+/* Returns the position after the epoch of @pos. The playlist index of
+ * @pos is known once the playlist has this many entries or is complete */
+guint
+gst_play_shuffle_get_epoch_end (GstPlayShuffle * self, guint pos)
+{
+  guint64 start, end;
+
+  get_epoch (self, pos, &start, &end);
+
+  return MIN (end, G_MAXUINT);
+}
+
+/* Returns the playlist index of @pos in a playlist of @length entries,
+ * where @length must not be smaller than the end of the epoch of @pos
+ * unless the playlist is complete */
+guint
+gst_play_shuffle_get_index (GstPlayShuffle * self, guint pos, guint length)
+{
+  guint64 start, end, key;
+  guint epoch, size, bits;
+  guint32 x;
+
+  g_return_val_if_fail (pos < length, pos);
+
+  epoch = get_epoch (self, pos, &start, &end);
+  size = MIN (end, length) - start;
+  if (size < 2)
+    return pos;
+
+  key = mix (self->seed ^ mix (epoch));
+  bits = g_bit_storage (size - 1);
+  bits = MAX ((bits + 1) & ~1U, 2);
+
+  x = pos - start;
+  do {
+    x = feistel (key, bits / 2, x);
+  } while (x >= size);
+
+  return start + x;
+}
@@ -0,0 +1,33 @@
+/* GStreamer command line playback testing utility - shuffle helpers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef __GST_PLAY_SHUFFLE_INCLUDED__
+#define __GST_PLAY_SHUFFLE_INCLUDED__
+
+#include <glib.h>
+
+typedef struct _GstPlayShuffle GstPlayShuffle;
+
+GstPlayShuffle * gst_play_shuffle_new (guint64 seed);
+void gst_play_shuffle_free (GstPlayShuffle * shuffle);
+void gst_play_shuffle_set_length (GstPlayShuffle * shuffle, guint length);
+
+guint gst_play_shuffle_get_epoch_end (GstPlayShuffle * shuffle, guint pos);
+guint gst_play_shuffle_get_index (GstPlayShuffle * shuffle, guint pos,
+    guint length);
+
+#endif /* __GST_PLAY_SHUFFLE_INCLUDED__ */
@@ -21,6 +21,7 @@
  * Boston, MA 02110-1301, USA.
  */
 
+#include <errno.h>
 #include <locale.h>
 
 #include <gst/gst.h>
@@ -29,19 +30,28 @@
 #include <string.h>
 #include <math.h>
 
+#include "gst-play-benchmark.h"
 #include "gst-play-kb.h"
+#include "gst-play-playlist.h"
+#include "gst-play-shuffle.h"
 #include <gst/player/player.h>
 
 #define VOLUME_STEPS 20
+#define MEDIA_INFO_CACHE_SIZE (64 * 1024 * 1024)
 
 GST_DEBUG_CATEGORY (play_debug);
 #define GST_CAT_DEFAULT play_debug
 
 typedef struct
 {
-  gchar **uris;
-  guint num_uris;
+  GstPlayPlaylist *playlist;
+  /* Maps playback positions to playlist indices, or NULL */
+  GstPlayShuffle *shuffle;
   gint cur_idx;
+  /* URIs set with play_uri() that were not reported as loaded yet */
+  guint pending_loads;
+  /* Whether the first item was looked up, see play_next() */
+  gboolean started;
 
   GstPlayer *player;
   GstState desired_state;
@@ -55,6 +65,9 @@ static gboolean play_next (GstPlay * play);
 static gboolean play_prev (GstPlay * play);
 static void play_reset (GstPlay * play);
 static void play_set_relative_volume (GstPlay * play, gdouble volume_step);
+static void play_queue_next (GstPlay * play);
+static gchar *play_uri_get_display_name (GstPlay * play, const gchar * uri);
+static gchar *play_get_uri (GstPlay * play, guint pos);
 
 static void
 end_of_stream_cb (GstPlayer * player, GstPlay * play)
@@ -67,10 +80,37 @@ end_of_stream_cb (GstPlayer * player, GstPlay * play)
   }
 }
 
+static void
+uri_loaded_cb (GstPlayer * player, const gchar * uri, GstPlay * play)
+{
+  gchar *loc;
+
+  if (play->pending_loads > 0) {
+    play->pending_loads--;
+    return;
+  }
+
+  /* the player continued with the next item without gap */
+  if ((play->cur_idx + 1) >= gst_play_playlist_get_length (play->playlist))
+    play->cur_idx = 0;
+  else
+    play->cur_idx++;
+
+  loc = play_uri_get_display_name (play, uri);
+  g_print ("\nNow playing %s\n", loc);
+  g_free (loc);
+
+  play_queue_next (play);
+}
+
 static void
 error_cb (GstPlayer * player, GError * err, GstPlay * play)
 {
-  g_printerr ("ERROR %s for %s\n", err->message, play->uris[play->cur_idx]);
+  gchar *uri;
+
+  uri = play_get_uri (play, play->cur_idx);
+  g_printerr ("ERROR %s for %s\n", err->message, uri);
+  g_free (uri);
 
   /* if looping is enabled, then disable it else will keep looping forever */
   play->repeat = FALSE;
@@ -341,14 +381,13 @@ media_info_cb (GstPlayer * player, GstPlayerMediaInfo * info, GstPlay * play)
 }
 
 static GstPlay *
-play_new (gchar ** uris, gdouble initial_volume)
+play_new (GstPlayPlaylist * playlist, gdouble initial_volume)
 {
   GstPlay *play;
 
   play = g_new0 (GstPlay, 1);
 
-  play->uris = uris;
-  play->num_uris = g_strv_length (uris);
+  play->playlist = playlist;
   play->cur_idx = -1;
 
   play->player = gst_player_new ();
@@ -362,6 +401,8 @@ play_new (gchar ** uris, gdouble initial_volume)
   g_signal_connect (play->player, "end-of-stream",
       G_CALLBACK (end_of_stream_cb), play);
   g_signal_connect (play->player, "error", G_CALLBACK (error_cb), play);
+  g_signal_connect (play->player, "uri-loaded",
+      G_CALLBACK (uri_loaded_cb), play);
 
   g_signal_connect (play->player, "media-info-updated",
       G_CALLBACK (media_info_cb), play);
@@ -383,7 +424,9 @@ play_free (GstPlay * play)
 
   g_main_loop_unref (play->loop);
 
-  g_strfreev (play->uris);
+  gst_play_playlist_free (play->playlist);
+  if (play->shuffle)
+    gst_play_shuffle_free (play->shuffle);
   g_free (play);
 }
 
@@ -424,6 +467,46 @@ play_uri_get_display_name (GstPlay * play, const gchar * uri)
   return loc;
 }
 
+/* returns the playlist index that has to be added before the item at @pos
+ * in playback order is known */
+static guint
+play_get_needed_index (GstPlay * play, guint pos)
+{
+  /* a shuffled position is known once its whole epoch was added */
+  if (play->shuffle)
+    return gst_play_shuffle_get_epoch_end (play->shuffle, pos) - 1;
+
+  return pos;
+}
+
+static gboolean
+play_is_uri_known (GstPlay * play, guint pos)
+{
+  return play_get_needed_index (play, pos) <
+      gst_play_playlist_get_length (play->playlist)
+      || gst_play_playlist_is_complete (play->playlist);
+}
+
+/* returns the URI at @pos in playback order, or NULL if there is none or
+ * it is not known yet */
+static gchar *
+play_get_uri (GstPlay * play, guint pos)
+{
+  guint idx = pos, length;
+
+  if (!play_is_uri_known (play, pos))
+    return NULL;
+
+  length = gst_play_playlist_get_length (play->playlist);
+  if (pos >= length)
+    return NULL;
+
+  if (play->shuffle)
+    idx = gst_play_shuffle_get_index (play->shuffle, pos, length);
+
+  return gst_play_playlist_get (play->playlist, idx);
+}
+
 static void
 play_uri (GstPlay * play, const gchar * next_uri)
 {
@@ -435,24 +518,85 @@ play_uri (GstPlay * play, const gchar * next_uri)
   g_print ("Now playing %s\n", loc);
   g_free (loc);
 
+  /* the item was chosen, don't switch to the one that was waited for */
+  gst_play_playlist_notify (play->playlist, 0, NULL, NULL);
+
+  play->pending_loads++;
   g_object_set (play->player, "uri", next_uri, NULL);
   gst_player_play (play->player);
+
+  play_queue_next (play);
+}
+
+/* queue the following item in the list, so that it is prerolled while the
+ * current one is still playing and played without gap */
+static void
+play_queue_next (GstPlay * play)
+{
+  gchar *next_uri = NULL;
+
+  /* only items that were already added to the playlist, play_next() waits
+   * for the others */
+  next_uri = play_get_uri (play, play->cur_idx + 1);
+  if (next_uri == NULL && play->repeat
+      && gst_play_playlist_is_complete (play->playlist))
+    next_uri = play_get_uri (play, 0);
+
+  gst_player_set_next_uri (play->player, next_uri);
+  g_free (next_uri);
 }
 
-/* returns FALSE if we have reached the end of the playlist */
+static void
+play_next_ready_cb (gpointer user_data)
+{
+  GstPlay *play = user_data;
+
+  if (!play_next (play)) {
+    g_print ("Reached end of play list.\n");
+    g_main_loop_quit (play->loop);
+  }
+}
+
+/* returns FALSE if we have reached the end of the playlist. If the next
+ * item is not known yet it is played once the playlist builder added it,
+ * without blocking the main loop */
 static gboolean
 play_next (GstPlay * play)
 {
-  if ((play->cur_idx + 1) >= play->num_uris) {
-    if (play->repeat) {
+  guint pos = play->cur_idx + 1;
+  gchar *uri;
+
+  /* a playlist that is complete before playback starts is shuffled as
+   * a whole, otherwise in growing epochs */
+  if (play->shuffle && !play->started
+      && gst_play_playlist_is_complete (play->playlist))
+    gst_play_shuffle_set_length (play->shuffle,
+        gst_play_playlist_get_length (play->playlist));
+
+  if (!play_is_uri_known (play, pos)) {
+    GST_DEBUG ("Waiting for playlist entry %u",
+        play_get_needed_index (play, pos));
+    gst_play_playlist_notify (play->playlist,
+        play_get_needed_index (play, pos), play_next_ready_cb, play);
+    return TRUE;
+  }
+  play->started = TRUE;
+
+  uri = play_get_uri (play, pos);
+  if (uri == NULL) {
+    /* the playlist is complete, so its start is known */
+    if (play->repeat && gst_play_playlist_get_length (play->playlist) > 0) {
       g_print ("Looping playlist \n");
       play->cur_idx = -1;
+      uri = play_get_uri (play, 0);
     }
     else
     return FALSE;
   }
 
-  play_uri (play, play->uris[++play->cur_idx]);
+  play->cur_idx++;
+  play_uri (play, uri);
+  g_free (uri);
   return TRUE;
 }
 
@@ -460,80 +604,26 @@ play_next (GstPlay * play)
 static gboolean
 play_prev (GstPlay * play)
 {
-  if (play->cur_idx == 0 || play->num_uris <= 1)
+  gchar *uri;
+
+  if (play->cur_idx <= 0)
     return FALSE;
 
-  play_uri (play, play->uris[--play->cur_idx]);
+  uri = play_get_uri (play, --play->cur_idx);
+  play_uri (play, uri);
+  g_free (uri);
   return TRUE;
 }
 
 static void
 do_play (GstPlay * play)
 {
-  gint i;
-
-  /* dump playlist */
-  for (i = 0; i < play->num_uris; ++i)
-    GST_INFO ("%4u : %s", i, play->uris[i]);
-
   if (!play_next (play))
     return;
 
   g_main_loop_run (play->loop);
 }
 
-static void
-add_to_playlist (GPtrArray * playlist, const gchar * filename)
-{
-  GDir *dir;
-  gchar *uri;
-
-  if (gst_uri_is_valid (filename)) {
-    g_ptr_array_add (playlist, g_strdup (filename));
-    return;
-  }
-
-  if ((dir = g_dir_open (filename, 0, NULL))) {
-    const gchar *entry;
-
-    /* FIXME: sort entries for each directory? */
-    while ((entry = g_dir_read_name (dir))) {
-      gchar *path;
-
-      path = g_strconcat (filename, G_DIR_SEPARATOR_S, entry, NULL);
-      add_to_playlist (playlist, path);
-      g_free (path);
-    }
-
-    g_dir_close (dir);
-    return;
-  }
-
-  uri = gst_filename_to_uri (filename, NULL);
-  if (uri != NULL)
-    g_ptr_array_add (playlist, uri);
-  else
-    g_warning ("Could not make URI out of filename '%s'", filename);
-}
-
-static void
-shuffle_uris (gchar ** uris, guint num)
-{
-  gchar *tmp;
-  guint i, j;
-
-  if (num < 2)
-    return;
-
-  for (i = 0; i < num; i++) {
-    /* gets equally distributed random number in 0..num-1 [0;num[ */
-    j = g_random_int_range (0, num);
-    tmp = uris[j];
-    uris[j] = uris[i];
-    uris[i] = tmp;
-  }
-}
-
 static void
 restore_terminal (void)
 {
@@ -639,23 +729,30 @@ int
 main (int argc, char **argv)
 {
   GstPlay *play;
-  GPtrArray *playlist;
+  GstPlayPlaylist *playlist;
   gboolean print_version = FALSE;
   gboolean interactive = FALSE; /* FIXME: maybe enable by default? */
   gboolean shuffle = FALSE;
+  gchar *shuffle_seed_str = NULL;
+  guint64 shuffle_seed = 0;
+  gboolean benchmark = FALSE;
+  gint benchmark_repeat = 1;
+  gint benchmark_jobs = 1;
+  gchar *benchmark_json = NULL;
   gboolean repeat = FALSE;
   gdouble volume = 1.0;
   gchar **filenames = NULL;
-  gchar **uris;
-  guint num, i;
   GError *err = NULL;
   GOptionContext *ctx;
   gchar *playlist_file = NULL;
+  gchar *media_info_cache_dir = NULL;
   GOptionEntry options[] = {
     {"version", 0, 0, G_OPTION_ARG_NONE, &print_version,
         "Print version information and exit", NULL},
     {"shuffle", 0, 0, G_OPTION_ARG_NONE, &shuffle,
         "Shuffle playlist", NULL},
+    {"shuffle-seed", 0, 0, G_OPTION_ARG_STRING, &shuffle_seed_str,
+        "Shuffle playlist in the order given by SEED", "SEED"},
     {"interactive", 0, 0, G_OPTION_ARG_NONE, &interactive,
         "Interactive control via keyboard", NULL},
     {"volume", 0, 0, G_OPTION_ARG_DOUBLE, &volume,
@@ -663,6 +760,19 @@ main (int argc, char **argv)
     {"playlist", 0, 0, G_OPTION_ARG_FILENAME, &playlist_file,
         "Playlist file containing input media files", NULL},
     {"loop", 0, 0, G_OPTION_ARG_NONE, &repeat, "Repeat all", NULL},
+    {"media-info-cache", 0, 0, G_OPTION_ARG_FILENAME, &media_info_cache_dir,
+        "Directory to cache media information in, to print it before the "
+          "media is prerolled", "DIR"},
+    {"benchmark", 0, 0, G_OPTION_ARG_NONE, &benchmark,
+        "Decode all media as fast as possible without output and print "
+          "timings", NULL},
+    {"benchmark-repeat", 0, 0, G_OPTION_ARG_INT, &benchmark_repeat,
+        "Decode every media N times in benchmark mode", "N"},
+    {"benchmark-jobs", 0, 0, G_OPTION_ARG_INT, &benchmark_jobs,
+        "Decode N media concurrently in benchmark mode", "N"},
+    {"benchmark-json", 0, 0, G_OPTION_ARG_FILENAME, &benchmark_json,
+        "Write the benchmark results as JSON to FILE instead of printing "
+          "them", "FILE"},
     {G_OPTION_REMAINING, 0, 0, G_OPTION_ARG_FILENAME_ARRAY, &filenames, NULL},
     {NULL}
   };
@@ -680,6 +790,29 @@ main (int argc, char **argv)
 
   GST_DEBUG_CATEGORY_INIT (play_debug, "play", 0, "gst-play");
 
+  if (shuffle_seed_str) {
+    gchar *end = NULL;
+
+    /* g_ascii_strtoull() would silently negate negative numbers */
+    errno = 0;
+    if (g_ascii_isdigit (shuffle_seed_str[0]))
+      shuffle_seed = g_ascii_strtoull (shuffle_seed_str, &end, 10);
+    if (end == NULL || *end != '\0' || errno != 0) {
+      g_printerr ("Invalid shuffle seed '%s', must be a number between 0 "
+          "and %" G_GUINT64_FORMAT "\n", shuffle_seed_str, G_MAXUINT64);
+      g_free (shuffle_seed_str);
+      g_free (playlist_file);
+      g_free (media_info_cache_dir);
+      g_free (benchmark_json);
+      g_strfreev (filenames);
+      return 1;
+    }
+    g_free (shuffle_seed_str);
+    shuffle = TRUE;
+  } else if (shuffle) {
+    shuffle_seed = ((guint64) g_random_int () << 32) | g_random_int ();
+  }
+
   if (print_version) {
     gchar *version_str;
 
@@ -689,70 +822,59 @@ main (int argc, char **argv)
     g_free (version_str);
 
     g_free (playlist_file);
+    g_free (media_info_cache_dir);
+    g_free (benchmark_json);
 
     return 0;
   }
 
-  playlist = g_ptr_array_new ();
-
-  if (playlist_file != NULL) {
-    gchar *playlist_contents = NULL;
-    gchar **lines = NULL;
-
-    if (g_file_get_contents (playlist_file, &playlist_contents, NULL, &err)) {
-      lines = g_strsplit (playlist_contents, "\n", 0);
-      num = g_strv_length (lines);
-
-      for (i = 0; i < num; i++) {
-        if (lines[i][0] != '\0') {
-          GST_LOG ("Playlist[%d]: %s", i + 1, lines[i]);
-          add_to_playlist (playlist, lines[i]);
-        }
-      }
-      g_strfreev (lines);
-      g_free (playlist_contents);
-    } else {
-      g_printerr ("Could not read playlist: %s\n", err->message);
-      g_clear_error (&err);
-    }
-    g_free (playlist_file);
-    playlist_file = NULL;
-  }
-
-  if (playlist->len == 0 && (filenames == NULL || *filenames == NULL)) {
+  if (playlist_file == NULL && (filenames == NULL || *filenames == NULL)) {
     g_printerr ("Usage: %s FILE1|URI1 [FILE2|URI2] [FILE3|URI3] ...",
         "gst-play");
     g_printerr ("\n\n"),
         g_printerr ("%s\n\n",
         "You must provide at least one filename or URI to play.");
-    /* No input provided. Free array */
-    g_ptr_array_free (playlist, TRUE);
 
     return 1;
   }
 
-  /* fill playlist */
-  if (filenames != NULL && *filenames != NULL) {
-    num = g_strv_length (filenames);
-    for (i = 0; i < num; ++i) {
-      GST_LOG ("command line argument: %s", filenames[i]);
-      add_to_playlist (playlist, filenames[i]);
-    }
-    g_strfreev (filenames);
-  }
+  /* fill playlist, playback starts as soon as the first item was added */
+  playlist = gst_play_playlist_new ();
+  gst_play_playlist_build (playlist, playlist_file, filenames);
+  g_free (playlist_file);
+  g_strfreev (filenames);
 
-  num = playlist->len;
-  g_ptr_array_add (playlist, NULL);
+  if (benchmark) {
+    gboolean ok;
 
-  uris = (gchar **) g_ptr_array_free (playlist, FALSE);
+    ok = gst_play_benchmark (playlist, MAX (benchmark_repeat, 1),
+        MAX (benchmark_jobs, 1), benchmark_json);
+    gst_play_playlist_free (playlist);
+    g_free (benchmark_json);
+    g_free (media_info_cache_dir);
 
-  if (shuffle)
-    shuffle_uris (uris, num);
+    return ok ? 0 : 1;
+  }
 
   /* prepare */
-  play = play_new (uris, volume);
+  play = play_new (playlist, volume);
   play->repeat = repeat;
 
+  if (shuffle) {
+    g_print ("Shuffle seed: %" G_GUINT64_FORMAT "\n", shuffle_seed);
+    play->shuffle = gst_play_shuffle_new (shuffle_seed);
+  }
+
+  if (media_info_cache_dir) {
+    GstPlayerMediaInfoCache *cache;
+
+    cache = gst_player_media_info_cache_new (media_info_cache_dir,
+        MEDIA_INFO_CACHE_SIZE);
+    gst_player_set_media_info_cache (play->player, cache);
+    g_object_unref (cache);
+    g_free (media_info_cache_dir);
+  }
+
   if (interactive) {
     if (gst_play_kb_set_key_handler (keyboard_cb, play)) {
       atexit (restore_terminal);
@@ -48,6 +48,8 @@ typedef struct
 
   GList *uris;
   GList *current_uri;
+  /* URIs set with gst_player_set_uri() not reported as loaded yet */
+  guint pending_loads;
 
   GtkWidget *window;
   GtkWidget *play_pause_button;
@@ -95,6 +97,8 @@ enum
 };
 
 static void display_cover_art (GtkPlay * play, GstPlayerMediaInfo * media_info);
+static void queue_next_uri (GtkPlay * play);
+static void repeat_toggled_cb (GtkToggleButton * button, GtkPlay * play);
 
 static void
 set_title (GtkPlay * play, const gchar * title)
@@ -169,9 +173,11 @@ skip_prev_clicked_cb (GtkButton * button, GtkPlay * play)
   gtk_widget_set_sensitive (play->next_button, TRUE);
   gtk_widget_set_sensitive (play->media_info_button, FALSE);
   gtk_range_set_range (GTK_RANGE (play->seekbar), 0, 0);
+  play->pending_loads++;
   gst_player_set_uri (play->player, prev->data);
   play->current_uri = prev;
   gst_player_play (play->player);
+  queue_next_uri (play);
   set_title (play, prev->data);
   gtk_widget_set_sensitive (play->prev_button, g_list_previous (prev) != NULL);
 }
@@ -191,9 +197,11 @@ skip_next_clicked_cb (GtkButton * button, GtkPlay * play)
   gtk_widget_set_sensitive (play->prev_button, TRUE);
   gtk_widget_set_sensitive (play->media_info_button, FALSE);
   gtk_range_set_range (GTK_RANGE (play->seekbar), 0, 0);
+  play->pending_loads++;
   gst_player_set_uri (play->player, next->data);
   play->current_uri = next;
   gst_player_play (play->player);
+  queue_next_uri (play);
   set_title (play, next->data);
   gtk_widget_set_sensitive (play->next_button, g_list_next (next) != NULL);
 }
@@ -902,6 +910,8 @@ create_ui (GtkPlay * play)
   if (play->loop)
     gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (play->repeat_button),
         TRUE);
+  g_signal_connect (G_OBJECT (play->repeat_button), "toggled",
+      G_CALLBACK (repeat_toggled_cb), play);
 
   /* Volume control button */
   play->volume_button = gtk_volume_button_new ();
@@ -982,33 +992,83 @@ position_updated_cb (GstPlayer * unused, GstClockTime position, GtkPlay * play)
       play->seekbar_value_changed_signal_id);
 }
 
+static GList *
+get_next_uri (GtkPlay * play)
+{
+  GList *next;
+
+  next = g_list_next (play->current_uri);
+  if (!next && gtk_toggle_button_get_active
+        (GTK_TOGGLE_BUTTON(play->repeat_button)))
+    next = g_list_first (play->uris);
+
+  return next;
+}
+
+/* Let the player preroll the next item while the current one is still
+ * playing, so that it continues without gap */
+static void
+queue_next_uri (GtkPlay * play)
+{
+  GList *next = get_next_uri (play);
+
+  gst_player_set_next_uri (play->player, next ? next->data : NULL);
+}
+
+static void
+repeat_toggled_cb (GtkToggleButton * button, GtkPlay * play)
+{
+  queue_next_uri (play);
+}
+
+static void
+switch_to_uri (GtkPlay * play, GList * next)
+{
+  if (!gtk_widget_is_sensitive (play->prev_button))
+    gtk_widget_set_sensitive (play->prev_button, TRUE);
+  gtk_widget_set_sensitive (play->next_button, g_list_next (next) != NULL);
+  if (play->image_pixbuf)
+    g_object_unref (play->image_pixbuf);
+  play->image_pixbuf = NULL;
+
+  gtk_widget_set_sensitive (play->media_info_button, FALSE);
+  gtk_range_set_range (GTK_RANGE (play->seekbar), 0, 0);
+
+  play->current_uri = next;
+  set_title (play, next->data);
+}
+
+static void
+uri_loaded_cb (GstPlayer * unused, const gchar * uri, GtkPlay * play)
+{
+  GList *next;
+
+  if (play->pending_loads > 0) {
+    play->pending_loads--;
+    return;
+  }
+
+  /* The player continued with the queued next item */
+  next = get_next_uri (play);
+  g_return_if_fail (next != NULL);
+
+  switch_to_uri (play, next);
+  queue_next_uri (play);
+}
+
 static void
 eos_cb (GstPlayer * unused, GtkPlay * play)
 {
   if (play->playing) {
-    GList *next = NULL;
-    gchar *uri;
-
-    next = g_list_next (play->current_uri);
-    if (!next && gtk_toggle_button_get_active
-          (GTK_TOGGLE_BUTTON(play->repeat_button)))
-      next = g_list_first (play->uris);
+    GList *next = get_next_uri (play);
 
     if (next) {
-      if (!gtk_widget_is_sensitive (play->prev_button))
-        gtk_widget_set_sensitive (play->prev_button, TRUE);
-      gtk_widget_set_sensitive (play->next_button, g_list_next (next) != NULL);
-      if (play->image_pixbuf)
-        g_object_unref (play->image_pixbuf);
-      play->image_pixbuf = NULL;
-
-      gtk_widget_set_sensitive (play->media_info_button, FALSE);
-      gtk_range_set_range (GTK_RANGE (play->seekbar), 0, 0);
+      switch_to_uri (play, next);
 
+      play->pending_loads++;
       gst_player_set_uri (play->player, next->data);
-      play->current_uri = next;
       gst_player_play (play->player);
-      set_title (play, next->data);
+      queue_next_uri (play);
     } else {
       GtkWidget *image;
 
@@ -1233,8 +1293,6 @@ main (gint argc, gchar ** argv)
 
   g_object_set (play.player, "dispatch-to-main-context", TRUE, NULL);
 
-  gst_player_set_uri (play.player, g_list_first (play.uris)->data);
-
   create_ui (&play);
 
   if (list_length > 1)
@@ -1245,13 +1303,18 @@ main (gint argc, gchar ** argv)
   g_signal_connect (play.player, "duration-changed",
       G_CALLBACK (duration_changed_cb), &play);
   g_signal_connect (play.player, "end-of-stream", G_CALLBACK (eos_cb), &play);
+  g_signal_connect (play.player, "uri-loaded", G_CALLBACK (uri_loaded_cb),
+      &play);
   g_signal_connect (play.player, "media-info-updated",
       G_CALLBACK (media_info_updated_cb), &play);
 
   /* We have file(s) that need playing. */
   set_title (&play, g_list_first (play.uris)->data);
+  play.pending_loads++;
+  gst_player_set_uri (play.player, g_list_first (play.uris)->data);
   gst_player_play (play.player);
   play.current_uri = g_list_first (play.uris);
+  queue_next_uri (&play);
 
   gtk_main ();
 
@@ -0,0 +1,56 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_PLAYER_AUDIO_ANALYSIS_PRIVATE_H__
+#define __GST_PLAYER_AUDIO_ANALYSIS_PRIVATE_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+/* Maximum number of spectrum bands */
+#define GST_PLAYER_AUDIO_ANALYSIS_MAX_BANDS 128
+
+typedef struct _GstPlayerAudioAnalysis GstPlayerAudioAnalysis;
+
+G_GNUC_INTERNAL GstPlayerAudioAnalysis *
+                        gst_player_audio_analysis_new       (void);
+G_GNUC_INTERNAL void    gst_player_audio_analysis_free      (GstPlayerAudioAnalysis *analysis);
+
+G_GNUC_INTERNAL void    gst_player_audio_analysis_configure (GstPlayerAudioAnalysis *analysis,
+                                                             GstClockTime interval,
+                                                             guint n_bands);
+G_GNUC_INTERNAL gboolean
+                        gst_player_audio_analysis_set_caps  (GstPlayerAudioAnalysis *analysis,
+                                                             GstCaps *caps);
+G_GNUC_INTERNAL void    gst_player_audio_analysis_set_segment
+                                                            (GstPlayerAudioAnalysis *analysis,
+                                                             const GstSegment *segment);
+G_GNUC_INTERNAL void    gst_player_audio_analysis_reset     (GstPlayerAudioAnalysis *analysis);
+
+G_GNUC_INTERNAL GstStructure *
+                        gst_player_audio_analysis_process   (GstPlayerAudioAnalysis *analysis,
+                                                             GstBuffer *buffer);
+
+G_GNUC_INTERNAL const gchar *
+                        gst_player_audio_analysis_get_kernel_name
+                                                            (GstPlayerAudioAnalysis *analysis);
+
+G_END_DECLS
+
+#endif /* __GST_PLAYER_AUDIO_ANALYSIS_PRIVATE_H__ */
@@ -0,0 +1,758 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Peak, RMS and spectrum of the played audio, see
+ * GstPlayer::audio-levels.
+ *
+ * Peak and RMS are accumulated over every sample with vectorized kernels.
+ * The vector lanes are assigned to channels round robin, which works for
+ * all channel counts that divide the number of lanes. Other channel counts
+ * and CPUs without a vector unit use the scalar kernel.
+ *
+ * The spectrum is only computed once per interval from the last
+ * FFT_SIZE frames, so it does not need to be fast.
+ */
+
+#include "gstplayer-audio-analysis-private.h"
+
+#include <math.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_X86_KERNELS 1
+#include <immintrin.h>
+#elif defined(__GNUC__) && defined(__ARM_NEON)
+#define HAVE_NEON_KERNELS 1
+#include <arm_neon.h>
+#endif
+
+GST_DEBUG_CATEGORY_STATIC (gst_player_audio_analysis_debug);
+#define GST_CAT_DEFAULT gst_player_audio_analysis_debug
+
+#define MAX_CHANNELS 64
+#define FFT_SIZE 1024
+#define MIN_DB -100.0
+#define MIN_FREQUENCY 20.0
+/* Samples per kernel call, the float accumulators of the vectorized
+ * kernels lose precision on longer runs */
+#define KERNEL_BLOCK 4096
+
+typedef enum
+{
+  SAMPLE_FORMAT_UNKNOWN,
+  SAMPLE_FORMAT_S16,
+  SAMPLE_FORMAT_F32
+} SampleFormat;
+
+/* Adds the absolute peak and the sum of squares of @n_samples interleaved
+ * samples to the accumulators of their channels. @n_samples is a multiple
+ * of @channels */
+typedef void (*LevelKernel) (gconstpointer data, guint n_samples,
+    guint channels, gfloat * peak, gdouble * sumsq);
+
+typedef struct
+{
+  const gchar *name;
+  guint lanes;
+  LevelKernel s16, f32;
+} LevelKernels;
+
+struct _GstPlayerAudioAnalysis
+{
+  GMutex lock;
+  volatile gint enabled;
+
+  /* Protected by lock */
+  GstClockTime interval;
+  guint n_bands;
+
+  SampleFormat format;
+  guint channels, rate, bpf;
+  const LevelKernels *kernels;
+  LevelKernel kernel;
+  GstSegment segment;
+
+  guint64 interval_frames;
+  guint64 n_frames;
+  gfloat peak[MAX_CHANNELS];
+  gdouble sumsq[MAX_CHANNELS];
+
+  /* Last FFT_SIZE frames downmixed to mono, only with n_bands > 0 */
+  gfloat *history;
+  guint history_pos;
+  gfloat *window;
+  gdouble window_sum;
+};
+
+static void
+level_fold (const gfloat * lane_peak, const gfloat * lane_sumsq, guint lanes,
+    guint channels, gfloat * peak, gdouble * sumsq)
+{
+  guint l, c;
+
+  for (l = 0; l < lanes; l++) {
+    c = l % channels;
+    peak[c] = MAX (peak[c], lane_peak[l]);
+    sumsq[c] += lane_sumsq[l];
+  }
+}
+
+static void
+level_s16_scalar (gconstpointer data, guint n_samples, guint channels,
+    gfloat * peak, gdouble * sumsq)
+{
+  const gint16 *s = data;
+  guint i, c = 0;
+  gfloat v;
+
+  for (i = 0; i < n_samples; i++) {
+    v = s[i] * (1.0f / 32768.0f);
+    peak[c] = MAX (peak[c], fabsf (v));
+    sumsq[c] += v * v;
+    if (++c == channels)
+      c = 0;
+  }
+}
+
+static void
+level_f32_scalar (gconstpointer data, guint n_samples, guint channels,
+    gfloat * peak, gdouble * sumsq)
+{
+  const gfloat *s = data;
+  guint i, c = 0;
+  gfloat v;
+
+  for (i = 0; i < n_samples; i++) {
+    v = s[i];
+    peak[c] = MAX (peak[c], fabsf (v));
+    sumsq[c] += v * v;
+    if (++c == channels)
+      c = 0;
+  }
+}
+
+static const LevelKernels scalar_kernels = {
+  "scalar", 1, level_s16_scalar, level_f32_scalar
+};
+
+#ifdef HAVE_X86_KERNELS
+__attribute__ ((target ("sse2")))
+static void
+level_s16_sse2 (gconstpointer data, guint n_samples, guint channels,
+    gfloat * peak, gdouble * sumsq)
+{
+  const gint16 *s = data;
+  const __m128 sign = _mm_set1_ps (-0.0f);
+  const __m128 scale = _mm_set1_ps (1.0f / 32768.0f);
+  __m128 vpeak = _mm_setzero_ps (), vsum = _mm_setzero_ps ();
+  __m128i x;
+  __m128 a, b;
+  gfloat lane_peak[4], lane_sumsq[4];
+  guint i, n = n_samples & ~7u;
+
+  for (i = 0; i < n; i += 8) {
+    x = _mm_loadu_si128 ((const __m128i *) (s + i));
+    a = _mm_cvtepi32_ps (_mm_srai_epi32 (_mm_unpacklo_epi16 (x, x), 16));
+    b = _mm_cvtepi32_ps (_mm_srai_epi32 (_mm_unpackhi_epi16 (x, x), 16));
+    a = _mm_mul_ps (a, scale);
+    b = _mm_mul_ps (b, scale);
+    vpeak = _mm_max_ps (vpeak, _mm_max_ps (_mm_andnot_ps (sign, a),
+            _mm_andnot_ps (sign, b)));
+    vsum = _mm_add_ps (vsum, _mm_add_ps (_mm_mul_ps (a, a),
+            _mm_mul_ps (b, b)));
+  }
+
+  _mm_storeu_ps (lane_peak, vpeak);
+  _mm_storeu_ps (lane_sumsq, vsum);
+  level_fold (lane_peak, lane_sumsq, 4, channels, peak, sumsq);
+  level_s16_scalar (s + n, n_samples - n, channels, peak, sumsq);
+}
+
+__attribute__ ((target ("sse2")))
+static void
+level_f32_sse2 (gconstpointer data, guint n_samples, guint channels,
+    gfloat * peak, gdouble * sumsq)
+{
+  const gfloat *s = data;
+  const __m128 sign = _mm_set1_ps (-0.0f);
+  __m128 vpeak = _mm_setzero_ps (), vsum = _mm_setzero_ps ();
+  __m128 v;
+  gfloat lane_peak[4], lane_sumsq[4];
+  guint i, n = n_samples & ~3u;
+
+  for (i = 0; i < n; i += 4) {
+    v = _mm_loadu_ps (s + i);
+    vpeak = _mm_max_ps (vpeak, _mm_andnot_ps (sign, v));
+    vsum = _mm_add_ps (vsum, _mm_mul_ps (v, v));
+  }
+
+  _mm_storeu_ps (lane_peak, vpeak);
+  _mm_storeu_ps (lane_sumsq, vsum);
+  level_fold (lane_peak, lane_sumsq, 4, channels, peak, sumsq);
+  level_f32_scalar (s + n, n_samples - n, channels, peak, sumsq);
+}
+
+static const LevelKernels sse2_kernels = {
+  "sse2", 4, level_s16_sse2, level_f32_sse2
+};
+
+__attribute__ ((target ("avx2")))
+static void
+level_s16_avx2 (gconstpointer data, guint n_samples, guint channels,
+    gfloat * peak, gdouble * sumsq)
+{
+  const gint16 *s = data;
+  const __m256 sign = _mm256_set1_ps (-0.0f);
+  const __m256 scale = _mm256_set1_ps (1.0f / 32768.0f);
+  __m256 vpeak = _mm256_setzero_ps (), vsum = _mm256_setzero_ps ();
+  __m256 v;
+  __m128i x;
+  gfloat lane_peak[8], lane_sumsq[8];
+  guint i, n = n_samples & ~7u;
+
+  for (i = 0; i < n; i += 8) {
+    x = _mm_loadu_si128 ((const __m128i *) (s + i));
+    v = _mm256_cvtepi32_ps (_mm256_cvtepi16_epi32 (x));
+    v = _mm256_mul_ps (v, scale);
+    vpeak = _mm256_max_ps (vpeak, _mm256_andnot_ps (sign, v));
+    vsum = _mm256_add_ps (vsum, _mm256_mul_ps (v, v));
+  }
+
+  _mm256_storeu_ps (lane_peak, vpeak);
+  _mm256_storeu_ps (lane_sumsq, vsum);
+  level_fold (lane_peak, lane_sumsq, 8, channels, peak, sumsq);
+  level_s16_scalar (s + n, n_samples - n, channels, peak, sumsq);
+}
+
+__attribute__ ((target ("avx2")))
+static void
+level_f32_avx2 (gconstpointer data, guint n_samples, guint channels,
+    gfloat * peak, gdouble * sumsq)
+{
+  const gfloat *s = data;
+  const __m256 sign = _mm256_set1_ps (-0.0f);
+  __m256 vpeak = _mm256_setzero_ps (), vsum = _mm256_setzero_ps ();
+  __m256 v;
+  gfloat lane_peak[8], lane_sumsq[8];
+  guint i, n = n_samples & ~7u;
+
+  for (i = 0; i < n; i += 8) {
+    v = _mm256_loadu_ps (s + i);
+    vpeak = _mm256_max_ps (vpeak, _mm256_andnot_ps (sign, v));
+    vsum = _mm256_add_ps (vsum, _mm256_mul_ps (v, v));
+  }
+
+  _mm256_storeu_ps (lane_peak, vpeak);
+  _mm256_storeu_ps (lane_sumsq, vsum);
+  level_fold (lane_peak, lane_sumsq, 8, channels, peak, sumsq);
+  level_f32_scalar (s + n, n_samples - n, channels, peak, sumsq);
+}
+
+static const LevelKernels avx2_kernels = {
+  "avx2", 8, level_s16_avx2, level_f32_avx2
+};
+#endif
+
+#ifdef HAVE_NEON_KERNELS
+static void
+level_s16_neon (gconstpointer data, guint n_samples, guint channels,
+    gfloat * peak, gdouble * sumsq)
+{
+  const gint16 *s = data;
+  float32x4_t vpeak = vdupq_n_f32 (0.0f), vsum = vdupq_n_f32 (0.0f);
+  float32x4_t a, b;
+  int16x8_t x;
+  gfloat lane_peak[4], lane_sumsq[4];
+  guint i, n = n_samples & ~7u;
+
+  for (i = 0; i < n; i += 8) {
+    x = vld1q_s16 (s + i);
+    a = vmulq_n_f32 (vcvtq_f32_s32 (vmovl_s16 (vget_low_s16 (x))),
+        1.0f / 32768.0f);
+    b = vmulq_n_f32 (vcvtq_f32_s32 (vmovl_s16 (vget_high_s16 (x))),
+        1.0f / 32768.0f);
+    vpeak = vmaxq_f32 (vpeak, vmaxq_f32 (vabsq_f32 (a), vabsq_f32 (b)));
+    vsum = vmlaq_f32 (vmlaq_f32 (vsum, a, a), b, b);
+  }
+
+  vst1q_f32 (lane_peak, vpeak);
+  vst1q_f32 (lane_sumsq, vsum);
+  level_fold (lane_peak, lane_sumsq, 4, channels, peak, sumsq);
+  level_s16_scalar (s + n, n_samples - n, channels, peak, sumsq);
+}
+
+static void
+level_f32_neon (gconstpointer data, guint n_samples, guint channels,
+    gfloat * peak, gdouble * sumsq)
+{
+  const gfloat *s = data;
+  float32x4_t vpeak = vdupq_n_f32 (0.0f), vsum = vdupq_n_f32 (0.0f);
+  float32x4_t v;
+  gfloat lane_peak[4], lane_sumsq[4];
+  guint i, n = n_samples & ~3u;
+
+  for (i = 0; i < n; i += 4) {
+    v = vld1q_f32 (s + i);
+    vpeak = vmaxq_f32 (vpeak, vabsq_f32 (v));
+    vsum = vmlaq_f32 (vsum, v, v);
+  }
+
+  vst1q_f32 (lane_peak, vpeak);
+  vst1q_f32 (lane_sumsq, vsum);
+  level_fold (lane_peak, lane_sumsq, 4, channels, peak, sumsq);
+  level_f32_scalar (s + n, n_samples - n, channels, peak, sumsq);
+}
+
+static const LevelKernels neon_kernels = {
+  "neon", 4, level_s16_neon, level_f32_neon
+};
+#endif
+
+/* Kernels of the widest vector unit of the CPU, ordered by decreasing
+ * number of lanes and terminated by the scalar kernels */
+static const LevelKernels *cpu_kernels[4];
+
+static gpointer
+cpu_kernels_init (gpointer data)
+{
+  guint n = 0;
+
+#ifdef HAVE_X86_KERNELS
+  __builtin_cpu_init ();
+  if (__builtin_cpu_supports ("avx2"))
+    cpu_kernels[n++] = &avx2_kernels;
+  if (__builtin_cpu_supports ("sse2"))
+    cpu_kernels[n++] = &sse2_kernels;
+#endif
+#ifdef HAVE_NEON_KERNELS
+  cpu_kernels[n++] = &neon_kernels;
+#endif
+  cpu_kernels[n] = &scalar_kernels;
+
+  GST_DEBUG_CATEGORY_INIT (gst_player_audio_analysis_debug,
+      "gst-player-audio-analysis", 0, "GstPlayer audio analysis");
+  GST_DEBUG ("Using %s level kernels", cpu_kernels[0]->name);
+
+  return NULL;
+}
+
+/* Returns the kernels with the most lanes that fit @channels */
+static const LevelKernels *
+level_kernels_get (guint channels)
+{
+  guint i;
+
+  for (i = 0; cpu_kernels[i]->lanes > 1; i++)
+    if (cpu_kernels[i]->lanes % channels == 0)
+      break;
+
+  return cpu_kernels[i];
+}
+
+/* In-place radix-2 FFT of FFT_SIZE complex values */
+static void
+fft (gfloat * re, gfloat * im)
+{
+  guint i, j, k, bit, len, half;
+  gdouble wr, wi, cr, ci, t;
+  gfloat ur, ui, vr, vi, tmp;
+
+  for (i = 1, j = 0; i < FFT_SIZE; i++) {
+    for (bit = FFT_SIZE >> 1; j & bit; bit >>= 1)
+      j ^= bit;
+    j ^= bit;
+    if (i < j) {
+      tmp = re[i];
+      re[i] = re[j];
+      re[j] = tmp;
+      tmp = im[i];
+      im[i] = im[j];
+      im[j] = tmp;
+    }
+  }
+
+  for (len = 2; len <= FFT_SIZE; len <<= 1) {
+    half = len / 2;
+    wr = cos (-2.0 * G_PI / len);
+    wi = sin (-2.0 * G_PI / len);
+    for (i = 0; i < FFT_SIZE; i += len) {
+      cr = 1.0;
+      ci = 0.0;
+      for (k = 0; k < half; k++) {
+        ur = re[i + k];
+        ui = im[i + k];
+        vr = re[i + k + half] * cr - im[i + k + half] * ci;
+        vi = re[i + k + half] * ci + im[i + k + half] * cr;
+        re[i + k] = ur + vr;
+        im[i + k] = ui + vi;
+        re[i + k + half] = ur - vr;
+        im[i + k + half] = ui - vi;
+        t = cr * wr - ci * wi;
+        ci = cr * wi + ci * wr;
+        cr = t;
+      }
+    }
+  }
+}
+
+static gdouble
+amplitude_to_db (gdouble amplitude)
+{
+  if (amplitude <= 0.0)
+    return MIN_DB;
+
+  return MAX (20.0 * log10 (amplitude), MIN_DB);
+}
+
+static void
+structure_set_doubles (GstStructure * s, const gchar * field,
+    const gdouble * values, guint n_values)
+{
+  GValue array = G_VALUE_INIT;
+  GValue value = G_VALUE_INIT;
+  guint i;
+
+  g_value_init (&array, GST_TYPE_ARRAY);
+  g_value_init (&value, G_TYPE_DOUBLE);
+  for (i = 0; i < n_values; i++) {
+    g_value_set_double (&value, values[i]);
+    gst_value_array_append_value (&array, &value);
+  }
+  gst_structure_take_value (s, field, &array);
+  g_value_unset (&value);
+}
+
+/* Must be called with lock */
+static void
+spectrum_compute_locked (GstPlayerAudioAnalysis * self, GstStructure * s)
+{
+  gfloat re[FFT_SIZE], im[FFT_SIZE];
+  gdouble bands[GST_PLAYER_AUDIO_ANALYSIS_MAX_BANDS];
+  gdouble fmin, fmax, amplitude, scale;
+  guint i, b, first, last;
+
+  for (i = 0; i < FFT_SIZE; i++) {
+    re[i] = self->history[(self->history_pos + i) % FFT_SIZE]
+        * self->window[i];
+    im[i] = 0.0f;
+  }
+  fft (re, im);
+
+  /* Bands are spaced logarithmically, a full scale sine is at 0 dB */
+  scale = 2.0 / self->window_sum;
+  fmax = self->rate / 2.0;
+  fmin = MIN (MIN_FREQUENCY, fmax / 2.0);
+  for (b = 0; b < self->n_bands; b++) {
+    first = fmin * pow (fmax / fmin, (gdouble) b / self->n_bands)
+        * FFT_SIZE / self->rate;
+    last = fmin * pow (fmax / fmin, (gdouble) (b + 1) / self->n_bands)
+        * FFT_SIZE / self->rate;
+    first = CLAMP (first, 1, FFT_SIZE / 2);
+    last = CLAMP (last, first, FFT_SIZE / 2);
+
+    amplitude = 0.0;
+    for (i = first; i <= last; i++)
+      amplitude = MAX (amplitude, sqrt (re[i] * re[i] + im[i] * im[i]));
+    bands[b] = amplitude_to_db (amplitude * scale);
+  }
+
+  structure_set_doubles (s, "spectrum", bands, self->n_bands);
+}
+
+/* Must be called with lock */
+static GstStructure *
+interval_finish_locked (GstPlayerAudioAnalysis * self, GstClockTime end)
+{
+  gdouble peak[MAX_CHANNELS], rms[MAX_CHANNELS];
+  GstStructure *s;
+  guint c;
+
+  for (c = 0; c < self->channels; c++) {
+    peak[c] = amplitude_to_db (self->peak[c]);
+    rms[c] = amplitude_to_db (sqrt (self->sumsq[c] / self->n_frames));
+  }
+
+  if (GST_CLOCK_TIME_IS_VALID (end))
+    end = gst_segment_to_stream_time (&self->segment, GST_FORMAT_TIME, end);
+
+  s = gst_structure_new ("application/x-gst-player-audio-levels",
+      "timestamp", G_TYPE_UINT64, end, NULL);
+  structure_set_doubles (s, "peak", peak, self->channels);
+  structure_set_doubles (s, "rms", rms, self->channels);
+  if (self->n_bands > 0)
+    spectrum_compute_locked (self, s);
+
+  self->n_frames = 0;
+  memset (self->peak, 0, sizeof (self->peak));
+  memset (self->sumsq, 0, sizeof (self->sumsq));
+
+  return s;
+}
+
+/* Must be called with lock */
+static void
+history_append_locked (GstPlayerAudioAnalysis * self, const guint8 * data,
+    guint n_frames)
+{
+  guint i, c;
+  gfloat v;
+
+  if (n_frames > FFT_SIZE) {
+    data += (n_frames - FFT_SIZE) * self->bpf;
+    n_frames = FFT_SIZE;
+  }
+
+  for (i = 0; i < n_frames; i++) {
+    v = 0.0f;
+    if (self->format == SAMPLE_FORMAT_F32) {
+      for (c = 0; c < self->channels; c++)
+        v += ((const gfloat *) data)[i * self->channels + c];
+    } else {
+      for (c = 0; c < self->channels; c++)
+        v += ((const gint16 *) data)[i * self->channels + c] / 32768.0f;
+    }
+    self->history[self->history_pos] = v / self->channels;
+    self->history_pos = (self->history_pos + 1) % FFT_SIZE;
+  }
+}
+
+/* Must be called with lock */
+static void
+level_accumulate_locked (GstPlayerAudioAnalysis * self, const guint8 * data,
+    guint n_frames)
+{
+  guint block, n;
+
+  block = KERNEL_BLOCK / self->channels;
+  while (n_frames > 0) {
+    n = MIN (n_frames, block);
+    self->kernel (data, n * self->channels, self->channels, self->peak,
+        self->sumsq);
+    data += n * self->bpf;
+    n_frames -= n;
+  }
+}
+
+/* Must be called with lock */
+static void
+interval_reset_locked (GstPlayerAudioAnalysis * self)
+{
+  self->n_frames = 0;
+  memset (self->peak, 0, sizeof (self->peak));
+  memset (self->sumsq, 0, sizeof (self->sumsq));
+  if (self->history)
+    memset (self->history, 0, FFT_SIZE * sizeof (gfloat));
+  self->history_pos = 0;
+  self->interval_frames = self->rate > 0 ?
+      MAX (gst_util_uint64_scale (self->interval, self->rate, GST_SECOND),
+      1) : 0;
+}
+
+GstPlayerAudioAnalysis *
+gst_player_audio_analysis_new (void)
+{
+  static GOnce once = G_ONCE_INIT;
+  GstPlayerAudioAnalysis *self;
+
+  g_once (&once, cpu_kernels_init, NULL);
+
+  self = g_new0 (GstPlayerAudioAnalysis, 1);
+  g_mutex_init (&self->lock);
+  gst_segment_init (&self->segment, GST_FORMAT_TIME);
+  self->kernels = &scalar_kernels;
+
+  return self;
+}
+
+void
+gst_player_audio_analysis_free (GstPlayerAudioAnalysis * self)
+{
+  g_free (self->history);
+  g_free (self->window);
+  g_mutex_clear (&self->lock);
+  g_free (self);
+}
+
+/* An @interval of 0 disables the analysis */
+void
+gst_player_audio_analysis_configure (GstPlayerAudioAnalysis * self,
+    GstClockTime interval, guint n_bands)
+{
+  guint i;
+
+  g_mutex_lock (&self->lock);
+  self->interval = interval;
+  self->n_bands = MIN (n_bands, GST_PLAYER_AUDIO_ANALYSIS_MAX_BANDS);
+
+  if (self->n_bands > 0 && !self->history) {
+    self->history = g_new0 (gfloat, FFT_SIZE);
+    self->window = g_new (gfloat, FFT_SIZE);
+    self->window_sum = 0.0;
+    for (i = 0; i < FFT_SIZE; i++) {
+      self->window[i] = 0.5 - 0.5 * cos (2.0 * G_PI * i / (FFT_SIZE - 1));
+      self->window_sum += self->window[i];
+    }
+  }
+
+  interval_reset_locked (self);
+  g_atomic_int_set (&self->enabled, interval > 0);
+  g_mutex_unlock (&self->lock);
+}
+
+/* Returns FALSE if the analysis does not support the caps */
+gboolean
+gst_player_audio_analysis_set_caps (GstPlayerAudioAnalysis * self,
+    GstCaps * caps)
+{
+  GstStructure *s;
+  const gchar *format, *layout;
+  gint channels = 0, rate = 0;
+
+  g_mutex_lock (&self->lock);
+
+  s = gst_caps_get_structure (caps, 0);
+  format = gst_structure_get_string (s, "format");
+  layout = gst_structure_get_string (s, "layout");
+  gst_structure_get_int (s, "channels", &channels);
+  gst_structure_get_int (s, "rate", &rate);
+
+  self->format = SAMPLE_FORMAT_UNKNOWN;
+  if (!layout || strcmp (layout, "interleaved") == 0) {
+    if (g_strcmp0 (format,
+            G_BYTE_ORDER == G_LITTLE_ENDIAN ? "F32LE" : "F32BE") == 0) {
+      self->format = SAMPLE_FORMAT_F32;
+      self->bpf = channels * sizeof (gfloat);
+    } else if (g_strcmp0 (format,
+            G_BYTE_ORDER == G_LITTLE_ENDIAN ? "S16LE" : "S16BE") == 0) {
+      self->format = SAMPLE_FORMAT_S16;
+      self->bpf = channels * sizeof (gint16);
+    }
+  }
+
+  if (channels < 1 || channels > MAX_CHANNELS || rate < 1)
+    self->format = SAMPLE_FORMAT_UNKNOWN;
+
+  if (self->format == SAMPLE_FORMAT_UNKNOWN) {
+    GST_DEBUG ("Unsupported caps %" GST_PTR_FORMAT, caps);
+    self->channels = 0;
+    self->rate = 0;
+    g_mutex_unlock (&self->lock);
+    return FALSE;
+  }
+
+  self->channels = channels;
+  self->rate = rate;
+  self->kernels = level_kernels_get (channels);
+  self->kernel = self->format == SAMPLE_FORMAT_F32 ?
+      self->kernels->f32 : self->kernels->s16;
+  GST_DEBUG ("Using %s kernel for %" GST_PTR_FORMAT, self->kernels->name,
+      caps);
+  interval_reset_locked (self);
+
+  g_mutex_unlock (&self->lock);
+
+  return TRUE;
+}
+
+void
+gst_player_audio_analysis_set_segment (GstPlayerAudioAnalysis * self,
+    const GstSegment * segment)
+{
+  g_mutex_lock (&self->lock);
+  if (segment->format == GST_FORMAT_TIME)
+    gst_segment_copy_into (segment, &self->segment);
+  else
+    gst_segment_init (&self->segment, GST_FORMAT_TIME);
+  g_mutex_unlock (&self->lock);
+}
+
+/* Drops the partial interval, e.g. after a seek */
+void
+gst_player_audio_analysis_reset (GstPlayerAudioAnalysis * self)
+{
+  g_mutex_lock (&self->lock);
+  interval_reset_locked (self);
+  g_mutex_unlock (&self->lock);
+}
+
+/* Returns the levels of the last interval that ended in @buffer, or NULL
+ * if no interval ended */
+GstStructure *
+gst_player_audio_analysis_process (GstPlayerAudioAnalysis * self,
+    GstBuffer * buffer)
+{
+  GstStructure *result = NULL;
+  GstClockTime pts, end;
+  GstMapInfo map;
+  const guint8 *data;
+  guint n_frames, offset, n;
+
+  if (!g_atomic_int_get (&self->enabled))
+    return NULL;
+
+  g_mutex_lock (&self->lock);
+
+  if (self->format == SAMPLE_FORMAT_UNKNOWN || self->interval == 0
+      || !gst_buffer_map (buffer, &map, GST_MAP_READ)) {
+    g_mutex_unlock (&self->lock);
+    return NULL;
+  }
+
+  data = map.data;
+  n_frames = map.size / self->bpf;
+  pts = GST_BUFFER_PTS (buffer);
+
+  /* Buffers are split at interval boundaries, if several intervals end in
+   * one buffer only the last one is reported */
+  for (offset = 0; offset < n_frames; offset += n) {
+    n = MIN (n_frames - offset, self->interval_frames - self->n_frames);
+
+    level_accumulate_locked (self, data + offset * self->bpf, n);
+    if (self->n_bands > 0)
+      history_append_locked (self, data + offset * self->bpf, n);
+    self->n_frames += n;
+
+    if (self->n_frames >= self->interval_frames) {
+      end = GST_CLOCK_TIME_NONE;
+      if (GST_CLOCK_TIME_IS_VALID (pts))
+        end = pts + gst_util_uint64_scale_int (offset + n, GST_SECOND,
+            self->rate);
+
+      if (result)
+        gst_structure_free (result);
+      result = interval_finish_locked (self, end);
+    }
+  }
+
+  gst_buffer_unmap (buffer, &map);
+  g_mutex_unlock (&self->lock);
+
+  return result;
+}
+
+const gchar *
+gst_player_audio_analysis_get_kernel_name (GstPlayerAudioAnalysis * self)
+{
+  const gchar *name;
+
+  g_mutex_lock (&self->lock);
+  name = self->kernels->name;
+  g_mutex_unlock (&self->lock);
+
+  return name;
+}
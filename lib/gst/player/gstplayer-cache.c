@@ -0,0 +1,141 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Entries of the download and the media info cache are files named by the
+ * SHA-1 checksum of their URI and validator in hex, followed by a suffix
+ * per cache. The least recently used entries are evicted by modification
+ * time. Only files with such a name are ever removed, as the cache
+ * directories are chosen by the application and might contain others.
+ */
+
+#include "gstplayer-cache-private.h"
+
+#include <glib/gstdio.h>
+#include <string.h>
+
+GST_DEBUG_CATEGORY_STATIC (gst_player_cache_debug);
+#define GST_CAT_DEFAULT gst_player_cache_debug
+
+/* Length of a SHA-1 in hex */
+#define KEY_LENGTH 40
+
+typedef struct
+{
+  gchar *path;
+  guint64 size;
+  time_t mtime;
+} CacheEntry;
+
+static gint
+cache_entry_compare (gconstpointer a, gconstpointer b)
+{
+  const CacheEntry *ea = a, *eb = b;
+
+  return (ea->mtime > eb->mtime) - (ea->mtime < eb->mtime);
+}
+
+static gboolean
+is_entry_name (const gchar * name, const gchar * suffix)
+{
+  guint i;
+
+  for (i = 0; i < KEY_LENGTH; i++) {
+    if (!g_ascii_isxdigit (name[i]) || g_ascii_isupper (name[i]))
+      return FALSE;
+  }
+
+  return strcmp (name + KEY_LENGTH, suffix) == 0;
+}
+
+/* Returns the file name of the entry for @uri and @validator */
+gchar *
+gst_player_cache_entry_name (const gchar * uri, const gchar * validator,
+    const gchar * suffix)
+{
+  gchar *str, *key, *name;
+
+  str = g_strconcat (uri, "\n", validator, NULL);
+  key = g_compute_checksum_for_string (G_CHECKSUM_SHA1, str, -1);
+  name = g_strconcat (key, suffix, NULL);
+  g_free (str);
+  g_free (key);
+
+  return name;
+}
+
+/* Removes the least recently used entries with @suffix from @dir until at
+ * most @target bytes are left. Returns the size of the remaining entries.
+ * Callers serialize evictions of the same directory */
+guint64
+gst_player_cache_evict (const gchar * dir, const gchar * suffix,
+    guint64 target)
+{
+  static gsize debug_init = 0;
+  CacheEntry entry;
+  const gchar *name;
+  GArray *entries;
+  GStatBuf st;
+  guint64 total = 0;
+  GDir *d;
+  guint i;
+
+  if (g_once_init_enter (&debug_init)) {
+    GST_DEBUG_CATEGORY_INIT (gst_player_cache_debug, "gst-player-cache", 0,
+        "GstPlayer caches");
+    g_once_init_leave (&debug_init, 1);
+  }
+
+  d = g_dir_open (dir, 0, NULL);
+  if (!d)
+    return 0;
+
+  entries = g_array_new (FALSE, FALSE, sizeof (CacheEntry));
+  while ((name = g_dir_read_name (d))) {
+    if (!is_entry_name (name, suffix))
+      continue;
+
+    entry.path = g_build_filename (dir, name, NULL);
+    if (g_stat (entry.path, &st) != 0
+        || !g_file_test (entry.path, G_FILE_TEST_IS_REGULAR)) {
+      g_free (entry.path);
+      continue;
+    }
+
+    entry.size = st.st_size;
+    entry.mtime = st.st_mtime;
+    total += entry.size;
+    g_array_append_val (entries, entry);
+  }
+  g_dir_close (d);
+
+  g_array_sort (entries, cache_entry_compare);
+  for (i = 0; i < entries->len; i++) {
+    CacheEntry *e = &g_array_index (entries, CacheEntry, i);
+
+    /* Entries removed by another process meanwhile are gone as well */
+    if (total > target) {
+      if (g_unlink (e->path) == 0)
+        GST_DEBUG ("Evicted '%s'", e->path);
+      total -= e->size;
+    }
+    g_free (e->path);
+  }
+  g_array_free (entries, TRUE);
+
+  return total;
+}
@@ -0,0 +1,418 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ * SECTION:gstplayer-discoverer
+ * @short_description: Media information of many URIs at once
+ *
+ * gst_player_discover_batch() creates the #GstPlayerMediaInfo of a list of
+ * URIs without a #GstPlayer, for example to index a media library. Each
+ * URI is only prerolled by a #GstDiscoverer instead of a whole playbin, and
+ * several URIs are discovered in parallel by a bounded number of worker
+ * threads, each reusing a single discoverer for all its URIs.
+ *
+ * The results are passed to a callback in the calling thread, in the order
+ * in which they are done, together with the number of URIs done so far.
+ * The batch can be stopped early with a #GCancellable.
+ */
+
+#include "gstplayer-discoverer.h"
+#include "gstplayer-media-info-private.h"
+#include "gstplayer.h"
+
+#include <gst/pbutils/pbutils.h>
+#include <gst/tag/tag.h>
+
+GST_DEBUG_CATEGORY_STATIC (gst_player_discoverer_debug);
+#define GST_CAT_DEFAULT gst_player_discoverer_debug
+
+#define DEFAULT_TIMEOUT (10 * GST_SECOND)
+
+/* Pushed by each worker before it exits */
+#define WORKER_DONE GUINT_TO_POINTER (1)
+
+typedef struct
+{
+  const gchar *const *uris;
+  guint n_uris;
+  GstClockTime timeout;
+  GCancellable *cancellable;
+
+  /* Index of the next URI to discover, claimed atomically by the workers */
+  volatile gint next;
+
+  /* DiscoverResult of each URI, or WORKER_DONE after a worker exited */
+  GAsyncQueue *results;
+} DiscoverBatch;
+
+typedef struct
+{
+  guint index;
+  GstPlayerMediaInfo *info;
+  GError *error;
+} DiscoverResult;
+
+static gchar *
+stream_get_codec (GstDiscovererStreamInfo * sinfo, const gchar * tag)
+{
+  const GstTagList *tags;
+  GstCaps *caps;
+  gchar *codec = NULL;
+
+  tags = gst_discoverer_stream_info_get_tags (sinfo);
+  if (tags) {
+    gst_tag_list_get_string (tags, tag, &codec);
+    if (!codec)
+      gst_tag_list_get_string (tags, GST_TAG_CODEC, &codec);
+  }
+
+  if (!codec) {
+    caps = gst_discoverer_stream_info_get_caps (sinfo);
+    if (caps) {
+      codec = gst_pb_utils_get_codec_description (caps);
+      gst_caps_unref (caps);
+    }
+  }
+
+  return codec;
+}
+
+static gchar *
+language_from_tags (const GstTagList * tags, const gchar * lang_code)
+{
+  gchar *language = NULL, *code = NULL;
+
+  if (tags) {
+    gst_tag_list_get_string (tags, GST_TAG_LANGUAGE_NAME, &language);
+    if (language)
+      return language;
+    gst_tag_list_get_string (tags, GST_TAG_LANGUAGE_CODE, &code);
+  }
+
+  if (code) {
+    language = g_strdup (gst_tag_get_language_name (code));
+    g_free (code);
+  } else if (lang_code) {
+    language = g_strdup (gst_tag_get_language_name (lang_code));
+  }
+
+  return language;
+}
+
+static GstPlayerStreamInfo *
+stream_info_create (GstDiscovererStreamInfo * sinfo, gint stream_index,
+    GType type)
+{
+  GstPlayerStreamInfo *s;
+  const GstTagList *tags;
+
+  s = gst_player_stream_info_new (stream_index, type);
+  s->caps = gst_discoverer_stream_info_get_caps (sinfo);
+  tags = gst_discoverer_stream_info_get_tags (sinfo);
+  if (tags)
+    s->tags = gst_tag_list_ref ((GstTagList *) tags);
+
+  /* Values that are not known are reported like by GstPlayer */
+  if (type == GST_TYPE_PLAYER_VIDEO_INFO) {
+    GstDiscovererVideoInfo *vinfo = (GstDiscovererVideoInfo *) sinfo;
+    GstPlayerVideoInfo *info = (GstPlayerVideoInfo *) s;
+
+    s->codec = stream_get_codec (sinfo, GST_TAG_VIDEO_CODEC);
+    info->width = gst_discoverer_video_info_get_width (vinfo);
+    if (info->width == 0)
+      info->width = -1;
+    info->height = gst_discoverer_video_info_get_height (vinfo);
+    if (info->height == 0)
+      info->height = -1;
+    info->framerate_num = gst_discoverer_video_info_get_framerate_num (vinfo);
+    info->framerate_denom =
+        gst_discoverer_video_info_get_framerate_denom (vinfo);
+    if (info->framerate_denom == 0) {
+      info->framerate_num = 0;
+      info->framerate_denom = 1;
+    }
+    info->par_num = gst_discoverer_video_info_get_par_num (vinfo);
+    info->par_denom = gst_discoverer_video_info_get_par_denom (vinfo);
+    if (info->par_num == 0 || info->par_denom == 0)
+      info->par_num = info->par_denom = 1;
+    info->bitrate = gst_discoverer_video_info_get_bitrate (vinfo);
+    if (info->bitrate == 0)
+      info->bitrate = -1;
+    info->max_bitrate = gst_discoverer_video_info_get_max_bitrate (vinfo);
+    if (info->max_bitrate == 0)
+      info->max_bitrate = -1;
+  } else if (type == GST_TYPE_PLAYER_AUDIO_INFO) {
+    GstDiscovererAudioInfo *ainfo = (GstDiscovererAudioInfo *) sinfo;
+    GstPlayerAudioInfo *info = (GstPlayerAudioInfo *) s;
+
+    s->codec = stream_get_codec (sinfo, GST_TAG_AUDIO_CODEC);
+    info->channels = gst_discoverer_audio_info_get_channels (ainfo);
+    info->sample_rate = gst_discoverer_audio_info_get_sample_rate (ainfo);
+    if (info->sample_rate == 0)
+      info->sample_rate = -1;
+    info->bitrate = gst_discoverer_audio_info_get_bitrate (ainfo);
+    if (info->bitrate == 0)
+      info->bitrate = -1;
+    info->max_bitrate = gst_discoverer_audio_info_get_max_bitrate (ainfo);
+    if (info->max_bitrate == 0)
+      info->max_bitrate = -1;
+    info->language = language_from_tags (tags,
+        gst_discoverer_audio_info_get_language (ainfo));
+  } else {
+    GstDiscovererSubtitleInfo *tinfo = (GstDiscovererSubtitleInfo *) sinfo;
+    GstPlayerSubtitleInfo *info = (GstPlayerSubtitleInfo *) s;
+
+    s->codec = stream_get_codec (sinfo, GST_TAG_SUBTITLE_CODEC);
+    info->language = language_from_tags (tags,
+        gst_discoverer_subtitle_info_get_language (tinfo));
+  }
+
+  return s;
+}
+
+static void
+streams_create (GstPlayerMediaInfo * media_info, GList * streams, GType type)
+{
+  GList *l;
+  gint i;
+
+  for (l = streams, i = 0; l; l = l->next, i++)
+    gst_player_media_info_set_stream (media_info,
+        stream_info_create (l->data, i, type));
+
+  gst_discoverer_stream_info_list_free (streams);
+}
+
+static GstPlayerMediaInfo *
+media_info_create (const gchar * uri, GstDiscovererInfo * dinfo)
+{
+  GstPlayerMediaInfo *media_info;
+  GstDiscovererStreamInfo *topology;
+  const GstTagList *tags;
+  GstCaps *caps;
+
+  media_info = gst_player_media_info_new (uri);
+  media_info->duration = gst_discoverer_info_get_duration (dinfo);
+  media_info->seekable = gst_discoverer_info_get_seekable (dinfo);
+  tags = gst_discoverer_info_get_tags (dinfo);
+  if (tags)
+    media_info->tags = gst_tag_list_ref ((GstTagList *) tags);
+
+  streams_create (media_info, gst_discoverer_info_get_video_streams (dinfo),
+      GST_TYPE_PLAYER_VIDEO_INFO);
+  streams_create (media_info, gst_discoverer_info_get_audio_streams (dinfo),
+      GST_TYPE_PLAYER_AUDIO_INFO);
+  streams_create (media_info,
+      gst_discoverer_info_get_subtitle_streams (dinfo),
+      GST_TYPE_PLAYER_SUBTITLE_INFO);
+
+  gst_player_media_info_update_from_tags (media_info);
+
+  /* Without a container format tag, describe the container caps */
+  topology = gst_discoverer_info_get_stream_info (dinfo);
+  if (!media_info->container && topology
+      && GST_IS_DISCOVERER_CONTAINER_INFO (topology)) {
+    caps = gst_discoverer_stream_info_get_caps (topology);
+    if (caps) {
+      media_info->container = gst_pb_utils_get_codec_description (caps);
+      gst_caps_unref (caps);
+    }
+  }
+  if (topology)
+    gst_discoverer_stream_info_unref (topology);
+
+  GST_DEBUG ("uri: %s title: %s duration: %" GST_TIME_FORMAT
+      " seekable: %s container: %s image_sample %p", media_info->uri,
+      media_info->title, GST_TIME_ARGS (media_info->duration),
+      media_info->seekable ? "yes" : "no", media_info->container,
+      media_info->image_sample);
+
+  return media_info;
+}
+
+static GError *
+discoverer_result_to_error (const gchar * uri, GstDiscovererResult result)
+{
+  switch (result) {
+    case GST_DISCOVERER_URI_INVALID:
+      return g_error_new (GST_PLAYER_ERROR, GST_PLAYER_ERROR_FAILED,
+          "Invalid URI '%s'", uri);
+    case GST_DISCOVERER_TIMEOUT:
+      return g_error_new (GST_PLAYER_ERROR, GST_PLAYER_ERROR_FAILED,
+          "Timeout while discovering '%s'", uri);
+    case GST_DISCOVERER_MISSING_PLUGINS:
+      return g_error_new (GST_PLAYER_ERROR, GST_PLAYER_ERROR_FAILED,
+          "Missing plugins for '%s'", uri);
+    default:
+      return g_error_new (GST_PLAYER_ERROR, GST_PLAYER_ERROR_FAILED,
+          "Failed to discover '%s'", uri);
+  }
+}
+
+static gpointer
+discover_worker (gpointer user_data)
+{
+  DiscoverBatch *batch = user_data;
+  GstDiscoverer *discoverer;
+  GstDiscovererInfo *dinfo;
+  GstDiscovererResult result;
+  DiscoverResult *res;
+  GError *err = NULL;
+  const gchar *uri;
+  guint index;
+
+  discoverer = gst_discoverer_new (batch->timeout, &err);
+  if (!discoverer) {
+    GST_ERROR ("Failed to create discoverer: %s", err->message);
+    g_clear_error (&err);
+  }
+
+  while (discoverer && !g_cancellable_is_cancelled (batch->cancellable)) {
+    index = g_atomic_int_add (&batch->next, 1);
+    if (index >= batch->n_uris)
+      break;
+
+    uri = batch->uris[index];
+    res = g_slice_new0 (DiscoverResult);
+    res->index = index;
+
+    GST_DEBUG ("Discovering %u: %s", index, uri);
+    dinfo = gst_discoverer_discover_uri (discoverer, uri, &err);
+    result = dinfo ? gst_discoverer_info_get_result (dinfo)
+        : GST_DISCOVERER_ERROR;
+    if (dinfo && result == GST_DISCOVERER_OK) {
+      res->info = media_info_create (uri, dinfo);
+      g_clear_error (&err);
+    } else if (err) {
+      res->error = err;
+      err = NULL;
+    } else {
+      res->error = discoverer_result_to_error (uri, result);
+    }
+    if (dinfo)
+      gst_discoverer_info_unref (dinfo);
+
+    g_async_queue_push (batch->results, res);
+  }
+
+  if (discoverer)
+    g_object_unref (discoverer);
+
+  g_async_queue_push (batch->results, WORKER_DONE);
+
+  return NULL;
+}
+
+/**
+ * gst_player_discover_batch:
+ * @uris: (array zero-terminated=1): %NULL terminated array of URIs
+ * @n_workers: number of URIs to discover in parallel, or 0 for the number
+ *   of processors
+ * @timeout: maximum time to discover a single URI, or
+ *   %GST_CLOCK_TIME_NONE for a default of 10 seconds
+ * @callback: (scope call): function called for every URI
+ * @user_data: user data passed to @callback
+ * @cancellable: (allow-none): a #GCancellable to stop the batch, or %NULL
+ * @error: return location for a #GError, or %NULL
+ *
+ * Discovers the media information of all @uris and passes it to @callback
+ * in the calling thread, which is blocked until all URIs are done or
+ * @cancellable was cancelled. URIs that can not be discovered within
+ * @timeout are passed with an error.
+ *
+ * After cancellation no new URIs are started. The URIs that are already
+ * being discovered are still passed to @callback once they are done.
+ *
+ * Returns: %TRUE if all URIs were done, %FALSE if the batch was cancelled
+ *   or could not be started
+ */
+gboolean
+gst_player_discover_batch (const gchar * const *uris, guint n_workers,
+    GstClockTime timeout, GstPlayerDiscoverCallback callback,
+    gpointer user_data, GCancellable * cancellable, GError ** error)
+{
+  static gsize debug_init = 0;
+  DiscoverBatch batch;
+  DiscoverResult *res;
+  GThread **workers;
+  gpointer item;
+  guint i, n_done = 0, n_running;
+
+  g_return_val_if_fail (uris != NULL, FALSE);
+  g_return_val_if_fail (callback != NULL, FALSE);
+  g_return_val_if_fail (cancellable == NULL
+      || G_IS_CANCELLABLE (cancellable), FALSE);
+  g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  if (g_once_init_enter (&debug_init)) {
+    GST_DEBUG_CATEGORY_INIT (gst_player_discoverer_debug,
+        "gst-player-discoverer", 0, "GstPlayer discoverer");
+    g_once_init_leave (&debug_init, 1);
+  }
+
+  batch.uris = uris;
+  batch.n_uris = g_strv_length ((gchar **) uris);
+  batch.timeout = GST_CLOCK_TIME_IS_VALID (timeout) ? timeout
+      : DEFAULT_TIMEOUT;
+  batch.cancellable = cancellable;
+  batch.next = 0;
+  batch.results = g_async_queue_new ();
+
+  if (n_workers == 0)
+    n_workers = g_get_num_processors ();
+  n_workers = CLAMP (n_workers, 1, MAX (batch.n_uris, 1));
+
+  GST_DEBUG ("Discovering %u URIs with %u workers", batch.n_uris, n_workers);
+
+  workers = g_new0 (GThread *, n_workers);
+  for (i = 0; i < n_workers; i++)
+    workers[i] = g_thread_new ("GstPlayerDiscoverer", discover_worker, &batch);
+
+  n_running = n_workers;
+  while (n_running > 0) {
+    item = g_async_queue_pop (batch.results);
+    if (item == WORKER_DONE) {
+      n_running--;
+      continue;
+    }
+
+    res = item;
+    n_done++;
+    callback (uris[res->index], res->index, res->info, res->error, n_done,
+        batch.n_uris, user_data);
+
+    if (res->info)
+      g_object_unref (res->info);
+    g_clear_error (&res->error);
+    g_slice_free (DiscoverResult, res);
+  }
+
+  for (i = 0; i < n_workers; i++)
+    g_thread_join (workers[i]);
+  g_free (workers);
+  g_async_queue_unref (batch.results);
+
+  if (n_done < batch.n_uris) {
+    if (!g_cancellable_set_error_if_cancelled (cancellable, error))
+      g_set_error (error, GST_PLAYER_ERROR, GST_PLAYER_ERROR_FAILED,
+          "Failed to create discoverer");
+    return FALSE;
+  }
+
+  return TRUE;
+}
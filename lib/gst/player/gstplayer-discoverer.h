@@ -0,0 +1,60 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_PLAYER_DISCOVERER_H__
+#define __GST_PLAYER_DISCOVERER_H__
+
+#include <gst/gst.h>
+#include <gio/gio.h>
+#include <gst/player/gstplayer-media-info.h>
+
+G_BEGIN_DECLS
+
+/**
+ * GstPlayerDiscoverCallback:
+ * @uri: the URI that was discovered
+ * @index: index of @uri in the array passed to gst_player_discover_batch()
+ * @info: (transfer none) (allow-none): the media information of @uri, or
+ *   %NULL if it could not be discovered
+ * @error: (allow-none): the reason why @uri could not be discovered, or %NULL
+ * @n_done: number of URIs discovered so far, including @uri
+ * @n_total: number of URIs in the batch
+ * @user_data: user data passed to gst_player_discover_batch()
+ *
+ * Called by gst_player_discover_batch() once for every URI. Take a
+ * reference of @info to keep it after the callback returned.
+ */
+typedef void (*GstPlayerDiscoverCallback) (const gchar *uri,
+                                           guint index,
+                                           GstPlayerMediaInfo *info,
+                                           const GError *error,
+                                           guint n_done,
+                                           guint n_total,
+                                           gpointer user_data);
+
+gboolean gst_player_discover_batch (const gchar * const *uris,
+                                    guint n_workers,
+                                    GstClockTime timeout,
+                                    GstPlayerDiscoverCallback callback,
+                                    gpointer user_data,
+                                    GCancellable *cancellable,
+                                    GError **error);
+
+G_END_DECLS
+
+#endif /* __GST_PLAYER_DISCOVERER_H__ */
@@ -0,0 +1,225 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ * SECTION:gstplayer-executor
+ * @short_description: Shared threads for many GstPlayer instances
+ *
+ * By default every #GstPlayer runs its own thread with its own main loop.
+ * Applications with many players can instead create a #GstPlayerExecutor
+ * and pass it to gst_player_new_with_executor(). Each player is then bound
+ * to the least busy thread of the executor for its whole lifetime, so all
+ * its callbacks stay serialized while many players share a few threads.
+ */
+
+#include "gstplayer-executor.h"
+#include "gstplayer-executor-private.h"
+
+typedef struct
+{
+  GThread *thread;
+  GMainLoop *loop;
+  GMainContext *context;
+  guint n_players;
+} GstPlayerExecutorThread;
+
+struct _GstPlayerExecutor
+{
+  GObject parent;
+
+  GMutex lock;
+  GCond cond;
+  guint n_threads;
+  GstPlayerExecutorThread *threads;
+};
+
+struct _GstPlayerExecutorClass
+{
+  GObjectClass parent_class;
+};
+
+G_DEFINE_TYPE (GstPlayerExecutor, gst_player_executor, G_TYPE_OBJECT);
+
+static gboolean
+executor_thread_running_cb (gpointer user_data)
+{
+  GstPlayerExecutor *self = user_data;
+
+  g_mutex_lock (&self->lock);
+  g_cond_broadcast (&self->cond);
+  g_mutex_unlock (&self->lock);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* The thread owns its own reference to the loop so that it can outlive the
+ * executor if the last reference is dropped from one of its threads */
+static gpointer
+executor_thread_main (gpointer data)
+{
+  GMainLoop *loop = data;
+  GMainContext *context = g_main_loop_get_context (loop);
+
+  g_main_context_push_thread_default (context);
+  g_main_loop_run (loop);
+  g_main_context_pop_thread_default (context);
+
+  g_main_loop_unref (loop);
+
+  return NULL;
+}
+
+static void
+gst_player_executor_init (GstPlayerExecutor * self)
+{
+  g_mutex_init (&self->lock);
+  g_cond_init (&self->cond);
+}
+
+static void
+gst_player_executor_finalize (GObject * object)
+{
+  GstPlayerExecutor *self = GST_PLAYER_EXECUTOR (object);
+  guint i;
+
+  for (i = 0; i < self->n_threads; i++) {
+    GstPlayerExecutorThread *t = &self->threads[i];
+
+    g_main_loop_quit (t->loop);
+    if (t->thread == g_thread_self ())
+      g_thread_unref (t->thread);
+    else
+      g_thread_join (t->thread);
+
+    g_main_loop_unref (t->loop);
+    g_main_context_unref (t->context);
+  }
+  g_free (self->threads);
+
+  g_mutex_clear (&self->lock);
+  g_cond_clear (&self->cond);
+
+  G_OBJECT_CLASS (gst_player_executor_parent_class)->finalize (object);
+}
+
+static void
+gst_player_executor_class_init (GstPlayerExecutorClass * klass)
+{
+  GObjectClass *gobject_class = (GObjectClass *) klass;
+
+  gobject_class->finalize = gst_player_executor_finalize;
+}
+
+/**
+ * gst_player_executor_new:
+ * @n_threads: number of threads, or 0 to use one thread per CPU core
+ *
+ * Creates a new pool of threads that can be shared by many #GstPlayer
+ * instances with gst_player_new_with_executor().
+ *
+ * Returns: a new #GstPlayerExecutor
+ */
+GstPlayerExecutor *
+gst_player_executor_new (guint n_threads)
+{
+  GstPlayerExecutor *self;
+  guint i;
+
+  if (n_threads == 0)
+    n_threads = MAX (g_get_num_processors (), 1);
+
+  self = g_object_new (GST_TYPE_PLAYER_EXECUTOR, NULL);
+  self->n_threads = n_threads;
+  self->threads = g_new0 (GstPlayerExecutorThread, n_threads);
+
+  g_mutex_lock (&self->lock);
+  for (i = 0; i < n_threads; i++) {
+    GstPlayerExecutorThread *t = &self->threads[i];
+    gchar *name = g_strdup_printf ("GstPlayerExec%u", i);
+    GSource *source;
+
+    t->context = g_main_context_new ();
+    t->loop = g_main_loop_new (t->context, FALSE);
+
+    source = g_idle_source_new ();
+    g_source_set_callback (source, executor_thread_running_cb, self, NULL);
+    g_source_attach (source, t->context);
+    g_source_unref (source);
+
+    t->thread = g_thread_new (name, executor_thread_main,
+        g_main_loop_ref (t->loop));
+    g_free (name);
+
+    while (!g_main_loop_is_running (t->loop))
+      g_cond_wait (&self->cond, &self->lock);
+  }
+  g_mutex_unlock (&self->lock);
+
+  return self;
+}
+
+/**
+ * gst_player_executor_get_n_threads:
+ * @executor: a #GstPlayerExecutor
+ *
+ * Returns: the number of threads of @executor
+ */
+guint
+gst_player_executor_get_n_threads (GstPlayerExecutor * self)
+{
+  g_return_val_if_fail (GST_IS_PLAYER_EXECUTOR (self), 0);
+
+  return self->n_threads;
+}
+
+/* Returns a reference to the context of the thread with the fewest players */
+GMainContext *
+gst_player_executor_acquire_context (GstPlayerExecutor * self)
+{
+  GstPlayerExecutorThread *best;
+  guint i;
+
+  g_mutex_lock (&self->lock);
+  best = &self->threads[0];
+  for (i = 1; i < self->n_threads; i++) {
+    if (self->threads[i].n_players < best->n_players)
+      best = &self->threads[i];
+  }
+  best->n_players++;
+  g_mutex_unlock (&self->lock);
+
+  return g_main_context_ref (best->context);
+}
+
+void
+gst_player_executor_release_context (GstPlayerExecutor * self,
+    GMainContext * context)
+{
+  guint i;
+
+  g_mutex_lock (&self->lock);
+  for (i = 0; i < self->n_threads; i++) {
+    if (self->threads[i].context == context) {
+      self->threads[i].n_players--;
+      break;
+    }
+  }
+  g_mutex_unlock (&self->lock);
+
+  g_main_context_unref (context);
+}
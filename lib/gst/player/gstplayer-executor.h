@@ -0,0 +1,54 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_PLAYER_EXECUTOR_H__
+#define __GST_PLAYER_EXECUTOR_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_PLAYER_EXECUTOR \
+  (gst_player_executor_get_type ())
+#define GST_PLAYER_EXECUTOR(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_PLAYER_EXECUTOR,GstPlayerExecutor))
+#define GST_PLAYER_EXECUTOR_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_PLAYER_EXECUTOR,GstPlayerExecutorClass))
+#define GST_IS_PLAYER_EXECUTOR(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_PLAYER_EXECUTOR))
+#define GST_IS_PLAYER_EXECUTOR_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_PLAYER_EXECUTOR))
+
+/**
+ * GstPlayerExecutor:
+ *
+ * A pool of threads that runs the internal main loops of many #GstPlayer
+ * instances, see gst_player_new_with_executor().
+ */
+typedef struct _GstPlayerExecutor GstPlayerExecutor;
+typedef struct _GstPlayerExecutorClass GstPlayerExecutorClass;
+GType gst_player_executor_get_type (void);
+
+GstPlayerExecutor * gst_player_executor_new         (guint n_threads);
+
+guint               gst_player_executor_get_n_threads
+                                                    (GstPlayerExecutor *executor);
+
+G_END_DECLS
+
+#endif /* __GST_PLAYER_EXECUTOR_H__ */
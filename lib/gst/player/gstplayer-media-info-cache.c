@@ -0,0 +1,626 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ * SECTION:gstplayer-media-info-cache
+ * @short_description: Media information available before preroll
+ *
+ * A #GstPlayerMediaInfoCache keeps the #GstPlayerMediaInfo of media that
+ * was played or discovered before in a directory. Set it on a #GstPlayer
+ * with gst_player_set_media_info_cache() to get the media information
+ * right after the URI was loaded, or use it together with
+ * gst_player_discover_batch() to index a library once.
+ *
+ * Every entry is a file named after the SHA-1 of the URI and a validator,
+ * which changes whenever the media behind the URI changes. For local files
+ * the validator defaults to their size and modification time, for other
+ * URIs it is for example their ETag. The media information is serialized
+ * as a #GVariant that is read directly from the mapped file, including the
+ * cover art.
+ *
+ * The directory can be shared by many processes. Entries are replaced
+ * atomically and once the directory grows beyond its maximum size, the
+ * least recently used entries (by modification time, refreshed on every
+ * hit) are removed.
+ */
+
+#include "gstplayer-media-info-cache.h"
+#include "gstplayer-media-info-private.h"
+#include "gstplayer-cache-private.h"
+#include "gstplayer.h"
+
+#include <glib/gstdio.h>
+#include <string.h>
+
+GST_DEBUG_CATEGORY_STATIC (gst_player_media_info_cache_debug);
+#define GST_CAT_DEFAULT gst_player_media_info_cache_debug
+
+/* Entry file layout: magic, version (little endian) and the serialized
+ * variant, always little endian */
+#define ENTRY_MAGIC "GSTPMINF"
+#define ENTRY_VERSION 1
+#define HEADER_VERSION_OFFSET 8
+#define HEADER_SIZE 16
+
+/* uri, validator, duration, seekable, title, container, tags, cover art
+ * (caps and data) and the streams (type, index, caps, tags, codec, language
+ * and the type specific values) */
+#define ENTRY_TYPE "(sstbmsmsmsm(say)a(uimsmsmsmsai))"
+
+/* Suffix of the entry files, see gst_player_cache_entry_name() */
+#define ENTRY_SUFFIX ".mediainfo"
+
+/* Eviction removes entries until this percentage of the maximum size is
+ * left, so that it does not run again on the next store */
+#define EVICT_TARGET_PERCENT 90
+
+typedef enum
+{
+  STREAM_TYPE_VIDEO,
+  STREAM_TYPE_AUDIO,
+  STREAM_TYPE_SUBTITLE
+} StreamType;
+
+struct _GstPlayerMediaInfoCache
+{
+  GObject parent;
+
+  gchar *location;
+  guint64 max_size;
+
+  /* Approximate size of all entries, -1 if unknown. Entries written by
+   * other processes are only counted after the next eviction. Protected
+   * by lock */
+  GMutex lock;
+  gint64 size;
+};
+
+struct _GstPlayerMediaInfoCacheClass
+{
+  GObjectClass parent_class;
+};
+
+#define _do_init \
+  GST_DEBUG_CATEGORY_INIT (gst_player_media_info_cache_debug, \
+      "gst-player-media-info-cache", 0, "GstPlayerMediaInfoCache");
+
+G_DEFINE_TYPE_WITH_CODE (GstPlayerMediaInfoCache, gst_player_media_info_cache,
+    G_TYPE_OBJECT, _do_init);
+
+static void
+gst_player_media_info_cache_init (GstPlayerMediaInfoCache * self)
+{
+  g_mutex_init (&self->lock);
+  self->size = -1;
+}
+
+static void
+gst_player_media_info_cache_finalize (GObject * object)
+{
+  GstPlayerMediaInfoCache *self = GST_PLAYER_MEDIA_INFO_CACHE (object);
+
+  g_free (self->location);
+  g_mutex_clear (&self->lock);
+
+  G_OBJECT_CLASS (gst_player_media_info_cache_parent_class)->finalize
+      (object);
+}
+
+static void
+gst_player_media_info_cache_class_init (GstPlayerMediaInfoCacheClass * klass)
+{
+  GObjectClass *gobject_class = (GObjectClass *) klass;
+
+  gobject_class->finalize = gst_player_media_info_cache_finalize;
+}
+
+/**
+ * gst_player_media_info_cache_new:
+ * @location: the directory to keep the entries in. It is created when the
+ *     first entry is stored
+ * @max_size: maximum size of all entries in bytes
+ *
+ * Returns: a new #GstPlayerMediaInfoCache
+ */
+GstPlayerMediaInfoCache *
+gst_player_media_info_cache_new (const gchar * location, guint64 max_size)
+{
+  GstPlayerMediaInfoCache *self;
+
+  g_return_val_if_fail (location != NULL, NULL);
+
+  self = g_object_new (GST_TYPE_PLAYER_MEDIA_INFO_CACHE, NULL);
+  self->location = g_strdup (location);
+  self->max_size = max_size;
+
+  return self;
+}
+
+/**
+ * gst_player_media_info_cache_get_location:
+ * @cache: a #GstPlayerMediaInfoCache
+ *
+ * Returns: the directory the entries are kept in
+ */
+const gchar *
+gst_player_media_info_cache_get_location (GstPlayerMediaInfoCache * self)
+{
+  g_return_val_if_fail (GST_IS_PLAYER_MEDIA_INFO_CACHE (self), NULL);
+
+  return self->location;
+}
+
+/**
+ * gst_player_media_info_cache_get_max_size:
+ * @cache: a #GstPlayerMediaInfoCache
+ *
+ * Returns: the maximum size of all entries in bytes
+ */
+guint64
+gst_player_media_info_cache_get_max_size (GstPlayerMediaInfoCache * self)
+{
+  g_return_val_if_fail (GST_IS_PLAYER_MEDIA_INFO_CACHE (self), 0);
+
+  return self->max_size;
+}
+
+/* Returns NULL if @uri is a local file that does not exist */
+static gchar *
+entry_validator (const gchar * uri, const gchar * validator)
+{
+  gchar *filename, *ret = NULL;
+  GStatBuf st;
+
+  if (validator)
+    return g_strdup (validator);
+
+  if (!gst_uri_has_protocol (uri, "file"))
+    return g_strdup ("");
+
+  filename = g_filename_from_uri (uri, NULL, NULL);
+  if (filename && g_stat (filename, &st) == 0)
+    ret = g_strdup_printf ("%" G_GINT64_FORMAT ":%" G_GINT64_FORMAT,
+        (gint64) st.st_size, (gint64) st.st_mtime);
+  g_free (filename);
+
+  return ret;
+}
+
+static gchar *
+entry_path (GstPlayerMediaInfoCache * self, const gchar * uri,
+    const gchar * validator)
+{
+  gchar *name, *path;
+
+  name = gst_player_cache_entry_name (uri, validator, ENTRY_SUFFIX);
+  path = g_build_filename (self->location, name, NULL);
+  g_free (name);
+
+  return path;
+}
+
+/* Images would be serialized as large strings, the cover art is stored as
+ * binary data instead */
+static gchar *
+tags_to_string (GstTagList * tags)
+{
+  GstTagList *copy;
+  gchar *str;
+
+  if (!tags)
+    return NULL;
+
+  copy = gst_tag_list_copy (tags);
+  gst_tag_list_remove_tag (copy, GST_TAG_IMAGE);
+  gst_tag_list_remove_tag (copy, GST_TAG_PREVIEW_IMAGE);
+  gst_tag_list_remove_tag (copy, GST_TAG_ATTACHMENT);
+  str = gst_tag_list_to_string (copy);
+  gst_tag_list_unref (copy);
+
+  return str;
+}
+
+static GVariant *
+stream_to_variant (GstPlayerStreamInfo * s)
+{
+  GVariantBuilder values;
+  gchar *caps, *tags, *language = NULL;
+  StreamType type;
+  GVariant *ret;
+
+  g_variant_builder_init (&values, G_VARIANT_TYPE ("ai"));
+  if (GST_IS_PLAYER_VIDEO_INFO (s)) {
+    GstPlayerVideoInfo *info = (GstPlayerVideoInfo *) s;
+
+    type = STREAM_TYPE_VIDEO;
+    g_variant_builder_add (&values, "i", info->width);
+    g_variant_builder_add (&values, "i", info->height);
+    g_variant_builder_add (&values, "i", info->framerate_num);
+    g_variant_builder_add (&values, "i", info->framerate_denom);
+    g_variant_builder_add (&values, "i", info->par_num);
+    g_variant_builder_add (&values, "i", info->par_denom);
+    g_variant_builder_add (&values, "i", (gint) info->bitrate);
+    g_variant_builder_add (&values, "i", (gint) info->max_bitrate);
+  } else if (GST_IS_PLAYER_AUDIO_INFO (s)) {
+    GstPlayerAudioInfo *info = (GstPlayerAudioInfo *) s;
+
+    type = STREAM_TYPE_AUDIO;
+    language = info->language;
+    g_variant_builder_add (&values, "i", info->channels);
+    g_variant_builder_add (&values, "i", info->sample_rate);
+    g_variant_builder_add (&values, "i", (gint) info->bitrate);
+    g_variant_builder_add (&values, "i", (gint) info->max_bitrate);
+  } else {
+    type = STREAM_TYPE_SUBTITLE;
+    language = ((GstPlayerSubtitleInfo *) s)->language;
+  }
+
+  caps = s->caps ? gst_caps_to_string (s->caps) : NULL;
+  tags = tags_to_string (s->tags);
+  ret = g_variant_new ("(uimsmsmsmsai)", type, s->stream_index, caps, tags,
+      s->codec, language, &values);
+  g_free (caps);
+  g_free (tags);
+
+  return ret;
+}
+
+static void
+streams_to_variant (GVariantBuilder * builder, GPtrArray * streams)
+{
+  GstPlayerStreamInfo *s;
+  guint i;
+
+  for (i = 0; i < streams->len; i++) {
+    s = g_ptr_array_index (streams, i);
+    if (s)
+      g_variant_builder_add_value (builder, stream_to_variant (s));
+  }
+}
+
+static GVariant *
+media_info_to_variant (GstPlayerMediaInfo * info, const gchar * validator)
+{
+  GVariantBuilder streams;
+  GVariant *cover = NULL, *ret;
+  GstBuffer *buffer;
+  GstCaps *caps;
+  GstMapInfo map;
+  gchar *tags, *caps_str;
+
+  if (info->image_sample) {
+    buffer = gst_sample_get_buffer (info->image_sample);
+    caps = gst_sample_get_caps (info->image_sample);
+    if (buffer && caps && gst_buffer_map (buffer, &map, GST_MAP_READ)) {
+      caps_str = gst_caps_to_string (caps);
+      cover = g_variant_new ("(s@ay)", caps_str,
+          g_variant_new_fixed_array (G_VARIANT_TYPE_BYTE, map.data,
+              map.size, 1));
+      g_free (caps_str);
+      gst_buffer_unmap (buffer, &map);
+    }
+  }
+
+  g_variant_builder_init (&streams, G_VARIANT_TYPE ("a(uimsmsmsmsai)"));
+  streams_to_variant (&streams, info->video_streams);
+  streams_to_variant (&streams, info->audio_streams);
+  streams_to_variant (&streams, info->subtitle_streams);
+
+  tags = tags_to_string (info->tags);
+  ret = g_variant_new ("(sstbmsmsmsm@(say)a(uimsmsmsmsai))", info->uri,
+      validator, info->duration, info->seekable, info->title,
+      info->container, tags, cover, &streams);
+  g_free (tags);
+
+  return g_variant_ref_sink (ret);
+}
+
+static GstPlayerStreamInfo *
+stream_from_variant (GVariant * v)
+{
+  const gchar *caps, *tags, *codec, *language;
+  GstPlayerStreamInfo *s;
+  GVariant *values_v;
+  const gint32 *values;
+  gsize n_values;
+  guint type;
+  gint index;
+  GType gtype;
+
+  g_variant_get (v, "(ui&ms&ms&ms&ms@ai)", &type, &index, &caps, &tags,
+      &codec, &language, &values_v);
+  values = g_variant_get_fixed_array (values_v, &n_values, sizeof (gint32));
+
+  if (type == STREAM_TYPE_VIDEO && n_values == 8)
+    gtype = GST_TYPE_PLAYER_VIDEO_INFO;
+  else if (type == STREAM_TYPE_AUDIO && n_values == 4)
+    gtype = GST_TYPE_PLAYER_AUDIO_INFO;
+  else if (type == STREAM_TYPE_SUBTITLE)
+    gtype = GST_TYPE_PLAYER_SUBTITLE_INFO;
+  else {
+    g_variant_unref (values_v);
+    return NULL;
+  }
+
+  s = gst_player_stream_info_new (index, gtype);
+  s->caps = caps ? gst_caps_from_string (caps) : NULL;
+  s->tags = tags ? gst_tag_list_new_from_string (tags) : NULL;
+  s->codec = g_strdup (codec);
+
+  if (type == STREAM_TYPE_VIDEO) {
+    GstPlayerVideoInfo *info = (GstPlayerVideoInfo *) s;
+
+    info->width = values[0];
+    info->height = values[1];
+    info->framerate_num = values[2];
+    info->framerate_denom = values[3];
+    info->par_num = values[4];
+    info->par_denom = values[5];
+    info->bitrate = values[6];
+    info->max_bitrate = values[7];
+  } else if (type == STREAM_TYPE_AUDIO) {
+    GstPlayerAudioInfo *info = (GstPlayerAudioInfo *) s;
+
+    info->channels = values[0];
+    info->sample_rate = values[1];
+    info->bitrate = values[2];
+    info->max_bitrate = values[3];
+    info->language = g_strdup (language);
+  } else {
+    ((GstPlayerSubtitleInfo *) s)->language = g_strdup (language);
+  }
+  g_variant_unref (values_v);
+
+  return s;
+}
+
+/* The cover art keeps pointing into the mapped entry */
+static GstSample *
+cover_from_variant (GVariant * v)
+{
+  const gchar *caps_str;
+  GVariant *data_v;
+  GstBuffer *buffer;
+  GstSample *sample = NULL;
+  GstCaps *caps;
+  gconstpointer data;
+  gsize size;
+
+  g_variant_get (v, "(&s@ay)", &caps_str, &data_v);
+  data = g_variant_get_fixed_array (data_v, &size, 1);
+  caps = gst_caps_from_string (caps_str);
+  if (caps && size > 0) {
+    buffer = gst_buffer_new_wrapped_full (GST_MEMORY_FLAG_READONLY,
+        (gpointer) data, size, 0, size, g_variant_ref (data_v),
+        (GDestroyNotify) g_variant_unref);
+    sample = gst_sample_new (buffer, caps, NULL, NULL);
+    gst_buffer_unref (buffer);
+  }
+  if (caps)
+    gst_caps_unref (caps);
+  g_variant_unref (data_v);
+
+  return sample;
+}
+
+static GstPlayerMediaInfo *
+media_info_from_variant (GVariant * v)
+{
+  const gchar *uri, *title, *container, *tags;
+  GstPlayerMediaInfo *info;
+  GstPlayerStreamInfo *s;
+  GVariant *cover, *streams, *stream;
+  GstClockTime duration;
+  gboolean seekable;
+  GVariantIter iter;
+
+  g_variant_get (v, "(&s&stb&ms&ms&msm@(say)@a(uimsmsmsmsai))", &uri, NULL,
+      &duration, &seekable, &title, &container, &tags, &cover, &streams);
+
+  info = gst_player_media_info_new (uri);
+  info->duration = duration;
+  info->seekable = seekable;
+  info->title = g_strdup (title);
+  info->container = g_strdup (container);
+  info->tags = tags ? gst_tag_list_new_from_string (tags) : NULL;
+
+  if (cover) {
+    info->image_sample = cover_from_variant (cover);
+    g_variant_unref (cover);
+  }
+
+  /* Make the cover art available from the tags again */
+  if (info->image_sample) {
+    if (!info->tags)
+      info->tags = gst_tag_list_new_empty ();
+    gst_tag_list_add (info->tags, GST_TAG_MERGE_APPEND, GST_TAG_IMAGE,
+        info->image_sample, NULL);
+  }
+
+  g_variant_iter_init (&iter, streams);
+  while ((stream = g_variant_iter_next_value (&iter))) {
+    s = stream_from_variant (stream);
+    if (s)
+      gst_player_media_info_set_stream (info, s);
+    g_variant_unref (stream);
+  }
+  g_variant_unref (streams);
+
+  return info;
+}
+
+/**
+ * gst_player_media_info_cache_lookup:
+ * @cache: a #GstPlayerMediaInfoCache
+ * @uri: the URI to look up
+ * @validator: (allow-none): the validator of @uri, or %NULL to use the size
+ *     and modification time of local files and nothing for other URIs
+ *
+ * Looks up the media information stored for @uri with the same
+ * @validator.
+ *
+ * Returns: (transfer full): the #GstPlayerMediaInfo of @uri, or %NULL if
+ *     there is none
+ */
+GstPlayerMediaInfo *
+gst_player_media_info_cache_lookup (GstPlayerMediaInfoCache * self,
+    const gchar * uri, const gchar * validator)
+{
+  GstPlayerMediaInfo *info = NULL;
+  const gchar *entry_uri, *entry_validator_str;
+  const guint8 *contents;
+  GMappedFile *file;
+  gchar *val, *path;
+  GVariant *v;
+  gsize size;
+
+  g_return_val_if_fail (GST_IS_PLAYER_MEDIA_INFO_CACHE (self), NULL);
+  g_return_val_if_fail (uri != NULL, NULL);
+
+  val = entry_validator (uri, validator);
+  if (!val)
+    return NULL;
+
+  path = entry_path (self, uri, val);
+  file = g_mapped_file_new (path, FALSE, NULL);
+  if (!file)
+    goto done;
+
+  contents = (const guint8 *) g_mapped_file_get_contents (file);
+  size = g_mapped_file_get_length (file);
+  if (size <= HEADER_SIZE || memcmp (contents, ENTRY_MAGIC, 8) != 0
+      || GST_READ_UINT32_LE (contents + HEADER_VERSION_OFFSET) !=
+      ENTRY_VERSION) {
+    GST_WARNING ("Invalid entry '%s'", path);
+    g_mapped_file_unref (file);
+    goto done;
+  }
+
+  /* Corrupted data is safe to read, it only results in default values */
+  v = g_variant_new_from_data (G_VARIANT_TYPE (ENTRY_TYPE),
+      contents + HEADER_SIZE, size - HEADER_SIZE, FALSE,
+      (GDestroyNotify) g_mapped_file_unref, file);
+  g_variant_ref_sink (v);
+  if (G_BYTE_ORDER == G_BIG_ENDIAN) {
+    GVariant *swapped = g_variant_byteswap (v);
+
+    g_variant_unref (v);
+    v = swapped;
+  }
+
+  g_variant_get_child (v, 0, "&s", &entry_uri);
+  g_variant_get_child (v, 1, "&s", &entry_validator_str);
+  if (strcmp (entry_uri, uri) == 0 && strcmp (entry_validator_str, val) == 0) {
+    info = media_info_from_variant (v);
+    /* The modification time orders the entries for eviction */
+    g_utime (path, NULL);
+    GST_DEBUG ("Found '%s' in '%s'", uri, path);
+  }
+  g_variant_unref (v);
+
+done:
+  g_free (path);
+  g_free (val);
+
+  return info;
+}
+
+/* Must be called with lock. Removes the least recently used entries until
+ * at most @target bytes are left and updates the size */
+static void
+cache_evict_locked (GstPlayerMediaInfoCache * self, guint64 target)
+{
+  self->size = gst_player_cache_evict (self->location, ENTRY_SUFFIX, target);
+}
+
+/**
+ * gst_player_media_info_cache_store:
+ * @cache: a #GstPlayerMediaInfoCache
+ * @info: the #GstPlayerMediaInfo to store
+ * @validator: (allow-none): the validator of the URI of @info, or %NULL to
+ *     use the size and modification time of local files and nothing for
+ *     other URIs
+ * @error: return location for a #GError, or %NULL
+ *
+ * Stores @info, replacing any entry for its URI and removing the least
+ * recently used entries if the cache grew too large.
+ *
+ * Returns: %TRUE if @info was stored
+ */
+gboolean
+gst_player_media_info_cache_store (GstPlayerMediaInfoCache * self,
+    GstPlayerMediaInfo * info, const gchar * validator, GError ** error)
+{
+  gchar *val, *path, *contents;
+  GVariant *v;
+  gsize size;
+  gboolean ret;
+
+  g_return_val_if_fail (GST_IS_PLAYER_MEDIA_INFO_CACHE (self), FALSE);
+  g_return_val_if_fail (GST_IS_PLAYER_MEDIA_INFO (info), FALSE);
+  g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  val = entry_validator (info->uri, validator);
+  if (!val) {
+    g_set_error (error, GST_PLAYER_ERROR, GST_PLAYER_ERROR_FAILED,
+        "Can't access '%s'", info->uri);
+    return FALSE;
+  }
+
+  v = media_info_to_variant (info, val);
+  if (G_BYTE_ORDER == G_BIG_ENDIAN) {
+    GVariant *swapped = g_variant_byteswap (v);
+
+    g_variant_unref (v);
+    v = swapped;
+  }
+
+  size = HEADER_SIZE + g_variant_get_size (v);
+  contents = g_malloc0 (size);
+  memcpy (contents, ENTRY_MAGIC, 8);
+  GST_WRITE_UINT32_LE (contents + HEADER_VERSION_OFFSET, ENTRY_VERSION);
+  g_variant_store (v, contents + HEADER_SIZE);
+  g_variant_unref (v);
+
+  path = entry_path (self, info->uri, val);
+
+  /* Readers either see the old or the new entry */
+  ret = g_mkdir_with_parents (self->location, 0700) == 0
+      && g_file_set_contents (path, contents, size, error);
+  if (ret) {
+    GST_DEBUG ("Stored '%s' in '%s'", info->uri, path);
+
+    g_mutex_lock (&self->lock);
+    if (self->size < 0)
+      cache_evict_locked (self, self->max_size);
+    else
+      self->size += size;
+    if ((guint64) self->size > self->max_size)
+      cache_evict_locked (self, self->max_size / 100 * EVICT_TARGET_PERCENT);
+    g_mutex_unlock (&self->lock);
+  } else if (error && !*error) {
+    g_set_error (error, GST_PLAYER_ERROR, GST_PLAYER_ERROR_FAILED,
+        "Can't create '%s'", self->location);
+  }
+
+  g_free (path);
+  g_free (contents);
+  g_free (val);
+
+  return ret;
+}
@@ -0,0 +1,65 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_PLAYER_MEDIA_INFO_CACHE_H__
+#define __GST_PLAYER_MEDIA_INFO_CACHE_H__
+
+#include <gst/gst.h>
+#include <gst/player/gstplayer-media-info.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_PLAYER_MEDIA_INFO_CACHE \
+  (gst_player_media_info_cache_get_type ())
+#define GST_PLAYER_MEDIA_INFO_CACHE(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_PLAYER_MEDIA_INFO_CACHE,GstPlayerMediaInfoCache))
+#define GST_PLAYER_MEDIA_INFO_CACHE_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_PLAYER_MEDIA_INFO_CACHE,GstPlayerMediaInfoCacheClass))
+#define GST_IS_PLAYER_MEDIA_INFO_CACHE(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_PLAYER_MEDIA_INFO_CACHE))
+#define GST_IS_PLAYER_MEDIA_INFO_CACHE_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_PLAYER_MEDIA_INFO_CACHE))
+
+/**
+ * GstPlayerMediaInfoCache:
+ *
+ * Stores #GstPlayerMediaInfo in a directory, so that it is available
+ * before the media is prerolled the next time.
+ */
+typedef struct _GstPlayerMediaInfoCache GstPlayerMediaInfoCache;
+typedef struct _GstPlayerMediaInfoCacheClass GstPlayerMediaInfoCacheClass;
+GType gst_player_media_info_cache_get_type (void);
+
+GstPlayerMediaInfoCache *
+                     gst_player_media_info_cache_new          (const gchar *location,
+                                                               guint64 max_size);
+
+const gchar *        gst_player_media_info_cache_get_location (GstPlayerMediaInfoCache *cache);
+guint64              gst_player_media_info_cache_get_max_size (GstPlayerMediaInfoCache *cache);
+
+GstPlayerMediaInfo * gst_player_media_info_cache_lookup       (GstPlayerMediaInfoCache *cache,
+                                                               const gchar *uri,
+                                                               const gchar *validator);
+gboolean             gst_player_media_info_cache_store        (GstPlayerMediaInfoCache *cache,
+                                                               GstPlayerMediaInfo *info,
+                                                               const gchar *validator,
+                                                               GError **error);
+
+G_END_DECLS
+
+#endif /* __GST_PLAYER_MEDIA_INFO_CACHE_H__ */
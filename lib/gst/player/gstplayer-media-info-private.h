@@ -100,12 +100,22 @@ struct _GstPlayerMediaInfo
   GstTagList *tags;
   GstSample *image_sample;
 
+  /* Stream information per type, indexed by stream index. Entries can be
+   * NULL if streams are not known yet */
+  GPtrArray *video_streams;
+  GPtrArray *audio_streams;
+  GPtrArray *subtitle_streams;
+
+  /* Lazily built by the public accessors, see stream_list_view_get() */
   GList *stream_list;
   GList *audio_stream_list;
   GList *video_stream_list;
   GList *subtitle_stream_list;
 
   GstClockTime  duration;
+
+  /* Number of tag and caps updates merged into this snapshot */
+  guint n_merged_updates;
 };
 
 struct _GstPlayerMediaInfoClass
@@ -117,6 +127,14 @@ G_GNUC_INTERNAL GstPlayerMediaInfo*   gst_player_media_info_new
                                       (const gchar *uri);
 G_GNUC_INTERNAL GstPlayerMediaInfo*   gst_player_media_info_copy
                                       (GstPlayerMediaInfo *ref);
+G_GNUC_INTERNAL GstPlayerStreamInfo*  gst_player_media_info_get_stream
+                                      (const GstPlayerMediaInfo *info,
+                                       GType type, gint stream_index);
+G_GNUC_INTERNAL void                  gst_player_media_info_set_stream
+                                      (GstPlayerMediaInfo *info,
+                                       GstPlayerStreamInfo *stream);
+G_GNUC_INTERNAL void                  gst_player_media_info_update_from_tags
+                                      (GstPlayerMediaInfo *info);
 G_GNUC_INTERNAL GstPlayerStreamInfo*  gst_player_stream_info_new
                                       (gint stream_index, GType type);
 G_GNUC_INTERNAL GstPlayerStreamInfo*  gst_player_stream_info_copy
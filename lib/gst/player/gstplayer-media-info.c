@@ -403,6 +403,10 @@ gst_player_media_info_init (GstPlayerMediaInfo * info)
 {
   info->duration = -1;
   info->seekable = FALSE;
+
+  info->video_streams = g_ptr_array_new_with_free_func (g_object_unref);
+  info->audio_streams = g_ptr_array_new_with_free_func (g_object_unref);
+  info->subtitle_streams = g_ptr_array_new_with_free_func (g_object_unref);
 }
 
 static void
@@ -424,17 +428,14 @@ gst_player_media_info_finalize (GObject * object)
   if (info->image_sample)
     gst_sample_unref (info->image_sample);
 
-  if (info->audio_stream_list)
-    g_list_free (info->audio_stream_list);
-
-  if (info->video_stream_list)
-    g_list_free (info->video_stream_list);
-
-  if (info->subtitle_stream_list)
-    g_list_free (info->subtitle_stream_list);
+  g_list_free (info->audio_stream_list);
+  g_list_free (info->video_stream_list);
+  g_list_free (info->subtitle_stream_list);
+  g_list_free (info->stream_list);
 
-  if (info->stream_list)
-    g_list_free_full (info->stream_list, g_object_unref);
+  g_ptr_array_unref (info->video_streams);
+  g_ptr_array_unref (info->audio_streams);
+  g_ptr_array_unref (info->subtitle_streams);
 
   G_OBJECT_CLASS (gst_player_media_info_parent_class)->finalize (object);
 }
@@ -533,13 +534,147 @@ gst_player_stream_info_copy (GstPlayerStreamInfo * ref)
   if (ref->tags)
     info->tags = gst_tag_list_ref (ref->tags);
   if (ref->caps)
-    info->caps = gst_caps_copy (ref->caps);
+    info->caps = gst_caps_ref (ref->caps);
   if (ref->codec)
     info->codec = g_strdup (ref->codec);
 
   return info;
 }
 
+static void
+stream_array_copy (GPtrArray * dest, GPtrArray * src)
+{
+  guint i;
+
+  g_ptr_array_set_size (dest, src->len);
+  for (i = 0; i < src->len; i++) {
+    GstPlayerStreamInfo *s = g_ptr_array_index (src, i);
+
+    g_ptr_array_index (dest, i) = s ? g_object_ref (s) : NULL;
+  }
+}
+
+static GPtrArray *
+stream_array_for_type (const GstPlayerMediaInfo * info, GType type)
+{
+  if (type == GST_TYPE_PLAYER_VIDEO_INFO)
+    return info->video_streams;
+  else if (type == GST_TYPE_PLAYER_AUDIO_INFO)
+    return info->audio_streams;
+  else
+    return info->subtitle_streams;
+}
+
+GstPlayerStreamInfo *
+gst_player_media_info_get_stream (const GstPlayerMediaInfo * info,
+    GType type, gint stream_index)
+{
+  GPtrArray *streams = stream_array_for_type (info, type);
+
+  if (stream_index < 0 || (guint) stream_index >= streams->len)
+    return NULL;
+
+  return g_ptr_array_index (streams, stream_index);
+}
+
+static gpointer
+get_title (const GstTagList * tags)
+{
+  gchar *title = NULL;
+
+  gst_tag_list_get_string (tags, GST_TAG_TITLE, &title);
+  if (!title)
+    gst_tag_list_get_string (tags, GST_TAG_TITLE_SORTNAME, &title);
+
+  return title;
+}
+
+static gpointer
+get_container_format (const GstTagList * tags)
+{
+  gchar *container = NULL;
+
+  gst_tag_list_get_string (tags, GST_TAG_CONTAINER_FORMAT, &container);
+
+  return container;
+}
+
+static gpointer
+get_cover_sample (const GstTagList * tags)
+{
+  GstSample *cover_sample = NULL;
+
+  gst_tag_list_get_sample (tags, GST_TAG_IMAGE, &cover_sample);
+  if (!cover_sample)
+    gst_tag_list_get_sample (tags, GST_TAG_PREVIEW_IMAGE, &cover_sample);
+
+  return cover_sample;
+}
+
+/* Looks at the global tags first and then at the tags of the video and
+ * audio streams */
+static gpointer
+get_from_tags (const GstPlayerMediaInfo * info,
+    gpointer (*func) (const GstTagList *))
+{
+  GPtrArray *arrays[] = { info->video_streams, info->audio_streams };
+  GstPlayerStreamInfo *s;
+  gpointer ret = NULL;
+  guint i, j;
+
+  if (info->tags)
+    ret = func (info->tags);
+
+  for (i = 0; !ret && i < G_N_ELEMENTS (arrays); i++) {
+    for (j = 0; !ret && j < arrays[i]->len; j++) {
+      s = g_ptr_array_index (arrays[i], j);
+      if (s && s->tags)
+        ret = func (s->tags);
+    }
+  }
+
+  return ret;
+}
+
+/* Sets title, container format and cover image of the not yet published
+ * @info from its tags */
+void
+gst_player_media_info_update_from_tags (GstPlayerMediaInfo * info)
+{
+  g_free (info->title);
+  info->title = get_from_tags (info, get_title);
+
+  g_free (info->container);
+  info->container = get_from_tags (info, get_container_format);
+
+  if (info->image_sample)
+    gst_sample_unref (info->image_sample);
+  info->image_sample = get_from_tags (info, get_cover_sample);
+}
+
+/* Adds @stream to the not yet published @info, replacing any previous
+ * stream with the same type and index. Takes ownership of @stream */
+void
+gst_player_media_info_set_stream (GstPlayerMediaInfo * info,
+    GstPlayerStreamInfo * stream)
+{
+  GPtrArray *streams = stream_array_for_type (info, G_OBJECT_TYPE (stream));
+  gint stream_index = stream->stream_index;
+
+  g_return_if_fail (info->stream_list == NULL);
+  g_return_if_fail (stream_index >= 0);
+
+  if ((guint) stream_index >= streams->len)
+    g_ptr_array_set_size (streams, stream_index + 1);
+
+  if (g_ptr_array_index (streams, stream_index))
+    g_object_unref (g_ptr_array_index (streams, stream_index));
+  g_ptr_array_index (streams, stream_index) = stream;
+}
+
+/* Media information is never modified once it was handed out, so a copy
+ * shares the (equally immutable) stream information objects with @ref.
+ * Updating a stream is done by replacing its object in the copy */
 GstPlayerMediaInfo *
 gst_player_media_info_copy (GstPlayerMediaInfo * ref)
 {
@@ -561,20 +696,9 @@ gst_player_media_info_copy (GstPlayerMediaInfo * ref)
   if (ref->image_sample)
     info->image_sample = gst_sample_ref (ref->image_sample);
 
-  for (l = ref->stream_list; l != NULL; l = l->next) {
-    GstPlayerStreamInfo *s;
-
-    s = gst_player_stream_info_copy ((GstPlayerStreamInfo *) l->data);
-    info->stream_list = g_list_append (info->stream_list, s);
-
-    if (GST_IS_PLAYER_AUDIO_INFO (s))
-      info->audio_stream_list = g_list_append (info->audio_stream_list, s);
-    else if (GST_IS_PLAYER_VIDEO_INFO (s))
-      info->video_stream_list = g_list_append (info->video_stream_list, s);
-    else
-      info->subtitle_stream_list =
-          g_list_append (info->subtitle_stream_list, s);
-  }
+  stream_array_copy (info->video_streams, ref->video_streams);
+  stream_array_copy (info->audio_streams, ref->audio_streams);
+  stream_array_copy (info->subtitle_streams, ref->subtitle_streams);
 
   return info;
 }
@@ -637,6 +761,40 @@ gst_player_media_info_is_seekable (const GstPlayerMediaInfo * info)
   return info->seekable;
 }
 
+/* The stream arrays of published media information never change, so the
+ * GList views on them are only built once, on first use. Concurrent callers
+ * might both build one, only the first one is kept */
+static GList *
+stream_list_view_get (GList ** view, GPtrArray * const *streams,
+    guint n_streams)
+{
+  GList *list = NULL, *current;
+  gint i, j;
+
+  current = g_atomic_pointer_get (view);
+  if (current)
+    return current;
+
+  for (i = n_streams - 1; i >= 0; i--) {
+    for (j = streams[i]->len - 1; j >= 0; j--) {
+      gpointer s = g_ptr_array_index (streams[i], j);
+
+      if (s)
+        list = g_list_prepend (list, s);
+    }
+  }
+
+  if (!list)
+    return NULL;
+
+  if (!g_atomic_pointer_compare_and_exchange (view, NULL, list)) {
+    g_list_free (list);
+    list = g_atomic_pointer_get (view);
+  }
+
+  return list;
+}
+
 /**
  * gst_player_media_info_get_stream_list:
  * @info: a #GstPlayerMediaInfo
@@ -647,9 +805,16 @@ gst_player_media_info_is_seekable (const GstPlayerMediaInfo * info)
 GList *
 gst_player_media_info_get_stream_list (const GstPlayerMediaInfo * info)
 {
+  GstPlayerMediaInfo *self = (GstPlayerMediaInfo *) info;
+  GPtrArray *streams[3];
+
   g_return_val_if_fail (GST_IS_PLAYER_MEDIA_INFO (info), NULL);
 
-  return info->stream_list;
+  streams[0] = self->video_streams;
+  streams[1] = self->audio_streams;
+  streams[2] = self->subtitle_streams;
+
+  return stream_list_view_get (&self->stream_list, streams, 3);
 }
 
 /**
@@ -662,9 +827,12 @@ gst_player_media_info_get_stream_list (const GstPlayerMediaInfo * info)
 GList *
 gst_player_get_video_streams (const GstPlayerMediaInfo * info)
 {
+  GstPlayerMediaInfo *self = (GstPlayerMediaInfo *) info;
+
   g_return_val_if_fail (GST_IS_PLAYER_MEDIA_INFO (info), NULL);
 
-  return info->video_stream_list;
+  return stream_list_view_get (&self->video_stream_list,
+      &self->video_streams, 1);
 }
 
 /**
@@ -677,9 +845,12 @@ gst_player_get_video_streams (const GstPlayerMediaInfo * info)
 GList *
 gst_player_get_subtitle_streams (const GstPlayerMediaInfo * info)
 {
+  GstPlayerMediaInfo *self = (GstPlayerMediaInfo *) info;
+
   g_return_val_if_fail (GST_IS_PLAYER_MEDIA_INFO (info), NULL);
 
-  return info->subtitle_stream_list;
+  return stream_list_view_get (&self->subtitle_stream_list,
+      &self->subtitle_streams, 1);
 }
 
 /**
@@ -692,9 +863,12 @@ gst_player_get_subtitle_streams (const GstPlayerMediaInfo * info)
 GList *
 gst_player_get_audio_streams (const GstPlayerMediaInfo * info)
 {
+  GstPlayerMediaInfo *self = (GstPlayerMediaInfo *) info;
+
   g_return_val_if_fail (GST_IS_PLAYER_MEDIA_INFO (info), NULL);
 
-  return info->audio_stream_list;
+  return stream_list_view_get (&self->audio_stream_list,
+      &self->audio_streams, 1);
 }
 
 /**
@@ -769,3 +943,21 @@ gst_player_media_info_get_image_sample (const GstPlayerMediaInfo * info)
 
   return info->image_sample;
 }
+
+/**
+ * gst_player_media_info_get_n_merged_updates:
+ * @info: a #GstPlayerMediaInfo
+ *
+ * Tag and caps changes are collected for the duration of
+ * #GstPlayer:media-info-update-interval and announced together.
+ *
+ * Returns: the number of tag and caps changes that were merged into @info,
+ * or 0 for the initial media information.
+ */
+guint
+gst_player_media_info_get_n_merged_updates (const GstPlayerMediaInfo * info)
+{
+  g_return_val_if_fail (GST_IS_PLAYER_MEDIA_INFO (info), 0);
+
+  return info->n_merged_updates;
+}
@@ -187,6 +187,8 @@ const gchar*  gst_player_media_info_get_container_format
                 (const GstPlayerMediaInfo *info);
 GstSample*    gst_player_media_info_get_image_sample
                 (const GstPlayerMediaInfo *info);
+guint         gst_player_media_info_get_n_merged_updates
+                (const GstPlayerMediaInfo *info);
 G_END_DECLS
 
 #endif /* __GST_PLAYER_MEDIA_INFO_H */
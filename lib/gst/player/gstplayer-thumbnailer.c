@@ -0,0 +1,701 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ * SECTION:gstplayer-thumbnailer
+ * @short_description: Thumbnails for previews while seeking
+ *
+ * A #GstPlayerThumbnailer decodes key frames at regular positions of a
+ * video with its own pipelines, each working on a part of the timeline in
+ * its own thread, and writes them scaled down into a single file.
+ * Applications can open this file with gst_player_thumbnails_open() and
+ * show the thumbnail for any position with
+ * gst_player_thumbnails_get_sample() without touching the #GstPlayer that
+ * plays the video.
+ *
+ * The file starts with a header, followed by the timestamps of all
+ * thumbnails and the thumbnails themselves as one vertical strip of RGBx
+ * pixels. It is mapped into memory when opened and the samples point
+ * directly into the mapping. The header identifies the video by its URI
+ * and, for local files, their modification time, so that outdated files
+ * are not opened.
+ */
+
+#include "gstplayer-thumbnailer.h"
+#include "gstplayer.h"
+
+#include <gst/video/video.h>
+#include <glib/gstdio.h>
+#include <string.h>
+
+GST_DEBUG_CATEGORY_STATIC (gst_player_thumbnailer_debug);
+#define GST_CAT_DEFAULT gst_player_thumbnailer_debug
+
+#define DEFAULT_WIDTH 160
+
+/* Time a worker waits for the pipeline to preroll after a seek */
+#define WORKER_TIMEOUT (10 * GST_SECOND)
+
+/* File layout, all values little endian */
+#define THUMBNAILS_MAGIC "GSTPTHMB"
+#define THUMBNAILS_VERSION 1
+#define HEADER_VERSION_OFFSET 8
+#define HEADER_N_THUMBNAILS_OFFSET 12
+#define HEADER_WIDTH_OFFSET 16
+#define HEADER_HEIGHT_OFFSET 20
+#define HEADER_STRIDE_OFFSET 24
+#define HEADER_MTIME_OFFSET 32
+#define HEADER_DATA_OFFSET_OFFSET 40
+#define HEADER_URI_HASH_OFFSET 48
+#define URI_HASH_SIZE 20
+#define HEADER_SIZE 72
+/* Thumbnails start at this alignment after the timestamps */
+#define DATA_ALIGNMENT 64
+
+struct _GstPlayerThumbnailer
+{
+  GObject parent;
+
+  guint n_workers;
+  guint width;
+};
+
+struct _GstPlayerThumbnailerClass
+{
+  GObjectClass parent_class;
+};
+
+struct _GstPlayerThumbnails
+{
+  GObject parent;
+
+  GMappedFile *file;
+  const guint8 *timestamps;
+  guint n_thumbnails;
+  gsize data_offset;
+  gsize thumbnail_size;
+  GstCaps *caps;
+};
+
+struct _GstPlayerThumbnailsClass
+{
+  GObjectClass parent_class;
+};
+
+/* State shared by all workers of one gst_player_thumbnailer_generate()
+ * call. Every worker writes its own range of thumbnails into contents */
+typedef struct
+{
+  const gchar *uri;
+  guint n_thumbnails;
+  GstClockTime duration;
+  GstClockTime interval;
+  GstVideoInfo info;
+  guint8 *contents;
+  gsize data_offset;
+} ThumbnailJob;
+
+typedef struct
+{
+  ThumbnailJob *job;
+  GstElement *pipeline;
+  GstElement *sink;
+  guint first, last;
+  GThread *thread;
+  gboolean ok;
+} ThumbnailWorker;
+
+#define _do_init \
+  GST_DEBUG_CATEGORY_INIT (gst_player_thumbnailer_debug, \
+      "gst-player-thumbnailer", 0, "GstPlayerThumbnailer");
+
+G_DEFINE_TYPE_WITH_CODE (GstPlayerThumbnailer, gst_player_thumbnailer,
+    G_TYPE_OBJECT, _do_init);
+G_DEFINE_TYPE (GstPlayerThumbnails, gst_player_thumbnails, G_TYPE_OBJECT);
+
+static void
+gst_player_thumbnailer_init (GstPlayerThumbnailer * self)
+{
+  self->width = DEFAULT_WIDTH;
+}
+
+static void
+gst_player_thumbnailer_class_init (GstPlayerThumbnailerClass * klass)
+{
+}
+
+/**
+ * gst_player_thumbnailer_new:
+ * @n_workers: number of pipelines decoding in parallel, or 0 to use one
+ *     per CPU core
+ *
+ * Returns: a new #GstPlayerThumbnailer
+ */
+GstPlayerThumbnailer *
+gst_player_thumbnailer_new (guint n_workers)
+{
+  GstPlayerThumbnailer *self;
+
+  if (n_workers == 0)
+    n_workers = MAX (g_get_num_processors (), 1);
+
+  self = g_object_new (GST_TYPE_PLAYER_THUMBNAILER, NULL);
+  self->n_workers = n_workers;
+
+  return self;
+}
+
+/**
+ * gst_player_thumbnailer_get_n_workers:
+ * @thumbnailer: a #GstPlayerThumbnailer
+ *
+ * Returns: the number of pipelines decoding in parallel
+ */
+guint
+gst_player_thumbnailer_get_n_workers (GstPlayerThumbnailer * self)
+{
+  g_return_val_if_fail (GST_IS_PLAYER_THUMBNAILER (self), 0);
+
+  return self->n_workers;
+}
+
+/**
+ * gst_player_thumbnailer_get_width:
+ * @thumbnailer: a #GstPlayerThumbnailer
+ *
+ * Returns: the width of generated thumbnails in pixels
+ */
+guint
+gst_player_thumbnailer_get_width (GstPlayerThumbnailer * self)
+{
+  g_return_val_if_fail (GST_IS_PLAYER_THUMBNAILER (self), DEFAULT_WIDTH);
+
+  return self->width;
+}
+
+/**
+ * gst_player_thumbnailer_set_width:
+ * @thumbnailer: a #GstPlayerThumbnailer
+ * @width: the width of generated thumbnails in pixels
+ *
+ * Sets the width of the thumbnails, their height follows from the aspect
+ * ratio of the video. Defaults to 160 pixels.
+ */
+void
+gst_player_thumbnailer_set_width (GstPlayerThumbnailer * self, guint width)
+{
+  g_return_if_fail (GST_IS_PLAYER_THUMBNAILER (self));
+  g_return_if_fail (width > 0);
+
+  self->width = width;
+}
+
+static void
+uri_get_key (const gchar * uri, guint8 * hash, guint64 * mtime)
+{
+  GChecksum *checksum;
+  gsize hash_size = URI_HASH_SIZE;
+  gchar *filename;
+  GStatBuf st;
+
+  checksum = g_checksum_new (G_CHECKSUM_SHA1);
+  g_checksum_update (checksum, (const guchar *) uri, -1);
+  g_checksum_get_digest (checksum, hash, &hash_size);
+  g_checksum_free (checksum);
+
+  *mtime = 0;
+  filename = g_filename_from_uri (uri, NULL, NULL);
+  if (filename && g_stat (filename, &st) == 0)
+    *mtime = st.st_mtime;
+  g_free (filename);
+}
+
+/* Decodes only the video of @uri and scales it to @width with square
+ * pixels */
+static GstElement *
+worker_pipeline_new (const gchar * uri, guint width, GstElement ** sink,
+    GError ** error)
+{
+  GstElement *pipeline, *bin;
+  gchar *desc;
+
+  desc = g_strdup_printf ("videoconvert ! videoscale ! "
+      "video/x-raw,format=RGBx,width=%u,pixel-aspect-ratio=1/1 ! "
+      "appsink name=sink sync=false max-buffers=1", width);
+  bin = gst_parse_bin_from_description (desc, TRUE, error);
+  g_free (desc);
+  if (!bin)
+    return NULL;
+
+  pipeline = gst_element_factory_make ("playbin", NULL);
+  if (!pipeline) {
+    g_set_error (error, GST_PLAYER_ERROR, GST_PLAYER_ERROR_FAILED,
+        "Failed to create playbin");
+    gst_object_unref (gst_object_ref_sink (bin));
+    return NULL;
+  }
+
+  *sink = gst_bin_get_by_name (GST_BIN (bin), "sink");
+  g_object_set (pipeline, "uri", uri, "video-sink", bin, NULL);
+  gst_util_set_object_arg (G_OBJECT (pipeline), "flags", "video");
+
+  return pipeline;
+}
+
+static void
+worker_clear (ThumbnailWorker * worker)
+{
+  if (worker->pipeline) {
+    gst_element_set_state (worker->pipeline, GST_STATE_NULL);
+    gst_object_unref (worker->pipeline);
+    gst_object_unref (worker->sink);
+    worker->pipeline = NULL;
+    worker->sink = NULL;
+  }
+}
+
+static gboolean
+worker_wait_preroll (ThumbnailWorker * worker)
+{
+  return gst_element_get_state (worker->pipeline, NULL, NULL,
+      WORKER_TIMEOUT) == GST_STATE_CHANGE_SUCCESS;
+}
+
+static GstSample *
+worker_pull (ThumbnailWorker * worker)
+{
+  GstSample *sample = NULL;
+
+  g_signal_emit_by_name (worker->sink, "pull-preroll", &sample);
+
+  return sample;
+}
+
+/* Seeks to the key frame before @position and copies it as thumbnail
+ * @index */
+static gboolean
+worker_extract (ThumbnailWorker * worker, guint index, GstClockTime position)
+{
+  ThumbnailJob *job = worker->job;
+  GstVideoInfo info;
+  GstVideoFrame frame;
+  GstSample *sample;
+  GstBuffer *buffer;
+  GstClockTime timestamp;
+  const GstSegment *segment;
+  guint8 *dest;
+  guint row, row_size;
+
+  if (!gst_element_seek_simple (worker->pipeline, GST_FORMAT_TIME,
+          GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_KEY_UNIT |
+          GST_SEEK_FLAG_SNAP_BEFORE, position)
+      || !worker_wait_preroll (worker))
+    return FALSE;
+
+  sample = worker_pull (worker);
+  if (!sample)
+    return FALSE;
+
+  buffer = gst_sample_get_buffer (sample);
+  if (!buffer || !gst_video_info_from_caps (&info, gst_sample_get_caps (sample))
+      || info.width != job->info.width || info.height != job->info.height
+      || !gst_video_frame_map (&frame, &info, buffer, GST_MAP_READ)) {
+    gst_sample_unref (sample);
+    return FALSE;
+  }
+
+  segment = gst_sample_get_segment (sample);
+  timestamp = GST_BUFFER_PTS (buffer);
+  if (segment && GST_CLOCK_TIME_IS_VALID (timestamp))
+    timestamp = gst_segment_to_stream_time (segment, GST_FORMAT_TIME,
+        timestamp);
+  if (!GST_CLOCK_TIME_IS_VALID (timestamp))
+    timestamp = position;
+  GST_WRITE_UINT64_LE (job->contents + HEADER_SIZE + index * 8, timestamp);
+
+  row_size = GST_VIDEO_INFO_PLANE_STRIDE (&job->info, 0);
+  dest = job->contents + job->data_offset + index * job->info.size;
+  for (row = 0; row < info.height; row++)
+    memcpy (dest + row * row_size,
+        GST_VIDEO_FRAME_PLANE_DATA (&frame, 0) +
+        row * GST_VIDEO_FRAME_PLANE_STRIDE (&frame, 0), row_size);
+
+  gst_video_frame_unmap (&frame);
+  gst_sample_unref (sample);
+
+  GST_LOG ("Thumbnail %u at %" GST_TIME_FORMAT, index,
+      GST_TIME_ARGS (timestamp));
+
+  return TRUE;
+}
+
+static GstClockTime
+job_get_position (ThumbnailJob * job, guint index)
+{
+  if (job->interval)
+    return index * job->interval;
+
+  /* Middle of the index-th part of the timeline */
+  return gst_util_uint64_scale (job->duration, 2 * index + 1,
+      2 * job->n_thumbnails);
+}
+
+static gpointer
+worker_main (gpointer data)
+{
+  ThumbnailWorker *worker = data;
+  guint i;
+
+  worker->ok = TRUE;
+  for (i = worker->first; i < worker->last && worker->ok; i++)
+    worker->ok = worker_extract (worker, i, job_get_position (worker->job, i));
+
+  worker_clear (worker);
+
+  return NULL;
+}
+
+static gboolean
+worker_start (ThumbnailWorker * worker, guint width, GError ** error)
+{
+  worker->pipeline = worker_pipeline_new (worker->job->uri, width,
+      &worker->sink, error);
+  if (!worker->pipeline)
+    return FALSE;
+
+  if (gst_element_set_state (worker->pipeline,
+          GST_STATE_PAUSED) == GST_STATE_CHANGE_FAILURE
+      || !worker_wait_preroll (worker)) {
+    g_set_error (error, GST_PLAYER_ERROR, GST_PLAYER_ERROR_FAILED,
+        "Failed to preroll '%s'", worker->job->uri);
+    worker_clear (worker);
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/* Prerolls the first worker to find out duration and thumbnail size and
+ * allocates the file contents accordingly */
+static gboolean
+job_prepare (ThumbnailJob * job, ThumbnailWorker * worker, guint width,
+    GError ** error)
+{
+  GstSample *sample;
+  gint64 duration;
+  gboolean ok;
+
+  if (!worker_start (worker, width, error))
+    return FALSE;
+
+  sample = worker_pull (worker);
+  ok = sample && gst_video_info_from_caps (&job->info,
+      gst_sample_get_caps (sample));
+  if (sample)
+    gst_sample_unref (sample);
+
+  if (!ok || !gst_element_query_duration (worker->pipeline, GST_FORMAT_TIME,
+          &duration) || duration <= 0) {
+    g_set_error (error, GST_PLAYER_ERROR, GST_PLAYER_ERROR_FAILED,
+        "No video with known duration in '%s'", job->uri);
+    worker_clear (worker);
+    return FALSE;
+  }
+
+  job->duration = duration;
+  if (job->interval)
+    job->n_thumbnails = MAX ((duration + job->interval - 1) / job->interval,
+        1);
+
+  job->data_offset = GST_ROUND_UP_N (HEADER_SIZE + job->n_thumbnails * 8,
+      DATA_ALIGNMENT);
+  job->contents = g_malloc0 (job->data_offset +
+      job->n_thumbnails * job->info.size);
+
+  return TRUE;
+}
+
+static void
+job_write_header (ThumbnailJob * job)
+{
+  guint8 *header = job->contents;
+  guint64 mtime;
+
+  memcpy (header, THUMBNAILS_MAGIC, 8);
+  GST_WRITE_UINT32_LE (header + HEADER_VERSION_OFFSET, THUMBNAILS_VERSION);
+  GST_WRITE_UINT32_LE (header + HEADER_N_THUMBNAILS_OFFSET, job->n_thumbnails);
+  GST_WRITE_UINT32_LE (header + HEADER_WIDTH_OFFSET, job->info.width);
+  GST_WRITE_UINT32_LE (header + HEADER_HEIGHT_OFFSET, job->info.height);
+  GST_WRITE_UINT32_LE (header + HEADER_STRIDE_OFFSET,
+      GST_VIDEO_INFO_PLANE_STRIDE (&job->info, 0));
+  GST_WRITE_UINT64_LE (header + HEADER_DATA_OFFSET_OFFSET, job->data_offset);
+  uri_get_key (job->uri, header + HEADER_URI_HASH_OFFSET, &mtime);
+  GST_WRITE_UINT64_LE (header + HEADER_MTIME_OFFSET, mtime);
+}
+
+/**
+ * gst_player_thumbnailer_generate:
+ * @thumbnailer: a #GstPlayerThumbnailer
+ * @uri: the URI of the video
+ * @n_thumbnails: number of thumbnails spread evenly over the video, or 0
+ *     to take one every @interval
+ * @interval: time between two thumbnails if @n_thumbnails is 0
+ * @location: the file to write
+ * @error: (allow-none): return location for a #GError
+ *
+ * Extracts the thumbnails of @uri and writes them to @location. The
+ * timeline is split evenly between the worker pipelines, which decode the
+ * key frame at or before each position. This blocks until all
+ * thumbnails are written.
+ *
+ * Returns: %TRUE if @location was written
+ */
+gboolean
+gst_player_thumbnailer_generate (GstPlayerThumbnailer * self,
+    const gchar * uri, guint n_thumbnails, GstClockTime interval,
+    const gchar * location, GError ** error)
+{
+  ThumbnailJob job = { 0, };
+  ThumbnailWorker *workers;
+  guint i, n_workers;
+  gboolean ok = TRUE;
+
+  g_return_val_if_fail (GST_IS_PLAYER_THUMBNAILER (self), FALSE);
+  g_return_val_if_fail (uri != NULL, FALSE);
+  g_return_val_if_fail (n_thumbnails > 0 || (interval > 0
+          && GST_CLOCK_TIME_IS_VALID (interval)), FALSE);
+  g_return_val_if_fail (location != NULL, FALSE);
+  g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  job.uri = uri;
+  job.n_thumbnails = n_thumbnails;
+  job.interval = n_thumbnails > 0 ? 0 : interval;
+
+  workers = g_new0 (ThumbnailWorker, self->n_workers);
+  workers[0].job = &job;
+  if (!job_prepare (&job, &workers[0], self->width, error)) {
+    g_free (workers);
+    return FALSE;
+  }
+
+  n_workers = MIN (self->n_workers, job.n_thumbnails);
+  GST_DEBUG ("Generating %u thumbnails of %ux%u for '%s' with %u workers",
+      job.n_thumbnails, job.info.width, job.info.height, uri, n_workers);
+
+  for (i = 0; i < n_workers; i++) {
+    ThumbnailWorker *worker = &workers[i];
+
+    worker->job = &job;
+    worker->first = i * job.n_thumbnails / n_workers;
+    worker->last = (i + 1) * job.n_thumbnails / n_workers;
+
+    if (i > 0 && !worker_start (worker, self->width, ok ? error : NULL)) {
+      ok = FALSE;
+      continue;
+    }
+
+    worker->thread = g_thread_new ("GstPlayerThumb", worker_main, worker);
+  }
+
+  for (i = 0; i < n_workers; i++) {
+    if (!workers[i].thread)
+      continue;
+
+    g_thread_join (workers[i].thread);
+    if (!workers[i].ok && ok) {
+      g_set_error (error, GST_PLAYER_ERROR, GST_PLAYER_ERROR_FAILED,
+          "Failed to extract thumbnails %u to %u of '%s'", workers[i].first,
+          workers[i].last - 1, uri);
+      ok = FALSE;
+    }
+  }
+  g_free (workers);
+
+  if (ok) {
+    job_write_header (&job);
+    ok = g_file_set_contents (location, (const gchar *) job.contents,
+        job.data_offset + job.n_thumbnails * job.info.size, error);
+  }
+  g_free (job.contents);
+
+  return ok;
+}
+
+static void
+gst_player_thumbnails_init (GstPlayerThumbnails * self)
+{
+}
+
+static void
+gst_player_thumbnails_finalize (GObject * object)
+{
+  GstPlayerThumbnails *self = GST_PLAYER_THUMBNAILS (object);
+
+  if (self->caps)
+    gst_caps_unref (self->caps);
+  if (self->file)
+    g_mapped_file_unref (self->file);
+
+  G_OBJECT_CLASS (gst_player_thumbnails_parent_class)->finalize (object);
+}
+
+static void
+gst_player_thumbnails_class_init (GstPlayerThumbnailsClass * klass)
+{
+  GObjectClass *gobject_class = (GObjectClass *) klass;
+
+  gobject_class->finalize = gst_player_thumbnails_finalize;
+}
+
+/**
+ * gst_player_thumbnails_open:
+ * @location: a file written by gst_player_thumbnailer_generate()
+ * @uri: (allow-none): the URI the thumbnails must have been generated
+ *     for, or %NULL to not check this
+ * @error: (allow-none): return location for a #GError
+ *
+ * Maps @location into memory. Fails if the file was generated for another
+ * URI than @uri or if the local file behind @uri changed since.
+ *
+ * Returns: (transfer full): the thumbnails, or %NULL
+ */
+GstPlayerThumbnails *
+gst_player_thumbnails_open (const gchar * location, const gchar * uri,
+    GError ** error)
+{
+  GstPlayerThumbnails *self;
+  GMappedFile *file;
+  const guint8 *header;
+  guint8 hash[URI_HASH_SIZE];
+  guint64 mtime, data_offset;
+  guint n_thumbnails, width, height, stride;
+  gsize size;
+
+  g_return_val_if_fail (location != NULL, NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  file = g_mapped_file_new (location, FALSE, error);
+  if (!file)
+    return NULL;
+
+  header = (const guint8 *) g_mapped_file_get_contents (file);
+  size = g_mapped_file_get_length (file);
+  if (size < HEADER_SIZE || memcmp (header, THUMBNAILS_MAGIC, 8) != 0
+      || GST_READ_UINT32_LE (header + HEADER_VERSION_OFFSET) !=
+      THUMBNAILS_VERSION)
+    goto invalid;
+
+  n_thumbnails = GST_READ_UINT32_LE (header + HEADER_N_THUMBNAILS_OFFSET);
+  width = GST_READ_UINT32_LE (header + HEADER_WIDTH_OFFSET);
+  height = GST_READ_UINT32_LE (header + HEADER_HEIGHT_OFFSET);
+  stride = GST_READ_UINT32_LE (header + HEADER_STRIDE_OFFSET);
+  data_offset = GST_READ_UINT64_LE (header + HEADER_DATA_OFFSET_OFFSET);
+  if (n_thumbnails == 0 || width == 0 || height == 0 || stride != width * 4
+      || data_offset < HEADER_SIZE + (guint64) n_thumbnails * 8
+      || data_offset > size
+      || (size - data_offset) / ((guint64) stride * height) < n_thumbnails)
+    goto invalid;
+
+  if (uri) {
+    uri_get_key (uri, hash, &mtime);
+    if (memcmp (hash, header + HEADER_URI_HASH_OFFSET, URI_HASH_SIZE) != 0
+        || mtime != GST_READ_UINT64_LE (header + HEADER_MTIME_OFFSET)) {
+      g_set_error (error, GST_PLAYER_ERROR, GST_PLAYER_ERROR_FAILED,
+          "Thumbnails in '%s' are not up to date for '%s'", location, uri);
+      g_mapped_file_unref (file);
+      return NULL;
+    }
+  }
+
+  self = g_object_new (GST_TYPE_PLAYER_THUMBNAILS, NULL);
+  self->file = file;
+  self->timestamps = header + HEADER_SIZE;
+  self->n_thumbnails = n_thumbnails;
+  self->data_offset = data_offset;
+  self->thumbnail_size = (gsize) stride * height;
+  self->caps = gst_caps_new_simple ("video/x-raw",
+      "format", G_TYPE_STRING, "RGBx",
+      "width", G_TYPE_INT, width, "height", G_TYPE_INT, height,
+      "pixel-aspect-ratio", GST_TYPE_FRACTION, 1, 1,
+      "framerate", GST_TYPE_FRACTION, 0, 1, NULL);
+
+  return self;
+
+invalid:
+  g_set_error (error, GST_PLAYER_ERROR, GST_PLAYER_ERROR_FAILED,
+      "'%s' contains no valid thumbnails", location);
+  g_mapped_file_unref (file);
+  return NULL;
+}
+
+/**
+ * gst_player_thumbnails_get_n_thumbnails:
+ * @thumbnails: a #GstPlayerThumbnails
+ *
+ * Returns: the number of thumbnails
+ */
+guint
+gst_player_thumbnails_get_n_thumbnails (GstPlayerThumbnails * self)
+{
+  g_return_val_if_fail (GST_IS_PLAYER_THUMBNAILS (self), 0);
+
+  return self->n_thumbnails;
+}
+
+/**
+ * gst_player_thumbnails_get_sample:
+ * @thumbnails: a #GstPlayerThumbnails
+ * @position: a position in the video
+ *
+ * Looks up the last thumbnail at or before @position, or the first one if
+ * all are later. The returned sample points into the mapped file and
+ * keeps it mapped, nothing is copied.
+ *
+ * Returns: (transfer full): a #GstSample with the thumbnail
+ */
+GstSample *
+gst_player_thumbnails_get_sample (GstPlayerThumbnails * self,
+    GstClockTime position)
+{
+  GstBuffer *buffer;
+  GstSample *sample;
+  guint lo = 0, hi, mid;
+
+  g_return_val_if_fail (GST_IS_PLAYER_THUMBNAILS (self), NULL);
+
+  hi = self->n_thumbnails;
+  while (hi - lo > 1) {
+    mid = lo + (hi - lo) / 2;
+    if (GST_READ_UINT64_LE (self->timestamps + mid * 8) <= position)
+      lo = mid;
+    else
+      hi = mid;
+  }
+
+  buffer = gst_buffer_new_wrapped_full (GST_MEMORY_FLAG_READONLY,
+      g_mapped_file_get_contents (self->file),
+      g_mapped_file_get_length (self->file),
+      self->data_offset + lo * self->thumbnail_size, self->thumbnail_size,
+      g_mapped_file_ref (self->file), (GDestroyNotify) g_mapped_file_unref);
+  GST_BUFFER_PTS (buffer) = GST_READ_UINT64_LE (self->timestamps + lo * 8);
+
+  sample = gst_sample_new (buffer, self->caps, NULL, NULL);
+  gst_buffer_unref (buffer);
+
+  return sample;
+}
@@ -0,0 +1,100 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_PLAYER_THUMBNAILER_H__
+#define __GST_PLAYER_THUMBNAILER_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_PLAYER_THUMBNAILER \
+  (gst_player_thumbnailer_get_type ())
+#define GST_PLAYER_THUMBNAILER(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_PLAYER_THUMBNAILER,GstPlayerThumbnailer))
+#define GST_PLAYER_THUMBNAILER_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_PLAYER_THUMBNAILER,GstPlayerThumbnailerClass))
+#define GST_IS_PLAYER_THUMBNAILER(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_PLAYER_THUMBNAILER))
+#define GST_IS_PLAYER_THUMBNAILER_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_PLAYER_THUMBNAILER))
+
+/**
+ * GstPlayerThumbnailer:
+ *
+ * Extracts thumbnails of a video with several pipelines in parallel and
+ * writes them into a file that can be opened with
+ * gst_player_thumbnails_open().
+ */
+typedef struct _GstPlayerThumbnailer GstPlayerThumbnailer;
+typedef struct _GstPlayerThumbnailerClass GstPlayerThumbnailerClass;
+GType gst_player_thumbnailer_get_type (void);
+
+#define GST_TYPE_PLAYER_THUMBNAILS \
+  (gst_player_thumbnails_get_type ())
+#define GST_PLAYER_THUMBNAILS(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_PLAYER_THUMBNAILS,GstPlayerThumbnails))
+#define GST_PLAYER_THUMBNAILS_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_PLAYER_THUMBNAILS,GstPlayerThumbnailsClass))
+#define GST_IS_PLAYER_THUMBNAILS(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_PLAYER_THUMBNAILS))
+#define GST_IS_PLAYER_THUMBNAILS_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_PLAYER_THUMBNAILS))
+
+/**
+ * GstPlayerThumbnails:
+ *
+ * Thumbnails written by gst_player_thumbnailer_generate(), mapped into
+ * memory.
+ */
+typedef struct _GstPlayerThumbnails GstPlayerThumbnails;
+typedef struct _GstPlayerThumbnailsClass GstPlayerThumbnailsClass;
+GType gst_player_thumbnails_get_type (void);
+
+GstPlayerThumbnailer * gst_player_thumbnailer_new      (guint n_workers);
+
+guint                  gst_player_thumbnailer_get_n_workers
+                                                       (GstPlayerThumbnailer *thumbnailer);
+
+guint                  gst_player_thumbnailer_get_width
+                                                       (GstPlayerThumbnailer *thumbnailer);
+void                   gst_player_thumbnailer_set_width
+                                                       (GstPlayerThumbnailer *thumbnailer,
+                                                        guint width);
+
+gboolean               gst_player_thumbnailer_generate (GstPlayerThumbnailer *thumbnailer,
+                                                        const gchar *uri,
+                                                        guint n_thumbnails,
+                                                        GstClockTime interval,
+                                                        const gchar *location,
+                                                        GError **error);
+
+GstPlayerThumbnails *  gst_player_thumbnails_open      (const gchar *location,
+                                                        const gchar *uri,
+                                                        GError **error);
+
+guint                  gst_player_thumbnails_get_n_thumbnails
+                                                       (GstPlayerThumbnails *thumbnails);
+
+GstSample *            gst_player_thumbnails_get_sample
+                                                       (GstPlayerThumbnails *thumbnails,
+                                                        GstClockTime position);
+
+G_END_DECLS
+
+#endif /* __GST_PLAYER_THUMBNAILER_H__ */
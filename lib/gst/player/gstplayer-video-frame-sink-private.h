@@ -0,0 +1,56 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_PLAYER_VIDEO_FRAME_SINK_PRIVATE_H__
+#define __GST_PLAYER_VIDEO_FRAME_SINK_PRIVATE_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_PLAYER_VIDEO_FRAME_SINK \
+  (gst_player_video_frame_sink_get_type ())
+#define GST_PLAYER_VIDEO_FRAME_SINK(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_PLAYER_VIDEO_FRAME_SINK,GstPlayerVideoFrameSink))
+
+typedef struct _GstPlayerVideoFrameSink GstPlayerVideoFrameSink;
+typedef struct _GstPlayerVideoFrameSinkClass GstPlayerVideoFrameSinkClass;
+
+/* Called from the streaming thread whenever a frame was queued */
+typedef void (*GstPlayerVideoFrameSinkCallback) (GstPlayerVideoFrameSink *
+    sink, gpointer user_data);
+
+G_GNUC_INTERNAL GType      gst_player_video_frame_sink_get_type (void);
+
+G_GNUC_INTERNAL GstElement *
+                           gst_player_video_frame_sink_new
+                           (GstPlayerVideoFrameSinkCallback callback,
+                            gpointer user_data);
+G_GNUC_INTERNAL void       gst_player_video_frame_sink_configure
+                           (GstPlayerVideoFrameSink *sink,
+                            guint queue_size,
+                            guint pool_size);
+G_GNUC_INTERNAL GstSample *
+                           gst_player_video_frame_sink_pull
+                           (GstPlayerVideoFrameSink *sink);
+G_GNUC_INTERNAL guint64    gst_player_video_frame_sink_get_dropped
+                           (GstPlayerVideoFrameSink *sink);
+
+G_END_DECLS
+
+#endif /* __GST_PLAYER_VIDEO_FRAME_SINK_PRIVATE_H__ */
@@ -0,0 +1,274 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Video sink that hands the decoded frames to the application, see
+ * gst_player_pull_video_frame().
+ *
+ * Frames are queued without copying in a bounded queue. If the application
+ * does not keep up, the oldest frames are dropped so that it always gets
+ * the latest ones. Upstream is offered a buffer pool with a fixed number of
+ * buffers, so that once playback runs no buffers are allocated anymore.
+ */
+
+#include "gstplayer-video-frame-sink-private.h"
+
+#include <gst/video/video.h>
+#include <gst/video/gstvideosink.h>
+
+struct _GstPlayerVideoFrameSink
+{
+  GstVideoSink parent;
+
+  GstPlayerVideoFrameSinkCallback callback;
+  gpointer user_data;
+
+  /* Protected by lock */
+  GMutex lock;
+  GQueue frames;
+  guint queue_size;
+  guint pool_size;
+  GstCaps *caps;
+  guint64 dropped;
+};
+
+struct _GstPlayerVideoFrameSinkClass
+{
+  GstVideoSinkClass parent_class;
+};
+
+static GstStaticPadTemplate sink_template = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE (GST_VIDEO_FORMATS_ALL)));
+
+G_DEFINE_TYPE (GstPlayerVideoFrameSink, gst_player_video_frame_sink,
+    GST_TYPE_VIDEO_SINK);
+
+/* Must be called with lock */
+static void
+frames_clear_locked (GstPlayerVideoFrameSink * self)
+{
+  GstSample *sample;
+
+  while ((sample = g_queue_pop_head (&self->frames)))
+    gst_sample_unref (sample);
+}
+
+static void
+gst_player_video_frame_sink_init (GstPlayerVideoFrameSink * self)
+{
+  g_mutex_init (&self->lock);
+  g_queue_init (&self->frames);
+  self->queue_size = 1;
+}
+
+static void
+gst_player_video_frame_sink_finalize (GObject * object)
+{
+  GstPlayerVideoFrameSink *self = GST_PLAYER_VIDEO_FRAME_SINK (object);
+
+  frames_clear_locked (self);
+  if (self->caps)
+    gst_caps_unref (self->caps);
+  g_mutex_clear (&self->lock);
+
+  G_OBJECT_CLASS (gst_player_video_frame_sink_parent_class)->finalize
+      (object);
+}
+
+static gboolean
+gst_player_video_frame_sink_set_caps (GstBaseSink * bsink, GstCaps * caps)
+{
+  GstPlayerVideoFrameSink *self = GST_PLAYER_VIDEO_FRAME_SINK (bsink);
+
+  g_mutex_lock (&self->lock);
+  gst_caps_replace (&self->caps, caps);
+  g_mutex_unlock (&self->lock);
+
+  return TRUE;
+}
+
+static gboolean
+gst_player_video_frame_sink_propose_allocation (GstBaseSink * bsink,
+    GstQuery * query)
+{
+  GstPlayerVideoFrameSink *self = GST_PLAYER_VIDEO_FRAME_SINK (bsink);
+  GstBufferPool *pool;
+  GstStructure *config;
+  GstVideoInfo info;
+  GstCaps *caps;
+  gboolean need_pool;
+  guint pool_size;
+
+  gst_query_parse_allocation (query, &caps, &need_pool);
+  if (!caps || !gst_video_info_from_caps (&info, caps))
+    return FALSE;
+
+  g_mutex_lock (&self->lock);
+  pool_size = self->pool_size;
+  g_mutex_unlock (&self->lock);
+
+  if (need_pool && pool_size > 0) {
+    pool = gst_video_buffer_pool_new ();
+    config = gst_buffer_pool_get_config (pool);
+    gst_buffer_pool_config_set_params (config, caps, info.size, pool_size,
+        pool_size);
+    gst_buffer_pool_config_add_option (config,
+        GST_BUFFER_POOL_OPTION_VIDEO_META);
+    if (gst_buffer_pool_set_config (pool, config)) {
+      GST_DEBUG_OBJECT (self, "Proposing pool of %u buffers", pool_size);
+      gst_query_add_allocation_pool (query, pool, info.size, pool_size,
+          pool_size);
+    }
+    gst_object_unref (pool);
+  }
+
+  gst_query_add_allocation_meta (query, GST_VIDEO_META_API_TYPE, NULL);
+
+  return TRUE;
+}
+
+static gboolean
+gst_player_video_frame_sink_event (GstBaseSink * bsink, GstEvent * event)
+{
+  GstPlayerVideoFrameSink *self = GST_PLAYER_VIDEO_FRAME_SINK (bsink);
+
+  /* Frames from before a seek are of no use anymore */
+  if (GST_EVENT_TYPE (event) == GST_EVENT_FLUSH_STOP) {
+    g_mutex_lock (&self->lock);
+    frames_clear_locked (self);
+    g_mutex_unlock (&self->lock);
+  }
+
+  return
+      GST_BASE_SINK_CLASS (gst_player_video_frame_sink_parent_class)->event
+      (bsink, event);
+}
+
+static gboolean
+gst_player_video_frame_sink_stop (GstBaseSink * bsink)
+{
+  GstPlayerVideoFrameSink *self = GST_PLAYER_VIDEO_FRAME_SINK (bsink);
+
+  g_mutex_lock (&self->lock);
+  frames_clear_locked (self);
+  gst_caps_replace (&self->caps, NULL);
+  g_mutex_unlock (&self->lock);
+
+  return TRUE;
+}
+
+static GstFlowReturn
+gst_player_video_frame_sink_show_frame (GstVideoSink * vsink,
+    GstBuffer * buffer)
+{
+  GstPlayerVideoFrameSink *self = GST_PLAYER_VIDEO_FRAME_SINK (vsink);
+
+  g_mutex_lock (&self->lock);
+  g_queue_push_tail (&self->frames, gst_sample_new (buffer, self->caps, NULL,
+          NULL));
+  while (g_queue_get_length (&self->frames) > self->queue_size) {
+    gst_sample_unref (g_queue_pop_head (&self->frames));
+    self->dropped++;
+  }
+  g_mutex_unlock (&self->lock);
+
+  if (self->callback)
+    self->callback (self, self->user_data);
+
+  return GST_FLOW_OK;
+}
+
+static void
+gst_player_video_frame_sink_class_init (GstPlayerVideoFrameSinkClass * klass)
+{
+  GObjectClass *gobject_class = (GObjectClass *) klass;
+  GstElementClass *element_class = (GstElementClass *) klass;
+  GstBaseSinkClass *basesink_class = (GstBaseSinkClass *) klass;
+  GstVideoSinkClass *videosink_class = (GstVideoSinkClass *) klass;
+
+  gobject_class->finalize = gst_player_video_frame_sink_finalize;
+
+  gst_element_class_add_pad_template (element_class,
+      gst_static_pad_template_get (&sink_template));
+  gst_element_class_set_static_metadata (element_class,
+      "Player video frame sink", "Sink/Video",
+      "Hands decoded video frames to the application",
+      "GstPlayer developers");
+
+  basesink_class->set_caps = gst_player_video_frame_sink_set_caps;
+  basesink_class->propose_allocation =
+      gst_player_video_frame_sink_propose_allocation;
+  basesink_class->event = gst_player_video_frame_sink_event;
+  basesink_class->stop = gst_player_video_frame_sink_stop;
+
+  videosink_class->show_frame = gst_player_video_frame_sink_show_frame;
+}
+
+GstElement *
+gst_player_video_frame_sink_new (GstPlayerVideoFrameSinkCallback callback,
+    gpointer user_data)
+{
+  GstPlayerVideoFrameSink *self;
+
+  self = g_object_new (GST_TYPE_PLAYER_VIDEO_FRAME_SINK, NULL);
+  self->callback = callback;
+  self->user_data = user_data;
+
+  return GST_ELEMENT (self);
+}
+
+/* A new pool size is proposed with the next allocation query */
+void
+gst_player_video_frame_sink_configure (GstPlayerVideoFrameSink * self,
+    guint queue_size, guint pool_size)
+{
+  g_mutex_lock (&self->lock);
+  self->queue_size = MAX (queue_size, 1);
+  self->pool_size = pool_size;
+  while (g_queue_get_length (&self->frames) > self->queue_size) {
+    gst_sample_unref (g_queue_pop_head (&self->frames));
+    self->dropped++;
+  }
+  g_mutex_unlock (&self->lock);
+}
+
+/* Returns the oldest queued frame, or NULL */
+GstSample *
+gst_player_video_frame_sink_pull (GstPlayerVideoFrameSink * self)
+{
+  GstSample *sample;
+
+  g_mutex_lock (&self->lock);
+  sample = g_queue_pop_head (&self->frames);
+  g_mutex_unlock (&self->lock);
+
+  return sample;
+}
+
+guint64
+gst_player_video_frame_sink_get_dropped (GstPlayerVideoFrameSink * self)
+{
+  guint64 dropped;
+
+  g_mutex_lock (&self->lock);
+  dropped = self->dropped;
+  g_mutex_unlock (&self->lock);
+
+  return dropped;
+}
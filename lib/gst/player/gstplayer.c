@@ -29,27 +29,31 @@
  *
  * - external subtitles
  * - Visualization
- * - Playback rate
  * - volume/mute change notification
  * - Equalizer
- * - Gapless playback
  * - Frame stepping
  * - Subtitle font, connection speed
  * - Color balance, deinterlacing
- * - Buffering control (-> progressive downloading)
  * - Playlist/queue object
- * - Custom video sink (e.g. embed in GL scene)
  *
  */
 
 #include "gstplayer.h"
 #include "gstplayer-media-info-private.h"
+#include "gstplayer-executor-private.h"
+#include "gstplayer-video-frame-sink-private.h"
+#include "gstplayer-audio-analysis-private.h"
+#include "gstplayer-cache-private.h"
 
 #include <gst/gst.h>
 #include <gst/video/video.h>
 #include <gst/tag/tag.h>
 #include <gst/pbutils/descriptions.h>
 
+#include <glib/gstdio.h>
+#include <gio/gio.h>
+#include <string.h>
+
 GST_DEBUG_CATEGORY_STATIC (gst_player_debug);
 #define GST_CAT_DEFAULT gst_player_debug
 
@@ -79,9 +83,105 @@ enum
   PROP_MUTE,
   PROP_WINDOW_HANDLE,
   PROP_PIPELINE,
+  PROP_POSITION_UPDATE_INTERVAL,
+  PROP_POSITION_UPDATE_FLAGS,
+  PROP_VISIBLE,
+  PROP_VERIFY_POSITION,
+  PROP_EXECUTOR,
+  PROP_MEDIA_INFO_UPDATE_INTERVAL,
+  PROP_NEXT_URI,
+  PROP_MAX_PRELOADED,
+  PROP_PRELOAD_MEMORY_LIMIT,
+  PROP_IDLE_TIMEOUT,
+  PROP_SEEK_MODE,
+  PROP_RATE,
+  PROP_DEGRADATION_STEPS,
+  PROP_BUFFER_SIZE,
+  PROP_BUFFER_DURATION,
+  PROP_BUFFERING_MODE,
+  PROP_LOW_WATERMARK,
+  PROP_HIGH_WATERMARK,
+  PROP_BUFFERING_EARLY_RESUME,
+  PROP_DOWNLOAD_CACHE_DIR,
+  PROP_DOWNLOAD_CACHE_SIZE,
+  PROP_MEDIA_INFO_CACHE,
+  PROP_VIDEO_FRAME_DELIVERY,
+  PROP_VIDEO_FRAME_QUEUE_SIZE,
+  PROP_VIDEO_FRAME_POOL_SIZE,
+  PROP_AUDIO_LEVEL_INTERVAL,
+  PROP_AUDIO_SPECTRUM_BANDS,
   PROP_LAST
 };
 
+#define DEFAULT_POSITION_UPDATE_INTERVAL 100
+#define DEFAULT_POSITION_UPDATE_FLAGS GST_PLAYER_POSITION_UPDATE_FLAG_NONE
+#define DEFAULT_VERIFY_POSITION FALSE
+#define DEFAULT_MEDIA_INFO_UPDATE_INTERVAL 0
+#define DEFAULT_MAX_PRELOADED 1
+#define DEFAULT_PRELOAD_MEMORY_LIMIT 0
+#define DEFAULT_IDLE_TIMEOUT 60000
+#define DEFAULT_SEEK_MODE GST_PLAYER_SEEK_MODE_DEFAULT
+#define DEFAULT_RATE 1.0
+#define DEFAULT_DEGRADATION_STEPS GST_PLAYER_DEGRADATION_FLAG_NONE
+#define DEFAULT_BUFFER_SIZE -1
+#define DEFAULT_BUFFER_DURATION -1
+#define DEFAULT_BUFFERING_MODE GST_BUFFERING_STREAM
+#define DEFAULT_LOW_WATERMARK 100
+#define DEFAULT_HIGH_WATERMARK 100
+#define DEFAULT_BUFFERING_EARLY_RESUME FALSE
+/* What queue2 buffers when no buffer duration is set */
+#define QUEUE2_BUFFER_DURATION (2 * GST_SECOND)
+#define DEFAULT_DOWNLOAD_CACHE_DIR NULL
+#define DEFAULT_DOWNLOAD_CACHE_SIZE (512 * 1024 * 1024)
+#define DEFAULT_VIDEO_FRAME_DELIVERY FALSE
+#define DEFAULT_VIDEO_FRAME_QUEUE_SIZE 1
+#define DEFAULT_VIDEO_FRAME_POOL_SIZE 0
+#define DEFAULT_AUDIO_LEVEL_INTERVAL 0
+#define DEFAULT_AUDIO_SPECTRUM_BANDS 0
+
+/* Suffix of the files in the download cache, see
+ * gst_player_cache_entry_name() */
+#define DOWNLOAD_CACHE_SUFFIX ".download"
+
+/* Size of the ring buffer in timeshift mode if no buffer-size is set */
+#define DEFAULT_RING_BUFFER_MAX_SIZE (64 * 1024 * 1024)
+
+/* From this rate on only keyframes are decoded and audio is skipped, most
+ * decoded frames would be dropped anyway */
+#define TRICKMODE_MIN_RATE 4.0
+
+/* Seeks are throttled to one per average latency of the last
+ * SEEK_LATENCY_HISTORY seeks, bounded by these values */
+#define SEEK_LATENCY_HISTORY 16
+#define DEFAULT_SEEK_INTERVAL (250 * GST_MSECOND)
+#define MIN_SEEK_INTERVAL (20 * GST_MSECOND)
+#define MAX_SEEK_INTERVAL (1000 * GST_MSECOND)
+
+/* Interpolated positions further away than this from the queried position
+ * are reported in verify-position mode */
+#define POSITION_VERIFY_TOLERANCE (50 * GST_MSECOND)
+
+/* A degradation step is taken after this many QoS messages reported that
+ * the video sink is behind, but at most once per hold time. One step is
+ * undone once the sink was not behind for the recovery time */
+#define DEGRADATION_LATE_MESSAGES 5
+#define DEGRADATION_HOLD_TIME (2 * GST_SECOND)
+#define DEGRADATION_RECOVERY_TIME (5 * GST_SECOND)
+/* max-lateness of video sinks in nanoseconds, GstBaseSink uses 20ms for
+ * video sinks by default */
+#define DEGRADATION_MAX_LATENESS "5000000"
+#define DEFAULT_VIDEO_MAX_LATENESS "20000000"
+
+/* Upper bounds of the latency histogram buckets in gst_player_get_stats(),
+ * the last bucket counts everything above */
+#define STATS_HISTOGRAM_BUCKETS 10
+static const GstClockTime stats_histogram_bounds[STATS_HISTOGRAM_BUCKETS - 1]
+    = {
+  10 * GST_MSECOND, 25 * GST_MSECOND, 50 * GST_MSECOND, 100 * GST_MSECOND,
+  250 * GST_MSECOND, 500 * GST_MSECOND, GST_SECOND, 2500 * GST_MSECOND,
+  5 * GST_SECOND
+};
+
 enum
 {
   SIGNAL_POSITION_UPDATED,
@@ -92,6 +192,12 @@ enum
   SIGNAL_ERROR,
   SIGNAL_VIDEO_DIMENSIONS_CHANGED,
   SIGNAL_MEDIA_INFO_UPDATED,
+  SIGNAL_URI_LOADED,
+  SIGNAL_ABOUT_TO_FINISH,
+  SIGNAL_DEGRADATION_CHANGED,
+  SIGNAL_BUFFERING_TIME_LEFT,
+  SIGNAL_VIDEO_FRAME_AVAILABLE,
+  SIGNAL_AUDIO_LEVELS,
   SIGNAL_LAST
 };
 
@@ -99,9 +205,109 @@ enum
 {
   GST_PLAY_FLAG_VIDEO = (1 << 0),
   GST_PLAY_FLAG_AUDIO = (1 << 1),
-  GST_PLAY_FLAG_SUBTITLE = (1 << 2)
+  GST_PLAY_FLAG_SUBTITLE = (1 << 2),
+  GST_PLAY_FLAG_DOWNLOAD = (1 << 7)
 };
 
+/* Events for the application are posted into a fixed size ring by the
+ * player thread (and by streaming threads for tags and caps changes) and
+ * drained by a single GSource attached to the application context.
+ *
+ * The ring is a bounded multi-producer queue where each cell carries a
+ * sequence number that tells producers and the consumer whose turn it is,
+ * so no lock is taken when posting an event. Events that do not fit into
+ * the ring are appended to an overflow list instead, and all later events
+ * follow them there until the application context drained the list, so
+ * no event is lost or delivered out of order.
+ *
+ * Position, buffering and video dimension updates are coalesced: as long
+ * as the last queued event of the same kind was not dispatched yet and it
+ * is still the last event in the ring, its value is replaced instead of
+ * queueing a new event. This keeps the order of events as seen by the
+ * application while only delivering the latest value per main loop
+ * iteration.
+ */
+
+#define EVENT_QUEUE_SIZE 64     /* Must be a power of two */
+
+typedef union
+{
+  GstPlayerState state;
+  GstClockTime time;
+  gint percent;
+  struct
+  {
+    gint width, height;
+  } dimensions;
+  GError *err;
+  GstPlayerMediaInfo *info;
+  GstPlayerDegradationFlags degradation;
+  gchar *uri;
+  GstStructure *levels;
+} GstPlayerEventData;
+
+typedef struct
+{
+  volatile gint seq;
+  guint signal;
+  GstPlayerEventData data;
+} GstPlayerEventCell;
+
+typedef struct
+{
+  guint signal;
+  GstPlayerEventData data;
+} GstPlayerEventOverflow;
+
+typedef struct
+{
+  GType type;
+  gint stream_index;
+} GstPlayerPendingStream;
+
+/* What standby_bus_sync_cb() keeps of the messages of a playbin that
+ * prerolls in the background. Attached to the playbin, so it lives as long
+ * as its bus can post messages */
+typedef struct
+{
+  GstPlayer *player;
+  GstElement *playbin;
+  volatile gint failed;
+  GMutex lock;
+  GstTagList *global_tags;      /* Protected by lock */
+  GstMessage *buffering;        /* Protected by lock */
+} GstPlayerStandbyBus;
+
+/* A playbin prerolled in the background, see gst_player_preload() */
+typedef struct
+{
+  gchar *uri;
+  GstElement *playbin;
+  GstPlayerStandbyBus *bus_data;
+  gboolean is_live;
+} GstPlayerStandby;
+
+typedef struct
+{
+  /* Bit lock protecting the fields below and the data of the referenced
+   * cell until it is dispatched */
+  volatile gint lock;
+  gboolean queued;
+  gint pos;
+} GstPlayerEventSlot;
+
+typedef struct
+{
+  guint64 frames_rendered;
+  guint64 frames_dropped;
+  gint64 jitter;
+  GstClockTime time_to_first_frame;
+  guint time_to_first_frame_histogram[STATS_HISTOGRAM_BUCKETS];
+  guint rebuffer_count;
+  GstClockTime stall_time;
+  guint seek_latency_histogram[STATS_HISTOGRAM_BUCKETS];
+} GstPlayerPlaybackStats;
+
 struct _GstPlayer
 {
   GstObject parent;
@@ -111,31 +317,173 @@ struct _GstPlayer
 
   gchar *uri;
 
+  /* Gapless playback, see about_to_finish_cb(). Protected by lock */
+  gchar *next_uri;
+  gchar *switching_uri;         /* Passed to playbin but not started yet */
+
   GThread *thread;
   GMutex lock;
   GCond cond;
   GMainContext *context;
   GMainLoop *loop;
+  GstPlayerExecutor *executor;
+  gboolean initialized;         /* Protected by lock */
+
+  /* Functions to run from the main context, see gst_player_invoke() */
+  GSource *command_source;
+  GQueue commands;              /* Protected by lock */
 
   guintptr window_handle;
 
   GstElement *playbin;
   GstBus *bus;
+  GSource *bus_source;
   GstState target_state, current_state;
   gboolean is_live, is_eos;
   GSource *tick_source, *ready_timeout_source;
 
+  /* Idle pipeline retention, see add_ready_timeout_source() */
+  volatile gint idle_timeout;
+  GList idle_link;              /* Protected by idle_players_lock */
+  gboolean idle_registered;     /* Protected by idle_players_lock */
+  GWeakRef idle_ref;
+  volatile gint warm_starts, cold_starts, idle_releases;
+
+  /* Position update settings, protected by lock. Copied to the tick_*
+   * fields by reconfigure_tick_source_cb() */
+  guint position_update_interval;
+  GstPlayerPositionUpdateFlags position_update_flags;
+  gboolean visible;
+  /* Only used from main context */
+  guint tick_interval;
+  GstPlayerPositionUpdateFlags tick_flags;
+  gboolean tick_visible;
+  gboolean tick_wanted;
+  gint video_fps_n, video_fps_d;
+
+  /* Position snapshot, see position_snapshot_update(). Only written from
+   * main context, read from any thread with position_seq as seqlock */
+  volatile gint position_seq;
+  GstClockTime position;
+  GstClockTime position_clock_time;      /* Monotonic time of position */
+  GstClockTime position_duration;
+  gdouble position_rate;
+  gboolean position_running;
+  gboolean verify_position;
+
   GstPlayerState app_state;
   gint buffering;
+  /* Whether playback may continue, see buffering_cb() */
+  gboolean buffering_done;
+  GstClockTime buffering_time_left;
+
+  /* Protected by lock */
+  gint buffer_size;
+  gint64 buffer_duration;
+  GstBufferingMode buffering_mode;
+  gint low_watermark, high_watermark;
+  gboolean buffering_early_resume;
+
+  /* Download cache, see download_cache_lookup_locked(). Protected by lock */
+  gchar *uri_validator;
+  gchar *download_cache_dir;
+  guint64 download_cache_size;
+  gchar *download_key;          /* Key of the current URI if not cached */
+  gchar *download_file;         /* Temporary file of the running download */
+  gchar *download_file_key;
+  gboolean download_complete;
+
+  /* Media information cache, see media_info_cache_lookup(). Protected by
+   * lock */
+  GstPlayerMediaInfoCache *media_info_cache;
+  gboolean media_info_cached;   /* media_info is from the cache */
+  gboolean media_info_uncached; /* Store media_info after preroll */
+
+  /* Conversion for gst_player_get_video_snapshot(), reused while the
+   * formats don't change. Protected by snapshot_lock */
+  GMutex snapshot_lock;
+#if GST_CHECK_VERSION(1,6,0)
+  GstVideoConverter *snapshot_converter;
+  GstBufferPool *snapshot_pool;
+  GstVideoInfo snapshot_in_info, snapshot_out_info;
+#endif
+
+  /* Frame delivery to the application, see gst_player_pull_video_frame().
+   * Protected by lock */
+  gboolean video_frame_delivery;
+  guint video_frame_queue_size;
+  guint video_frame_pool_size;
+  GstElement *video_frame_sink;
+
+  /* Audio analysis tap, see audio_analysis_attach(). Protected by lock */
+  guint audio_level_interval;
+  guint audio_spectrum_bands;
+  GstPlayerAudioAnalysis *audio_analysis;
+
+  /* Preloaded pipelines, least recently preloaded first. Only accessed
+   * from main context */
+  GQueue standby;
+  /* Protected by lock */
+  GQueue preload_requests;
+  guint max_preloaded;
+  guint64 preload_memory_limit;
 
   GstTagList *global_tags;
   GstPlayerMediaInfo *media_info;
 
+  /* Tag and caps changes not yet merged into media_info, see
+   * media_info_schedule_update_locked(). Protected by lock */
+  guint media_info_update_interval;
+  GSource *media_info_update_source;
+  GArray *pending_streams;
+  GstTagList *pending_global_tags;
+  guint n_pending_updates;
+
   /* Protected by lock */
   gboolean seek_pending;        /* Only set from main context */
   GstClockTime last_seek_time;  /* Only set from main context */
   GSource *seek_source;
   GstClockTime seek_position;
+  GstPlayerSeekMode seek_mode;
+  gdouble rate;
+  GstClockTime seek_interval;
+  GstClockTime seek_latencies[SEEK_LATENCY_HISTORY];
+  guint n_seek_latencies;
+  guint seek_latencies_pos;
+
+  /* Playback statistics, see stats_begin_write(). Only written from main
+   * context, read from any thread with stats_seq as seqlock */
+  volatile gint stats_seq;
+  GstPlayerPlaybackStats stats;
+  GstClockTime startup_time;    /* Only used from main context */
+  GstClockTime stall_start_time;        /* Only used from main context */
+  /* Since the URI was set, written from the streaming thread of the
+   * source. Protected by lock */
+  guint64 bytes_downloaded;
+
+  /* QoS degradation controller, see degradation_handle_qos() */
+  volatile gint degradation_steps;
+  GstPlayerDegradationFlags degradation_active; /* Only main context */
+  volatile gint degradation_applied;    /* degradation_active for elements
+                                         * added while playing */
+  guint degradation_late_count; /* Only main context */
+  GstClockTime degradation_last_late;   /* Only main context */
+  GstClockTime degradation_last_change; /* Only main context */
+  GSource *degradation_source;  /* Only main context */
+
+  /* Events for the application context, see post_event() */
+  GSource *event_source;
+  GstPlayerEventCell events[EVENT_QUEUE_SIZE];
+  volatile gint events_enqueue_pos;
+  gint events_dequeue_pos;
+  volatile gint events_wakeup_pending;
+  GstPlayerEventSlot event_slots[SIGNAL_LAST];
+  /* Events that did not fit into the ring, protected by
+   * events_overflow_lock */
+  GMutex events_overflow_lock;
+  GQueue events_overflow;
+  volatile gint events_n_overflow;
+  volatile gint events_overflowed, events_coalesced;
 };
 
 struct _GstPlayerClass
@@ -146,9 +494,21 @@ struct _GstPlayerClass
 #define parent_class gst_player_parent_class
 G_DEFINE_TYPE (GstPlayer, gst_player, GST_TYPE_OBJECT);
 
+/* Players with an idle pipeline in READY state, least recently used first,
+ * see gst_player_release_idle_pipelines() */
+static GMutex idle_players_lock;
+static GQueue idle_players = G_QUEUE_INIT;
+
+/* Serializes all changes to download cache directories, which can be
+ * shared by many players */
+static GMutex download_cache_lock;
+
 static guint signals[SIGNAL_LAST] = { 0, };
 static GParamSpec *param_specs[PROP_LAST] = { NULL, };
+static GQuark audio_analysis_quark;
+static GQuark standby_bus_quark;
 
+static void gst_player_constructed (GObject * object);
 static void gst_player_finalize (GObject * object);
 static void gst_player_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec);
@@ -156,12 +516,53 @@ static void gst_player_get_property (GObject * object, guint prop_id,
     GValue * value, GParamSpec * pspec);
 
 static gpointer gst_player_main (gpointer data);
-
+static void gst_player_setup (GstPlayer * self);
+static void gst_player_teardown (GstPlayer * self);
+static void gst_player_invoke (GstPlayer * self, GSourceFunc func);
+static GSource *command_source_new (GstPlayer * self);
+static gboolean gst_player_teardown_cb (gpointer user_data);
+
+static void event_queue_init (GstPlayer * self);
+static void event_queue_flush (GstPlayer * self);
+static GSource *event_source_new (GstPlayer * self);
+
+static void seek_latency_record_locked (GstPlayer * self,
+    GstClockTime latency);
 static void gst_player_seek_internal_locked (GstPlayer * self);
+static void gst_player_seek_schedule_locked (GstPlayer * self);
+static gboolean degradation_reconfigure_cb (gpointer user_data);
+static void playbin_set_buffering_locked (GstPlayer * self,
+    GstElement * playbin);
+static void player_set_flag (GstPlayer * self, gint pos);
+static void player_clear_flag (GstPlayer * self, gint pos);
+static void gst_player_set_rate_internal_locked (GstPlayer * self,
+    gdouble rate);
+static gboolean playbin_seek (GstPlayer * self, GstClockTime position,
+    gdouble rate, GstSeekFlags flags);
 static gboolean gst_player_stop_internal (gpointer user_data);
 static gboolean gst_player_pause_internal (gpointer user_data);
 static gboolean gst_player_play_internal (gpointer user_data);
+static GstClockTime playback_start_position (GstPlayer * self, gdouble rate);
+static gboolean gst_player_preload_internal (gpointer user_data);
+static GstElement *playbin_ref (GstPlayer * self);
+static gboolean gst_player_set_uri_internal (gpointer user_data);
+static gchar *download_cache_lookup_locked (GstPlayer * self);
+static void media_info_cache_lookup (GstPlayer * self);
+static void media_info_cache_store (GstPlayer * self);
+static void download_finish (GstPlayer * self);
+static void download_temp_location_cb (GstObject * playbin,
+    GstObject * prop_object, GParamSpec * pspec, GstPlayer * self);
+static void standby_free (GstPlayerStandby * standby);
+#if GST_CHECK_VERSION(1,6,0)
+static void snapshot_reset_locked (GstPlayer * self);
+#endif
+static void video_frame_delivery_configure_locked (GstPlayer * self);
 static void change_state (GstPlayer * self, GstPlayerState state);
+static void emit_uri_loaded (GstPlayer * self, const gchar * uri);
+static gboolean reconfigure_tick_source_cb (gpointer user_data);
+static gboolean reconfigure_ready_timeout_source_cb (gpointer user_data);
+static GstClockTime position_snapshot_get (GstPlayer * self);
+static void position_snapshot_verify (GstPlayer * self, GstClockTime position);
 
 static GstPlayerMediaInfo *gst_player_media_info_create (GstPlayer * self);
 
@@ -184,12 +585,10 @@ static void gst_player_subtitle_info_update (GstPlayer * self,
     GstPlayerStreamInfo * stream_info);
 
 static void emit_media_info_updated_signal (GstPlayer * self);
-
-static void *get_title (GstTagList * tags);
-static void *get_container_format (GstTagList * tags);
-static void *get_from_tags (GstPlayer * self, GstPlayerMediaInfo * media_info,
-    void *(*func) (GstTagList *));
-static void *get_cover_sample (GstTagList * tags);
+static void media_info_publish (GstPlayer * self, GstPlayerMediaInfo * info);
+static void media_info_schedule_update_locked (GstPlayer * self);
+static gboolean media_info_update_cb (gpointer user_data);
+static void media_info_clear_pending_updates_locked (GstPlayer * self);
 
 static void
 gst_player_init (GstPlayer * self)
@@ -199,15 +598,107 @@ gst_player_init (GstPlayer * self)
   self = gst_player_get_instance_private (self);
 
   g_mutex_init (&self->lock);
+  g_mutex_init (&self->snapshot_lock);
   g_cond_init (&self->cond);
 
   self->seek_pending = FALSE;
   self->seek_position = GST_CLOCK_TIME_NONE;
   self->last_seek_time = GST_CLOCK_TIME_NONE;
+  self->seek_mode = DEFAULT_SEEK_MODE;
+  self->rate = DEFAULT_RATE;
+  self->seek_interval = DEFAULT_SEEK_INTERVAL;
+
+  self->startup_time = GST_CLOCK_TIME_NONE;
+  self->stall_start_time = GST_CLOCK_TIME_NONE;
+  self->stats.time_to_first_frame = GST_CLOCK_TIME_NONE;
+
+  self->degradation_steps = DEFAULT_DEGRADATION_STEPS;
+
+  self->buffering_time_left = GST_CLOCK_TIME_NONE;
+  self->buffer_size = DEFAULT_BUFFER_SIZE;
+  self->buffer_duration = DEFAULT_BUFFER_DURATION;
+  self->buffering_mode = DEFAULT_BUFFERING_MODE;
+  self->low_watermark = DEFAULT_LOW_WATERMARK;
+  self->high_watermark = DEFAULT_HIGH_WATERMARK;
+  self->buffering_early_resume = DEFAULT_BUFFERING_EARLY_RESUME;
+  self->download_cache_dir = DEFAULT_DOWNLOAD_CACHE_DIR;
+  self->download_cache_size = DEFAULT_DOWNLOAD_CACHE_SIZE;
+  self->video_frame_delivery = DEFAULT_VIDEO_FRAME_DELIVERY;
+  self->video_frame_queue_size = DEFAULT_VIDEO_FRAME_QUEUE_SIZE;
+  self->video_frame_pool_size = DEFAULT_VIDEO_FRAME_POOL_SIZE;
+  self->audio_level_interval = DEFAULT_AUDIO_LEVEL_INTERVAL;
+  self->audio_spectrum_bands = DEFAULT_AUDIO_SPECTRUM_BANDS;
+  self->audio_analysis = gst_player_audio_analysis_new ();
+  self->degradation_last_late = GST_CLOCK_TIME_NONE;
+  self->degradation_last_change = GST_CLOCK_TIME_NONE;
+
+  self->position_update_interval = DEFAULT_POSITION_UPDATE_INTERVAL;
+  self->position_update_flags = DEFAULT_POSITION_UPDATE_FLAGS;
+  self->visible = TRUE;
+  self->tick_interval = self->position_update_interval;
+  self->tick_flags = self->position_update_flags;
+  self->tick_visible = self->visible;
+
+  self->position = 0;
+  self->position_clock_time = GST_CLOCK_TIME_NONE;
+  self->position_duration = GST_CLOCK_TIME_NONE;
+  self->position_rate = 1.0;
+  self->verify_position = DEFAULT_VERIFY_POSITION;
+
+  self->media_info_update_interval = DEFAULT_MEDIA_INFO_UPDATE_INTERVAL;
+  self->max_preloaded = DEFAULT_MAX_PRELOADED;
+  self->idle_timeout = DEFAULT_IDLE_TIMEOUT;
+  self->idle_link.data = self;
+  g_weak_ref_init (&self->idle_ref, self);
+  self->preload_memory_limit = DEFAULT_PRELOAD_MEMORY_LIMIT;
+  g_queue_init (&self->standby);
+  g_queue_init (&self->preload_requests);
+  self->pending_streams =
+      g_array_new (FALSE, FALSE, sizeof (GstPlayerPendingStream));
+
+  event_queue_init (self);
+  g_queue_init (&self->commands);
+}
+
+static gboolean
+gst_player_setup_cb (gpointer user_data)
+{
+  GstPlayer *self = GST_PLAYER (user_data);
+
+  gst_player_setup (self);
+
+  g_mutex_lock (&self->lock);
+  self->initialized = TRUE;
+  g_cond_signal (&self->cond);
+  g_mutex_unlock (&self->lock);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+gst_player_constructed (GObject * object)
+{
+  GstPlayer *self = GST_PLAYER (object);
+
+  G_OBJECT_CLASS (parent_class)->constructed (object);
+
+  /* Run everything from one of the executor's threads if there is one,
+   * otherwise from our own thread */
+  if (self->executor)
+    self->context = gst_player_executor_acquire_context (self->executor);
+  else
+    self->context = g_main_context_new ();
+
+  self->command_source = command_source_new (self);
+  g_source_attach (self->command_source, self->context);
+
+  if (self->executor)
+    gst_player_invoke (self, gst_player_setup_cb);
+  else
+    self->thread = g_thread_new ("GstPlayer", gst_player_main, self);
 
   g_mutex_lock (&self->lock);
-  self->thread = g_thread_new ("GstPlayer", gst_player_main, self);
-  while (!self->loop || !g_main_loop_is_running (self->loop))
+  while (!self->initialized)
     g_cond_wait (&self->cond, &self->lock);
   g_mutex_unlock (&self->lock);
   GST_TRACE_OBJECT (self, "Initialized");
@@ -220,8 +711,13 @@ gst_player_class_init (GstPlayerClass * klass)
 
   gobject_class->set_property = gst_player_set_property;
   gobject_class->get_property = gst_player_get_property;
+  gobject_class->constructed = gst_player_constructed;
   gobject_class->finalize = gst_player_finalize;
 
+  audio_analysis_quark =
+      g_quark_from_static_string ("gst-player-audio-analysis");
+  standby_bus_quark = g_quark_from_static_string ("gst-player-standby-bus");
+
   param_specs[PROP_DISPATCH_TO_MAIN_CONTEXT] =
       g_param_spec_boolean ("dispatch-to-main-context",
       "Dispatch to main context", "Dispatch to the thread default main context",
@@ -276,6 +772,168 @@ gst_player_class_init (GstPlayerClass * klass)
       "GStreamer pipeline that is used",
       GST_TYPE_ELEMENT, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS);
 
+  param_specs[PROP_POSITION_UPDATE_INTERVAL] =
+      g_param_spec_uint ("position-update-interval", "Position update interval",
+      "Interval in milliseconds between position updates (0 = disabled)",
+      0, 10000, DEFAULT_POSITION_UPDATE_INTERVAL,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+  param_specs[PROP_POSITION_UPDATE_FLAGS] =
+      g_param_spec_flags ("position-update-flags", "Position update flags",
+      "Flags controlling how position updates are scheduled",
+      GST_TYPE_PLAYER_POSITION_UPDATE_FLAGS, DEFAULT_POSITION_UPDATE_FLAGS,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+  param_specs[PROP_VISIBLE] =
+      g_param_spec_boolean ("visible", "Visible",
+      "Whether the application currently shows the player to the user",
+      TRUE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+  param_specs[PROP_VERIFY_POSITION] =
+      g_param_spec_boolean ("verify-position", "Verify position",
+      "Compare the interpolated position against a position query on every "
+      "position read and log the drift (for debugging)",
+      DEFAULT_VERIFY_POSITION, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+  param_specs[PROP_EXECUTOR] =
+      g_param_spec_object ("executor", "Executor",
+      "Executor whose threads run the player instead of a dedicated thread",
+      GST_TYPE_PLAYER_EXECUTOR, G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY |
+      G_PARAM_STATIC_STRINGS);
+
+  param_specs[PROP_MEDIA_INFO_UPDATE_INTERVAL] =
+      g_param_spec_uint ("media-info-update-interval",
+      "Media info update interval",
+      "Time in milliseconds during which tag and caps changes are merged into "
+      "a single media info update (0 = once per main loop iteration)",
+      0, 10000, DEFAULT_MEDIA_INFO_UPDATE_INTERVAL,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+  param_specs[PROP_NEXT_URI] = g_param_spec_string ("next-uri", "Next URI",
+      "URI to continue with without gap when the current one finishes",
+      NULL, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+  param_specs[PROP_MAX_PRELOADED] =
+      g_param_spec_uint ("max-preloaded", "Max preloaded",
+      "Maximum number of pipelines prerolled in the background",
+      0, 16, DEFAULT_MAX_PRELOADED,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+  param_specs[PROP_PRELOAD_MEMORY_LIMIT] =
+      g_param_spec_uint64 ("preload-memory-limit", "Preload memory limit",
+      "Maximum number of bytes all preloaded pipelines together buffer "
+      "(0 = playbin default)", 0, G_MAXUINT64, DEFAULT_PRELOAD_MEMORY_LIMIT,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+  param_specs[PROP_IDLE_TIMEOUT] =
+      g_param_spec_int ("idle-timeout", "Idle timeout",
+      "Time in milliseconds after which a stopped pipeline releases all its "
+      "resources (-1 = never, 0 = immediately)", -1, G_MAXINT,
+      DEFAULT_IDLE_TIMEOUT, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+  param_specs[PROP_SEEK_MODE] =
+      g_param_spec_enum ("seek-mode", "Seek mode",
+      "Trade-off between accuracy and speed of seeks",
+      GST_TYPE_PLAYER_SEEK_MODE, DEFAULT_SEEK_MODE,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+  param_specs[PROP_RATE] =
+      g_param_spec_double ("rate", "Rate",
+      "Playback rate, negative for playing backwards", -64.0, 64.0,
+      DEFAULT_RATE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+  param_specs[PROP_DEGRADATION_STEPS] =
+      g_param_spec_flags ("degradation-steps", "Degradation steps",
+      "Steps taken one after another to reduce the decoding load while the "
+      "video sink cannot keep up", GST_TYPE_PLAYER_DEGRADATION_FLAGS,
+      DEFAULT_DEGRADATION_STEPS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+  param_specs[PROP_BUFFER_SIZE] =
+      g_param_spec_int ("buffer-size", "Buffer size",
+      "Maximum number of bytes buffered for network streams (-1 = default)",
+      -1, G_MAXINT, DEFAULT_BUFFER_SIZE,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+  param_specs[PROP_BUFFER_DURATION] =
+      g_param_spec_int64 ("buffer-duration", "Buffer duration",
+      "Maximum time in nanoseconds buffered for network streams "
+      "(-1 = default)", -1, G_MAXINT64, DEFAULT_BUFFER_DURATION,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+  param_specs[PROP_BUFFERING_MODE] =
+      g_param_spec_enum ("buffering-mode", "Buffering mode",
+      "Whether network streams are buffered in memory, downloaded or kept "
+      "in a ring buffer", GST_TYPE_BUFFERING_MODE, DEFAULT_BUFFERING_MODE,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+  param_specs[PROP_LOW_WATERMARK] =
+      g_param_spec_int ("low-watermark", "Low watermark",
+      "Buffer fill level in percent below which playback pauses", 0, 100,
+      DEFAULT_LOW_WATERMARK, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+  param_specs[PROP_HIGH_WATERMARK] =
+      g_param_spec_int ("high-watermark", "High watermark",
+      "Buffer fill level in percent from which paused playback resumes",
+      0, 100, DEFAULT_HIGH_WATERMARK,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+  param_specs[PROP_BUFFERING_EARLY_RESUME] =
+      g_param_spec_boolean ("buffering-early-resume", "Buffering early resume",
+      "Resume before the high watermark once the estimated time to finish "
+      "buffering is shorter than the buffered playback time",
+      DEFAULT_BUFFERING_EARLY_RESUME,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+  param_specs[PROP_DOWNLOAD_CACHE_DIR] =
+      g_param_spec_string ("download-cache-dir", "Download cache directory",
+      "Directory in which completely downloaded media is kept for playing "
+      "it again without network access (NULL = disabled)",
+      DEFAULT_DOWNLOAD_CACHE_DIR, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+  param_specs[PROP_DOWNLOAD_CACHE_SIZE] =
+      g_param_spec_uint64 ("download-cache-size", "Download cache size",
+      "Maximum number of bytes in the download cache directory", 0,
+      G_MAXUINT64, DEFAULT_DOWNLOAD_CACHE_SIZE,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+  param_specs[PROP_MEDIA_INFO_CACHE] =
+      g_param_spec_object ("media-info-cache", "Media info cache",
+      "Cache that provides the media information before preroll",
+      GST_TYPE_PLAYER_MEDIA_INFO_CACHE,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+  param_specs[PROP_VIDEO_FRAME_DELIVERY] =
+      g_param_spec_boolean ("video-frame-delivery", "Video frame delivery",
+      "Deliver decoded video frames to the application instead of showing "
+      "them, see gst_player_pull_video_frame()",
+      DEFAULT_VIDEO_FRAME_DELIVERY,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+  param_specs[PROP_VIDEO_FRAME_QUEUE_SIZE] =
+      g_param_spec_uint ("video-frame-queue-size", "Video frame queue size",
+      "Maximum number of frames waiting for the application, older frames "
+      "are dropped", 1, G_MAXUINT, DEFAULT_VIDEO_FRAME_QUEUE_SIZE,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+  param_specs[PROP_VIDEO_FRAME_POOL_SIZE] =
+      g_param_spec_uint ("video-frame-pool-size", "Video frame pool size",
+      "Number of buffers in the pool proposed to the decoder in frame "
+      "delivery mode (0 = decoder decides)", 0, G_MAXUINT,
+      DEFAULT_VIDEO_FRAME_POOL_SIZE,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+  param_specs[PROP_AUDIO_LEVEL_INTERVAL] =
+      g_param_spec_uint ("audio-level-interval", "Audio level interval",
+      "Interval in milliseconds between two audio-levels signals "
+      "(0 = disabled)", 0, G_MAXUINT, DEFAULT_AUDIO_LEVEL_INTERVAL,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+  param_specs[PROP_AUDIO_SPECTRUM_BANDS] =
+      g_param_spec_uint ("audio-spectrum-bands", "Audio spectrum bands",
+      "Number of spectrum bands in the audio-levels signal (0 = none)", 0,
+      GST_PLAYER_AUDIO_ANALYSIS_MAX_BANDS, DEFAULT_AUDIO_SPECTRUM_BANDS,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
   g_object_class_install_properties (gobject_class, PROP_LAST, param_specs);
 
   signals[SIGNAL_POSITION_UPDATED] =
@@ -317,6 +975,46 @@ gst_player_class_init (GstPlayerClass * klass)
       g_signal_new ("media-info-updated", G_TYPE_FROM_CLASS (klass),
       G_SIGNAL_RUN_LAST | G_SIGNAL_NO_RECURSE | G_SIGNAL_NO_HOOKS, 0, NULL,
       NULL, NULL, G_TYPE_NONE, 1, GST_TYPE_PLAYER_MEDIA_INFO);
+
+  signals[SIGNAL_URI_LOADED] =
+      g_signal_new ("uri-loaded", G_TYPE_FROM_CLASS (klass),
+      G_SIGNAL_RUN_LAST | G_SIGNAL_NO_RECURSE | G_SIGNAL_NO_HOOKS, 0, NULL,
+      NULL, NULL, G_TYPE_NONE, 1, G_TYPE_STRING);
+
+  signals[SIGNAL_ABOUT_TO_FINISH] =
+      g_signal_new ("about-to-finish", G_TYPE_FROM_CLASS (klass),
+      G_SIGNAL_RUN_LAST | G_SIGNAL_NO_RECURSE | G_SIGNAL_NO_HOOKS, 0, NULL,
+      NULL, NULL, G_TYPE_NONE, 0, G_TYPE_INVALID);
+
+  signals[SIGNAL_DEGRADATION_CHANGED] =
+      g_signal_new ("degradation-changed", G_TYPE_FROM_CLASS (klass),
+      G_SIGNAL_RUN_LAST | G_SIGNAL_NO_RECURSE | G_SIGNAL_NO_HOOKS, 0, NULL,
+      NULL, NULL, G_TYPE_NONE, 1, GST_TYPE_PLAYER_DEGRADATION_FLAGS);
+
+  signals[SIGNAL_BUFFERING_TIME_LEFT] =
+      g_signal_new ("buffering-time-left", G_TYPE_FROM_CLASS (klass),
+      G_SIGNAL_RUN_LAST | G_SIGNAL_NO_RECURSE | G_SIGNAL_NO_HOOKS, 0, NULL,
+      NULL, NULL, G_TYPE_NONE, 1, GST_TYPE_CLOCK_TIME);
+
+  signals[SIGNAL_VIDEO_FRAME_AVAILABLE] =
+      g_signal_new ("video-frame-available", G_TYPE_FROM_CLASS (klass),
+      G_SIGNAL_RUN_LAST | G_SIGNAL_NO_RECURSE | G_SIGNAL_NO_HOOKS, 0, NULL,
+      NULL, NULL, G_TYPE_NONE, 0, G_TYPE_INVALID);
+
+  /**
+   * GstPlayer::audio-levels:
+   * @player: #GstPlayer instance
+   * @levels: the levels of the last interval
+   *
+   * See gst_player_set_audio_level_interval(). Only native endian
+   * interleaved S16 and F32 audio is analyzed, for other formats no levels
+   * are emitted and a warning is logged.
+   */
+  signals[SIGNAL_AUDIO_LEVELS] =
+      g_signal_new ("audio-levels", G_TYPE_FROM_CLASS (klass),
+      G_SIGNAL_RUN_LAST | G_SIGNAL_NO_RECURSE | G_SIGNAL_NO_HOOKS, 0, NULL,
+      NULL, NULL, G_TYPE_NONE, 1,
+      GST_TYPE_STRUCTURE | G_SIGNAL_TYPE_STATIC_SCOPE);
 }
 
 static void
@@ -324,28 +1022,92 @@ gst_player_finalize (GObject * object)
 {
   GstPlayer *self = GST_PLAYER (object);
 
-  GST_TRACE_OBJECT (self, "Stopping main thread");
-  g_main_loop_quit (self->loop);
-  g_thread_join (self->thread);
+  if (self->executor) {
+    GST_TRACE_OBJECT (self, "Stopping on executor thread");
+
+    if (g_main_context_is_owner (self->context)) {
+      gst_player_teardown (self);
+    } else {
+      g_mutex_lock (&self->lock);
+      /* Pending commands must not run on a finalizing instance */
+      g_queue_clear (&self->commands);
+      g_queue_push_tail (&self->commands, (gpointer) gst_player_teardown_cb);
+      g_source_set_ready_time (self->command_source, 0);
+      while (self->initialized)
+        g_cond_wait (&self->cond, &self->lock);
+      g_mutex_unlock (&self->lock);
+    }
+
+    gst_player_executor_release_context (self->executor, self->context);
+    self->context = NULL;
+    g_object_unref (self->executor);
+  } else {
+    GST_TRACE_OBJECT (self, "Stopping main thread");
+    g_main_loop_quit (self->loop);
+    g_thread_join (self->thread);
+  }
 
   GST_TRACE_OBJECT (self, "Finalizing");
 
+  if (self->event_source) {
+    g_source_destroy (self->event_source);
+    g_source_unref (self->event_source);
+  }
+  event_queue_flush (self);
+
+  g_weak_ref_clear (&self->idle_ref);
+
   g_free (self->uri);
+  g_free (self->next_uri);
+  g_free (self->switching_uri);
+  g_free (self->uri_validator);
+  g_free (self->download_cache_dir);
+  g_free (self->download_key);
+  if (self->media_info_cache)
+    g_object_unref (self->media_info_cache);
   if (self->global_tags)
     gst_tag_list_unref (self->global_tags);
+  if (self->pending_global_tags)
+    gst_tag_list_unref (self->pending_global_tags);
+  g_array_free (self->pending_streams, TRUE);
+  if (self->video_frame_sink)
+    gst_object_unref (self->video_frame_sink);
+  gst_player_audio_analysis_free (self->audio_analysis);
   if (self->application_context)
     g_main_context_unref (self->application_context);
 
+#if GST_CHECK_VERSION(1,6,0)
+  snapshot_reset_locked (self);
+#endif
+  g_mutex_clear (&self->events_overflow_lock);
+  g_mutex_clear (&self->snapshot_lock);
   g_mutex_clear (&self->lock);
   g_cond_clear (&self->cond);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
+static void
+gst_player_set_uri_full (GstPlayer * self, const gchar * uri,
+    const gchar * validator)
+{
+  g_mutex_lock (&self->lock);
+  g_free (self->uri);
+  self->uri = g_strdup (uri);
+  g_free (self->uri_validator);
+  self->uri_validator = g_strdup (validator);
+  GST_DEBUG_OBJECT (self, "Set uri=%s validator=%s", self->uri,
+      GST_STR_NULL (self->uri_validator));
+  g_mutex_unlock (&self->lock);
+
+  gst_player_invoke (self, gst_player_set_uri_internal);
+}
+
 static gboolean
 gst_player_set_uri_internal (gpointer user_data)
 {
   GstPlayer *self = user_data;
+  gchar *uri, *cached_uri;
 
   gst_player_stop_internal (self);
 
@@ -353,10 +1115,20 @@ gst_player_set_uri_internal (gpointer user_data)
 
   GST_DEBUG_OBJECT (self, "Changing URI to '%s'", GST_STR_NULL (self->uri));
 
-  g_object_set (self->playbin, "uri", self->uri, NULL);
+  cached_uri = download_cache_lookup_locked (self);
+  g_object_set (self->playbin, "uri", cached_uri ? cached_uri : self->uri,
+      NULL);
+  g_free (cached_uri);
+  uri = g_strdup (self->uri);
+  self->bytes_downloaded = 0;
 
   g_mutex_unlock (&self->lock);
 
+  emit_uri_loaded (self, uri);
+  g_free (uri);
+
+  media_info_cache_lookup (self);
+
   return G_SOURCE_REMOVE;
 }
 
@@ -365,38 +1137,217 @@ gst_player_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec)
 {
   GstPlayer *self = GST_PLAYER (object);
+  GstElement *playbin;
 
   switch (prop_id) {
     case PROP_DISPATCH_TO_MAIN_CONTEXT:
       self->dispatch_to_main_context = g_value_get_boolean (value);
-      self->application_context = g_main_context_ref_thread_default ();
+      if (self->dispatch_to_main_context && !self->event_source) {
+        self->application_context = g_main_context_ref_thread_default ();
+        self->event_source = event_source_new (self);
+        g_source_attach (self->event_source, self->application_context);
+      }
       break;
-    case PROP_URI:{
-      g_mutex_lock (&self->lock);
-      if (self->uri)
-        g_free (self->uri);
-
-      self->uri = g_value_dup_string (value);
-      GST_DEBUG_OBJECT (self, "Set uri=%s", self->uri);
-      g_mutex_unlock (&self->lock);
-
-      g_main_context_invoke (self->context, gst_player_set_uri_internal, self);
+    case PROP_URI:
+      gst_player_set_uri_full (self, g_value_get_string (value), NULL);
       break;
-    }
     case PROP_VOLUME:
       GST_DEBUG_OBJECT (self, "Set volume=%lf", g_value_get_double (value));
-      g_object_set_property (G_OBJECT (self->playbin), "volume", value);
+      playbin = playbin_ref (self);
+      g_object_set_property (G_OBJECT (playbin), "volume", value);
+      gst_object_unref (playbin);
       break;
     case PROP_MUTE:
       GST_DEBUG_OBJECT (self, "Set mute=%d", g_value_get_boolean (value));
-      g_object_set_property (G_OBJECT (self->playbin), "mute", value);
+      playbin = playbin_ref (self);
+      g_object_set_property (G_OBJECT (playbin), "mute", value);
+      gst_object_unref (playbin);
       break;
     case PROP_WINDOW_HANDLE:
       GST_DEBUG_OBJECT (self, "Set window handle from %p to %p",
           (gpointer) self->window_handle, g_value_get_pointer (value));
       self->window_handle = (guintptr) g_value_get_pointer (value);
-      gst_video_overlay_set_window_handle (GST_VIDEO_OVERLAY (self->playbin),
+      playbin = playbin_ref (self);
+      gst_video_overlay_set_window_handle (GST_VIDEO_OVERLAY (playbin),
           self->window_handle);
+      gst_object_unref (playbin);
+      break;
+    case PROP_POSITION_UPDATE_INTERVAL:
+      g_mutex_lock (&self->lock);
+      self->position_update_interval = g_value_get_uint (value);
+      GST_DEBUG_OBJECT (self, "Set position-update-interval=%u",
+          self->position_update_interval);
+      g_mutex_unlock (&self->lock);
+      gst_player_invoke (self, reconfigure_tick_source_cb);
+      break;
+    case PROP_POSITION_UPDATE_FLAGS:
+      g_mutex_lock (&self->lock);
+      self->position_update_flags = g_value_get_flags (value);
+      GST_DEBUG_OBJECT (self, "Set position-update-flags=0x%x",
+          self->position_update_flags);
+      g_mutex_unlock (&self->lock);
+      gst_player_invoke (self, reconfigure_tick_source_cb);
+      break;
+    case PROP_VISIBLE:
+      g_mutex_lock (&self->lock);
+      self->visible = g_value_get_boolean (value);
+      GST_DEBUG_OBJECT (self, "Set visible=%d", self->visible);
+      g_mutex_unlock (&self->lock);
+      gst_player_invoke (self, reconfigure_tick_source_cb);
+      break;
+    case PROP_VERIFY_POSITION:
+      self->verify_position = g_value_get_boolean (value);
+      break;
+    case PROP_EXECUTOR:
+      self->executor = g_value_dup_object (value);
+      break;
+    case PROP_MEDIA_INFO_UPDATE_INTERVAL:
+      g_mutex_lock (&self->lock);
+      self->media_info_update_interval = g_value_get_uint (value);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_MAX_PRELOADED:
+      g_mutex_lock (&self->lock);
+      self->max_preloaded = g_value_get_uint (value);
+      g_mutex_unlock (&self->lock);
+      gst_player_invoke (self, gst_player_preload_internal);
+      break;
+    case PROP_PRELOAD_MEMORY_LIMIT:
+      g_mutex_lock (&self->lock);
+      self->preload_memory_limit = g_value_get_uint64 (value);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_IDLE_TIMEOUT:
+      g_atomic_int_set (&self->idle_timeout, g_value_get_int (value));
+      GST_DEBUG_OBJECT (self, "Set idle-timeout=%d", self->idle_timeout);
+      gst_player_invoke (self, reconfigure_ready_timeout_source_cb);
+      break;
+    case PROP_SEEK_MODE:
+      g_mutex_lock (&self->lock);
+      self->seek_mode = g_value_get_enum (value);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_RATE:
+      /* The pspec allows the whole range, a rate of 0 is no playback */
+      if (g_value_get_double (value) == 0.0) {
+        GST_WARNING_OBJECT (self, "Ignoring rate 0");
+        break;
+      }
+      g_mutex_lock (&self->lock);
+      gst_player_set_rate_internal_locked (self, g_value_get_double (value));
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_DEGRADATION_STEPS:
+      g_atomic_int_set (&self->degradation_steps, g_value_get_flags (value));
+      gst_player_invoke (self, degradation_reconfigure_cb);
+      break;
+    case PROP_BUFFER_SIZE:
+      g_mutex_lock (&self->lock);
+      self->buffer_size = g_value_get_int (value);
+      playbin_set_buffering_locked (self, self->playbin);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_BUFFER_DURATION:
+      g_mutex_lock (&self->lock);
+      self->buffer_duration = g_value_get_int64 (value);
+      playbin_set_buffering_locked (self, self->playbin);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_BUFFERING_MODE:{
+      GstBufferingMode mode = g_value_get_enum (value);
+
+      g_mutex_lock (&self->lock);
+      self->buffering_mode = mode;
+      playbin_set_buffering_locked (self, self->playbin);
+      g_mutex_unlock (&self->lock);
+      if (mode == GST_BUFFERING_DOWNLOAD || mode == GST_BUFFERING_TIMESHIFT)
+        player_set_flag (self, GST_PLAY_FLAG_DOWNLOAD);
+      else
+        player_clear_flag (self, GST_PLAY_FLAG_DOWNLOAD);
+      break;
+    }
+    case PROP_LOW_WATERMARK:
+      g_mutex_lock (&self->lock);
+      self->low_watermark = g_value_get_int (value);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_HIGH_WATERMARK:
+      g_mutex_lock (&self->lock);
+      self->high_watermark = g_value_get_int (value);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_BUFFERING_EARLY_RESUME:
+      g_mutex_lock (&self->lock);
+      self->buffering_early_resume = g_value_get_boolean (value);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_DOWNLOAD_CACHE_DIR:
+      g_mutex_lock (&self->lock);
+      g_free (self->download_cache_dir);
+      self->download_cache_dir = g_value_dup_string (value);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_DOWNLOAD_CACHE_SIZE:
+      g_mutex_lock (&self->lock);
+      self->download_cache_size = g_value_get_uint64 (value);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_MEDIA_INFO_CACHE:
+      g_mutex_lock (&self->lock);
+      if (self->media_info_cache)
+        g_object_unref (self->media_info_cache);
+      self->media_info_cache = g_value_dup_object (value);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_VIDEO_FRAME_DELIVERY:
+      g_mutex_lock (&self->lock);
+      self->video_frame_delivery = g_value_get_boolean (value);
+      GST_DEBUG_OBJECT (self, "Set video-frame-delivery=%d",
+          self->video_frame_delivery);
+      video_frame_delivery_configure_locked (self);
+      if (self->playbin)
+        g_object_set (self->playbin, "video-sink",
+            self->video_frame_delivery ? self->video_frame_sink : NULL, NULL);
+      g_mutex_unlock (&self->lock);
+      /* Drops the preloaded pipelines, they render on their own */
+      gst_player_invoke (self, gst_player_preload_internal);
+      break;
+    case PROP_VIDEO_FRAME_QUEUE_SIZE:
+      g_mutex_lock (&self->lock);
+      self->video_frame_queue_size = g_value_get_uint (value);
+      video_frame_delivery_configure_locked (self);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_VIDEO_FRAME_POOL_SIZE:
+      g_mutex_lock (&self->lock);
+      self->video_frame_pool_size = g_value_get_uint (value);
+      video_frame_delivery_configure_locked (self);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_AUDIO_LEVEL_INTERVAL:
+      g_mutex_lock (&self->lock);
+      self->audio_level_interval = g_value_get_uint (value);
+      GST_DEBUG_OBJECT (self, "Set audio-level-interval=%u",
+          self->audio_level_interval);
+      gst_player_audio_analysis_configure (self->audio_analysis,
+          self->audio_level_interval * GST_MSECOND,
+          self->audio_spectrum_bands);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_AUDIO_SPECTRUM_BANDS:
+      g_mutex_lock (&self->lock);
+      self->audio_spectrum_bands = g_value_get_uint (value);
+      gst_player_audio_analysis_configure (self->audio_analysis,
+          self->audio_level_interval * GST_MSECOND,
+          self->audio_spectrum_bands);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_NEXT_URI:
+      g_mutex_lock (&self->lock);
+      g_free (self->next_uri);
+      self->next_uri = g_value_dup_string (value);
+      GST_DEBUG_OBJECT (self, "Set next uri=%s", self->next_uri);
+      g_mutex_unlock (&self->lock);
       break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
@@ -409,6 +1360,7 @@ gst_player_get_property (GObject * object, guint prop_id,
     GValue * value, GParamSpec * pspec)
 {
   GstPlayer *self = GST_PLAYER (object);
+  GstElement *playbin;
 
   switch (prop_id) {
     case PROP_URI:
@@ -420,9 +1372,11 @@ gst_player_get_property (GObject * object, guint prop_id,
           g_value_get_boolean (value));
       break;
     case PROP_POSITION:{
-      gint64 position;
+      GstClockTime position = position_snapshot_get (self);
+
+      if (self->verify_position)
+        position_snapshot_verify (self, position);
 
-      gst_element_query_position (self->playbin, GST_FORMAT_TIME, &position);
       g_value_set_uint64 (value, position);
       GST_TRACE_OBJECT (self, "Returning position=%" GST_TIME_FORMAT,
           GST_TIME_ARGS (g_value_get_uint64 (value)));
@@ -431,7 +1385,9 @@ gst_player_get_property (GObject * object, guint prop_id,
     case PROP_DURATION:{
       gint64 duration;
 
-      gst_element_query_duration (self->playbin, GST_FORMAT_TIME, &duration);
+      playbin = playbin_ref (self);
+      gst_element_query_duration (playbin, GST_FORMAT_TIME, &duration);
+      gst_object_unref (playbin);
       g_value_set_uint64 (value, duration);
       GST_TRACE_OBJECT (self, "Returning duration=%" GST_TIME_FORMAT,
           GST_TIME_ARGS (g_value_get_uint64 (value)));
@@ -465,12 +1421,16 @@ gst_player_get_property (GObject * object, guint prop_id,
       break;
     }
     case PROP_VOLUME:
-      g_object_get_property (G_OBJECT (self->playbin), "volume", value);
+      playbin = playbin_ref (self);
+      g_object_get_property (G_OBJECT (playbin), "volume", value);
+      gst_object_unref (playbin);
       GST_TRACE_OBJECT (self, "Returning volume=%lf",
           g_value_get_double (value));
       break;
     case PROP_MUTE:
-      g_object_get_property (G_OBJECT (self->playbin), "mute", value);
+      playbin = playbin_ref (self);
+      g_object_get_property (G_OBJECT (playbin), "mute", value);
+      gst_object_unref (playbin);
       GST_TRACE_OBJECT (self, "Returning mute=%d", g_value_get_boolean (value));
       break;
     case PROP_WINDOW_HANDLE:
@@ -479,12 +1439,141 @@ gst_player_get_property (GObject * object, guint prop_id,
           g_value_get_pointer (value));
       break;
     case PROP_PIPELINE:
+      g_mutex_lock (&self->lock);
       g_value_set_object (value, self->playbin);
+      g_mutex_unlock (&self->lock);
       break;
-    default:
-      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    case PROP_POSITION_UPDATE_INTERVAL:
+      g_mutex_lock (&self->lock);
+      g_value_set_uint (value, self->position_update_interval);
+      g_mutex_unlock (&self->lock);
       break;
-  }
+    case PROP_POSITION_UPDATE_FLAGS:
+      g_mutex_lock (&self->lock);
+      g_value_set_flags (value, self->position_update_flags);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_VISIBLE:
+      g_mutex_lock (&self->lock);
+      g_value_set_boolean (value, self->visible);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_VERIFY_POSITION:
+      g_value_set_boolean (value, self->verify_position);
+      break;
+    case PROP_EXECUTOR:
+      g_value_set_object (value, self->executor);
+      break;
+    case PROP_MEDIA_INFO_UPDATE_INTERVAL:
+      g_mutex_lock (&self->lock);
+      g_value_set_uint (value, self->media_info_update_interval);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_NEXT_URI:
+      g_mutex_lock (&self->lock);
+      g_value_set_string (value, self->next_uri);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_MAX_PRELOADED:
+      g_mutex_lock (&self->lock);
+      g_value_set_uint (value, self->max_preloaded);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_PRELOAD_MEMORY_LIMIT:
+      g_mutex_lock (&self->lock);
+      g_value_set_uint64 (value, self->preload_memory_limit);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_IDLE_TIMEOUT:
+      g_value_set_int (value, g_atomic_int_get (&self->idle_timeout));
+      break;
+    case PROP_SEEK_MODE:
+      g_mutex_lock (&self->lock);
+      g_value_set_enum (value, self->seek_mode);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_RATE:
+      g_mutex_lock (&self->lock);
+      g_value_set_double (value, self->rate);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_DEGRADATION_STEPS:
+      g_value_set_flags (value, g_atomic_int_get (&self->degradation_steps));
+      break;
+    case PROP_BUFFER_SIZE:
+      g_mutex_lock (&self->lock);
+      g_value_set_int (value, self->buffer_size);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_BUFFER_DURATION:
+      g_mutex_lock (&self->lock);
+      g_value_set_int64 (value, self->buffer_duration);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_BUFFERING_MODE:
+      g_mutex_lock (&self->lock);
+      g_value_set_enum (value, self->buffering_mode);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_LOW_WATERMARK:
+      g_mutex_lock (&self->lock);
+      g_value_set_int (value, self->low_watermark);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_HIGH_WATERMARK:
+      g_mutex_lock (&self->lock);
+      g_value_set_int (value, self->high_watermark);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_BUFFERING_EARLY_RESUME:
+      g_mutex_lock (&self->lock);
+      g_value_set_boolean (value, self->buffering_early_resume);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_DOWNLOAD_CACHE_DIR:
+      g_mutex_lock (&self->lock);
+      g_value_set_string (value, self->download_cache_dir);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_DOWNLOAD_CACHE_SIZE:
+      g_mutex_lock (&self->lock);
+      g_value_set_uint64 (value, self->download_cache_size);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_MEDIA_INFO_CACHE:
+      g_mutex_lock (&self->lock);
+      g_value_set_object (value, self->media_info_cache);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_VIDEO_FRAME_DELIVERY:
+      g_mutex_lock (&self->lock);
+      g_value_set_boolean (value, self->video_frame_delivery);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_VIDEO_FRAME_QUEUE_SIZE:
+      g_mutex_lock (&self->lock);
+      g_value_set_uint (value, self->video_frame_queue_size);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_VIDEO_FRAME_POOL_SIZE:
+      g_mutex_lock (&self->lock);
+      g_value_set_uint (value, self->video_frame_pool_size);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_AUDIO_LEVEL_INTERVAL:
+      g_mutex_lock (&self->lock);
+      g_value_set_uint (value, self->audio_level_interval);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_AUDIO_SPECTRUM_BANDS:
+      g_mutex_lock (&self->lock);
+      g_value_set_uint (value, self->audio_spectrum_bands);
+      g_mutex_unlock (&self->lock);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
 }
 
 static gboolean
@@ -495,6 +1584,7 @@ main_loop_running_cb (gpointer user_data)
   GST_TRACE_OBJECT (self, "Main loop running now");
 
   g_mutex_lock (&self->lock);
+  self->initialized = TRUE;
   g_cond_signal (&self->cond);
   g_mutex_unlock (&self->lock);
 
@@ -503,2100 +1593,5953 @@ main_loop_running_cb (gpointer user_data)
 
 typedef struct
 {
+  GSource source;
   GstPlayer *player;
-  GstPlayerState state;
-} StateChangedSignalData;
+} GstPlayerEventSource;
 
+/* Functions invoked from other threads are queued and run in order from a
+ * single source on the player's main context. Unlike with
+ * g_main_context_invoke() nothing is left behind in the context when the
+ * player goes away, which matters if the context is shared with other
+ * players through a #GstPlayerExecutor */
 static gboolean
-state_changed_dispatch (gpointer user_data)
+command_source_dispatch (GSource * source, GSourceFunc callback,
+    gpointer user_data)
 {
-  StateChangedSignalData *data = user_data;
+  GstPlayer *self = ((GstPlayerEventSource *) source)->player;
+  GSourceFunc func;
 
-  g_signal_emit (data->player, signals[SIGNAL_STATE_CHANGED], 0, data->state);
+  g_source_set_ready_time (source, -1);
 
-  return G_SOURCE_REMOVE;
+  /* The player might be gone after running a command if the source was
+   * destroyed by it */
+  while (!g_source_is_destroyed (source)) {
+    g_mutex_lock (&self->lock);
+    func = (GSourceFunc) g_queue_pop_head (&self->commands);
+    g_mutex_unlock (&self->lock);
+
+    if (!func)
+      break;
+
+    func (self);
+  }
+
+  return G_SOURCE_CONTINUE;
+}
+
+static GSourceFuncs command_source_funcs = {
+  NULL,
+  NULL,
+  command_source_dispatch,
+  NULL
+};
+
+static GSource *
+command_source_new (GstPlayer * self)
+{
+  GSource *source;
+
+  source = g_source_new (&command_source_funcs, sizeof (GstPlayerEventSource));
+  ((GstPlayerEventSource *) source)->player = self;
+
+  return source;
 }
 
 static void
-change_state (GstPlayer * self, GstPlayerState state)
+gst_player_invoke (GstPlayer * self, GSourceFunc func)
 {
-  if (state == self->app_state)
+  if (g_main_context_is_owner (self->context)) {
+    func (self);
     return;
+  }
 
-  GST_DEBUG_OBJECT (self, "Changing app state from %s to %s",
-      gst_player_state_get_name (self->app_state),
-      gst_player_state_get_name (state));
-  self->app_state = state;
+  g_mutex_lock (&self->lock);
+  g_queue_push_tail (&self->commands, (gpointer) func);
+  g_mutex_unlock (&self->lock);
 
-  if (self->dispatch_to_main_context
-      && g_signal_handler_find (self, G_SIGNAL_MATCH_ID,
-          signals[SIGNAL_STATE_CHANGED], 0, NULL, NULL, NULL) != 0) {
-    StateChangedSignalData *data = g_new (StateChangedSignalData, 1);
+  g_source_set_ready_time (self->command_source, 0);
+}
 
-    data->player = self;
-    data->state = state;
-    g_main_context_invoke_full (self->application_context,
-        G_PRIORITY_DEFAULT, state_changed_dispatch, data,
-        (GDestroyNotify) g_free);
-  } else {
-    g_signal_emit (self, signals[SIGNAL_STATE_CHANGED], 0, state);
-  }
+static gboolean
+event_is_coalesced (guint signal)
+{
+  return signal == SIGNAL_POSITION_UPDATED || signal == SIGNAL_BUFFERING
+      || signal == SIGNAL_BUFFERING_TIME_LEFT
+      || signal == SIGNAL_VIDEO_DIMENSIONS_CHANGED
+      || signal == SIGNAL_VIDEO_FRAME_AVAILABLE
+      || signal == SIGNAL_AUDIO_LEVELS;
 }
 
-typedef struct
+static void
+event_queue_init (GstPlayer * self)
 {
-  GstPlayer *player;
-  GstClockTime position;
-} PositionUpdatedSignalData;
+  gint i;
+
+  for (i = 0; i < EVENT_QUEUE_SIZE; i++)
+    self->events[i].seq = i;
+  self->events_enqueue_pos = 0;
+  self->events_dequeue_pos = 0;
+  g_mutex_init (&self->events_overflow_lock);
+  g_queue_init (&self->events_overflow);
+}
 
 static gboolean
-position_updated_dispatch (gpointer user_data)
+event_queue_push (GstPlayer * self, guint signal,
+    const GstPlayerEventData * data, gint * queued_pos)
 {
-  PositionUpdatedSignalData *data = user_data;
+  GstPlayerEventCell *cell;
+  gint pos, seq;
+
+  pos = g_atomic_int_get (&self->events_enqueue_pos);
+  for (;;) {
+    cell = &self->events[pos & (EVENT_QUEUE_SIZE - 1)];
+    seq = g_atomic_int_get (&cell->seq);
+
+    if (seq == pos) {
+      if (g_atomic_int_compare_and_exchange (&self->events_enqueue_pos, pos,
+              pos + 1))
+        break;
+    } else if (seq - pos < 0) {
+      /* Queue is full */
+      return FALSE;
+    }
 
-  g_signal_emit (data->player, signals[SIGNAL_POSITION_UPDATED], 0,
-      data->position);
-  g_object_notify_by_pspec (G_OBJECT (data->player),
-      param_specs[PROP_POSITION]);
+    pos = g_atomic_int_get (&self->events_enqueue_pos);
+  }
 
-  return G_SOURCE_REMOVE;
+  cell->signal = signal;
+  if (data)
+    cell->data = *data;
+  g_atomic_int_set (&cell->seq, pos + 1);
+
+  if (queued_pos)
+    *queued_pos = pos;
+
+  return TRUE;
+}
+
+static void
+event_overflow_push (GstPlayer * self, guint signal,
+    const GstPlayerEventData * data)
+{
+  GstPlayerEventOverflow *event;
+
+  event = g_slice_new0 (GstPlayerEventOverflow);
+  event->signal = signal;
+  if (data)
+    event->data = *data;
+
+  g_mutex_lock (&self->events_overflow_lock);
+  g_queue_push_tail (&self->events_overflow, event);
+  g_atomic_int_inc (&self->events_n_overflow);
+  g_mutex_unlock (&self->events_overflow_lock);
+
+  g_atomic_int_inc (&self->events_overflowed);
+  GST_DEBUG_OBJECT (self, "Event queue full, deferring %s event",
+      g_signal_name (signals[signal]));
 }
 
 static gboolean
-tick_cb (gpointer user_data)
+event_overflow_pop (GstPlayer * self, guint * signal,
+    GstPlayerEventData * data)
 {
-  GstPlayer *self = GST_PLAYER (user_data);
-  gint64 position;
+  GstPlayerEventOverflow *event;
+
+  if (g_atomic_int_get (&self->events_n_overflow) == 0)
+    return FALSE;
 
-  if (gst_element_query_position (self->playbin, GST_FORMAT_TIME, &position)) {
-    GST_LOG_OBJECT (self, "Position %" GST_TIME_FORMAT,
-        GST_TIME_ARGS (position));
+  g_mutex_lock (&self->events_overflow_lock);
+  event = g_queue_pop_head (&self->events_overflow);
+  if (event)
+    g_atomic_int_add (&self->events_n_overflow, -1);
+  g_mutex_unlock (&self->events_overflow_lock);
 
-    if (self->dispatch_to_main_context
-        && g_signal_handler_find (self, G_SIGNAL_MATCH_ID,
-            signals[SIGNAL_POSITION_UPDATED], 0, NULL, NULL, NULL) != 0) {
-      PositionUpdatedSignalData *data = g_new (PositionUpdatedSignalData, 1);
+  if (!event)
+    return FALSE;
 
-      data->player = self;
-      data->position = position;
-      g_main_context_invoke_full (self->application_context,
-          G_PRIORITY_DEFAULT, position_updated_dispatch, data,
-          (GDestroyNotify) g_free);
-    } else {
-      g_signal_emit (self, signals[SIGNAL_POSITION_UPDATED], 0, position);
-      g_object_notify_by_pspec (G_OBJECT (self), param_specs[PROP_POSITION]);
+  *signal = event->signal;
+  *data = event->data;
+  g_slice_free (GstPlayerEventOverflow, event);
+
+  return TRUE;
+}
+
+/* Events in the ring were always posted before the ones in the overflow
+ * list, or concurrently with them */
+static gboolean
+event_queue_pop (GstPlayer * self, guint * signal, GstPlayerEventData * data)
+{
+  GstPlayerEventCell *cell;
+  gint pos, seq;
+
+  /* Only ever called from the application context, so there is a single
+   * consumer and we don't need to compare-and-exchange the position */
+  pos = self->events_dequeue_pos;
+  cell = &self->events[pos & (EVENT_QUEUE_SIZE - 1)];
+  seq = g_atomic_int_get (&cell->seq);
+
+  if (seq != pos + 1)
+    return event_overflow_pop (self, signal, data);
+
+  *signal = cell->signal;
+  self->events_dequeue_pos = pos + 1;
+
+  if (event_is_coalesced (cell->signal)) {
+    GstPlayerEventSlot *slot = &self->event_slots[cell->signal];
+
+    /* Producers might still replace the value until we marked the
+     * cell as consumed */
+    g_bit_lock (&slot->lock, 0);
+    *data = cell->data;
+    g_atomic_int_set (&cell->seq, pos + EVENT_QUEUE_SIZE);
+    g_bit_unlock (&slot->lock, 0);
+  } else {
+    *data = cell->data;
+    g_atomic_int_set (&cell->seq, pos + EVENT_QUEUE_SIZE);
+  }
+
+  return TRUE;
+}
+
+/* Replaces the value of the last queued event of this kind if it was not
+ * dispatched yet and no other event was queued after it, which is the case
+ * while its cell is the last claimed one of the ring and nothing
+ * overflowed. On success @data holds the replaced value */
+static gboolean
+event_slot_coalesce (GstPlayer * self, guint signal, GstPlayerEventData * data)
+{
+  GstPlayerEventData replaced;
+  GstPlayerEventSlot *slot = &self->event_slots[signal];
+  GstPlayerEventCell *cell;
+  gboolean ret = FALSE;
+
+  g_bit_lock (&slot->lock, 0);
+  if (slot->queued && g_atomic_int_get (&self->events_n_overflow) == 0
+      && g_atomic_int_get (&self->events_enqueue_pos) == slot->pos + 1) {
+    cell = &self->events[slot->pos & (EVENT_QUEUE_SIZE - 1)];
+
+    if (g_atomic_int_get (&cell->seq) == slot->pos + 1) {
+      replaced = cell->data;
+      cell->data = *data;
+      *data = replaced;
+      ret = TRUE;
     }
   }
+  g_bit_unlock (&slot->lock, 0);
 
-  return G_SOURCE_CONTINUE;
+  return ret;
 }
 
 static void
-add_tick_source (GstPlayer * self)
+event_slot_set_queued (GstPlayer * self, guint signal, gint pos)
 {
-  if (self->tick_source)
-    return;
+  GstPlayerEventSlot *slot = &self->event_slots[signal];
 
-  self->tick_source = g_timeout_source_new (100);
-  g_source_set_callback (self->tick_source, (GSourceFunc) tick_cb, self, NULL);
-  g_source_attach (self->tick_source, self->context);
+  g_bit_lock (&slot->lock, 0);
+  slot->queued = TRUE;
+  slot->pos = pos;
+  g_bit_unlock (&slot->lock, 0);
 }
 
 static void
-remove_tick_source (GstPlayer * self)
+event_data_clear (guint signal, GstPlayerEventData * data)
 {
-  if (!self->tick_source)
-    return;
+  if (signal == SIGNAL_ERROR)
+    g_clear_error (&data->err);
+  else if (signal == SIGNAL_MEDIA_INFO_UPDATED && data->info)
+    g_object_unref (data->info);
+  else if (signal == SIGNAL_URI_LOADED)
+    g_free (data->uri);
+  else if (signal == SIGNAL_AUDIO_LEVELS && data->levels)
+    gst_structure_free (data->levels);
+}
 
-  g_source_destroy (self->tick_source);
-  g_source_unref (self->tick_source);
-  self->tick_source = NULL;
+static void
+event_emit (GstPlayer * self, guint signal, GstPlayerEventData * data)
+{
+  switch (signal) {
+    case SIGNAL_STATE_CHANGED:
+      g_signal_emit (self, signals[SIGNAL_STATE_CHANGED], 0, data->state);
+      break;
+    case SIGNAL_POSITION_UPDATED:
+      g_signal_emit (self, signals[SIGNAL_POSITION_UPDATED], 0, data->time);
+      g_object_notify_by_pspec (G_OBJECT (self), param_specs[PROP_POSITION]);
+      break;
+    case SIGNAL_DURATION_CHANGED:
+      g_signal_emit (self, signals[SIGNAL_DURATION_CHANGED], 0, data->time);
+      g_object_notify_by_pspec (G_OBJECT (self), param_specs[PROP_DURATION]);
+      break;
+    case SIGNAL_BUFFERING:
+      g_signal_emit (self, signals[SIGNAL_BUFFERING], 0, data->percent);
+      break;
+    case SIGNAL_END_OF_STREAM:
+      g_signal_emit (self, signals[SIGNAL_END_OF_STREAM], 0);
+      break;
+    case SIGNAL_ERROR:
+      g_signal_emit (self, signals[SIGNAL_ERROR], 0, data->err);
+      break;
+    case SIGNAL_VIDEO_DIMENSIONS_CHANGED:
+      g_signal_emit (self, signals[SIGNAL_VIDEO_DIMENSIONS_CHANGED], 0,
+          data->dimensions.width, data->dimensions.height);
+      break;
+    case SIGNAL_MEDIA_INFO_UPDATED:
+      g_signal_emit (self, signals[SIGNAL_MEDIA_INFO_UPDATED], 0, data->info);
+      break;
+    case SIGNAL_URI_LOADED:
+      g_signal_emit (self, signals[SIGNAL_URI_LOADED], 0, data->uri);
+      break;
+    case SIGNAL_ABOUT_TO_FINISH:
+      g_signal_emit (self, signals[SIGNAL_ABOUT_TO_FINISH], 0);
+      break;
+    case SIGNAL_DEGRADATION_CHANGED:
+      g_signal_emit (self, signals[SIGNAL_DEGRADATION_CHANGED], 0,
+          data->degradation);
+      break;
+    case SIGNAL_BUFFERING_TIME_LEFT:
+      g_signal_emit (self, signals[SIGNAL_BUFFERING_TIME_LEFT], 0,
+          data->time);
+      break;
+    case SIGNAL_VIDEO_FRAME_AVAILABLE:
+      g_signal_emit (self, signals[SIGNAL_VIDEO_FRAME_AVAILABLE], 0);
+      break;
+    case SIGNAL_AUDIO_LEVELS:
+      g_signal_emit (self, signals[SIGNAL_AUDIO_LEVELS], 0, data->levels);
+      break;
+    default:
+      g_assert_not_reached ();
+      break;
+  }
 }
 
 static gboolean
-ready_timeout_cb (gpointer user_data)
+event_source_dispatch (GSource * source, GSourceFunc callback,
+    gpointer user_data)
 {
-  GstPlayer *self = user_data;
+  GstPlayer *self = ((GstPlayerEventSource *) source)->player;
+  GstPlayerEventData data;
+  guint signal;
 
-  if (self->target_state <= GST_STATE_READY) {
-    GST_DEBUG_OBJECT (self, "Setting pipeline to NULL state");
-    self->target_state = GST_STATE_NULL;
-    self->current_state = GST_STATE_NULL;
-    gst_element_set_state (self->playbin, GST_STATE_NULL);
+  g_source_set_ready_time (source, -1);
+  /* Must be cleared before draining, see post_event() */
+  g_atomic_int_set (&self->events_wakeup_pending, 0);
+
+  while (event_queue_pop (self, &signal, &data)) {
+    event_emit (self, signal, &data);
+    event_data_clear (signal, &data);
   }
 
-  return G_SOURCE_REMOVE;
+  return G_SOURCE_CONTINUE;
 }
 
-static void
-add_ready_timeout_source (GstPlayer * self)
+static GSourceFuncs event_source_funcs = {
+  NULL,
+  NULL,
+  event_source_dispatch,
+  NULL
+};
+
+static GSource *
+event_source_new (GstPlayer * self)
 {
-  if (self->ready_timeout_source)
-    return;
+  GSource *source;
 
-  self->ready_timeout_source = g_timeout_source_new_seconds (60);
-  g_source_set_callback (self->ready_timeout_source,
-      (GSourceFunc) ready_timeout_cb, self, NULL);
-  g_source_attach (self->ready_timeout_source, self->context);
+  source = g_source_new (&event_source_funcs, sizeof (GstPlayerEventSource));
+  ((GstPlayerEventSource *) source)->player = self;
+  g_source_set_priority (source, G_PRIORITY_DEFAULT);
+  g_source_set_ready_time (source, -1);
+
+  return source;
 }
 
+/* Takes ownership of the payload in @data */
 static void
-remove_ready_timeout_source (GstPlayer * self)
+post_event (GstPlayer * self, guint signal, GstPlayerEventData * data)
 {
-  if (!self->ready_timeout_source)
+  gint pos;
+
+  if (event_is_coalesced (signal) && event_slot_coalesce (self, signal, data)) {
+    event_data_clear (signal, data);
+    g_atomic_int_inc (&self->events_coalesced);
     return;
+  }
 
-  g_source_destroy (self->ready_timeout_source);
-  g_source_unref (self->ready_timeout_source);
-  self->ready_timeout_source = NULL;
+  /* Once an event overflowed, later ones must not overtake it */
+  if (g_atomic_int_get (&self->events_n_overflow) > 0
+      || !event_queue_push (self, signal, data, &pos))
+    event_overflow_push (self, signal, data);
+  else if (event_is_coalesced (signal))
+    event_slot_set_queued (self, signal, pos);
+
+  /* Only wake up the application context if it is not already going to
+   * drain the queue */
+  if (g_atomic_int_compare_and_exchange (&self->events_wakeup_pending, 0, 1))
+    g_source_set_ready_time (self->event_source, 0);
 }
 
-typedef struct
-{
-  GstPlayer *player;
-  GError *err;
-} ErrorSignalData;
-
+/* Returns TRUE if @signal has to be dispatched via the application context */
 static gboolean
-error_dispatch (gpointer user_data)
+should_post_event (GstPlayer * self, guint signal)
 {
-  ErrorSignalData *data = user_data;
+  return self->dispatch_to_main_context
+      && g_signal_handler_find (self, G_SIGNAL_MATCH_ID, signals[signal], 0,
+      NULL, NULL, NULL) != 0;
+}
 
-  g_signal_emit (data->player, signals[SIGNAL_ERROR], 0, data->err);
+static void
+event_queue_flush (GstPlayer * self)
+{
+  GstPlayerEventData data;
+  guint signal;
 
-  return G_SOURCE_REMOVE;
+  while (event_queue_pop (self, &signal, &data))
+    event_data_clear (signal, &data);
 }
 
 static void
-free_error_signal_data (ErrorSignalData * data)
+change_state (GstPlayer * self, GstPlayerState state)
 {
-  g_clear_error (&data->err);
-  g_free (data);
+  if (state == self->app_state)
+    return;
+
+  GST_DEBUG_OBJECT (self, "Changing app state from %s to %s",
+      gst_player_state_get_name (self->app_state),
+      gst_player_state_get_name (state));
+  self->app_state = state;
+
+  if (should_post_event (self, SIGNAL_STATE_CHANGED)) {
+    GstPlayerEventData data;
+
+    data.state = state;
+    post_event (self, SIGNAL_STATE_CHANGED, &data);
+  } else {
+    g_signal_emit (self, signals[SIGNAL_STATE_CHANGED], 0, state);
+  }
 }
 
 static void
-emit_error (GstPlayer * self, GError * err)
+emit_uri_loaded (GstPlayer * self, const gchar * uri)
 {
-  GST_ERROR_OBJECT (self, "Error: %s (%s, %d)", err->message,
-      g_quark_to_string (err->domain), err->code);
-
-  if (self->dispatch_to_main_context
-      && g_signal_handler_find (self, G_SIGNAL_MATCH_ID,
-          signals[SIGNAL_ERROR], 0, NULL, NULL, NULL) != 0) {
-    ErrorSignalData *data = g_new (ErrorSignalData, 1);
+  if (should_post_event (self, SIGNAL_URI_LOADED)) {
+    GstPlayerEventData data;
 
-    data->player = self;
-    data->err = g_error_copy (err);
-    g_main_context_invoke_full (self->application_context,
-        G_PRIORITY_DEFAULT, error_dispatch, data,
-        (GDestroyNotify) free_error_signal_data);
+    data.uri = g_strdup (uri);
+    post_event (self, SIGNAL_URI_LOADED, &data);
   } else {
-    g_signal_emit (self, signals[SIGNAL_ERROR], 0, err);
+    g_signal_emit (self, signals[SIGNAL_URI_LOADED], 0, uri);
   }
+}
 
-  g_error_free (err);
+/* The position is interpolated from the last queried position, the
+ * monotonic time at that moment and the playback rate, so that reading it
+ * does not need a position query. The snapshot is taken whenever the
+ * pipeline reaches PAUSED or PLAYING, after seeks and on every position
+ * update. The pipeline clock is not used as readers could not keep it
+ * alive; the drift against it is corrected by the next snapshot.
+ *
+ * There is a single writer (the player thread), readers retry if the
+ * sequence number was odd or changed while reading.
+ */
+static void
+position_snapshot_update (GstPlayer * self, GstClockTime position,
+    gboolean running)
+{
+  GstClockTime clock_time = g_get_monotonic_time () * GST_USECOND;
 
-  remove_tick_source (self);
-  remove_ready_timeout_source (self);
+  g_atomic_int_inc (&self->position_seq);
 
-  self->target_state = GST_STATE_NULL;
-  self->current_state = GST_STATE_NULL;
-  self->is_live = FALSE;
-  self->is_eos = FALSE;
-  gst_element_set_state (self->playbin, GST_STATE_NULL);
-  change_state (self, GST_PLAYER_STATE_STOPPED);
-  self->buffering = 100;
+  self->position = position;
+  self->position_clock_time = clock_time;
+  self->position_running = running;
 
-  g_mutex_lock (&self->lock);
-  if (self->media_info) {
-    g_object_unref (self->media_info);
-    self->media_info = NULL;
-  }
+  g_atomic_int_inc (&self->position_seq);
+}
 
-  if (self->global_tags) {
-    gst_tag_list_unref (self->global_tags);
-    self->global_tags = NULL;
-  }
-
-  self->seek_pending = FALSE;
-  if (self->seek_source) {
-    g_source_destroy (self->seek_source);
-    g_source_unref (self->seek_source);
-    self->seek_source = NULL;
-  }
-  self->seek_position = GST_CLOCK_TIME_NONE;
-  self->last_seek_time = GST_CLOCK_TIME_NONE;
-  g_mutex_unlock (&self->lock);
+static void
+position_snapshot_update_duration (GstPlayer * self, GstClockTime duration)
+{
+  g_atomic_int_inc (&self->position_seq);
+  self->position_duration = duration;
+  g_atomic_int_inc (&self->position_seq);
 }
 
 static void
-dump_dot_file (GstPlayer * self, const gchar * name)
+position_snapshot_update_rate (GstPlayer * self, gdouble rate)
 {
-  gchar *full_name;
+  g_atomic_int_inc (&self->position_seq);
+  self->position_rate = rate;
+  g_atomic_int_inc (&self->position_seq);
+}
 
-  full_name = g_strdup_printf ("gst-player.%p.%s", self, name);
+/* Stop interpolating at the current position, e.g. when pausing */
+static void
+position_snapshot_freeze (GstPlayer * self)
+{
+  position_snapshot_update (self, position_snapshot_get (self), FALSE);
+}
 
-  GST_DEBUG_BIN_TO_DOT_FILE_WITH_TS (GST_BIN (self->playbin),
-      GST_DEBUG_GRAPH_SHOW_ALL, full_name);
+static void
+position_snapshot_sync (GstPlayer * self)
+{
+  gint64 position;
 
-  g_free (full_name);
+  if (gst_element_query_position (self->playbin, GST_FORMAT_TIME, &position))
+    position_snapshot_update (self, position,
+        self->current_state == GST_STATE_PLAYING);
 }
 
-static void
-error_cb (GstBus * bus, GstMessage * msg, gpointer user_data)
+static GstClockTime
+position_snapshot_get (GstPlayer * self)
 {
-  GstPlayer *self = GST_PLAYER (user_data);
-  GError *err, *player_err;
-  gchar *name, *debug, *message, *full_message;
+  GstClockTime position, clock_time, duration, now, elapsed;
+  gdouble rate;
+  gboolean running;
+  gint seq;
+
+  for (;;) {
+    seq = g_atomic_int_get (&self->position_seq);
+    if (seq & 1) {
+      /* The writer might have been preempted */
+      g_thread_yield ();
+      continue;
+    }
 
-  dump_dot_file (self, "error");
+    position = self->position;
+    clock_time = self->position_clock_time;
+    duration = self->position_duration;
+    rate = self->position_rate;
+    running = self->position_running;
 
-  gst_message_parse_error (msg, &err, &debug);
+    if (g_atomic_int_get (&self->position_seq) == seq)
+      break;
+  }
 
-  name = gst_object_get_path_string (msg->src);
-  message = gst_error_get_message (err->domain, err->code);
+  if (!running || !GST_CLOCK_TIME_IS_VALID (position)
+      || !GST_CLOCK_TIME_IS_VALID (clock_time))
+    return position;
 
-  if (debug)
-    full_message =
-        g_strdup_printf ("Error from element %s: %s\n%s\n%s", name, message,
-        err->message, debug);
-  else
-    full_message =
-        g_strdup_printf ("Error from element %s: %s\n%s", name, message,
-        err->message);
+  now = g_get_monotonic_time () * GST_USECOND;
+  if (now <= clock_time)
+    return position;
 
-  GST_ERROR_OBJECT (self, "ERROR: from element %s: %s\n", name, err->message);
-  if (debug != NULL)
-    GST_ERROR_OBJECT (self, "Additional debug info:\n%s\n", debug);
+  elapsed = now - clock_time;
+  if (rate == 1.0) {
+    position += elapsed;
+  } else if (rate > 0.0) {
+    position += (GstClockTime) (elapsed * rate);
+  } else {
+    elapsed = (GstClockTime) (elapsed * -rate);
+    position = position > elapsed ? position - elapsed : 0;
+  }
 
-  player_err =
-      g_error_new_literal (GST_PLAYER_ERROR, GST_PLAYER_ERROR_FAILED,
-      full_message);
-  emit_error (self, player_err);
+  if (GST_CLOCK_TIME_IS_VALID (duration) && position > duration)
+    position = duration;
 
-  g_clear_error (&err);
-  g_free (debug);
-  g_free (name);
-  g_free (full_message);
-  g_free (message);
+  return position;
 }
 
 static void
-warning_cb (GstBus * bus, GstMessage * msg, gpointer user_data)
+position_snapshot_verify (GstPlayer * self, GstClockTime position)
 {
-  GstPlayer *self = GST_PLAYER (user_data);
-  GError *err;
-  gchar *name, *debug, *message, *full_message;
-
-  dump_dot_file (self, "warning");
-
-  gst_message_parse_warning (msg, &err, &debug);
+  GstElement *playbin;
+  gint64 queried;
+  GstClockTimeDiff drift;
+  gboolean ret;
 
-  name = gst_object_get_path_string (msg->src);
-  message = gst_error_get_message (err->domain, err->code);
+  /* Called from the application thread */
+  playbin = playbin_ref (self);
+  ret = gst_element_query_position (playbin, GST_FORMAT_TIME, &queried);
+  gst_object_unref (playbin);
+  if (!ret)
+    return;
 
-  if (debug)
-    full_message =
-        g_strdup_printf ("Warning from element %s: %s\n%s\n%s", name, message,
-        err->message, debug);
+  drift = GST_CLOCK_DIFF (queried, position);
+  if (ABS (drift) > POSITION_VERIFY_TOLERANCE)
+    GST_WARNING_OBJECT (self, "Interpolated position %" GST_TIME_FORMAT
+        " drifted from queried position %" GST_TIME_FORMAT " by %c%"
+        GST_TIME_FORMAT, GST_TIME_ARGS (position), GST_TIME_ARGS (queried),
+        drift < 0 ? '-' : '+', GST_TIME_ARGS (ABS (drift)));
   else
-    full_message =
-        g_strdup_printf ("Warning from element %s: %s\n%s", name, message,
-        err->message);
-
-  GST_WARNING_OBJECT (self, "WARNING: from element %s: %s\n", name,
-      err->message);
-  if (debug != NULL)
-    GST_WARNING_OBJECT (self, "Additional debug info:\n%s\n", debug);
-
-  g_clear_error (&err);
-  g_free (debug);
-  g_free (name);
-  g_free (full_message);
-  g_free (message);
+    GST_LOG_OBJECT (self, "Interpolated position drift %c%" GST_TIME_FORMAT,
+        drift < 0 ? '-' : '+', GST_TIME_ARGS (ABS (drift)));
 }
 
-static gboolean
-eos_dispatch (gpointer user_data)
+/* Playback statistics are only written from the main context. Readers in
+ * gst_player_get_stats() retry if the sequence number was odd or changed
+ * while reading, like for the position snapshot */
+static void
+stats_begin_write (GstPlayer * self)
 {
-  g_signal_emit (user_data, signals[SIGNAL_END_OF_STREAM], 0);
-
-  return G_SOURCE_REMOVE;
+  g_atomic_int_inc (&self->stats_seq);
 }
 
 static void
-eos_cb (GstBus * bus, GstMessage * msg, gpointer user_data)
+stats_end_write (GstPlayer * self)
 {
-  GstPlayer *self = GST_PLAYER (user_data);
-
-  GST_DEBUG_OBJECT (self, "End of stream");
+  g_atomic_int_inc (&self->stats_seq);
+}
 
-  tick_cb (self);
-  remove_tick_source (self);
+static void
+stats_histogram_add (guint * histogram, GstClockTime value)
+{
+  guint i;
 
-  if (self->dispatch_to_main_context
-      && g_signal_handler_find (self, G_SIGNAL_MATCH_ID,
-          signals[SIGNAL_END_OF_STREAM], 0, NULL, NULL, NULL) != 0) {
-    g_main_context_invoke (self->application_context, eos_dispatch, self);
-  } else {
-    g_signal_emit (self, signals[SIGNAL_END_OF_STREAM], 0);
+  for (i = 0; i < G_N_ELEMENTS (stats_histogram_bounds); i++) {
+    if (value <= stats_histogram_bounds[i])
+      break;
   }
-  change_state (self, GST_PLAYER_STATE_STOPPED);
-  self->buffering = 100;
-  self->is_eos = TRUE;
+  histogram[i]++;
 }
 
-typedef struct
+static void
+stats_record_startup (GstPlayer * self)
 {
-  GstPlayer *player;
-  gint percent;
-} BufferingSignalData;
+  GstClockTime latency;
 
-static gboolean
-buffering_dispatch (gpointer user_data)
-{
-  BufferingSignalData *data = user_data;
+  if (!GST_CLOCK_TIME_IS_VALID (self->startup_time))
+    return;
 
-  g_signal_emit (data->player, signals[SIGNAL_BUFFERING], 0, data->percent);
+  latency = gst_util_get_timestamp () - self->startup_time;
+  self->startup_time = GST_CLOCK_TIME_NONE;
+  GST_DEBUG_OBJECT (self, "Playback started after %" GST_TIME_FORMAT,
+      GST_TIME_ARGS (latency));
 
-  return G_SOURCE_REMOVE;
+  stats_begin_write (self);
+  self->stats.time_to_first_frame = latency;
+  stats_histogram_add (self->stats.time_to_first_frame_histogram, latency);
+  stats_end_write (self);
 }
 
 static void
-buffering_cb (GstBus * bus, GstMessage * msg, gpointer user_data)
+stats_stall_begin (GstPlayer * self)
 {
-  GstPlayer *self = GST_PLAYER (user_data);
-  gint percent;
-
-  if (self->is_live)
+  if (GST_CLOCK_TIME_IS_VALID (self->stall_start_time))
     return;
 
-  gst_message_parse_buffering (msg, &percent);
-  GST_LOG_OBJECT (self, "Buffering %d%%", percent);
-
-  if (percent < 100 && self->target_state >= GST_STATE_PAUSED) {
-    GstStateChangeReturn state_ret;
+  self->stall_start_time = gst_util_get_timestamp ();
 
-    GST_DEBUG_OBJECT (self, "Waiting for buffering to finish");
-    state_ret = gst_element_set_state (self->playbin, GST_STATE_PAUSED);
+  stats_begin_write (self);
+  self->stats.rebuffer_count++;
+  stats_end_write (self);
+}
 
-    if (state_ret == GST_STATE_CHANGE_FAILURE) {
-      emit_error (self, g_error_new (GST_PLAYER_ERROR, GST_PLAYER_ERROR_FAILED,
-              "Failed to handle buffering"));
-      return;
-    }
+static void
+stats_stall_end (GstPlayer * self)
+{
+  GstClockTime stall;
 
-    change_state (self, GST_PLAYER_STATE_BUFFERING);
-  }
+  if (!GST_CLOCK_TIME_IS_VALID (self->stall_start_time))
+    return;
 
-  if (self->buffering != percent) {
-    if (self->dispatch_to_main_context
-        && g_signal_handler_find (self, G_SIGNAL_MATCH_ID,
-            signals[SIGNAL_BUFFERING], 0, NULL, NULL, NULL) != 0) {
-      BufferingSignalData *data = g_new (BufferingSignalData, 1);
-
-      data->player = self;
-      data->percent = percent;
-      g_main_context_invoke_full (self->application_context,
-          G_PRIORITY_DEFAULT, buffering_dispatch, data,
-          (GDestroyNotify) g_free);
-    } else {
-      g_signal_emit (self, signals[SIGNAL_BUFFERING], 0, percent);
-    }
+  stall = gst_util_get_timestamp () - self->stall_start_time;
+  self->stall_start_time = GST_CLOCK_TIME_NONE;
+  GST_DEBUG_OBJECT (self, "Playback stalled for %" GST_TIME_FORMAT,
+      GST_TIME_ARGS (stall));
 
-    self->buffering = percent;
-  }
+  stats_begin_write (self);
+  self->stats.stall_time += stall;
+  stats_end_write (self);
+}
 
+static void
+update_position (GstPlayer * self)
+{
+  gint64 position;
 
-  g_mutex_lock (&self->lock);
-  if (percent == 100 && (self->seek_position != GST_CLOCK_TIME_NONE ||
-          self->seek_pending)) {
-    g_mutex_unlock (&self->lock);
+  if (!gst_element_query_position (self->playbin, GST_FORMAT_TIME, &position))
+    return;
 
-    GST_DEBUG_OBJECT (self, "Buffering finished - seek pending");
-  } else if (percent == 100 && self->target_state >= GST_STATE_PLAYING
-      && self->current_state >= GST_STATE_PAUSED) {
-    GstStateChangeReturn state_ret;
+  GST_LOG_OBJECT (self, "Position %" GST_TIME_FORMAT, GST_TIME_ARGS (position));
 
-    g_mutex_unlock (&self->lock);
+  position_snapshot_update (self, position,
+      self->current_state == GST_STATE_PLAYING);
 
-    GST_DEBUG_OBJECT (self, "Buffering finished - going to PLAYING");
-    state_ret = gst_element_set_state (self->playbin, GST_STATE_PLAYING);
-    /* Application state change is happening when the state change happened */
-    if (state_ret == GST_STATE_CHANGE_FAILURE)
-      emit_error (self, g_error_new (GST_PLAYER_ERROR, GST_PLAYER_ERROR_FAILED,
-              "Failed to handle buffering"));
-  } else if (percent == 100 && self->target_state >= GST_STATE_PAUSED) {
-    g_mutex_unlock (&self->lock);
+  if (should_post_event (self, SIGNAL_POSITION_UPDATED)) {
+    GstPlayerEventData data;
 
-    GST_DEBUG_OBJECT (self, "Buffering finished - staying PAUSED");
-    change_state (self, GST_PLAYER_STATE_PAUSED);
+    data.time = position;
+    post_event (self, SIGNAL_POSITION_UPDATED, &data);
   } else {
-    g_mutex_unlock (&self->lock);
+    g_signal_emit (self, signals[SIGNAL_POSITION_UPDATED], 0, position);
+    g_object_notify_by_pspec (G_OBJECT (self), param_specs[PROP_POSITION]);
   }
 }
 
-static void
-clock_lost_cb (GstBus * bus, GstMessage * msg, gpointer user_data)
+/* Without any handler for the position there is no point in querying it,
+ * and a hidden application does not need to update its seekbar either */
+static gboolean
+position_updates_wanted (GstPlayer * self)
 {
-  GstPlayer *self = GST_PLAYER (user_data);
-  GstStateChangeReturn state_ret;
+  if (!(self->tick_flags & GST_PLAYER_POSITION_UPDATE_FLAG_ADAPTIVE))
+    return TRUE;
 
-  GST_DEBUG_OBJECT (self, "Clock lost");
-  if (self->target_state >= GST_STATE_PLAYING) {
-    state_ret = gst_element_set_state (self->playbin, GST_STATE_PAUSED);
-    if (state_ret != GST_STATE_CHANGE_FAILURE)
-      state_ret = gst_element_set_state (self->playbin, GST_STATE_PLAYING);
+  if (!self->tick_visible)
+    return FALSE;
 
-    if (state_ret == GST_STATE_CHANGE_FAILURE)
-      emit_error (self, g_error_new (GST_PLAYER_ERROR, GST_PLAYER_ERROR_FAILED,
-              "Failed to handle clock loss"));
-  }
+  return g_signal_has_handler_pending (self,
+      signals[SIGNAL_POSITION_UPDATED], 0, FALSE)
+      || g_signal_has_handler_pending (self,
+      g_signal_lookup ("notify", G_TYPE_OBJECT),
+      g_quark_from_static_string ("position"), FALSE);
 }
 
-typedef struct
+/* Returns the time in microseconds until the next tick. If requested and
+ * the framerate is known, the next tick is moved to the next frame boundary
+ * after the interval so that seekbars advance by whole frames. Frame
+ * boundaries are in stream time, which advances with the playback rate */
+static gint64
+next_tick_delay (GstPlayer * self, GstClockTime position)
 {
-  GstPlayer *player;
-  gint width, height;
-} VideoDimensionsChangedSignalData;
+  GstClockTime interval, frame_duration, advance, target;
+  gdouble rate = ABS (self->position_rate);
+
+  interval = self->tick_interval * GST_MSECOND;
+
+  if ((self->tick_flags & GST_PLAYER_POSITION_UPDATE_FLAG_FRAME_ALIGNED)
+      && self->video_fps_n > 0 && self->video_fps_d > 0
+      && GST_CLOCK_TIME_IS_VALID (position)) {
+    frame_duration = gst_util_uint64_scale_int (GST_SECOND,
+        self->video_fps_d, self->video_fps_n);
+    advance = (GstClockTime) (interval * rate);
+
+    if (frame_duration > 0 && self->position_rate > 0.0) {
+      target = position + advance + frame_duration - 1;
+      target -= target % frame_duration;
+      interval = (GstClockTime) ((target - position) / rate);
+    } else if (frame_duration > 0 && position > advance) {
+      target = position - advance;
+      target -= target % frame_duration;
+      interval = (GstClockTime) ((position - target) / rate);
+    }
+  }
+
+  return interval / GST_USECOND;
+}
 
 static gboolean
-video_dimensions_changed_dispatch (gpointer user_data)
+tick_cb (gpointer user_data)
 {
-  VideoDimensionsChangedSignalData *data = user_data;
+  GstPlayer *self = GST_PLAYER (user_data);
+
+  /* Disarmed until the next state change, seek or reconfiguration, see
+   * add_tick_source() */
+  if (!position_updates_wanted (self)) {
+    GST_DEBUG_OBJECT (self, "Position updates not wanted, removing tick");
+    g_source_unref (self->tick_source);
+    self->tick_source = NULL;
+    return G_SOURCE_REMOVE;
+  }
 
-  g_signal_emit (data->player, signals[SIGNAL_VIDEO_DIMENSIONS_CHANGED], 0,
-      data->width, data->height);
+  update_position (self);
 
-  return G_SOURCE_REMOVE;
+  g_source_set_ready_time (self->tick_source, g_get_monotonic_time () +
+      next_tick_delay (self, position_snapshot_get (self)));
+
+  return G_SOURCE_CONTINUE;
 }
 
-static void
-check_video_dimensions_changed (GstPlayer * self)
+static gboolean
+tick_source_dispatch (GSource * source, GSourceFunc callback,
+    gpointer user_data)
 {
-  GstElement *video_sink;
-  GstPad *video_sink_pad;
-  GstCaps *caps;
-  GstVideoInfo info;
-  gint width = 0, height = 0;
-
-  g_object_get (self->playbin, "video-sink", &video_sink, NULL);
-  if (!video_sink)
-    goto out;
+  /* tick_cb() schedules the next tick */
+  g_source_set_ready_time (source, -1);
 
-  video_sink_pad = gst_element_get_static_pad (video_sink, "sink");
-  if (!video_sink_pad) {
-    gst_object_unref (video_sink);
-    goto out;
-  }
+  return callback (user_data);
+}
 
-  caps = gst_pad_get_current_caps (video_sink_pad);
+static GSourceFuncs tick_source_funcs = {
+  NULL,
+  NULL,
+  tick_source_dispatch,
+  NULL
+};
 
-  if (caps) {
-    if (gst_video_info_from_caps (&info, caps)) {
-      info.width = info.width * info.par_n / info.par_d;
+static void
+add_tick_source (GstPlayer * self)
+{
+  self->tick_wanted = TRUE;
 
-      GST_DEBUG_OBJECT (self, "Video dimensions changed: %dx%d", info.width,
-          info.height);
-      width = info.width;
-      height = info.height;
-    }
+  if (self->tick_source)
+    return;
 
-    gst_caps_unref (caps);
+  if (self->tick_interval == 0) {
+    GST_DEBUG_OBJECT (self, "Position updates disabled");
+    return;
   }
-  gst_object_unref (video_sink_pad);
-  gst_object_unref (video_sink);
 
-out:
-  if (self->dispatch_to_main_context
-      && g_signal_handler_find (self, G_SIGNAL_MATCH_ID,
-          signals[SIGNAL_VIDEO_DIMENSIONS_CHANGED], 0, NULL, NULL, NULL) != 0) {
-    VideoDimensionsChangedSignalData *data =
-        g_new (VideoDimensionsChangedSignalData, 1);
-
-    data->player = self;
-    data->width = width;
-    data->height = height;
-    g_main_context_invoke_full (self->application_context,
-        G_PRIORITY_DEFAULT, video_dimensions_changed_dispatch, data,
-        (GDestroyNotify) g_free);
-  } else {
-    g_signal_emit (self, signals[SIGNAL_VIDEO_DIMENSIONS_CHANGED], 0,
-        width, height);
+  /* In adaptive mode there are no wakeups at all while nobody is
+   * interested in the position */
+  if (!position_updates_wanted (self)) {
+    GST_DEBUG_OBJECT (self, "Position updates not wanted, not adding tick "
+        "source");
+    return;
   }
+
+  self->tick_source = g_source_new (&tick_source_funcs, sizeof (GSource));
+  g_source_set_callback (self->tick_source, (GSourceFunc) tick_cb, self, NULL);
+  g_source_set_ready_time (self->tick_source, g_get_monotonic_time () +
+      next_tick_delay (self, GST_CLOCK_TIME_NONE));
+  g_source_attach (self->tick_source, self->context);
 }
 
 static void
-notify_caps_cb (GObject * object, GParamSpec * pspec, gpointer user_data)
+remove_tick_source (GstPlayer * self)
 {
-  GstPlayer *self = GST_PLAYER (user_data);
+  self->tick_wanted = FALSE;
 
-  check_video_dimensions_changed (self);
+  if (!self->tick_source)
+    return;
+
+  g_source_destroy (self->tick_source);
+  g_source_unref (self->tick_source);
+  self->tick_source = NULL;
 }
 
-typedef struct
-{
-  GstPlayer *player;
-  GstClockTime duration;
-} DurationChangedSignalData;
-
 static gboolean
-duration_changed_dispatch (gpointer user_data)
+reconfigure_tick_source_cb (gpointer user_data)
 {
-  DurationChangedSignalData *data = user_data;
+  GstPlayer *self = GST_PLAYER (user_data);
+
+  g_mutex_lock (&self->lock);
+  self->tick_interval = self->position_update_interval;
+  self->tick_flags = self->position_update_flags;
+  self->tick_visible = self->visible;
+  g_mutex_unlock (&self->lock);
 
-  g_signal_emit (data->player, signals[SIGNAL_DURATION_CHANGED], 0,
-      data->duration);
-  g_object_notify_by_pspec (G_OBJECT (data->player),
-      param_specs[PROP_DURATION]);
+  if (self->tick_wanted) {
+    remove_tick_source (self);
+    add_tick_source (self);
+  }
 
   return G_SOURCE_REMOVE;
 }
 
 static void
-emit_duration_changed (GstPlayer * self, GstClockTime duration)
+idle_players_add (GstPlayer * self)
 {
-  GST_DEBUG_OBJECT (self, "Duration changed %" GST_TIME_FORMAT,
-      GST_TIME_ARGS (duration));
-
-  if (self->dispatch_to_main_context
-      && g_signal_handler_find (self, G_SIGNAL_MATCH_ID,
-          signals[SIGNAL_DURATION_CHANGED], 0, NULL, NULL, NULL) != 0) {
-    DurationChangedSignalData *data = g_new (DurationChangedSignalData, 1);
-
-    data->player = self;
-    data->duration = duration;
-    g_main_context_invoke_full (self->application_context,
-        G_PRIORITY_DEFAULT, duration_changed_dispatch, data,
-        (GDestroyNotify) g_free);
-  } else {
-    g_signal_emit (self, signals[SIGNAL_DURATION_CHANGED], 0, duration);
-    g_object_notify_by_pspec (G_OBJECT (self), param_specs[PROP_DURATION]);
+  g_mutex_lock (&idle_players_lock);
+  if (!self->idle_registered) {
+    g_queue_push_tail_link (&idle_players, &self->idle_link);
+    self->idle_registered = TRUE;
   }
+  g_mutex_unlock (&idle_players_lock);
 }
 
 static void
-state_changed_cb (GstBus * bus, GstMessage * msg, gpointer user_data)
+idle_players_remove (GstPlayer * self)
 {
-  GstPlayer *self = GST_PLAYER (user_data);
-  GstState old_state, new_state, pending_state;
-
-  gst_message_parse_state_changed (msg, &old_state, &new_state, &pending_state);
-
-  if (GST_MESSAGE_SRC (msg) == GST_OBJECT (self->playbin)) {
-    gchar *transition_name;
+  g_mutex_lock (&idle_players_lock);
+  if (self->idle_registered) {
+    g_queue_unlink (&idle_players, &self->idle_link);
+    self->idle_registered = FALSE;
+  }
+  g_mutex_unlock (&idle_players_lock);
+}
 
-    GST_DEBUG_OBJECT (self, "Changed state old: %s new: %s pending: %s",
-        gst_element_state_get_name (old_state),
-        gst_element_state_get_name (new_state),
-        gst_element_state_get_name (pending_state));
+/* Releases all resources of a stopped pipeline. It has to be rebuilt
+ * completely when playing the next time */
+static void
+release_idle_pipeline (GstPlayer * self)
+{
+  if (self->target_state > GST_STATE_READY
+      || self->current_state == GST_STATE_NULL)
+    return;
 
-    transition_name = g_strdup_printf ("%s_%s",
-        gst_element_state_get_name (old_state),
-        gst_element_state_get_name (new_state));
-    dump_dot_file (self, transition_name);
-    g_free (transition_name);
+  GST_DEBUG_OBJECT (self, "Setting pipeline to NULL state");
+  self->target_state = GST_STATE_NULL;
+  self->current_state = GST_STATE_NULL;
+  gst_element_set_state (self->playbin, GST_STATE_NULL);
+  g_atomic_int_inc (&self->idle_releases);
+}
 
-    self->current_state = new_state;
+static gboolean
+ready_timeout_cb (gpointer user_data)
+{
+  GstPlayer *self = user_data;
 
-    if (old_state == GST_STATE_READY && new_state == GST_STATE_PAUSED
-        && pending_state == GST_STATE_VOID_PENDING) {
-      GstElement *video_sink;
-      GstPad *video_sink_pad;
-      gint64 duration = -1;
+  g_source_unref (self->ready_timeout_source);
+  self->ready_timeout_source = NULL;
+  idle_players_remove (self);
 
-      GST_DEBUG_OBJECT (self, "Initial PAUSED - pre-rolled");
+  release_idle_pipeline (self);
 
-      g_mutex_lock (&self->lock);
-      if (self->media_info)
-        g_object_unref (self->media_info);
-      self->media_info = gst_player_media_info_create (self);
-      g_mutex_unlock (&self->lock);
-      emit_media_info_updated_signal (self);
+  return G_SOURCE_REMOVE;
+}
 
-      g_object_get (self->playbin, "video-sink", &video_sink, NULL);
+/* Called when the pipeline becomes idle. Depending on the idle-timeout it
+ * is kept in READY state forever, released in the next main loop iteration
+ * or after the timeout. Until then it can be released early by
+ * gst_player_release_idle_pipelines() */
+static void
+add_ready_timeout_source (GstPlayer * self)
+{
+  gint timeout;
 
-      if (video_sink) {
-        video_sink_pad = gst_element_get_static_pad (video_sink, "sink");
+  if (self->ready_timeout_source || self->idle_registered)
+    return;
 
-        if (video_sink_pad) {
-          g_signal_connect (video_sink_pad, "notify::caps",
-              (GCallback) notify_caps_cb, self);
-          gst_object_unref (video_sink_pad);
-        }
-        gst_object_unref (video_sink);
-      }
+  idle_players_add (self);
 
-      check_video_dimensions_changed (self);
-      gst_element_query_duration (self->playbin, GST_FORMAT_TIME, &duration);
-      emit_duration_changed (self, duration);
-    }
+  timeout = g_atomic_int_get (&self->idle_timeout);
+  if (timeout < 0)
+    return;
 
-    if (new_state == GST_STATE_PAUSED
-        && pending_state == GST_STATE_VOID_PENDING) {
-      remove_tick_source (self);
+  if (timeout > 0 && timeout % 1000 == 0)
+    self->ready_timeout_source = g_timeout_source_new_seconds (timeout / 1000);
+  else
+    self->ready_timeout_source = g_timeout_source_new (timeout);
+  g_source_set_callback (self->ready_timeout_source,
+      (GSourceFunc) ready_timeout_cb, self, NULL);
+  g_source_attach (self->ready_timeout_source, self->context);
+}
 
-      g_mutex_lock (&self->lock);
-      if (self->seek_pending) {
-        self->seek_pending = FALSE;
+static void
+remove_ready_timeout_source (GstPlayer * self)
+{
+  idle_players_remove (self);
 
-        if (!self->media_info->seekable) {
-          GST_DEBUG_OBJECT (self, "Media is not seekable");
-          if (self->seek_source) {
-            g_source_destroy (self->seek_source);
-            g_source_unref (self->seek_source);
-            self->seek_source = NULL;
-          }
-          self->seek_position = GST_CLOCK_TIME_NONE;
-          self->last_seek_time = GST_CLOCK_TIME_NONE;
-        } else if (self->seek_source) {
-          GST_DEBUG_OBJECT (self, "Seek finished but new seek is pending");
-          gst_player_seek_internal_locked (self);
-        } else {
-          GST_DEBUG_OBJECT (self, "Seek finished");
-        }
-      }
+  if (!self->ready_timeout_source)
+    return;
 
-      if (self->seek_position != GST_CLOCK_TIME_NONE) {
-        GST_DEBUG_OBJECT (self, "Seeking now that we reached PAUSED state");
-        gst_player_seek_internal_locked (self);
-        g_mutex_unlock (&self->lock);
-      } else if (!self->seek_pending) {
-        g_mutex_unlock (&self->lock);
+  g_source_destroy (self->ready_timeout_source);
+  g_source_unref (self->ready_timeout_source);
+  self->ready_timeout_source = NULL;
+}
 
-        tick_cb (self);
+static gboolean
+reconfigure_ready_timeout_source_cb (gpointer user_data)
+{
+  GstPlayer *self = GST_PLAYER (user_data);
 
-        if (self->target_state >= GST_STATE_PLAYING && self->buffering == 100) {
-          GstStateChangeReturn state_ret;
+  if (!self->idle_registered)
+    return G_SOURCE_REMOVE;
 
-          state_ret = gst_element_set_state (self->playbin, GST_STATE_PLAYING);
-          if (state_ret == GST_STATE_CHANGE_FAILURE)
-            emit_error (self, g_error_new (GST_PLAYER_ERROR,
-                    GST_PLAYER_ERROR_FAILED, "Failed to play"));
-        } else if (self->buffering == 100) {
-          change_state (self, GST_PLAYER_STATE_PAUSED);
-        }
-      } else {
-        g_mutex_unlock (&self->lock);
-      }
-    } else if (new_state == GST_STATE_PLAYING
-        && pending_state == GST_STATE_VOID_PENDING) {
+  remove_ready_timeout_source (self);
+  add_ready_timeout_source (self);
 
-      /* If no seek is currently pending, add the tick source. This can happen
-       * if we seeked already but the state-change message was still queued up */
-      if (!self->seek_pending) {
-        add_tick_source (self);
-        change_state (self, GST_PLAYER_STATE_PLAYING);
-      }
-    } else if (new_state == GST_STATE_READY && old_state > GST_STATE_READY) {
-      change_state (self, GST_PLAYER_STATE_STOPPED);
-    } else {
-      /* Otherwise we neither reached PLAYING nor PAUSED, so must
-       * wait for something to happen... i.e. are BUFFERING now */
-      change_state (self, GST_PLAYER_STATE_BUFFERING);
-    }
-  }
+  return G_SOURCE_REMOVE;
 }
 
-static void
-duration_changed_cb (GstBus * bus, GstMessage * msg, gpointer user_data)
+static gboolean
+release_idle_pipeline_cb (gpointer user_data)
 {
   GstPlayer *self = GST_PLAYER (user_data);
-  gint64 duration;
 
-  if (gst_element_query_duration (self->playbin, GST_FORMAT_TIME, &duration)) {
-    emit_duration_changed (self, duration);
+  if (self->idle_registered) {
+    remove_ready_timeout_source (self);
+    release_idle_pipeline (self);
   }
+
+  return G_SOURCE_REMOVE;
 }
 
+/* Counts whether a pipeline is started from READY, i.e. with elements that
+ * were kept around, or has to be built up from NULL */
 static void
-latency_cb (GstBus * bus, GstMessage * msg, gpointer user_data)
+count_pipeline_start (GstPlayer * self)
 {
-  GstPlayer *self = GST_PLAYER (user_data);
-
-  GST_DEBUG_OBJECT (self, "Latency changed");
+  if (self->target_state >= GST_STATE_PAUSED)
+    return;
 
-  gst_bin_recalculate_latency (GST_BIN (self->playbin));
+  if (self->current_state == GST_STATE_NULL)
+    g_atomic_int_inc (&self->cold_starts);
+  else
+    g_atomic_int_inc (&self->warm_starts);
 }
 
 static void
-request_state_cb (GstBus * bus, GstMessage * msg, gpointer user_data)
+emit_error (GstPlayer * self, GError * err)
 {
-  GstPlayer *self = GST_PLAYER (user_data);
-  GstState state;
-  GstStateChangeReturn state_ret;
+  GST_ERROR_OBJECT (self, "Error: %s (%s, %d)", err->message,
+      g_quark_to_string (err->domain), err->code);
 
-  gst_message_parse_request_state (msg, &state);
+  if (should_post_event (self, SIGNAL_ERROR)) {
+    GstPlayerEventData data;
 
-  GST_DEBUG_OBJECT (self, "State %s requested",
-      gst_element_state_get_name (state));
+    data.err = g_error_copy (err);
+    post_event (self, SIGNAL_ERROR, &data);
+  } else {
+    g_signal_emit (self, signals[SIGNAL_ERROR], 0, err);
+  }
 
-  self->target_state = state;
-  state_ret = gst_element_set_state (self->playbin, state);
-  if (state_ret == GST_STATE_CHANGE_FAILURE)
-    emit_error (self, g_error_new (GST_PLAYER_ERROR, GST_PLAYER_ERROR_FAILED,
-            "Failed to change to requested state %s",
-            gst_element_state_get_name (state)));
+  g_error_free (err);
+
+  remove_tick_source (self);
+  remove_ready_timeout_source (self);
+
+  self->target_state = GST_STATE_NULL;
+  self->current_state = GST_STATE_NULL;
+  self->is_live = FALSE;
+  self->is_eos = FALSE;
+  gst_element_set_state (self->playbin, GST_STATE_NULL);
+  download_finish (self);
+  change_state (self, GST_PLAYER_STATE_STOPPED);
+  self->buffering = 100;
+  self->buffering_done = TRUE;
+  self->buffering_time_left = GST_CLOCK_TIME_NONE;
+
+  g_mutex_lock (&self->lock);
+  media_info_clear_pending_updates_locked (self);
+  if (self->media_info) {
+    g_object_unref (self->media_info);
+    self->media_info = NULL;
+  }
+  self->media_info_cached = FALSE;
+  self->media_info_uncached = FALSE;
+
+  if (self->global_tags) {
+    gst_tag_list_unref (self->global_tags);
+    self->global_tags = NULL;
+  }
+
+  self->seek_pending = FALSE;
+  if (self->seek_source) {
+    g_source_destroy (self->seek_source);
+    g_source_unref (self->seek_source);
+    self->seek_source = NULL;
+  }
+  self->seek_position = GST_CLOCK_TIME_NONE;
+  self->last_seek_time = GST_CLOCK_TIME_NONE;
+  g_mutex_unlock (&self->lock);
 }
 
 static void
-media_info_update (GstPlayer * self, GstPlayerMediaInfo * info)
+dump_dot_file (GstPlayer * self, const gchar * name)
 {
-  if (info->title)
-    g_free (info->title);
-  info->title = get_from_tags (self, info, get_title);
+  gchar *full_name;
 
-  if (info->container)
-    g_free (info->container);
-  info->container = get_from_tags (self, info, get_container_format);
+  full_name = g_strdup_printf ("gst-player.%p.%s", self, name);
 
-  if (info->image_sample)
-    gst_sample_unref (info->image_sample);
-  info->image_sample = get_from_tags (self, info, get_cover_sample);
+  GST_DEBUG_BIN_TO_DOT_FILE_WITH_TS (GST_BIN (self->playbin),
+      GST_DEBUG_GRAPH_SHOW_ALL, full_name);
 
-  GST_DEBUG_OBJECT (self, "title: %s, container: %s "
-      "image_sample: %p", info->title, info->container, info->image_sample);
+  g_free (full_name);
 }
 
 static void
-tags_cb (GstBus * bus, GstMessage * msg, gpointer user_data)
+error_cb (GstBus * bus, GstMessage * msg, gpointer user_data)
 {
   GstPlayer *self = GST_PLAYER (user_data);
-  GstTagList *tags = NULL;
+  GError *err, *player_err;
+  gchar *name, *debug, *message, *full_message;
 
-  gst_message_parse_tag (msg, &tags);
+  dump_dot_file (self, "error");
 
-  /*
-   * NOTE: Inorder to get global tag you must apply the following patches in
-   * your gstreamer build.
-   *
-   * http://cgit.freedesktop.org/gstreamer/gst-plugins-good/commit/?id=9119fbd774093e3ae762c8652acd80d54b2c3b45
-   * http://cgit.freedesktop.org/gstreamer/gstreamer/commit/?id=18b058100940bdcaed86fa412e3582a02871f995
-   */
-  GST_DEBUG_OBJECT (self, "recieved %s tags",
-      gst_tag_list_get_scope (tags) ==
-      GST_TAG_SCOPE_GLOBAL ? "global" : "stream");
+  gst_message_parse_error (msg, &err, &debug);
 
-  if (gst_tag_list_get_scope (tags) == GST_TAG_SCOPE_GLOBAL) {
-    g_mutex_lock (&self->lock);
-    if (self->media_info) {
-      if (self->media_info->tags)
-        gst_tag_list_unref (self->media_info->tags);
-      self->media_info->tags = gst_tag_list_ref (tags);
-      media_info_update (self, self->media_info);
-      g_mutex_unlock (&self->lock);
-      emit_media_info_updated_signal (self);
-    } else {
-      if (self->global_tags)
-        gst_tag_list_unref (self->global_tags);
-      self->global_tags = gst_tag_list_ref (tags);
-      g_mutex_unlock (&self->lock);
-    }
-  }
+  name = gst_object_get_path_string (msg->src);
+  message = gst_error_get_message (err->domain, err->code);
 
-  gst_tag_list_unref (tags);
+  if (debug)
+    full_message =
+        g_strdup_printf ("Error from element %s: %s\n%s\n%s", name, message,
+        err->message, debug);
+  else
+    full_message =
+        g_strdup_printf ("Error from element %s: %s\n%s", name, message,
+        err->message);
+
+  GST_ERROR_OBJECT (self, "ERROR: from element %s: %s\n", name, err->message);
+  if (debug != NULL)
+    GST_ERROR_OBJECT (self, "Additional debug info:\n%s\n", debug);
+
+  player_err =
+      g_error_new_literal (GST_PLAYER_ERROR, GST_PLAYER_ERROR_FAILED,
+      full_message);
+  emit_error (self, player_err);
+
+  g_clear_error (&err);
+  g_free (debug);
+  g_free (name);
+  g_free (full_message);
+  g_free (message);
 }
 
 static void
-element_cb (GstBus * bus, GstMessage * msg, gpointer user_data)
+warning_cb (GstBus * bus, GstMessage * msg, gpointer user_data)
 {
   GstPlayer *self = GST_PLAYER (user_data);
-  const GstStructure *s;
+  GError *err;
+  gchar *name, *debug, *message, *full_message;
 
-  s = gst_message_get_structure (msg);
-  if (gst_structure_has_name (s, "redirect")) {
-    const gchar *new_location;
+  dump_dot_file (self, "warning");
 
-    new_location = gst_structure_get_string (s, "new-location");
-    if (!new_location) {
-      const GValue *locations_list, *location_val;
-      guint i, size;
+  gst_message_parse_warning (msg, &err, &debug);
 
-      locations_list = gst_structure_get_value (s, "locations");
-      size = gst_value_list_get_size (locations_list);
-      for (i = 0; i < size; ++i) {
-        const GstStructure *location_s;
+  name = gst_object_get_path_string (msg->src);
+  message = gst_error_get_message (err->domain, err->code);
 
-        location_val = gst_value_list_get_value (locations_list, i);
-        if (!GST_VALUE_HOLDS_STRUCTURE (location_val))
-          continue;
+  if (debug)
+    full_message =
+        g_strdup_printf ("Warning from element %s: %s\n%s\n%s", name, message,
+        err->message, debug);
+  else
+    full_message =
+        g_strdup_printf ("Warning from element %s: %s\n%s", name, message,
+        err->message);
 
-        location_s = (const GstStructure *) g_value_get_boxed (location_val);
-        if (!gst_structure_has_name (location_s, "redirect"))
-          continue;
+  GST_WARNING_OBJECT (self, "WARNING: from element %s: %s\n", name,
+      err->message);
+  if (debug != NULL)
+    GST_WARNING_OBJECT (self, "Additional debug info:\n%s\n", debug);
 
-        new_location = gst_structure_get_string (location_s, "new-location");
-        if (new_location)
-          break;
-      }
-    }
+  g_clear_error (&err);
+  g_free (debug);
+  g_free (name);
+  g_free (full_message);
+  g_free (message);
+}
 
-    if (new_location) {
-      GstState target_state;
+static void
+eos_cb (GstBus * bus, GstMessage * msg, gpointer user_data)
+{
+  GstPlayer *self = GST_PLAYER (user_data);
+  gchar *next_uri;
 
-      GST_DEBUG_OBJECT (self, "Redirect to '%s'", new_location);
+  GST_DEBUG_OBJECT (self, "End of stream");
 
-      /* Remember target state and restore after setting the URI */
-      target_state = self->target_state;
+  /* The next URI was set too late to be played without gap, so continue
+   * with it like after a redirect */
+  g_mutex_lock (&self->lock);
+  next_uri = self->next_uri;
+  self->next_uri = NULL;
+  if (next_uri) {
+    g_free (self->uri);
+    self->uri = next_uri;
+    g_free (self->uri_validator);
+    self->uri_validator = NULL;
+  }
+  g_mutex_unlock (&self->lock);
 
-      g_mutex_lock (&self->lock);
-      if (self->uri)
-        g_free (self->uri);
+  if (next_uri) {
+    GstState target_state = self->target_state;
 
-      self->uri = g_strdup (new_location);
-      g_mutex_unlock (&self->lock);
+    GST_DEBUG_OBJECT (self, "Continuing with next URI after EOS");
 
-      gst_player_set_uri_internal (self);
+    gst_player_set_uri_internal (self);
 
-      if (target_state == GST_STATE_PAUSED)
-        gst_player_pause_internal (self);
-      else if (target_state == GST_STATE_PLAYING)
-        gst_player_play_internal (self);
-    }
+    if (target_state == GST_STATE_PAUSED)
+      gst_player_pause_internal (self);
+    else
+      gst_player_play_internal (self);
+    return;
+  }
+
+  update_position (self);
+  position_snapshot_freeze (self);
+  remove_tick_source (self);
+
+  if (should_post_event (self, SIGNAL_END_OF_STREAM)) {
+    post_event (self, SIGNAL_END_OF_STREAM, NULL);
+  } else {
+    g_signal_emit (self, signals[SIGNAL_END_OF_STREAM], 0);
   }
+  change_state (self, GST_PLAYER_STATE_STOPPED);
+  self->buffering = 100;
+  self->buffering_done = TRUE;
+  self->buffering_time_left = GST_CLOCK_TIME_NONE;
+  self->is_eos = TRUE;
 }
 
-static void
-player_set_flag (GstPlayer * self, gint pos)
+/* Estimates the time until the buffer is filled from the source's own
+ * estimate, which download buffering provides, or from the input rate and
+ * the configured buffer-size */
+static GstClockTime
+buffering_estimate_time_left (GstPlayer * self, gint percent, gint avg_in,
+    gint64 buffering_left)
 {
-  gint flags;
+  gint buffer_size;
 
-  g_object_get (self->playbin, "flags", &flags, NULL);
-  flags |= pos;
-  g_object_set (self->playbin, "flags", flags, NULL);
+  if (percent >= 100)
+    return 0;
 
-  GST_DEBUG_OBJECT (self, "setting flags=%#x", flags);
-}
+  if (buffering_left >= 0)
+    return buffering_left * GST_MSECOND;
 
-static void
-player_clear_flag (GstPlayer * self, gint pos)
-{
-  gint flags;
+  g_mutex_lock (&self->lock);
+  buffer_size = self->buffer_size;
+  g_mutex_unlock (&self->lock);
 
-  g_object_get (self->playbin, "flags", &flags, NULL);
-  flags &= ~pos;
-  g_object_set (self->playbin, "flags", flags, NULL);
+  if (avg_in <= 0 || buffer_size <= 0)
+    return GST_CLOCK_TIME_NONE;
 
-  GST_DEBUG_OBJECT (self, "setting flags=%#x", flags);
+  return gst_util_uint64_scale (buffer_size, (100 - percent) * GST_SECOND,
+      (guint64) avg_in * 100);
 }
 
-typedef struct
-{
-  GstPlayer *player;
-  GstPlayerMediaInfo *info;
-} MediaInfoUpdatedSignalData;
-
+/* Whether playback can continue before the high watermark is reached
+ * without running out of data again: when downloading, if the download
+ * finishes before playback reaches the end; when streaming, if the
+ * buffered data lasts longer than filling the rest of the buffer takes.
+ * Nothing is played while buffering, so the output rate is of no use */
 static gboolean
-media_info_updated_dispatch (gpointer user_data)
+buffering_can_resume_early (GstPlayer * self, GstBufferingMode mode,
+    gint percent, GstClockTime time_left)
 {
-  MediaInfoUpdatedSignalData *data = user_data;
+  GstClockTime position, remaining;
+  gint64 buffer_duration;
+
+  if (mode == GST_BUFFERING_DOWNLOAD || mode == GST_BUFFERING_TIMESHIFT) {
+    position = position_snapshot_get (self);
+    if (!GST_CLOCK_TIME_IS_VALID (time_left)
+        || !GST_CLOCK_TIME_IS_VALID (position)
+        || !GST_CLOCK_TIME_IS_VALID (self->position_duration))
+      return FALSE;
+
+    remaining = self->position_duration > position ?
+        self->position_duration - position : 0;
+    return time_left < remaining;
+  }
 
-  g_signal_emit (data->player, signals[SIGNAL_MEDIA_INFO_UPDATED], 0,
-      data->info);
+  if (!GST_CLOCK_TIME_IS_VALID (time_left))
+    return FALSE;
 
-  return FALSE;
-}
+  g_mutex_lock (&self->lock);
+  buffer_duration = self->buffer_duration;
+  g_mutex_unlock (&self->lock);
 
-static void
-free_media_info_updated_signal_data (MediaInfoUpdatedSignalData * data)
-{
-  g_object_unref (data->info);
-  g_free (data);
+  if (buffer_duration <= 0)
+    buffer_duration = QUEUE2_BUFFER_DURATION;
+
+  remaining = gst_util_uint64_scale_int (buffer_duration, percent, 100);
+  return time_left < remaining;
 }
 
-/*
- * emit_media_info_updated_signal:
- *
- * create a new copy of self->media_info object and emits the newly created
- * copy to user application. The newly created media_info will be unref'ed
- * as part of signal finalize method.
- */
+/* Playback pauses when the buffer falls below the low watermark while
+ * playing, or below the high watermark otherwise, and continues from the
+ * high watermark or earlier with buffering-early-resume */
 static void
-emit_media_info_updated_signal (GstPlayer * self)
+buffering_cb (GstBus * bus, GstMessage * msg, gpointer user_data)
 {
-  if (self->dispatch_to_main_context) {
-    MediaInfoUpdatedSignalData *data = g_new (MediaInfoUpdatedSignalData, 1);
-    data->player = self;
-    g_mutex_lock (&self->lock);
-    data->info = gst_player_media_info_copy (self->media_info);
-    g_mutex_unlock (&self->lock);
+  GstPlayer *self = GST_PLAYER (user_data);
+  GstBufferingMode mode;
+  gint percent, avg_in, avg_out, low, high;
+  gint64 buffering_left;
+  gboolean early_resume, done;
+  GstClockTime time_left;
 
-    g_main_context_invoke_full (self->application_context,
-        G_PRIORITY_DEFAULT, media_info_updated_dispatch,
-        data, (GDestroyNotify) free_media_info_updated_signal_data);
-  } else {
-    GstPlayerMediaInfo *info;
+  if (self->is_live)
+    return;
 
-    g_mutex_lock (&self->lock);
-    info = gst_player_media_info_copy (self->media_info);
-    g_mutex_unlock (&self->lock);
+  gst_message_parse_buffering (msg, &percent);
+  gst_message_parse_buffering_stats (msg, &mode, &avg_in, &avg_out,
+      &buffering_left);
+  GST_LOG_OBJECT (self, "Buffering %d%% (in %d B/s, out %d B/s, left %"
+      G_GINT64_FORMAT " ms)", percent, avg_in, avg_out, buffering_left);
 
-    g_signal_emit (self, signals[SIGNAL_MEDIA_INFO_UPDATED], 0, info);
-    g_object_unref (info);
+  g_mutex_lock (&self->lock);
+  high = self->high_watermark;
+  low = MIN (self->low_watermark, high);
+  early_resume = self->buffering_early_resume;
+  g_mutex_unlock (&self->lock);
+
+  time_left = buffering_estimate_time_left (self, percent, avg_in,
+      buffering_left);
+
+  if (percent >= high) {
+    done = TRUE;
+  } else if (!self->buffering_done && early_resume
+      && buffering_can_resume_early (self, mode, percent, time_left)) {
+    GST_DEBUG_OBJECT (self, "Buffering %d%%, resuming early", percent);
+    done = TRUE;
+  } else if (percent < low || self->app_state != GST_PLAYER_STATE_PLAYING) {
+    done = FALSE;
+  } else {
+    done = self->buffering_done;
   }
-}
 
-static GstCaps *
-get_caps (GstPlayer * self, gint stream_index, GType type)
-{
-  GstPad *pad = NULL;
-  GstCaps *caps = NULL;
+  if (!done && self->target_state >= GST_STATE_PAUSED) {
+    GstStateChangeReturn state_ret;
 
-  if (type == GST_TYPE_PLAYER_VIDEO_INFO)
-    g_signal_emit_by_name (G_OBJECT (self->playbin),
-        "get-video-pad", stream_index, &pad);
-  else if (type == GST_TYPE_PLAYER_AUDIO_INFO)
-    g_signal_emit_by_name (G_OBJECT (self->playbin),
-        "get-audio-pad", stream_index, &pad);
-  else
-    g_signal_emit_by_name (G_OBJECT (self->playbin),
-        "get-text-pad", stream_index, &pad);
+    /* Buffering before playback started is not a stall */
+    if (self->app_state == GST_PLAYER_STATE_PLAYING)
+      stats_stall_begin (self);
 
-  if (pad) {
-    caps = gst_pad_get_current_caps (pad);
-    gst_object_unref (pad);
-  }
+    GST_DEBUG_OBJECT (self, "Waiting for buffering to finish");
+    state_ret = gst_element_set_state (self->playbin, GST_STATE_PAUSED);
 
-  return caps;
-}
+    if (state_ret == GST_STATE_CHANGE_FAILURE) {
+      emit_error (self, g_error_new (GST_PLAYER_ERROR, GST_PLAYER_ERROR_FAILED,
+              "Failed to handle buffering"));
+      return;
+    }
 
-static void
-gst_player_subtitle_info_update (GstPlayer * self,
-    GstPlayerStreamInfo * stream_info)
-{
-  GstPlayerSubtitleInfo *info = (GstPlayerSubtitleInfo *) stream_info;
+    change_state (self, GST_PLAYER_STATE_BUFFERING);
+  }
 
-  if (stream_info->tags) {
+  if (self->buffering != percent) {
+    if (should_post_event (self, SIGNAL_BUFFERING)) {
+      GstPlayerEventData data;
 
-    /* free the old language info */
-    if (info->language) {
-      g_free (info->language);
-      info->language = NULL;
+      data.percent = percent;
+      post_event (self, SIGNAL_BUFFERING, &data);
+    } else {
+      g_signal_emit (self, signals[SIGNAL_BUFFERING], 0, percent);
     }
 
-    /* First try to get the language full name from tag, if name is not
-     * available then try language code. If we find the language code
-     * then use gstreamer api to translate code to full name.
-     */
-    gst_tag_list_get_string (stream_info->tags, GST_TAG_LANGUAGE_NAME,
-        &info->language);
-    if (!info->language) {
-      gchar *lang_code = NULL;
+    self->buffering = percent;
+  }
 
-      gst_tag_list_get_string (stream_info->tags, GST_TAG_LANGUAGE_CODE,
-          &lang_code);
-      if (lang_code) {
-        info->language = g_strdup (gst_tag_get_language_name (lang_code));
-        g_free (lang_code);
-      }
-    }
-  } else {
-    if (info->language) {
-      g_free (info->language);
-      info->language = NULL;
+  if (self->buffering_time_left != time_left) {
+    if (should_post_event (self, SIGNAL_BUFFERING_TIME_LEFT)) {
+      GstPlayerEventData data;
+
+      data.time = time_left;
+      post_event (self, SIGNAL_BUFFERING_TIME_LEFT, &data);
+    } else {
+      g_signal_emit (self, signals[SIGNAL_BUFFERING_TIME_LEFT], 0, time_left);
     }
+
+    self->buffering_time_left = time_left;
   }
 
-  GST_DEBUG_OBJECT (self, "language=%s", info->language);
-}
+  self->buffering_done = done;
+  if (done)
+    stats_stall_end (self);
 
-static void
-gst_player_video_info_update (GstPlayer * self,
-    GstPlayerStreamInfo * stream_info)
-{
-  GstPlayerVideoInfo *info = (GstPlayerVideoInfo *) stream_info;
+  g_mutex_lock (&self->lock);
+  if (done && (self->seek_position != GST_CLOCK_TIME_NONE ||
+          self->seek_pending)) {
+    g_mutex_unlock (&self->lock);
 
-  if (stream_info->caps) {
-    GstStructure *s;
+    GST_DEBUG_OBJECT (self, "Buffering finished - seek pending");
+  } else if (done && self->target_state >= GST_STATE_PLAYING
+      && self->current_state >= GST_STATE_PAUSED) {
+    GstStateChangeReturn state_ret;
 
-    s = gst_caps_get_structure (stream_info->caps, 0);
-    if (s) {
-      gint width, height;
-      gint fps_n, fps_d;
-      gint par_n, par_d;
+    g_mutex_unlock (&self->lock);
 
-      if (gst_structure_get_int (s, "width", &width))
-        info->width = width;
-      else
-        info->width = -1;
+    GST_DEBUG_OBJECT (self, "Buffering finished - going to PLAYING");
+    state_ret = gst_element_set_state (self->playbin, GST_STATE_PLAYING);
+    /* Application state change is happening when the state change happened */
+    if (state_ret == GST_STATE_CHANGE_FAILURE)
+      emit_error (self, g_error_new (GST_PLAYER_ERROR, GST_PLAYER_ERROR_FAILED,
+              "Failed to handle buffering"));
+  } else if (done && self->target_state >= GST_STATE_PAUSED) {
+    g_mutex_unlock (&self->lock);
 
-      if (gst_structure_get_int (s, "height", &height))
-        info->height = height;
-      else
-        info->height = -1;
+    GST_DEBUG_OBJECT (self, "Buffering finished - staying PAUSED");
+    change_state (self, GST_PLAYER_STATE_PAUSED);
+  } else {
+    g_mutex_unlock (&self->lock);
+  }
+}
 
-      if (gst_structure_get_fraction (s, "framerate", &fps_n, &fps_d)) {
-        info->framerate_num = fps_n;
-        info->framerate_denom = fps_d;
-      } else {
-        info->framerate_num = 0;
-        info->framerate_denom = 1;
-      }
+static gboolean
+element_is_video (GstElement * element, const gchar * klass)
+{
+  const gchar *element_klass;
 
+  element_klass = gst_element_get_metadata (element,
+      GST_ELEMENT_METADATA_KLASS);
 
-      if (gst_structure_get_fraction (s, "pixel-aspect-ratio", &par_n, &par_d)) {
-        info->par_num = par_n;
-        info->par_denom = par_d;
-      } else {
-        info->par_num = 1;
-        info->par_denom = 1;
-      }
-    }
-  } else {
-    info->width = info->height = -1;
-    info->par_num = info->par_denom = 1;
-    info->framerate_num = 0;
-    info->framerate_denom = 1;
-  }
+  return element_klass && strstr (element_klass, klass)
+      && strstr (element_klass, "Video");
+}
 
-  if (stream_info->tags) {
-    guint bitrate, max_bitrate;
+typedef struct
+{
+  const gchar *klass;
+  const gchar *property;
+  const gchar *value;
+} GstPlayerElementSetting;
 
-    if (gst_tag_list_get_uint (stream_info->tags, GST_TAG_BITRATE, &bitrate))
-      info->bitrate = bitrate;
-    else
-      info->bitrate = -1;
+static void
+element_setting_apply (GstElement * element,
+    const GstPlayerElementSetting * setting)
+{
+  if (setting->klass && !element_is_video (element, setting->klass))
+    return;
 
-    if (gst_tag_list_get_uint (stream_info->tags, GST_TAG_MAXIMUM_BITRATE,
-            &max_bitrate) || gst_tag_list_get_uint (stream_info->tags,
-            GST_TAG_NOMINAL_BITRATE, &max_bitrate))
-      info->max_bitrate = max_bitrate;
-    else
-      info->max_bitrate = -1;
-  } else {
-    info->bitrate = info->max_bitrate = -1;
-  }
+  if (!g_object_class_find_property (G_OBJECT_GET_CLASS (element),
+          setting->property))
+    return;
 
-  GST_DEBUG_OBJECT (self, "width=%d height=%d fps=%.2f par=%d:%d "
-      "bitrate=%d max_bitrate=%d", info->width, info->height,
-      (gdouble) info->framerate_num / info->framerate_denom,
-      info->par_num, info->par_denom, info->bitrate, info->max_bitrate);
+  GST_DEBUG_OBJECT (element, "Setting %s=%s", setting->property,
+      setting->value);
+  gst_util_set_object_arg (G_OBJECT (element), setting->property,
+      setting->value);
 }
 
 static void
-gst_player_audio_info_update (GstPlayer * self,
-    GstPlayerStreamInfo * stream_info)
+element_setting_apply_cb (const GValue * item, gpointer user_data)
 {
-  GstPlayerAudioInfo *info = (GstPlayerAudioInfo *) stream_info;
+  element_setting_apply (g_value_get_object (item), user_data);
+}
 
-  if (stream_info->caps) {
-    GstStructure *s;
+/* Sets @property on all elements of the pipeline that have it. If @klass
+ * is not %NULL, only on video elements of that class */
+static void
+playbin_set_element_property (GstPlayer * self, const gchar * klass,
+    const gchar * property, const gchar * value)
+{
+  GstPlayerElementSetting setting = { klass, property, value };
+  GstIterator *it;
+
+  it = gst_bin_iterate_recurse (GST_BIN (self->playbin));
+  while (gst_iterator_foreach (it, element_setting_apply_cb,
+          &setting) == GST_ITERATOR_RESYNC)
+    gst_iterator_resync (it);
+  gst_iterator_free (it);
+}
 
-    s = gst_caps_get_structure (stream_info->caps, 0);
-    if (s) {
-      gint rate, channels;
+static void
+degradation_apply_step (GstPlayer * self, GstPlayerDegradationFlags step,
+    gboolean enable)
+{
+  gchar *speed;
+  guint64 connection_speed;
 
-      if (gst_structure_get_int (s, "rate", &rate))
-        info->sample_rate = rate;
-      else
-        info->sample_rate = -1;
+  GST_DEBUG_OBJECT (self, "%s degradation step 0x%x",
+      enable ? "Enabling" : "Disabling", step);
 
-      if (gst_structure_get_int (s, "channels", &channels))
-        info->channels = channels;
-      else
-        info->channels = 0;
-    }
-  } else {
-    info->sample_rate = -1;
-    info->channels = 0;
+  switch (step) {
+    case GST_PLAYER_DEGRADATION_FLAG_SKIP_FRAMES:
+      /* Only decoders based on libav have it, 1 skips B-frames */
+      playbin_set_element_property (self, "Decoder", "skip-frame",
+          enable ? "1" : "0");
+      break;
+    case GST_PLAYER_DEGRADATION_FLAG_MAX_LATENESS:
+      playbin_set_element_property (self, "Sink", "max-lateness",
+          enable ? DEGRADATION_MAX_LATENESS : DEFAULT_VIDEO_MAX_LATENESS);
+      break;
+    case GST_PLAYER_DEGRADATION_FLAG_LOWER_VARIANT:
+      /* Adaptive demuxers select the variant that fits the connection
+       * speed in kbps, so 1 selects the lowest one */
+      g_object_get (self->playbin, "connection-speed", &connection_speed,
+          NULL);
+      speed = g_strdup_printf ("%" G_GUINT64_FORMAT,
+          enable ? 1 : connection_speed);
+      playbin_set_element_property (self, NULL, "connection-speed", speed);
+      g_free (speed);
+      break;
+    case GST_PLAYER_DEGRADATION_FLAG_KEY_UNITS:
+      /* Takes effect with a seek to the current position, see
+       * playbin_seek() */
+      g_mutex_lock (&self->lock);
+      if (self->current_state >= GST_STATE_PAUSED && self->media_info
+          && self->media_info->seekable) {
+        if (self->seek_position == GST_CLOCK_TIME_NONE)
+          self->seek_position = position_snapshot_get (self);
+        gst_player_seek_schedule_locked (self);
+      }
+      g_mutex_unlock (&self->lock);
+      break;
+    default:
+      g_assert_not_reached ();
+      break;
   }
+}
 
-  if (stream_info->tags) {
-    guint bitrate, max_bitrate;
+#if GST_CHECK_VERSION(1,10,0)
+/* Decoders and demuxers are also created while playing, e.g. for the next
+ * gapless URI or a new track, and only get the enabled steps from here.
+ * Called from streaming threads */
+static void
+deep_element_added_cb (GstBin * playbin, GstBin * sub_bin,
+    GstElement * element, GstPlayer * self)
+{
+  static const GstPlayerElementSetting skip_frame =
+      { "Decoder", "skip-frame", "1" };
+  static const GstPlayerElementSetting max_lateness =
+      { "Sink", "max-lateness", DEGRADATION_MAX_LATENESS };
+  static const GstPlayerElementSetting connection_speed =
+      { NULL, "connection-speed", "1" };
+  GstPlayerDegradationFlags active;
+
+  active = g_atomic_int_get (&self->degradation_applied);
+  if (active & GST_PLAYER_DEGRADATION_FLAG_SKIP_FRAMES)
+    element_setting_apply (element, &skip_frame);
+  if (active & GST_PLAYER_DEGRADATION_FLAG_MAX_LATENESS)
+    element_setting_apply (element, &max_lateness);
+  if (active & GST_PLAYER_DEGRADATION_FLAG_LOWER_VARIANT)
+    element_setting_apply (element, &connection_speed);
+}
+#endif
 
-    if (gst_tag_list_get_uint (stream_info->tags, GST_TAG_BITRATE, &bitrate))
-      info->bitrate = bitrate;
-    else
-      info->bitrate = -1;
+static gboolean degradation_check_cb (gpointer user_data);
 
-    if (gst_tag_list_get_uint (stream_info->tags, GST_TAG_MAXIMUM_BITRATE,
-            &max_bitrate) || gst_tag_list_get_uint (stream_info->tags,
-            GST_TAG_NOMINAL_BITRATE, &max_bitrate))
-      info->max_bitrate = max_bitrate;
-    else
-      info->max_bitrate = -1;
+static void
+degradation_set_active (GstPlayer * self, GstPlayerDegradationFlags active)
+{
+  GstPlayerDegradationFlags changed = self->degradation_active ^ active;
+  guint step;
 
-    /* if we have old language the free it */
-    if (info->language) {
-      g_free (info->language);
-      info->language = NULL;
-    }
+  if (!changed)
+    return;
 
-    /* First try to get the language full name from tag, if name is not
-     * available then try language code. If we find the language code
-     * then use gstreamer api to translate code to full name.
-     */
-    gst_tag_list_get_string (stream_info->tags, GST_TAG_LANGUAGE_NAME,
-        &info->language);
-    if (!info->language) {
-      gchar *lang_code = NULL;
+  self->degradation_active = active;
+  /* Before applying, so that elements added in between get it either from
+   * here or from deep_element_added_cb() */
+  g_atomic_int_set (&self->degradation_applied, active);
+  self->degradation_last_change = gst_util_get_timestamp ();
+  self->degradation_late_count = 0;
 
-      gst_tag_list_get_string (stream_info->tags, GST_TAG_LANGUAGE_CODE,
-          &lang_code);
-      if (lang_code) {
-        info->language = g_strdup (gst_tag_get_language_name (lang_code));
-        g_free (lang_code);
-      }
-    }
-  } else {
-    if (info->language) {
-      g_free (info->language);
-      info->language = NULL;
-    }
-    info->max_bitrate = info->bitrate = -1;
+  for (step = 1; step <= GST_PLAYER_DEGRADATION_FLAG_KEY_UNITS; step <<= 1) {
+    if (changed & step)
+      degradation_apply_step (self, step, (active & step) != 0);
   }
 
-  GST_DEBUG_OBJECT (self, "language=%s rate=%d channels=%d bitrate=%d "
-      "max_bitrate=%d", info->language, info->sample_rate, info->channels,
-      info->bitrate, info->bitrate);
-}
+  if (active && !self->degradation_source) {
+    self->degradation_source = g_timeout_source_new_seconds (1);
+    g_source_set_callback (self->degradation_source, degradation_check_cb,
+        self, NULL);
+    g_source_attach (self->degradation_source, self->context);
+  } else if (!active && self->degradation_source) {
+    g_source_destroy (self->degradation_source);
+    g_source_unref (self->degradation_source);
+    self->degradation_source = NULL;
+  }
 
-static GstPlayerStreamInfo *
-gst_player_stream_info_find (GstPlayer * self, GstPlayerMediaInfo * media_info,
-    GType type, gint stream_index)
-{
-  GList *list, *l;
-  GstPlayerStreamInfo *info = NULL;
+  if (should_post_event (self, SIGNAL_DEGRADATION_CHANGED)) {
+    GstPlayerEventData data;
 
-  if (!media_info)
-    return NULL;
+    data.degradation = active;
+    post_event (self, SIGNAL_DEGRADATION_CHANGED, &data);
+  } else {
+    g_signal_emit (self, signals[SIGNAL_DEGRADATION_CHANGED], 0, active);
+  }
+}
 
-  list = gst_player_media_info_get_stream_list (media_info);
-  for (l = list; l != NULL; l = l->next) {
-    info = (GstPlayerStreamInfo *) l->data;
-    if ((G_OBJECT_TYPE (info) == type) && (info->stream_index == stream_index)) {
-      return info;
+/* Undoes the last step once the video sink kept up for a while */
+static gboolean
+degradation_check_cb (gpointer user_data)
+{
+  GstPlayer *self = GST_PLAYER (user_data);
+  GstClockTime now = gst_util_get_timestamp ();
+  GstPlayerDegradationFlags active = self->degradation_active;
+  guint step;
+
+  if (now - self->degradation_last_change < DEGRADATION_RECOVERY_TIME
+      || (GST_CLOCK_TIME_IS_VALID (self->degradation_last_late)
+          && now - self->degradation_last_late < DEGRADATION_RECOVERY_TIME))
+    return G_SOURCE_CONTINUE;
+
+  for (step = GST_PLAYER_DEGRADATION_FLAG_KEY_UNITS; step > 0; step >>= 1) {
+    if (active & step) {
+      GST_DEBUG_OBJECT (self, "Video sink keeps up again, recovering");
+      /* Might destroy the source */
+      degradation_set_active (self, active & ~step);
+      break;
     }
   }
 
-  return NULL;
+  return G_SOURCE_CONTINUE;
 }
 
 static gboolean
-is_track_enabled (GstPlayer * self, gint pos)
+degradation_reconfigure_cb (gpointer user_data)
 {
-  gint flags;
-
-  g_object_get (G_OBJECT (self->playbin), "flags", &flags, NULL);
+  GstPlayer *self = GST_PLAYER (user_data);
+  GstPlayerDegradationFlags steps;
 
-  if ((flags & pos))
-    return TRUE;
+  steps = g_atomic_int_get (&self->degradation_steps);
+  degradation_set_active (self, self->degradation_active & steps);
 
-  return FALSE;
+  return G_SOURCE_REMOVE;
 }
 
-static GstPlayerStreamInfo *
-gst_player_stream_info_get_current (GstPlayer * self, const gchar * prop,
-    GType type)
+/* A QoS message from the video sink with a positive jitter and a proportion
+ * above 1.0 means frames arrive late because decoding is too slow. Enough
+ * of them take the next of the enabled steps */
+static void
+degradation_handle_qos (GstPlayer * self, gint64 jitter, gdouble proportion)
 {
-  gint current;
-  GstPlayerStreamInfo *info;
+  GstPlayerDegradationFlags steps, next;
+  GstClockTime now;
+  guint step;
 
-  if (!self->media_info)
-    return NULL;
+  steps = g_atomic_int_get (&self->degradation_steps);
+  if (!steps || jitter <= 0 || proportion <= 1.0)
+    return;
 
-  g_object_get (G_OBJECT (self->playbin), prop, &current, NULL);
-  g_mutex_lock (&self->lock);
-  info = gst_player_stream_info_find (self, self->media_info, type, current);
-  if (info)
-    info = gst_player_stream_info_copy (info);
-  g_mutex_unlock (&self->lock);
+  now = gst_util_get_timestamp ();
+  if (GST_CLOCK_TIME_IS_VALID (self->degradation_last_late)
+      && now - self->degradation_last_late > DEGRADATION_HOLD_TIME)
+    self->degradation_late_count = 0;
+  self->degradation_last_late = now;
+  self->degradation_late_count++;
 
-  return info;
+  if (self->degradation_late_count < DEGRADATION_LATE_MESSAGES
+      || (GST_CLOCK_TIME_IS_VALID (self->degradation_last_change)
+          && now - self->degradation_last_change < DEGRADATION_HOLD_TIME))
+    return;
+
+  next = steps & ~self->degradation_active;
+  for (step = 1; step <= GST_PLAYER_DEGRADATION_FLAG_KEY_UNITS; step <<= 1) {
+    if (next & step) {
+      GST_DEBUG_OBJECT (self, "Video sink is behind (proportion %lf), "
+          "degrading", proportion);
+      degradation_set_active (self, self->degradation_active | step);
+      break;
+    }
+  }
 }
 
 static void
-gst_player_stream_info_update (GstPlayer * self, GstPlayerStreamInfo * s)
+qos_cb (GstBus * bus, GstMessage * msg, gpointer user_data)
 {
-  if (GST_IS_PLAYER_VIDEO_INFO (s))
-    gst_player_video_info_update (self, s);
-  else if (GST_IS_PLAYER_AUDIO_INFO (s))
-    gst_player_audio_info_update (self, s);
-  else
-    gst_player_subtitle_info_update (self, s);
+  GstPlayer *self = GST_PLAYER (user_data);
+  GstObject *src = GST_MESSAGE_SRC (msg);
+  GstFormat format;
+  guint64 processed, dropped;
+  gint64 jitter;
+  gdouble proportion;
+
+  /* Only the video sink knows how many frames were actually shown */
+  if (!GST_IS_ELEMENT (src) || !element_is_video (GST_ELEMENT (src), "Sink"))
+    return;
+
+  gst_message_parse_qos_values (msg, &jitter, &proportion, NULL);
+  gst_message_parse_qos_stats (msg, &format, &processed, &dropped);
+  GST_LOG_OBJECT (self, "QoS jitter %" G_GINT64_FORMAT " processed %"
+      G_GUINT64_FORMAT " dropped %" G_GUINT64_FORMAT, jitter, processed,
+      dropped);
+
+  stats_begin_write (self);
+  self->stats.jitter = jitter;
+  if (format == GST_FORMAT_BUFFERS && processed != G_MAXUINT64)
+    self->stats.frames_rendered = processed;
+  if (format == GST_FORMAT_BUFFERS && dropped != G_MAXUINT64)
+    self->stats.frames_dropped = dropped;
+  stats_end_write (self);
+
+  degradation_handle_qos (self, jitter, proportion);
 }
 
-static gchar *
-stream_info_get_codec (GstPlayerStreamInfo * s)
+static GstPadProbeReturn
+source_data_probe_cb (GstPad * pad, GstPadProbeInfo * info,
+    gpointer user_data)
 {
-  const gchar *type;
-  GstTagList *tags;
-  gchar *codec = NULL;
+  GstPlayer *self = GST_PLAYER (user_data);
+  gsize size = 0;
 
-  if (GST_IS_PLAYER_VIDEO_INFO (s))
-    type = GST_TAG_VIDEO_CODEC;
-  else if (GST_IS_PLAYER_AUDIO_INFO (s))
-    type = GST_TAG_AUDIO_CODEC;
-  else
-    type = GST_TAG_SUBTITLE_CODEC;
+  if (GST_PAD_PROBE_INFO_TYPE (info) & GST_PAD_PROBE_TYPE_BUFFER) {
+    size = gst_buffer_get_size (GST_PAD_PROBE_INFO_BUFFER (info));
+  } else {
+    GstBufferList *list = GST_PAD_PROBE_INFO_BUFFER_LIST (info);
+    guint i;
 
-  tags = gst_player_stream_info_get_tags (s);
-  if (tags) {
-    gst_tag_list_get_string (tags, type, &codec);
-    if (!codec)
-      gst_tag_list_get_string (tags, GST_TAG_CODEC, &codec);
+    for (i = 0; i < gst_buffer_list_length (list); i++)
+      size += gst_buffer_get_size (gst_buffer_list_get (list, i));
   }
 
-  if (!codec) {
-    GstCaps *caps;
-    caps = gst_player_stream_info_get_caps (s);
-    if (caps) {
-      codec = gst_pb_utils_get_codec_description (caps);
-    }
-  }
+  g_mutex_lock (&self->lock);
+  self->bytes_downloaded += size;
+  g_mutex_unlock (&self->lock);
 
-  return codec;
+  return GST_PAD_PROBE_OK;
 }
 
+/* Counts the bytes the source element produces. Sources with dynamic pads
+ * are not counted */
 static void
-gst_player_stream_info_update_tags_and_caps (GstPlayer * self,
-    GstPlayerStreamInfo * s)
+source_setup_cb (GstElement * playbin, GstElement * source, GstPlayer * self)
 {
-  GstTagList *tags;
-  gint stream_index;
+  GstPad *pad;
 
-  stream_index = gst_player_stream_info_get_index (s);
+  pad = gst_element_get_static_pad (source, "src");
+  if (!pad) {
+    GST_DEBUG_OBJECT (self, "Source %s has no static source pad",
+        GST_ELEMENT_NAME (source));
+    return;
+  }
 
-  if (GST_IS_PLAYER_VIDEO_INFO (s))
-    g_signal_emit_by_name (self->playbin, "get-video-tags",
-        stream_index, &tags);
-  else if (GST_IS_PLAYER_AUDIO_INFO (s))
-    g_signal_emit_by_name (self->playbin, "get-audio-tags",
-        stream_index, &tags);
-  else
-    g_signal_emit_by_name (self->playbin, "get-text-tags", stream_index, &tags);
+  gst_pad_add_probe (pad,
+      GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST,
+      source_data_probe_cb, self, NULL);
+  gst_object_unref (pad);
+}
 
-  if (s->tags)
-    gst_tag_list_unref (s->tags);
-  s->tags = tags;
+static void
+emit_audio_levels (GstPlayer * self, GstStructure * levels)
+{
+  if (should_post_event (self, SIGNAL_AUDIO_LEVELS)) {
+    GstPlayerEventData data;
 
-  if (s->caps)
-    gst_caps_unref (s->caps);
-  s->caps = get_caps (self, stream_index, G_OBJECT_TYPE (s));
+    data.levels = levels;
+    post_event (self, SIGNAL_AUDIO_LEVELS, &data);
+  } else {
+    g_signal_emit (self, signals[SIGNAL_AUDIO_LEVELS], 0, levels);
+    gst_structure_free (levels);
+  }
+}
 
-  if (s->codec)
-    g_free (s->codec);
-  s->codec = stream_info_get_codec (s);
+/* The analysis only handles the formats decoders usually output. Others
+ * are not converted, as that would change the played audio, but a warning
+ * is posted if levels were requested */
+static void
+audio_analysis_set_caps (GstPlayer * self, GstPad * pad, GstCaps * caps)
+{
+  GstElement *combiner;
+  GError *err;
+  gchar *str;
+  guint interval;
 
-  GST_DEBUG_OBJECT (self, "%s index: %d tags: %p caps: %p",
-      gst_player_stream_info_get_stream_type (s), stream_index,
-      s->tags, s->caps);
+  if (gst_player_audio_analysis_set_caps (self->audio_analysis, caps))
+    return;
 
-  gst_player_stream_info_update (self, s);
+  g_mutex_lock (&self->lock);
+  interval = self->audio_level_interval;
+  g_mutex_unlock (&self->lock);
+
+  if (interval == 0)
+    return;
+
+  str = gst_caps_to_string (caps);
+  GST_WARNING_OBJECT (self, "No audio levels for unsupported caps %s", str);
+  err = g_error_new (GST_STREAM_ERROR, GST_STREAM_ERROR_FORMAT,
+      "Audio levels are not available for %s", str);
+
+  /* Posted by the combiner, so the message ends up on the bus of the
+   * pipeline the pad belongs to */
+  combiner = gst_pad_get_parent_element (pad);
+  if (combiner) {
+    gst_element_post_message (combiner,
+        gst_message_new_warning (GST_OBJECT (combiner), err,
+            "Only native endian interleaved S16 and F32 audio is analyzed"));
+    gst_object_unref (combiner);
+  }
+
+  g_error_free (err);
+  g_free (str);
+}
+
+static GstPadProbeReturn
+audio_analysis_probe_cb (GstPad * pad, GstPadProbeInfo * info,
+    gpointer user_data)
+{
+  GstPlayer *self = GST_PLAYER (user_data);
+  GstStructure *levels;
+  GstEvent *event;
+
+  if (!(GST_PAD_PROBE_INFO_TYPE (info) & GST_PAD_PROBE_TYPE_BUFFER)) {
+    event = GST_PAD_PROBE_INFO_EVENT (info);
+
+    if (GST_EVENT_TYPE (event) == GST_EVENT_CAPS) {
+      GstCaps *caps;
+
+      gst_event_parse_caps (event, &caps);
+      audio_analysis_set_caps (self, pad, caps);
+    } else if (GST_EVENT_TYPE (event) == GST_EVENT_SEGMENT) {
+      const GstSegment *segment;
+
+      gst_event_parse_segment (event, &segment);
+      gst_player_audio_analysis_set_segment (self->audio_analysis, segment);
+    } else if (GST_EVENT_TYPE (event) == GST_EVENT_FLUSH_STOP) {
+      gst_player_audio_analysis_reset (self->audio_analysis);
+    }
+
+    return GST_PAD_PROBE_OK;
+  }
+
+  levels = gst_player_audio_analysis_process (self->audio_analysis,
+      GST_PAD_PROBE_INFO_BUFFER (info));
+  if (levels)
+    emit_audio_levels (self, levels);
+
+  return GST_PAD_PROBE_OK;
 }
 
+/* Taps the output of the audio stream combiner of @playbin, which only
+ * passes the selected audio track. The probe stays installed while the
+ * analysis is disabled and then only checks a flag per buffer. Called
+ * again whenever the audio streams change, the combiner is only probed
+ * once */
 static void
-gst_player_streams_info_create (GstPlayer * self,
-    GstPlayerMediaInfo * media_info, const gchar * prop, GType type)
+audio_analysis_attach (GstPlayer * self, GstElement * playbin)
 {
-  gint i;
-  gint total = -1;
-  GstPlayerStreamInfo *s;
+  GstPad *pad = NULL, *srcpad = NULL;
+  GstElement *combiner;
+  GstEvent *segment;
+  GstCaps *caps;
+  gboolean attached;
 
-  if (!media_info)
+  g_signal_emit_by_name (playbin, "get-audio-pad", 0, &pad);
+  if (!pad)
     return;
 
-  g_object_get (G_OBJECT (self->playbin), prop, &total, NULL);
+  combiner = gst_pad_get_parent_element (pad);
+  if (combiner) {
+    srcpad = gst_element_get_static_pad (combiner, "src");
+    gst_object_unref (combiner);
+  }
+  gst_object_unref (pad);
 
-  GST_DEBUG_OBJECT (self, "%s: %d", prop, total);
+  if (!srcpad)
+    return;
 
-  for (i = 0; i < total; i++) {
-    /* check if stream already exist in the list */
-    s = gst_player_stream_info_find (self, media_info, type, i);
-
-    if (!s) {
-      /* create a new stream info instance */
-      s = gst_player_stream_info_new (i, type);
-
-      /* add the object in stream list */
-      media_info->stream_list = g_list_append (media_info->stream_list, s);
-
-      /* based on type, add the object in its corresponding stream_ list */
-      if (GST_IS_PLAYER_AUDIO_INFO (s))
-        media_info->audio_stream_list = g_list_append
-            (media_info->audio_stream_list, s);
-      else if (GST_IS_PLAYER_VIDEO_INFO (s))
-        media_info->video_stream_list = g_list_append
-            (media_info->video_stream_list, s);
-      else
-        media_info->subtitle_stream_list = g_list_append
-            (media_info->subtitle_stream_list, s);
+  GST_OBJECT_LOCK (srcpad);
+  attached = g_object_get_qdata (G_OBJECT (srcpad), audio_analysis_quark)
+      != NULL;
+  if (!attached)
+    g_object_set_qdata (G_OBJECT (srcpad), audio_analysis_quark, self);
+  GST_OBJECT_UNLOCK (srcpad);
 
-      GST_DEBUG_OBJECT (self, "create %s stream stream_index: %d",
-          gst_player_stream_info_get_stream_type (s), i);
+  if (!attached) {
+    GST_DEBUG_OBJECT (self, "Attaching audio analysis to %" GST_PTR_FORMAT,
+        srcpad);
+
+    /* Data might have passed already, e.g. in a preloaded pipeline */
+    caps = gst_pad_get_current_caps (srcpad);
+    if (caps) {
+      audio_analysis_set_caps (self, srcpad, caps);
+      gst_caps_unref (caps);
     }
+    segment = gst_pad_get_sticky_event (srcpad, GST_EVENT_SEGMENT, 0);
+    if (segment) {
+      const GstSegment *s;
 
-    gst_player_stream_info_update_tags_and_caps (self, s);
+      gst_event_parse_segment (segment, &s);
+      gst_player_audio_analysis_set_segment (self->audio_analysis, s);
+      gst_event_unref (segment);
+    }
+
+    gst_pad_add_probe (srcpad,
+        GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM |
+        GST_PAD_PROBE_TYPE_EVENT_FLUSH, audio_analysis_probe_cb, self, NULL);
+  }
+
+  gst_object_unref (srcpad);
+}
+
+/* Must be called with lock. Returns the URI of the cached copy of the
+ * current URI, or NULL if there is none. In that case the key under which
+ * the running download is cached once complete is remembered */
+static gchar *
+download_cache_lookup_locked (GstPlayer * self)
+{
+  gchar *key, *path, *cached_uri = NULL;
+
+  g_free (self->download_key);
+  self->download_key = NULL;
+
+  if (!self->uri || !self->download_cache_dir
+      || self->buffering_mode != GST_BUFFERING_DOWNLOAD
+      || gst_uri_has_protocol (self->uri, "file"))
+    return NULL;
+
+  key = gst_player_cache_entry_name (self->uri, self->uri_validator,
+      DOWNLOAD_CACHE_SUFFIX);
+  path = g_build_filename (self->download_cache_dir, key, NULL);
+
+  /* The modification time orders the entries for eviction */
+  g_mutex_lock (&download_cache_lock);
+  if (g_file_test (path, G_FILE_TEST_IS_REGULAR) && g_utime (path, NULL) == 0)
+    cached_uri = g_filename_to_uri (path, NULL, NULL);
+  g_mutex_unlock (&download_cache_lock);
+
+  if (cached_uri) {
+    GST_DEBUG_OBJECT (self, "Playing '%s' from cache '%s'", self->uri, path);
+    g_free (key);
+  } else {
+    self->download_key = key;
+  }
+  g_free (path);
+
+  return cached_uri;
+}
+
+/* Moves @file into the cache directory as @tmp, from where it is renamed
+ * into place under download_cache_lock. Copying can take long, so this
+ * must not be called with the lock */
+static gboolean
+download_cache_prepare (const gchar * file, const gchar * tmp)
+{
+  GFile *src, *dest;
+  GError *err = NULL;
+  gboolean ret;
+
+  if (g_rename (file, tmp) == 0)
+    return TRUE;
+
+  /* Temporary files can be on another file system */
+  src = g_file_new_for_path (file);
+  dest = g_file_new_for_path (tmp);
+  ret = g_file_copy (src, dest, G_FILE_COPY_OVERWRITE, NULL, NULL, NULL,
+      &err);
+  if (!ret) {
+    GST_WARNING ("Failed to copy '%s' to '%s': %s", file, tmp, err->message);
+    g_error_free (err);
   }
+  g_object_unref (src);
+  g_object_unref (dest);
+
+  return ret;
 }
 
+/* Moves the file of a complete download into the cache and removes any
+ * other. Must be called once the pipeline released the file, i.e. after
+ * going to READY */
 static void
-video_changed_cb (GObject * object, gpointer user_data)
+download_finish (GstPlayer * self)
+{
+  gchar *file, *key, *dir, *path, *tmp;
+  guint64 max_size;
+  gboolean complete, ret;
+
+  g_mutex_lock (&self->lock);
+  file = self->download_file;
+  key = self->download_file_key;
+  complete = self->download_complete;
+  self->download_file = NULL;
+  self->download_file_key = NULL;
+  self->download_complete = FALSE;
+  dir = g_strdup (self->download_cache_dir);
+  max_size = self->download_cache_size;
+  g_mutex_unlock (&self->lock);
+
+  if (!file)
+    goto done;
+
+  if (complete && dir) {
+    path = g_build_filename (dir, key, NULL);
+    /* Not an entry name, so never evicted or used by other players */
+    tmp = g_strdup_printf ("%s.%p", path, self);
+
+    ret = g_mkdir_with_parents (dir, 0700) == 0
+        && download_cache_prepare (file, tmp);
+    if (ret) {
+      g_mutex_lock (&download_cache_lock);
+      ret = g_rename (tmp, path) == 0;
+      if (ret)
+        gst_player_cache_evict (dir, DOWNLOAD_CACHE_SUFFIX, max_size);
+      g_mutex_unlock (&download_cache_lock);
+    }
+
+    if (ret) {
+      GST_DEBUG_OBJECT (self, "Cached download '%s' as '%s'", file, path);
+    } else {
+      GST_WARNING_OBJECT (self, "Failed to cache download '%s' as '%s'",
+          file, path);
+      g_unlink (tmp);
+    }
+
+    g_free (tmp);
+    g_free (path);
+  }
+
+  g_unlink (file);
+
+done:
+  g_free (file);
+  g_free (key);
+  g_free (dir);
+}
+
+/* Whether @queue has all bytes of the stream in its temporary file */
+static gboolean
+download_is_complete (GstElement * queue, GstPad * sinkpad)
+{
+  GstQuery *query;
+  gint64 total, start, stop;
+  gboolean complete = FALSE;
+
+  if (!gst_pad_peer_query_duration (sinkpad, GST_FORMAT_BYTES, &total)
+      || total <= 0)
+    return FALSE;
+
+  query = gst_query_new_buffering (GST_FORMAT_BYTES);
+  if (gst_element_query (queue, query)
+      && gst_query_get_n_buffering_ranges (query) == 1) {
+    gst_query_parse_nth_buffering_range (query, 0, &start, &stop);
+    complete = start == 0 && stop >= total;
+  }
+  gst_query_unref (query);
+
+  return complete;
+}
+
+static GstPadProbeReturn
+download_event_probe_cb (GstPad * pad, GstPadProbeInfo * info,
+    gpointer user_data)
 {
   GstPlayer *self = GST_PLAYER (user_data);
+  GstElement *queue;
+  gchar *location = NULL;
+  gboolean complete;
+
+  if (GST_EVENT_TYPE (GST_PAD_PROBE_INFO_EVENT (info)) != GST_EVENT_EOS)
+    return GST_PAD_PROBE_OK;
+
+  queue = gst_pad_get_parent_element (pad);
+  if (!queue)
+    return GST_PAD_PROBE_OK;
+
+  g_object_get (queue, "temp-location", &location, NULL);
+  complete = download_is_complete (queue, pad);
+  gst_object_unref (queue);
+
+  GST_DEBUG_OBJECT (self, "Download to '%s' finished, complete: %d",
+      GST_STR_NULL (location), complete);
 
   g_mutex_lock (&self->lock);
-  gst_player_streams_info_create (self, self->media_info,
-      "n-video", GST_TYPE_PLAYER_VIDEO_INFO);
+  if (g_strcmp0 (location, self->download_file) == 0)
+    self->download_complete = complete;
   g_mutex_unlock (&self->lock);
+  g_free (location);
+
+  return GST_PAD_PROBE_OK;
 }
 
+/* In download mode queue2 stores the stream in a temporary file, which
+ * also serves seeks into downloaded ranges. The file is kept once the
+ * queue is shut down and moved into the cache by download_finish() */
 static void
-audio_changed_cb (GObject * object, gpointer user_data)
+download_temp_location_cb (GstObject * playbin, GstObject * prop_object,
+    GParamSpec * pspec, GstPlayer * self)
 {
-  GstPlayer *self = GST_PLAYER (user_data);
+  gchar *location = NULL, *stale;
+  GstPad *pad;
+
+  if (!g_object_class_find_property (G_OBJECT_GET_CLASS (prop_object),
+          "temp-remove"))
+    return;
+
+  g_object_get (prop_object, "temp-location", &location, NULL);
+  if (!location)
+    return;
 
   g_mutex_lock (&self->lock);
-  gst_player_streams_info_create (self, self->media_info,
-      "n-audio", GST_TYPE_PLAYER_AUDIO_INFO);
+  if (!self->download_key) {
+    g_mutex_unlock (&self->lock);
+    g_free (location);
+    return;
+  }
+
+  GST_DEBUG_OBJECT (self, "Downloading to '%s'", location);
+
+  g_object_set (prop_object, "temp-remove", FALSE, NULL);
+  stale = self->download_file;
+  self->download_file = location;
+  g_free (self->download_file_key);
+  self->download_file_key = g_strdup (self->download_key);
+  self->download_complete = FALSE;
   g_mutex_unlock (&self->lock);
+
+  if (stale) {
+    g_unlink (stale);
+    g_free (stale);
+  }
+
+  pad = gst_element_get_static_pad (GST_ELEMENT (prop_object), "sink");
+  if (pad) {
+    gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM,
+        download_event_probe_cb, self, NULL);
+    gst_object_unref (pad);
+  }
+}
+
+static void
+clock_lost_cb (GstBus * bus, GstMessage * msg, gpointer user_data)
+{
+  GstPlayer *self = GST_PLAYER (user_data);
+  GstStateChangeReturn state_ret;
+
+  GST_DEBUG_OBJECT (self, "Clock lost");
+  if (self->target_state >= GST_STATE_PLAYING) {
+    state_ret = gst_element_set_state (self->playbin, GST_STATE_PAUSED);
+    if (state_ret != GST_STATE_CHANGE_FAILURE)
+      state_ret = gst_element_set_state (self->playbin, GST_STATE_PLAYING);
+
+    if (state_ret == GST_STATE_CHANGE_FAILURE)
+      emit_error (self, g_error_new (GST_PLAYER_ERROR, GST_PLAYER_ERROR_FAILED,
+              "Failed to handle clock loss"));
+  }
+}
+
+static void
+check_video_dimensions_changed (GstPlayer * self)
+{
+  GstElement *video_sink;
+  GstPad *video_sink_pad;
+  GstCaps *caps;
+  GstVideoInfo info;
+  gint width = 0, height = 0;
+  gint fps_n = 0, fps_d = 1;
+
+  g_object_get (self->playbin, "video-sink", &video_sink, NULL);
+  if (!video_sink)
+    goto out;
+
+  video_sink_pad = gst_element_get_static_pad (video_sink, "sink");
+  if (!video_sink_pad) {
+    gst_object_unref (video_sink);
+    goto out;
+  }
+
+  caps = gst_pad_get_current_caps (video_sink_pad);
+
+  if (caps) {
+    if (gst_video_info_from_caps (&info, caps)) {
+      info.width = info.width * info.par_n / info.par_d;
+
+      GST_DEBUG_OBJECT (self, "Video dimensions changed: %dx%d", info.width,
+          info.height);
+      width = info.width;
+      height = info.height;
+      fps_n = info.fps_n;
+      fps_d = info.fps_d;
+    }
+
+    gst_caps_unref (caps);
+  }
+  gst_object_unref (video_sink_pad);
+  gst_object_unref (video_sink);
+
+out:
+  self->video_fps_n = fps_n;
+  self->video_fps_d = fps_d;
+
+  if (should_post_event (self, SIGNAL_VIDEO_DIMENSIONS_CHANGED)) {
+    GstPlayerEventData data;
+
+    data.dimensions.width = width;
+    data.dimensions.height = height;
+    post_event (self, SIGNAL_VIDEO_DIMENSIONS_CHANGED, &data);
+  } else {
+    g_signal_emit (self, signals[SIGNAL_VIDEO_DIMENSIONS_CHANGED], 0,
+        width, height);
+  }
+}
+
+static void
+notify_caps_cb (GObject * object, GParamSpec * pspec, gpointer user_data)
+{
+  GstPlayer *self = GST_PLAYER (user_data);
+
+  check_video_dimensions_changed (self);
 }
 
-static void
-subtitle_changed_cb (GObject * object, gpointer user_data)
-{
-  GstPlayer *self = GST_PLAYER (user_data);
+static void
+emit_duration_changed (GstPlayer * self, GstClockTime duration)
+{
+  GST_DEBUG_OBJECT (self, "Duration changed %" GST_TIME_FORMAT,
+      GST_TIME_ARGS (duration));
+
+  position_snapshot_update_duration (self, duration);
+
+  if (should_post_event (self, SIGNAL_DURATION_CHANGED)) {
+    GstPlayerEventData data;
+
+    data.time = duration;
+    post_event (self, SIGNAL_DURATION_CHANGED, &data);
+  } else {
+    g_signal_emit (self, signals[SIGNAL_DURATION_CHANGED], 0, duration);
+    g_object_notify_by_pspec (G_OBJECT (self), param_specs[PROP_DURATION]);
+  }
+}
+
+static void
+state_changed_cb (GstBus * bus, GstMessage * msg, gpointer user_data)
+{
+  GstPlayer *self = GST_PLAYER (user_data);
+  GstState old_state, new_state, pending_state;
+
+  gst_message_parse_state_changed (msg, &old_state, &new_state, &pending_state);
+
+  if (GST_MESSAGE_SRC (msg) == GST_OBJECT (self->playbin)) {
+    gchar *transition_name;
+
+    GST_DEBUG_OBJECT (self, "Changed state old: %s new: %s pending: %s",
+        gst_element_state_get_name (old_state),
+        gst_element_state_get_name (new_state),
+        gst_element_state_get_name (pending_state));
+
+    transition_name = g_strdup_printf ("%s_%s",
+        gst_element_state_get_name (old_state),
+        gst_element_state_get_name (new_state));
+    dump_dot_file (self, transition_name);
+    g_free (transition_name);
+
+    self->current_state = new_state;
+
+    if (old_state == GST_STATE_READY && new_state == GST_STATE_PAUSED
+        && pending_state == GST_STATE_VOID_PENDING) {
+      GstElement *video_sink;
+      GstPad *video_sink_pad;
+      gint64 duration = -1;
+
+      GST_DEBUG_OBJECT (self, "Initial PAUSED - pre-rolled");
+
+      g_mutex_lock (&self->lock);
+      media_info_clear_pending_updates_locked (self);
+      media_info_publish (self, gst_player_media_info_create (self));
+      g_mutex_unlock (&self->lock);
+      emit_media_info_updated_signal (self);
+      media_info_cache_store (self);
+
+      g_object_get (self->playbin, "video-sink", &video_sink, NULL);
+
+      if (video_sink) {
+        video_sink_pad = gst_element_get_static_pad (video_sink, "sink");
+
+        if (video_sink_pad) {
+          g_signal_connect (video_sink_pad, "notify::caps",
+              (GCallback) notify_caps_cb, self);
+          gst_object_unref (video_sink_pad);
+        }
+        gst_object_unref (video_sink);
+      }
+
+      check_video_dimensions_changed (self);
+      gst_element_query_duration (self->playbin, GST_FORMAT_TIME, &duration);
+      emit_duration_changed (self, duration);
+    }
+
+    if (new_state == GST_STATE_PAUSED
+        && pending_state == GST_STATE_VOID_PENDING) {
+      remove_tick_source (self);
+
+      g_mutex_lock (&self->lock);
+      if (self->seek_pending) {
+        self->seek_pending = FALSE;
+
+        if (self->media_info->seekable)
+          seek_latency_record_locked (self,
+              gst_util_get_timestamp () - self->last_seek_time);
+
+        if (!self->media_info->seekable) {
+          GST_DEBUG_OBJECT (self, "Media is not seekable");
+          if (self->seek_source) {
+            g_source_destroy (self->seek_source);
+            g_source_unref (self->seek_source);
+            self->seek_source = NULL;
+          }
+          self->seek_position = GST_CLOCK_TIME_NONE;
+          self->last_seek_time = GST_CLOCK_TIME_NONE;
+        } else if (self->seek_source) {
+          GST_DEBUG_OBJECT (self, "Seek finished but new seek is pending");
+          gst_player_seek_internal_locked (self);
+        } else {
+          GST_DEBUG_OBJECT (self, "Seek finished");
+        }
+      }
+
+      /* Apply a rate that was set before the pipeline was prerolled.
+       * Playing backwards from the beginning starts at the end instead */
+      if (!self->seek_pending && self->seek_position == GST_CLOCK_TIME_NONE
+          && self->rate != self->position_rate && self->media_info->seekable) {
+        GstClockTime start = playback_start_position (self, self->rate);
+
+        self->seek_position = position_snapshot_get (self);
+        if (self->rate < 0.0 && self->seek_position == 0
+            && GST_CLOCK_TIME_IS_VALID (start))
+          self->seek_position = start;
+      }
+
+      if (self->seek_position != GST_CLOCK_TIME_NONE) {
+        GST_DEBUG_OBJECT (self, "Seeking now that we reached PAUSED state");
+        gst_player_seek_internal_locked (self);
+        g_mutex_unlock (&self->lock);
+      } else if (!self->seek_pending) {
+        g_mutex_unlock (&self->lock);
+
+        update_position (self);
+
+        if (self->target_state >= GST_STATE_PLAYING && self->buffering_done) {
+          GstStateChangeReturn state_ret;
+
+          state_ret = gst_element_set_state (self->playbin, GST_STATE_PLAYING);
+          if (state_ret == GST_STATE_CHANGE_FAILURE)
+            emit_error (self, g_error_new (GST_PLAYER_ERROR,
+                    GST_PLAYER_ERROR_FAILED, "Failed to play"));
+        } else if (self->buffering_done) {
+          change_state (self, GST_PLAYER_STATE_PAUSED);
+        }
+      } else {
+        g_mutex_unlock (&self->lock);
+      }
+    } else if (new_state == GST_STATE_PLAYING
+        && pending_state == GST_STATE_VOID_PENDING) {
+
+      /* If no seek is currently pending, add the tick source. This can happen
+       * if we seeked already but the state-change message was still queued up */
+      if (!self->seek_pending) {
+        position_snapshot_sync (self);
+        add_tick_source (self);
+        stats_record_startup (self);
+        change_state (self, GST_PLAYER_STATE_PLAYING);
+      }
+    } else if (new_state == GST_STATE_READY && old_state > GST_STATE_READY) {
+      change_state (self, GST_PLAYER_STATE_STOPPED);
+    } else {
+      /* Otherwise we neither reached PLAYING nor PAUSED, so must
+       * wait for something to happen... i.e. are BUFFERING now */
+      change_state (self, GST_PLAYER_STATE_BUFFERING);
+    }
+  }
+}
+
+static void
+duration_changed_cb (GstBus * bus, GstMessage * msg, gpointer user_data)
+{
+  GstPlayer *self = GST_PLAYER (user_data);
+  gint64 duration;
+
+  if (gst_element_query_duration (self->playbin, GST_FORMAT_TIME, &duration)) {
+    emit_duration_changed (self, duration);
+  }
+}
+
+static void
+latency_cb (GstBus * bus, GstMessage * msg, gpointer user_data)
+{
+  GstPlayer *self = GST_PLAYER (user_data);
+
+  GST_DEBUG_OBJECT (self, "Latency changed");
+
+  gst_bin_recalculate_latency (GST_BIN (self->playbin));
+}
+
+static void
+request_state_cb (GstBus * bus, GstMessage * msg, gpointer user_data)
+{
+  GstPlayer *self = GST_PLAYER (user_data);
+  GstState state;
+  GstStateChangeReturn state_ret;
+
+  gst_message_parse_request_state (msg, &state);
+
+  GST_DEBUG_OBJECT (self, "State %s requested",
+      gst_element_state_get_name (state));
+
+  self->target_state = state;
+  state_ret = gst_element_set_state (self->playbin, state);
+  if (state_ret == GST_STATE_CHANGE_FAILURE)
+    emit_error (self, g_error_new (GST_PLAYER_ERROR, GST_PLAYER_ERROR_FAILED,
+            "Failed to change to requested state %s",
+            gst_element_state_get_name (state)));
+}
+
+static void
+media_info_update (GstPlayer * self, GstPlayerMediaInfo * info)
+{
+  gst_player_media_info_update_from_tags (info);
+
+  GST_DEBUG_OBJECT (self, "title: %s, container: %s "
+      "image_sample: %p", info->title, info->container, info->image_sample);
+}
+
+static void
+tags_cb (GstBus * bus, GstMessage * msg, gpointer user_data)
+{
+  GstPlayer *self = GST_PLAYER (user_data);
+  GstTagList *tags = NULL;
+
+  gst_message_parse_tag (msg, &tags);
+
+  /*
+   * NOTE: Inorder to get global tag you must apply the following patches in
+   * your gstreamer build.
+   *
+   * http://cgit.freedesktop.org/gstreamer/gst-plugins-good/commit/?id=9119fbd774093e3ae762c8652acd80d54b2c3b45
+   * http://cgit.freedesktop.org/gstreamer/gstreamer/commit/?id=18b058100940bdcaed86fa412e3582a02871f995
+   */
+  GST_DEBUG_OBJECT (self, "recieved %s tags",
+      gst_tag_list_get_scope (tags) ==
+      GST_TAG_SCOPE_GLOBAL ? "global" : "stream");
+
+  if (gst_tag_list_get_scope (tags) == GST_TAG_SCOPE_GLOBAL) {
+    g_mutex_lock (&self->lock);
+    /* While switching to the next URI, global tags belong to the next one */
+    if (self->media_info && !self->media_info_cached
+        && !self->switching_uri) {
+      if (self->pending_global_tags)
+        gst_tag_list_unref (self->pending_global_tags);
+      self->pending_global_tags = gst_tag_list_ref (tags);
+      media_info_schedule_update_locked (self);
+      g_mutex_unlock (&self->lock);
+    } else {
+      if (self->global_tags)
+        gst_tag_list_unref (self->global_tags);
+      self->global_tags = gst_tag_list_ref (tags);
+      g_mutex_unlock (&self->lock);
+    }
+  }
+
+  gst_tag_list_unref (tags);
+}
+
+static void
+element_cb (GstBus * bus, GstMessage * msg, gpointer user_data)
+{
+  GstPlayer *self = GST_PLAYER (user_data);
+  const GstStructure *s;
+
+  s = gst_message_get_structure (msg);
+  if (gst_structure_has_name (s, "redirect")) {
+    const gchar *new_location;
+
+    new_location = gst_structure_get_string (s, "new-location");
+    if (!new_location) {
+      const GValue *locations_list, *location_val;
+      guint i, size;
+
+      locations_list = gst_structure_get_value (s, "locations");
+      size = gst_value_list_get_size (locations_list);
+      for (i = 0; i < size; ++i) {
+        const GstStructure *location_s;
+
+        location_val = gst_value_list_get_value (locations_list, i);
+        if (!GST_VALUE_HOLDS_STRUCTURE (location_val))
+          continue;
+
+        location_s = (const GstStructure *) g_value_get_boxed (location_val);
+        if (!gst_structure_has_name (location_s, "redirect"))
+          continue;
+
+        new_location = gst_structure_get_string (location_s, "new-location");
+        if (new_location)
+          break;
+      }
+    }
+
+    if (new_location) {
+      GstState target_state;
+
+      GST_DEBUG_OBJECT (self, "Redirect to '%s'", new_location);
+
+      /* Remember target state and restore after setting the URI */
+      target_state = self->target_state;
+
+      g_mutex_lock (&self->lock);
+      if (self->uri)
+        g_free (self->uri);
+
+      self->uri = g_strdup (new_location);
+      g_mutex_unlock (&self->lock);
+
+      gst_player_set_uri_internal (self);
+
+      if (target_state == GST_STATE_PAUSED)
+        gst_player_pause_internal (self);
+      else if (target_state == GST_STATE_PLAYING)
+        gst_player_play_internal (self);
+    }
+  }
+}
+
+/* Must be called with lock */
+static void
+playbin_set_buffering_locked (GstPlayer * self, GstElement * playbin)
+{
+  guint64 ring_buffer_max_size = 0;
+
+  if (self->buffering_mode == GST_BUFFERING_TIMESHIFT)
+    ring_buffer_max_size = self->buffer_size > 0 ? self->buffer_size :
+        DEFAULT_RING_BUFFER_MAX_SIZE;
+
+  g_object_set (playbin, "buffer-size", self->buffer_size,
+      "buffer-duration", self->buffer_duration,
+      "ring-buffer-max-size", ring_buffer_max_size, NULL);
+}
+
+static void
+player_set_flag (GstPlayer * self, gint pos)
+{
+  GstElement *playbin = playbin_ref (self);
+  gint flags;
+
+  g_object_get (playbin, "flags", &flags, NULL);
+  flags |= pos;
+  g_object_set (playbin, "flags", flags, NULL);
+  gst_object_unref (playbin);
+
+  GST_DEBUG_OBJECT (self, "setting flags=%#x", flags);
+}
+
+static void
+player_clear_flag (GstPlayer * self, gint pos)
+{
+  GstElement *playbin = playbin_ref (self);
+  gint flags;
+
+  g_object_get (playbin, "flags", &flags, NULL);
+  flags &= ~pos;
+  g_object_set (playbin, "flags", flags, NULL);
+  gst_object_unref (playbin);
+
+  GST_DEBUG_OBJECT (self, "setting flags=%#x", flags);
+}
+
+/*
+ * media_info_publish:
+ *
+ * Replaces self->media_info with @info, taking ownership of it. Must be
+ * called with the lock.
+ *
+ * Published media information is never modified again. Updates are done on
+ * a copy (that shares all unchanged streams) which then replaces the
+ * current one, so readers only need to take a reference.
+ */
+static void
+media_info_publish (GstPlayer * self, GstPlayerMediaInfo * info)
+{
+  if (self->media_info)
+    g_object_unref (self->media_info);
+  self->media_info = info;
+  self->media_info_cached = FALSE;
+}
+
+static GstPlayerMediaInfo *
+media_info_ref_current (GstPlayer * self)
+{
+  GstPlayerMediaInfo *info = NULL;
+
+  g_mutex_lock (&self->lock);
+  if (self->media_info)
+    info = g_object_ref (self->media_info);
+  g_mutex_unlock (&self->lock);
+
+  return info;
+}
+
+/*
+ * emit_media_info_updated_signal:
+ *
+ * emits the current self->media_info snapshot to the user application.
+ */
+static void
+emit_media_info_updated_signal (GstPlayer * self)
+{
+  if (self->dispatch_to_main_context) {
+    GstPlayerEventData data;
+
+    data.info = media_info_ref_current (self);
+
+    post_event (self, SIGNAL_MEDIA_INFO_UPDATED, &data);
+  } else {
+    GstPlayerMediaInfo *info = media_info_ref_current (self);
+
+    g_signal_emit (self, signals[SIGNAL_MEDIA_INFO_UPDATED], 0, info);
+    g_object_unref (info);
+  }
+}
+
+static GstCaps *
+get_caps (GstPlayer * self, gint stream_index, GType type)
+{
+  GstPad *pad = NULL;
+  GstCaps *caps = NULL;
+
+  if (type == GST_TYPE_PLAYER_VIDEO_INFO)
+    g_signal_emit_by_name (G_OBJECT (self->playbin),
+        "get-video-pad", stream_index, &pad);
+  else if (type == GST_TYPE_PLAYER_AUDIO_INFO)
+    g_signal_emit_by_name (G_OBJECT (self->playbin),
+        "get-audio-pad", stream_index, &pad);
+  else
+    g_signal_emit_by_name (G_OBJECT (self->playbin),
+        "get-text-pad", stream_index, &pad);
+
+  if (pad) {
+    caps = gst_pad_get_current_caps (pad);
+    gst_object_unref (pad);
+  }
+
+  return caps;
+}
+
+static void
+gst_player_subtitle_info_update (GstPlayer * self,
+    GstPlayerStreamInfo * stream_info)
+{
+  GstPlayerSubtitleInfo *info = (GstPlayerSubtitleInfo *) stream_info;
+
+  if (stream_info->tags) {
+
+    /* free the old language info */
+    if (info->language) {
+      g_free (info->language);
+      info->language = NULL;
+    }
+
+    /* First try to get the language full name from tag, if name is not
+     * available then try language code. If we find the language code
+     * then use gstreamer api to translate code to full name.
+     */
+    gst_tag_list_get_string (stream_info->tags, GST_TAG_LANGUAGE_NAME,
+        &info->language);
+    if (!info->language) {
+      gchar *lang_code = NULL;
+
+      gst_tag_list_get_string (stream_info->tags, GST_TAG_LANGUAGE_CODE,
+          &lang_code);
+      if (lang_code) {
+        info->language = g_strdup (gst_tag_get_language_name (lang_code));
+        g_free (lang_code);
+      }
+    }
+  } else {
+    if (info->language) {
+      g_free (info->language);
+      info->language = NULL;
+    }
+  }
+
+  GST_DEBUG_OBJECT (self, "language=%s", info->language);
+}
+
+static void
+gst_player_video_info_update (GstPlayer * self,
+    GstPlayerStreamInfo * stream_info)
+{
+  GstPlayerVideoInfo *info = (GstPlayerVideoInfo *) stream_info;
+
+  if (stream_info->caps) {
+    GstStructure *s;
+
+    s = gst_caps_get_structure (stream_info->caps, 0);
+    if (s) {
+      gint width, height;
+      gint fps_n, fps_d;
+      gint par_n, par_d;
+
+      if (gst_structure_get_int (s, "width", &width))
+        info->width = width;
+      else
+        info->width = -1;
+
+      if (gst_structure_get_int (s, "height", &height))
+        info->height = height;
+      else
+        info->height = -1;
+
+      if (gst_structure_get_fraction (s, "framerate", &fps_n, &fps_d)) {
+        info->framerate_num = fps_n;
+        info->framerate_denom = fps_d;
+      } else {
+        info->framerate_num = 0;
+        info->framerate_denom = 1;
+      }
+
+
+      if (gst_structure_get_fraction (s, "pixel-aspect-ratio", &par_n, &par_d)) {
+        info->par_num = par_n;
+        info->par_denom = par_d;
+      } else {
+        info->par_num = 1;
+        info->par_denom = 1;
+      }
+    }
+  } else {
+    info->width = info->height = -1;
+    info->par_num = info->par_denom = 1;
+    info->framerate_num = 0;
+    info->framerate_denom = 1;
+  }
+
+  if (stream_info->tags) {
+    guint bitrate, max_bitrate;
+
+    if (gst_tag_list_get_uint (stream_info->tags, GST_TAG_BITRATE, &bitrate))
+      info->bitrate = bitrate;
+    else
+      info->bitrate = -1;
+
+    if (gst_tag_list_get_uint (stream_info->tags, GST_TAG_MAXIMUM_BITRATE,
+            &max_bitrate) || gst_tag_list_get_uint (stream_info->tags,
+            GST_TAG_NOMINAL_BITRATE, &max_bitrate))
+      info->max_bitrate = max_bitrate;
+    else
+      info->max_bitrate = -1;
+  } else {
+    info->bitrate = info->max_bitrate = -1;
+  }
+
+  GST_DEBUG_OBJECT (self, "width=%d height=%d fps=%.2f par=%d:%d "
+      "bitrate=%d max_bitrate=%d", info->width, info->height,
+      (gdouble) info->framerate_num / info->framerate_denom,
+      info->par_num, info->par_denom, info->bitrate, info->max_bitrate);
+}
+
+static void
+gst_player_audio_info_update (GstPlayer * self,
+    GstPlayerStreamInfo * stream_info)
+{
+  GstPlayerAudioInfo *info = (GstPlayerAudioInfo *) stream_info;
+
+  if (stream_info->caps) {
+    GstStructure *s;
+
+    s = gst_caps_get_structure (stream_info->caps, 0);
+    if (s) {
+      gint rate, channels;
+
+      if (gst_structure_get_int (s, "rate", &rate))
+        info->sample_rate = rate;
+      else
+        info->sample_rate = -1;
+
+      if (gst_structure_get_int (s, "channels", &channels))
+        info->channels = channels;
+      else
+        info->channels = 0;
+    }
+  } else {
+    info->sample_rate = -1;
+    info->channels = 0;
+  }
+
+  if (stream_info->tags) {
+    guint bitrate, max_bitrate;
+
+    if (gst_tag_list_get_uint (stream_info->tags, GST_TAG_BITRATE, &bitrate))
+      info->bitrate = bitrate;
+    else
+      info->bitrate = -1;
+
+    if (gst_tag_list_get_uint (stream_info->tags, GST_TAG_MAXIMUM_BITRATE,
+            &max_bitrate) || gst_tag_list_get_uint (stream_info->tags,
+            GST_TAG_NOMINAL_BITRATE, &max_bitrate))
+      info->max_bitrate = max_bitrate;
+    else
+      info->max_bitrate = -1;
+
+    /* if we have old language the free it */
+    if (info->language) {
+      g_free (info->language);
+      info->language = NULL;
+    }
+
+    /* First try to get the language full name from tag, if name is not
+     * available then try language code. If we find the language code
+     * then use gstreamer api to translate code to full name.
+     */
+    gst_tag_list_get_string (stream_info->tags, GST_TAG_LANGUAGE_NAME,
+        &info->language);
+    if (!info->language) {
+      gchar *lang_code = NULL;
+
+      gst_tag_list_get_string (stream_info->tags, GST_TAG_LANGUAGE_CODE,
+          &lang_code);
+      if (lang_code) {
+        info->language = g_strdup (gst_tag_get_language_name (lang_code));
+        g_free (lang_code);
+      }
+    }
+  } else {
+    if (info->language) {
+      g_free (info->language);
+      info->language = NULL;
+    }
+    info->max_bitrate = info->bitrate = -1;
+  }
+
+  GST_DEBUG_OBJECT (self, "language=%s rate=%d channels=%d bitrate=%d "
+      "max_bitrate=%d", info->language, info->sample_rate, info->channels,
+      info->bitrate, info->bitrate);
+}
+
+static GstPlayerStreamInfo *
+gst_player_stream_info_find (GstPlayer * self, GstPlayerMediaInfo * media_info,
+    GType type, gint stream_index)
+{
+  if (!media_info)
+    return NULL;
+
+  return gst_player_media_info_get_stream (media_info, type, stream_index);
+}
+
+static gboolean
+is_track_enabled (GstPlayer * self, gint pos)
+{
+  GstElement *playbin = playbin_ref (self);
+  gint flags;
+
+  g_object_get (G_OBJECT (playbin), "flags", &flags, NULL);
+  gst_object_unref (playbin);
+
+  if ((flags & pos))
+    return TRUE;
+
+  return FALSE;
+}
+
+static GstPlayerStreamInfo *
+gst_player_stream_info_get_current (GstPlayer * self, const gchar * prop,
+    GType type)
+{
+  GstElement *playbin;
+  gint current;
+  GstPlayerStreamInfo *info;
+
+  if (!self->media_info)
+    return NULL;
+
+  playbin = playbin_ref (self);
+  g_object_get (G_OBJECT (playbin), prop, &current, NULL);
+  gst_object_unref (playbin);
+  g_mutex_lock (&self->lock);
+  info = gst_player_stream_info_find (self, self->media_info, type, current);
+  if (info)
+    g_object_ref (info);
+  g_mutex_unlock (&self->lock);
+
+  return info;
+}
+
+static void
+gst_player_stream_info_update (GstPlayer * self, GstPlayerStreamInfo * s)
+{
+  if (GST_IS_PLAYER_VIDEO_INFO (s))
+    gst_player_video_info_update (self, s);
+  else if (GST_IS_PLAYER_AUDIO_INFO (s))
+    gst_player_audio_info_update (self, s);
+  else
+    gst_player_subtitle_info_update (self, s);
+}
+
+static gchar *
+stream_info_get_codec (GstPlayerStreamInfo * s)
+{
+  const gchar *type;
+  GstTagList *tags;
+  gchar *codec = NULL;
+
+  if (GST_IS_PLAYER_VIDEO_INFO (s))
+    type = GST_TAG_VIDEO_CODEC;
+  else if (GST_IS_PLAYER_AUDIO_INFO (s))
+    type = GST_TAG_AUDIO_CODEC;
+  else
+    type = GST_TAG_SUBTITLE_CODEC;
+
+  tags = gst_player_stream_info_get_tags (s);
+  if (tags) {
+    gst_tag_list_get_string (tags, type, &codec);
+    if (!codec)
+      gst_tag_list_get_string (tags, GST_TAG_CODEC, &codec);
+  }
+
+  if (!codec) {
+    GstCaps *caps;
+    caps = gst_player_stream_info_get_caps (s);
+    if (caps) {
+      codec = gst_pb_utils_get_codec_description (caps);
+    }
+  }
+
+  return codec;
+}
+
+static void
+gst_player_stream_info_update_tags_and_caps (GstPlayer * self,
+    GstPlayerStreamInfo * s)
+{
+  GstTagList *tags;
+  gint stream_index;
+
+  stream_index = gst_player_stream_info_get_index (s);
+
+  if (GST_IS_PLAYER_VIDEO_INFO (s))
+    g_signal_emit_by_name (self->playbin, "get-video-tags",
+        stream_index, &tags);
+  else if (GST_IS_PLAYER_AUDIO_INFO (s))
+    g_signal_emit_by_name (self->playbin, "get-audio-tags",
+        stream_index, &tags);
+  else
+    g_signal_emit_by_name (self->playbin, "get-text-tags", stream_index, &tags);
+
+  if (s->tags)
+    gst_tag_list_unref (s->tags);
+  s->tags = tags;
+
+  if (s->caps)
+    gst_caps_unref (s->caps);
+  s->caps = get_caps (self, stream_index, G_OBJECT_TYPE (s));
+
+  if (s->codec)
+    g_free (s->codec);
+  s->codec = stream_info_get_codec (s);
+
+  GST_DEBUG_OBJECT (self, "%s index: %d tags: %p caps: %p",
+      gst_player_stream_info_get_stream_type (s), stream_index,
+      s->tags, s->caps);
+
+  gst_player_stream_info_update (self, s);
+}
+
+static void
+gst_player_streams_info_create (GstPlayer * self,
+    GstPlayerMediaInfo * media_info, const gchar * prop, GType type)
+{
+  gint i;
+  gint total = -1;
+  GstPlayerStreamInfo *s, *old;
+
+  if (!media_info)
+    return;
+
+  g_object_get (G_OBJECT (self->playbin), prop, &total, NULL);
+
+  GST_DEBUG_OBJECT (self, "%s: %d", prop, total);
+
+  for (i = 0; i < total; i++) {
+    /* check if stream already exist in the list */
+    old = gst_player_stream_info_find (self, media_info, type, i);
+
+    /* create a new stream info instance, existing ones might be shared with
+     * previously published media information and are replaced instead */
+    s = gst_player_stream_info_new (i, type);
+    gst_player_stream_info_update_tags_and_caps (self, s);
+
+    if (!old)
+      GST_DEBUG_OBJECT (self, "create %s stream stream_index: %d",
+          gst_player_stream_info_get_stream_type (s), i);
+
+    gst_player_media_info_set_stream (media_info, s);
+  }
+}
+
+static void
+streams_changed (GstPlayer * self, const gchar * prop, GType type)
+{
+  GstPlayerMediaInfo *info;
+
+  g_mutex_lock (&self->lock);
+  if (self->media_info && !self->media_info_cached) {
+    info = gst_player_media_info_copy (self->media_info);
+    gst_player_streams_info_create (self, info, prop, type);
+    media_info_publish (self, info);
+  }
+  g_mutex_unlock (&self->lock);
+}
+
+static void
+video_changed_cb (GObject * object, gpointer user_data)
+{
+  streams_changed (GST_PLAYER (user_data), "n-video",
+      GST_TYPE_PLAYER_VIDEO_INFO);
+}
+
+static void
+audio_changed_cb (GObject * object, gpointer user_data)
+{
+  audio_analysis_attach (GST_PLAYER (user_data), GST_ELEMENT (object));
+  streams_changed (GST_PLAYER (user_data), "n-audio",
+      GST_TYPE_PLAYER_AUDIO_INFO);
+}
+
+static void
+subtitle_changed_cb (GObject * object, gpointer user_data)
+{
+  streams_changed (GST_PLAYER (user_data), "n-text",
+      GST_TYPE_PLAYER_SUBTITLE_INFO);
+}
+
+static GstPlayerMediaInfo *
+gst_player_media_info_create (GstPlayer * self)
+{
+  GstPlayerMediaInfo *media_info;
+  GstQuery *query;
+
+  GST_DEBUG_OBJECT (self, "begin");
+  media_info = gst_player_media_info_new (self->uri);
+  media_info->duration = gst_player_get_duration (self);
+  media_info->tags = self->global_tags;
+  self->global_tags = NULL;
+
+  query = gst_query_new_seeking (GST_FORMAT_TIME);
+  if (gst_element_query (self->playbin, query))
+    gst_query_parse_seeking (query, NULL, &media_info->seekable, NULL, NULL);
+  gst_query_unref (query);
+
+  /* create audio/video/sub streams */
+  gst_player_streams_info_create (self, media_info, "n-video",
+      GST_TYPE_PLAYER_VIDEO_INFO);
+  gst_player_streams_info_create (self, media_info, "n-audio",
+      GST_TYPE_PLAYER_AUDIO_INFO);
+  gst_player_streams_info_create (self, media_info, "n-text",
+      GST_TYPE_PLAYER_SUBTITLE_INFO);
+
+  gst_player_media_info_update_from_tags (media_info);
+
+  GST_DEBUG_OBJECT (self, "uri: %s title: %s duration: %" GST_TIME_FORMAT
+      " seekable: %s container: %s image_sample %p",
+      media_info->uri, media_info->title, GST_TIME_ARGS (media_info->duration),
+      media_info->seekable ? "yes" : "no", media_info->container,
+      media_info->image_sample);
+
+  GST_DEBUG_OBJECT (self, "end");
+  return media_info;
+}
+
+/*
+ * media_info_schedule_update_locked:
+ *
+ * Tag and caps changes are not applied immediately but collected and
+ * merged into a single new media info snapshot, which is then announced
+ * with a single media-info-updated signal. This happens once per main loop
+ * iteration or after media-info-update-interval milliseconds.
+ *
+ * Must be called with the lock.
+ */
+static void
+media_info_schedule_update_locked (GstPlayer * self)
+{
+  self->n_pending_updates++;
+
+  if (self->media_info_update_source)
+    return;
+
+  if (self->media_info_update_interval == 0)
+    self->media_info_update_source = g_idle_source_new ();
+  else
+    self->media_info_update_source =
+        g_timeout_source_new (self->media_info_update_interval);
+  g_source_set_callback (self->media_info_update_source,
+      media_info_update_cb, self, NULL);
+  g_source_attach (self->media_info_update_source, self->context);
+}
+
+/* Must be called with the lock */
+static void
+media_info_clear_pending_updates_locked (GstPlayer * self)
+{
+  if (self->media_info_update_source) {
+    g_source_destroy (self->media_info_update_source);
+    g_source_unref (self->media_info_update_source);
+    self->media_info_update_source = NULL;
+  }
+
+  g_array_set_size (self->pending_streams, 0);
+  if (self->pending_global_tags) {
+    gst_tag_list_unref (self->pending_global_tags);
+    self->pending_global_tags = NULL;
+  }
+  self->n_pending_updates = 0;
+}
+
+static gboolean
+media_info_update_cb (gpointer user_data)
+{
+  GstPlayer *self = GST_PLAYER (user_data);
+  GstPlayerMediaInfo *info;
+  guint i;
+
+  g_mutex_lock (&self->lock);
+  g_source_unref (self->media_info_update_source);
+  self->media_info_update_source = NULL;
+
+  if (!self->media_info) {
+    media_info_clear_pending_updates_locked (self);
+    g_mutex_unlock (&self->lock);
+    return G_SOURCE_REMOVE;
+  }
+
+  info = gst_player_media_info_copy (self->media_info);
+
+  for (i = 0; i < self->pending_streams->len; i++) {
+    GstPlayerPendingStream *p =
+        &g_array_index (self->pending_streams, GstPlayerPendingStream, i);
+    GstPlayerStreamInfo *s;
+
+    s = gst_player_stream_info_new (p->stream_index, p->type);
+    gst_player_stream_info_update_tags_and_caps (self, s);
+    gst_player_media_info_set_stream (info, s);
+  }
+
+  if (self->pending_global_tags) {
+    if (info->tags)
+      gst_tag_list_unref (info->tags);
+    info->tags = self->pending_global_tags;
+    self->pending_global_tags = NULL;
+  }
+
+  media_info_update (self, info);
+
+  info->n_merged_updates = self->n_pending_updates;
+  GST_DEBUG_OBJECT (self, "Merged %u tag and caps changes",
+      info->n_merged_updates);
+
+  g_array_set_size (self->pending_streams, 0);
+  self->n_pending_updates = 0;
+
+  media_info_publish (self, info);
+  g_mutex_unlock (&self->lock);
+
+  emit_media_info_updated_signal (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+tags_changed_cb (GstPlayer * self, gint stream_index, GType type)
+{
+  GstPlayerPendingStream p;
+  guint i;
+
+  g_mutex_lock (&self->lock);
+  if (self->media_info_cached
+      || !gst_player_stream_info_find (self, self->media_info, type,
+          stream_index)) {
+    g_mutex_unlock (&self->lock);
+    return;
+  }
+
+  for (i = 0; i < self->pending_streams->len; i++) {
+    GstPlayerPendingStream *pending =
+        &g_array_index (self->pending_streams, GstPlayerPendingStream, i);
+
+    if (pending->type == type && pending->stream_index == stream_index)
+      break;
+  }
+
+  if (i == self->pending_streams->len) {
+    p.type = type;
+    p.stream_index = stream_index;
+    g_array_append_val (self->pending_streams, p);
+  }
+
+  media_info_schedule_update_locked (self);
+  g_mutex_unlock (&self->lock);
+}
+
+static void
+video_tags_changed_cb (GstElement * playbin, gint stream_index,
+    gpointer user_data)
+{
+  tags_changed_cb (GST_PLAYER (user_data), stream_index,
+      GST_TYPE_PLAYER_VIDEO_INFO);
+}
+
+static void
+audio_tags_changed_cb (GstElement * playbin, gint stream_index,
+    gpointer user_data)
+{
+  tags_changed_cb (GST_PLAYER (user_data), stream_index,
+      GST_TYPE_PLAYER_AUDIO_INFO);
+}
+
+static void
+subtitle_tags_changed_cb (GstElement * playbin, gint stream_index,
+    gpointer user_data)
+{
+  tags_changed_cb (GST_PLAYER (user_data), stream_index,
+      GST_TYPE_PLAYER_SUBTITLE_INFO);
+}
+
+static gboolean
+about_to_finish_dispatch_cb (gpointer user_data)
+{
+  GstPlayer *self = GST_PLAYER (user_data);
+
+  if (should_post_event (self, SIGNAL_ABOUT_TO_FINISH)) {
+    post_event (self, SIGNAL_ABOUT_TO_FINISH, NULL);
+  } else {
+    g_signal_emit (self, signals[SIGNAL_ABOUT_TO_FINISH], 0);
+  }
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Called from a streaming thread once playbin has no more data to read for
+ * the current URI. Handing the next URI to playbin from here makes it
+ * preroll the next source while the current one is still draining and
+ * switch over without gap, see stream_start_cb() */
+static void
+about_to_finish_cb (GstElement * playbin, gpointer user_data)
+{
+  GstPlayer *self = GST_PLAYER (user_data);
+
+  g_mutex_lock (&self->lock);
+  if (self->next_uri) {
+    GST_DEBUG_OBJECT (self, "Prerolling next URI '%s'", self->next_uri);
+
+    g_object_set (self->playbin, "uri", self->next_uri, NULL);
+    g_free (self->switching_uri);
+    self->switching_uri = self->next_uri;
+    self->next_uri = NULL;
+    /* Not cached, the download of the next URI can't be told apart */
+    g_free (self->download_key);
+    self->download_key = NULL;
+
+    if (self->global_tags) {
+      gst_tag_list_unref (self->global_tags);
+      self->global_tags = NULL;
+    }
+  }
+  g_mutex_unlock (&self->lock);
+
+  gst_player_invoke (self, about_to_finish_dispatch_cb);
+}
+
+/* The first data of the next URI reached the sinks, so refresh everything
+ * the application knows about the current media without going through
+ * READY */
+static void
+stream_start_cb (GstBus * bus, GstMessage * msg, gpointer user_data)
+{
+  GstPlayer *self = GST_PLAYER (user_data);
+  gint64 duration = -1;
+  gchar *uri;
+
+  g_mutex_lock (&self->lock);
+  uri = self->switching_uri;
+  self->switching_uri = NULL;
+  if (!uri) {
+    g_mutex_unlock (&self->lock);
+    return;
+  }
+
+  GST_DEBUG_OBJECT (self, "Switched to next URI '%s'", uri);
+
+  g_free (self->uri);
+  self->uri = g_strdup (uri);
+  media_info_clear_pending_updates_locked (self);
+  media_info_publish (self, gst_player_media_info_create (self));
+  g_mutex_unlock (&self->lock);
+
+  emit_uri_loaded (self, uri);
+  g_free (uri);
+
+  position_snapshot_sync (self);
+  emit_media_info_updated_signal (self);
+  check_video_dimensions_changed (self);
+  gst_element_query_duration (self->playbin, GST_FORMAT_TIME, &duration);
+  emit_duration_changed (self, duration);
+}
+
+/* Connects to the bus and signals of self->playbin. Messages that were
+ * posted while the pipeline was prerolled in the background are dispatched
+ * once the bus watch is attached */
+static void
+playbin_attach (GstPlayer * self)
+{
+  self->bus = gst_element_get_bus (self->playbin);
+  self->bus_source = gst_bus_create_watch (self->bus);
+  g_source_set_callback (self->bus_source,
+      (GSourceFunc) gst_bus_async_signal_func, NULL, NULL);
+  g_source_attach (self->bus_source, self->context);
+
+  g_signal_connect (G_OBJECT (self->bus), "message::error",
+      G_CALLBACK (error_cb), self);
+  g_signal_connect (G_OBJECT (self->bus), "message::warning",
+      G_CALLBACK (warning_cb), self);
+  g_signal_connect (G_OBJECT (self->bus), "message::eos",
+      G_CALLBACK (eos_cb), self);
+  g_signal_connect (G_OBJECT (self->bus), "message::state-changed",
+      G_CALLBACK (state_changed_cb), self);
+  g_signal_connect (G_OBJECT (self->bus), "message::buffering",
+      G_CALLBACK (buffering_cb), self);
+  g_signal_connect (G_OBJECT (self->bus), "message::clock-lost",
+      G_CALLBACK (clock_lost_cb), self);
+  g_signal_connect (G_OBJECT (self->bus), "message::duration-changed",
+      G_CALLBACK (duration_changed_cb), self);
+  g_signal_connect (G_OBJECT (self->bus), "message::latency",
+      G_CALLBACK (latency_cb), self);
+  g_signal_connect (G_OBJECT (self->bus), "message::request-state",
+      G_CALLBACK (request_state_cb), self);
+  g_signal_connect (G_OBJECT (self->bus), "message::element",
+      G_CALLBACK (element_cb), self);
+  g_signal_connect (G_OBJECT (self->bus), "message::tag",
+      G_CALLBACK (tags_cb), self);
+  g_signal_connect (G_OBJECT (self->bus), "message::stream-start",
+      G_CALLBACK (stream_start_cb), self);
+  g_signal_connect (G_OBJECT (self->bus), "message::qos",
+      G_CALLBACK (qos_cb), self);
+
+  g_signal_connect (self->playbin, "video-changed",
+      G_CALLBACK (video_changed_cb), self);
+  g_signal_connect (self->playbin, "audio-changed",
+      G_CALLBACK (audio_changed_cb), self);
+  g_signal_connect (self->playbin, "text-changed",
+      G_CALLBACK (subtitle_changed_cb), self);
+
+  g_signal_connect (self->playbin, "video-tags-changed",
+      G_CALLBACK (video_tags_changed_cb), self);
+  g_signal_connect (self->playbin, "audio-tags-changed",
+      G_CALLBACK (audio_tags_changed_cb), self);
+  g_signal_connect (self->playbin, "text-tags-changed",
+      G_CALLBACK (subtitle_tags_changed_cb), self);
+
+  g_signal_connect (self->playbin, "about-to-finish",
+      G_CALLBACK (about_to_finish_cb), self);
+  g_signal_connect (self->playbin, "source-setup",
+      G_CALLBACK (source_setup_cb), self);
+  g_signal_connect (self->playbin, "deep-notify::temp-location",
+      G_CALLBACK (download_temp_location_cb), self);
+#if GST_CHECK_VERSION(1,10,0)
+  g_signal_connect (self->playbin, "deep-element-added",
+      G_CALLBACK (deep_element_added_cb), self);
+#endif
+
+  audio_analysis_attach (self, self->playbin);
+}
+
+static void
+playbin_detach (GstPlayer * self)
+{
+  g_source_destroy (self->bus_source);
+  g_source_unref (self->bus_source);
+  self->bus_source = NULL;
+
+  g_signal_handlers_disconnect_by_data (self->bus, self);
+  g_signal_handlers_disconnect_by_data (self->playbin, self);
+  gst_object_unref (self->bus);
+  self->bus = NULL;
+}
+
+/* self->playbin is replaced when activating a preloaded pipeline, so code
+ * not running in the main context has to work on its own reference */
+static GstElement *
+playbin_ref (GstPlayer * self)
+{
+  GstElement *playbin;
+
+  g_mutex_lock (&self->lock);
+  playbin = gst_object_ref (self->playbin);
+  g_mutex_unlock (&self->lock);
+
+  return playbin;
+}
+
+static void
+video_frame_available_cb (GstPlayerVideoFrameSink * sink, gpointer user_data)
+{
+  GstPlayer *self = user_data;
+
+  if (should_post_event (self, SIGNAL_VIDEO_FRAME_AVAILABLE)) {
+    GstPlayerEventData data = { 0, };
+
+    post_event (self, SIGNAL_VIDEO_FRAME_AVAILABLE, &data);
+  } else {
+    g_signal_emit (self, signals[SIGNAL_VIDEO_FRAME_AVAILABLE], 0);
+  }
+}
+
+/* Must be called with lock. The frame sink is kept around once created, so
+ * the dropped frames are counted over the lifetime of the player */
+static void
+video_frame_delivery_configure_locked (GstPlayer * self)
+{
+  if (self->video_frame_delivery && !self->video_frame_sink)
+    self->video_frame_sink =
+        gst_object_ref_sink (gst_player_video_frame_sink_new
+        (video_frame_available_cb, self));
+
+  if (self->video_frame_sink)
+    gst_player_video_frame_sink_configure (GST_PLAYER_VIDEO_FRAME_SINK
+        (self->video_frame_sink), self->video_frame_queue_size,
+        self->video_frame_pool_size);
+}
+
+static void
+gst_player_setup (GstPlayer * self)
+{
+  self->playbin = gst_element_factory_make ("playbin", "playbin");
+  playbin_attach (self);
+
+  self->target_state = GST_STATE_NULL;
+  self->current_state = GST_STATE_NULL;
+  change_state (self, GST_PLAYER_STATE_STOPPED);
+  self->buffering = 100;
+  self->buffering_done = TRUE;
+  self->buffering_time_left = GST_CLOCK_TIME_NONE;
+  self->is_eos = FALSE;
+  self->is_live = FALSE;
+}
+
+/* Must be called from the main context. Removes everything the player
+ * attached to its main context and shuts down the pipeline */
+static void
+gst_player_teardown (GstPlayer * self)
+{
+  GstPlayerStandby *standby;
+
+  playbin_detach (self);
+
+  while ((standby = g_queue_pop_head (&self->standby)))
+    standby_free (standby);
+
+  remove_tick_source (self);
+  remove_ready_timeout_source (self);
+
+  if (self->degradation_source) {
+    g_source_destroy (self->degradation_source);
+    g_source_unref (self->degradation_source);
+    self->degradation_source = NULL;
+  }
+
+  g_source_destroy (self->command_source);
+  g_source_unref (self->command_source);
+  self->command_source = NULL;
+
+  g_mutex_lock (&self->lock);
+  g_queue_clear (&self->commands);
+  g_queue_foreach (&self->preload_requests, (GFunc) g_free, NULL);
+  g_queue_clear (&self->preload_requests);
+
+  media_info_clear_pending_updates_locked (self);
+  if (self->media_info) {
+    g_object_unref (self->media_info);
+    self->media_info = NULL;
+  }
+  self->media_info_cached = FALSE;
+  self->media_info_uncached = FALSE;
+
+  if (self->seek_source) {
+    g_source_destroy (self->seek_source);
+    g_source_unref (self->seek_source);
+  }
+  self->seek_source = NULL;
+  g_mutex_unlock (&self->lock);
+
+  self->target_state = GST_STATE_NULL;
+  self->current_state = GST_STATE_NULL;
+  if (self->playbin) {
+    gst_element_set_state (self->playbin, GST_STATE_NULL);
+    gst_object_unref (self->playbin);
+    self->playbin = NULL;
+  }
+  download_finish (self);
+}
+
+static gboolean
+gst_player_teardown_cb (gpointer user_data)
+{
+  GstPlayer *self = GST_PLAYER (user_data);
+
+  gst_player_teardown (self);
+
+  g_mutex_lock (&self->lock);
+  self->initialized = FALSE;
+  g_cond_signal (&self->cond);
+  g_mutex_unlock (&self->lock);
+
+  return G_SOURCE_REMOVE;
+}
+
+static gpointer
+gst_player_main (gpointer data)
+{
+  GstPlayer *self = GST_PLAYER (data);
+  GSource *source;
+
+  GST_TRACE_OBJECT (self, "Starting main thread");
+
+  g_main_context_push_thread_default (self->context);
+
+  self->loop = g_main_loop_new (self->context, FALSE);
+
+  gst_player_setup (self);
+
+  source = g_idle_source_new ();
+  g_source_set_callback (source, (GSourceFunc) main_loop_running_cb, self,
+      NULL);
+  g_source_attach (source, self->context);
+  g_source_unref (source);
+
+  GST_TRACE_OBJECT (self, "Starting main loop");
+  g_main_loop_run (self->loop);
+  GST_TRACE_OBJECT (self, "Stopped main loop");
+
+  g_main_loop_unref (self->loop);
+  self->loop = NULL;
+
+  gst_player_teardown (self);
+
+  g_main_context_pop_thread_default (self->context);
+  g_main_context_unref (self->context);
+  self->context = NULL;
+
+  GST_TRACE_OBJECT (self, "Stopped main thread");
+
+  return NULL;
+}
+
+static gpointer
+gst_player_init_once (gpointer user_data)
+{
+  gst_init (NULL, NULL);
+
+  GST_DEBUG_CATEGORY_INIT (gst_player_debug, "gst-player", 0, "GstPlayer");
+  gst_player_error_quark ();
+
+  return NULL;
+}
+
+static GOnce init_once = G_ONCE_INIT;
+
+GstPlayer *
+gst_player_new (void)
+{
+  g_once (&init_once, gst_player_init_once, NULL);
+
+  return g_object_new (GST_TYPE_PLAYER, NULL);
+}
+
+/**
+ * gst_player_new_with_executor:
+ * @executor: a #GstPlayerExecutor
+ *
+ * Creates a new #GstPlayer that runs on one of the threads of @executor
+ * instead of its own thread. All callbacks of the returned player are
+ * serialized, but other players might run in between.
+ *
+ * Returns: a new #GstPlayer instance
+ */
+GstPlayer *
+gst_player_new_with_executor (GstPlayerExecutor * executor)
+{
+  g_return_val_if_fail (GST_IS_PLAYER_EXECUTOR (executor), NULL);
+
+  g_once (&init_once, gst_player_init_once, NULL);
+
+  return g_object_new (GST_TYPE_PLAYER, "executor", executor, NULL);
+}
+
+/* Returns where playback at @rate starts, which is the end of the stream
+ * when playing backwards or GST_CLOCK_TIME_NONE if that is not known */
+static GstClockTime
+playback_start_position (GstPlayer * self, gdouble rate)
+{
+  gint64 duration = -1;
+
+  if (rate > 0.0)
+    return 0;
+
+  if (GST_CLOCK_TIME_IS_VALID (self->position_duration))
+    return self->position_duration;
+
+  if (gst_element_query_duration (self->playbin, GST_FORMAT_TIME, &duration)
+      && duration >= 0)
+    return duration;
+
+  return GST_CLOCK_TIME_NONE;
+}
+
+static gboolean
+gst_player_play_internal (gpointer user_data)
+{
+  GstPlayer *self = GST_PLAYER (user_data);
+  GstStateChangeReturn state_ret;
+
+  GST_DEBUG_OBJECT (self, "Play");
+
+  g_mutex_lock (&self->lock);
+  if (!self->uri) {
+    g_mutex_unlock (&self->lock);
+    return G_SOURCE_REMOVE;
+  }
+  g_mutex_unlock (&self->lock);
+
+  remove_ready_timeout_source (self);
+  count_pipeline_start (self);
+  self->target_state = GST_STATE_PLAYING;
+
+  if (self->current_state < GST_STATE_PAUSED) {
+    if (!GST_CLOCK_TIME_IS_VALID (self->startup_time))
+      self->startup_time = gst_util_get_timestamp ();
+    change_state (self, GST_PLAYER_STATE_BUFFERING);
+  }
+
+  if (self->current_state >= GST_STATE_PAUSED && !self->is_eos) {
+    state_ret = gst_element_set_state (self->playbin, GST_STATE_PLAYING);
+  } else {
+    state_ret = gst_element_set_state (self->playbin, GST_STATE_PAUSED);
+  }
+
+  if (state_ret == GST_STATE_CHANGE_NO_PREROLL) {
+    self->is_live = TRUE;
+    GST_DEBUG_OBJECT (self, "Pipeline is live");
+  }
+
+  if (state_ret == GST_STATE_CHANGE_FAILURE) {
+    emit_error (self, g_error_new (GST_PLAYER_ERROR, GST_PLAYER_ERROR_FAILED,
+            "Failed to play"));
+    return G_SOURCE_REMOVE;
+  } else if (state_ret == GST_STATE_CHANGE_NO_PREROLL) {
+    self->is_live = TRUE;
+    GST_DEBUG_OBJECT (self, "Pipeline is live");
+  }
+
+  if (self->is_eos) {
+    gboolean ret;
+    gdouble rate;
+
+    GST_DEBUG_OBJECT (self, "Was EOS, seeking to beginning");
+    self->is_eos = FALSE;
+    g_mutex_lock (&self->lock);
+    rate = self->rate;
+    g_mutex_unlock (&self->lock);
+    ret = playbin_seek (self, playback_start_position (self, rate), rate,
+        GST_SEEK_FLAG_FLUSH);
+    if (!ret) {
+      GST_ERROR_OBJECT (self, "Seek to beginning failed");
+      gst_element_set_state (self->playbin, GST_STATE_READY);
+      gst_player_play_internal (self);
+    }
+  }
+
+  return G_SOURCE_REMOVE;
+}
+
+void
+gst_player_play (GstPlayer * self)
+{
+  g_return_if_fail (GST_IS_PLAYER (self));
+
+  gst_player_invoke (self, gst_player_play_internal);
+}
+
+static gboolean
+gst_player_pause_internal (gpointer user_data)
+{
+  GstPlayer *self = GST_PLAYER (user_data);
+  GstStateChangeReturn state_ret;
+
+  GST_DEBUG_OBJECT (self, "Pause");
+
+  g_mutex_lock (&self->lock);
+  if (!self->uri) {
+    g_mutex_unlock (&self->lock);
+    return G_SOURCE_REMOVE;
+  }
+  g_mutex_unlock (&self->lock);
+
+  update_position (self);
+  position_snapshot_freeze (self);
+  remove_tick_source (self);
+  remove_ready_timeout_source (self);
+  count_pipeline_start (self);
+
+  self->target_state = GST_STATE_PAUSED;
+
+  if (self->current_state < GST_STATE_PAUSED)
+    change_state (self, GST_PLAYER_STATE_BUFFERING);
+
+  state_ret = gst_element_set_state (self->playbin, GST_STATE_PAUSED);
+  if (state_ret == GST_STATE_CHANGE_FAILURE) {
+    emit_error (self, g_error_new (GST_PLAYER_ERROR, GST_PLAYER_ERROR_FAILED,
+            "Failed to pause"));
+    return G_SOURCE_REMOVE;
+  } else if (state_ret == GST_STATE_CHANGE_NO_PREROLL) {
+    self->is_live = TRUE;
+    GST_DEBUG_OBJECT (self, "Pipeline is live");
+  }
+
+  if (self->is_eos) {
+    gboolean ret;
+    gdouble rate;
+
+    GST_DEBUG_OBJECT (self, "Was EOS, seeking to beginning");
+    self->is_eos = FALSE;
+    g_mutex_lock (&self->lock);
+    rate = self->rate;
+    g_mutex_unlock (&self->lock);
+    ret = playbin_seek (self, playback_start_position (self, rate), rate,
+        GST_SEEK_FLAG_FLUSH);
+    if (!ret) {
+      GST_ERROR_OBJECT (self, "Seek to beginning failed");
+      gst_element_set_state (self->playbin, GST_STATE_READY);
+      gst_player_pause_internal (self);
+    }
+  }
+
+  return G_SOURCE_REMOVE;
+}
+
+void
+gst_player_pause (GstPlayer * self)
+{
+  g_return_if_fail (GST_IS_PLAYER (self));
+
+  gst_player_invoke (self, gst_player_pause_internal);
+}
+
+static gboolean
+gst_player_stop_internal (gpointer user_data)
+{
+  GstPlayer *self = GST_PLAYER (user_data);
+
+  GST_DEBUG_OBJECT (self, "Stop");
+
+  update_position (self);
+  remove_tick_source (self);
+
+  add_ready_timeout_source (self);
+
+  self->target_state = GST_STATE_NULL;
+  self->current_state = GST_STATE_READY;
+  self->is_live = FALSE;
+  self->is_eos = FALSE;
+  gst_bus_set_flushing (self->bus, TRUE);
+  gst_element_set_state (self->playbin, GST_STATE_READY);
+  gst_bus_set_flushing (self->bus, FALSE);
+  download_finish (self);
+  position_snapshot_update (self, 0, FALSE);
+  position_snapshot_update_duration (self, GST_CLOCK_TIME_NONE);
+  position_snapshot_update_rate (self, 1.0);
+  self->startup_time = GST_CLOCK_TIME_NONE;
+  stats_stall_end (self);
+  degradation_set_active (self, 0);
+  self->degradation_last_late = GST_CLOCK_TIME_NONE;
+  change_state (self, GST_PLAYER_STATE_STOPPED);
+  self->buffering = 100;
+  self->buffering_done = TRUE;
+  self->buffering_time_left = GST_CLOCK_TIME_NONE;
+  g_mutex_lock (&self->lock);
+  media_info_clear_pending_updates_locked (self);
+  if (self->media_info) {
+    g_object_unref (self->media_info);
+    self->media_info = NULL;
+  }
+  if (self->global_tags) {
+    gst_tag_list_unref (self->global_tags);
+    self->global_tags = NULL;
+  }
+  self->seek_pending = FALSE;
+  if (self->seek_source) {
+    g_source_destroy (self->seek_source);
+    g_source_unref (self->seek_source);
+    self->seek_source = NULL;
+  }
+  self->seek_position = GST_CLOCK_TIME_NONE;
+  self->last_seek_time = GST_CLOCK_TIME_NONE;
+  g_free (self->switching_uri);
+  self->switching_uri = NULL;
+  g_mutex_unlock (&self->lock);
+
+  return G_SOURCE_REMOVE;
+}
+
+void
+gst_player_stop (GstPlayer * self)
+{
+  g_return_if_fail (GST_IS_PLAYER (self));
+
+  gst_player_invoke (self, gst_player_stop_internal);
+}
+
+static void
+standby_bus_free (GstPlayerStandbyBus * data)
+{
+  if (data->global_tags)
+    gst_tag_list_unref (data->global_tags);
+  if (data->buffering)
+    gst_message_unref (data->buffering);
+  g_mutex_clear (&data->lock);
+  g_free (data);
+}
+
+static gboolean
+standby_drop_failed_cb (gpointer user_data)
+{
+  GstPlayer *self = GST_PLAYER (user_data);
+  GstPlayerStandby *standby;
+  GList *l, *next;
+
+  for (l = self->standby.head; l; l = next) {
+    next = l->next;
+    standby = l->data;
+
+    if (g_atomic_int_get (&standby->bus_data->failed)) {
+      GST_WARNING_OBJECT (self, "Failed to preload '%s'", standby->uri);
+      g_queue_delete_link (&self->standby, l);
+      standby_free (standby);
+    }
+  }
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Nobody watches the bus of a standby pipeline, so messages are dropped
+ * instead of piling up. Only the state changes of the playbin are kept as
+ * they bring the application state up to date on activation, and the
+ * last global tags and buffering level are applied then. A pipeline that
+ * posts an error is dropped. Called from streaming threads */
+static GstBusSyncReply
+standby_bus_sync_cb (GstBus * bus, GstMessage * msg, gpointer user_data)
+{
+  GstPlayerStandbyBus *data = user_data;
+  GstTagList *tags;
+
+  switch (GST_MESSAGE_TYPE (msg)) {
+    case GST_MESSAGE_STATE_CHANGED:
+      if (GST_MESSAGE_SRC (msg) == GST_OBJECT (data->playbin))
+        return GST_BUS_PASS;
+      break;
+    case GST_MESSAGE_TAG:
+      gst_message_parse_tag (msg, &tags);
+      if (gst_tag_list_get_scope (tags) == GST_TAG_SCOPE_GLOBAL) {
+        g_mutex_lock (&data->lock);
+        if (data->global_tags)
+          gst_tag_list_unref (data->global_tags);
+        data->global_tags = gst_tag_list_ref (tags);
+        g_mutex_unlock (&data->lock);
+      }
+      gst_tag_list_unref (tags);
+      break;
+    case GST_MESSAGE_BUFFERING:
+      g_mutex_lock (&data->lock);
+      gst_message_replace (&data->buffering, msg);
+      g_mutex_unlock (&data->lock);
+      break;
+    case GST_MESSAGE_ERROR:
+      if (g_atomic_int_compare_and_exchange (&data->failed, FALSE, TRUE))
+        gst_player_invoke (data->player, standby_drop_failed_cb);
+      break;
+    default:
+      break;
+  }
+
+  return GST_BUS_DROP;
+}
+
+static void
+standby_free (GstPlayerStandby * standby)
+{
+  gst_element_set_state (standby->playbin, GST_STATE_NULL);
+  gst_object_unref (standby->playbin);
+  g_free (standby->uri);
+  g_free (standby);
+}
+
+static gint
+standby_compare_uri (gconstpointer a, gconstpointer b)
+{
+  const GstPlayerStandby *standby = a;
+
+  return g_strcmp0 (standby->uri, b);
+}
+
+static void
+standby_add (GstPlayer * self, gchar * uri, guint max_preloaded,
+    guint64 memory_limit)
+{
+  GstPlayerStandby *standby;
+  GstStateChangeReturn state_ret;
+  GstBus *bus;
+  GList *l;
+  gint flags;
+
+  l = g_queue_find_custom (&self->standby, uri, standby_compare_uri);
+  if (l) {
+    GST_DEBUG_OBJECT (self, "'%s' is already preloaded", uri);
+    g_queue_push_tail (&self->standby, l->data);
+    g_queue_delete_link (&self->standby, l);
+    g_free (uri);
+    return;
+  }
+
+  while (self->standby.length > 0 && self->standby.length >= max_preloaded)
+    standby_free (g_queue_pop_head (&self->standby));
+
+  if (max_preloaded == 0) {
+    g_free (uri);
+    return;
+  }
+
+  GST_DEBUG_OBJECT (self, "Preloading '%s'", uri);
+
+  standby = g_new0 (GstPlayerStandby, 1);
+  standby->uri = uri;
+  standby->playbin = gst_element_factory_make ("playbin", "playbin");
+
+  standby->bus_data = g_new0 (GstPlayerStandbyBus, 1);
+  standby->bus_data->player = self;
+  standby->bus_data->playbin = standby->playbin;
+  g_mutex_init (&standby->bus_data->lock);
+  g_object_set_qdata_full (G_OBJECT (standby->playbin), standby_bus_quark,
+      standby->bus_data, (GDestroyNotify) standby_bus_free);
+  bus = gst_element_get_bus (standby->playbin);
+  gst_bus_set_sync_handler (bus, standby_bus_sync_cb, standby->bus_data,
+      NULL);
+  gst_object_unref (bus);
+
+  /* Decode the same kind of streams as the current pipeline */
+  g_object_get (self->playbin, "flags", &flags, NULL);
+  g_object_set (standby->playbin, "uri", uri, "flags", flags, NULL);
+  if (memory_limit > 0)
+    g_object_set (standby->playbin, "buffer-size",
+        (gint) MIN (memory_limit / max_preloaded, G_MAXINT), NULL);
+
+  state_ret = gst_element_set_state (standby->playbin, GST_STATE_PAUSED);
+  if (state_ret == GST_STATE_CHANGE_FAILURE) {
+    GST_WARNING_OBJECT (self, "Failed to preload '%s'", uri);
+    standby_free (standby);
+    return;
+  }
+  standby->is_live = state_ret == GST_STATE_CHANGE_NO_PREROLL;
+
+  g_queue_push_tail (&self->standby, standby);
+}
+
+static gboolean
+gst_player_preload_internal (gpointer user_data)
+{
+  GstPlayer *self = GST_PLAYER (user_data);
+  guint max_preloaded;
+  guint64 memory_limit;
+  gchar *uri;
+
+  g_mutex_lock (&self->lock);
+  max_preloaded = self->max_preloaded;
+  /* A preloaded pipeline would show its frames instead of delivering them,
+   * the frame sink can only be part of one pipeline */
+  if (self->video_frame_delivery)
+    max_preloaded = 0;
+  memory_limit = self->preload_memory_limit;
+  uri = g_queue_pop_head (&self->preload_requests);
+  g_mutex_unlock (&self->lock);
+
+  /* Also applies a lowered max-preloaded without new requests */
+  while (self->standby.length > max_preloaded)
+    standby_free (g_queue_pop_head (&self->standby));
+
+  while (uri) {
+    standby_add (self, uri, max_preloaded, memory_limit);
+
+    g_mutex_lock (&self->lock);
+    uri = g_queue_pop_head (&self->preload_requests);
+    g_mutex_unlock (&self->lock);
+  }
+
+  return G_SOURCE_REMOVE;
+}
+
+/**
+ * gst_player_preload:
+ * @player: #GstPlayer instance
+ * @uri: URI to preload
+ *
+ * Prerolls @uri in a separate pipeline in the background, so that a later
+ * gst_player_activate_preloaded() with the same URI can start playback
+ * without waiting for typefinding, decoder setup and buffering.
+ *
+ * At most #GstPlayer:max-preloaded pipelines are kept. Preloading more URIs
+ * drops the pipeline that was preloaded least recently. Preloading a URI
+ * that is already preloaded only marks it as most recently preloaded.
+ */
+void
+gst_player_preload (GstPlayer * self, const gchar * uri)
+{
+  g_return_if_fail (GST_IS_PLAYER (self));
+  g_return_if_fail (uri != NULL);
+
+  g_mutex_lock (&self->lock);
+  g_queue_push_tail (&self->preload_requests, g_strdup (uri));
+  g_mutex_unlock (&self->lock);
+
+  gst_player_invoke (self, gst_player_preload_internal);
+}
+
+static gboolean
+gst_player_activate_preloaded_internal (gpointer user_data)
+{
+  GstPlayer *self = GST_PLAYER (user_data);
+  GstPlayerStandby *standby;
+  GstElement *old_playbin;
+  GstState target_state, state;
+  GstTagList *global_tags;
+  GstMessage *buffering;
+  GstBus *bus;
+  gdouble volume;
+  gboolean mute, delivery;
+  gint flags, standby_flags;
+  GList *l;
+
+  g_mutex_lock (&self->lock);
+  l = g_queue_find_custom (&self->standby, self->uri, standby_compare_uri);
+  delivery = self->video_frame_delivery;
+  g_mutex_unlock (&self->lock);
+
+  if (!l) {
+    GST_DEBUG_OBJECT (self, "Nothing preloaded, loading URI");
+    return gst_player_set_uri_internal (self);
+  }
+
+  standby = l->data;
+  g_queue_delete_link (&self->standby, l);
+
+  /* A pipeline preloaded before video frame delivery was enabled would
+   * show the frames instead of delivering them */
+  if (delivery || g_atomic_int_get (&standby->bus_data->failed)) {
+    GST_DEBUG_OBJECT (self, "Dropping unusable preloaded pipeline");
+    standby_free (standby);
+    return gst_player_set_uri_internal (self);
+  }
+
+  GST_DEBUG_OBJECT (self, "Activating preloaded '%s'", standby->uri);
+
+  target_state = self->target_state;
+  gst_player_stop_internal (self);
+  playbin_detach (self);
+
+  bus = gst_element_get_bus (standby->playbin);
+  gst_bus_set_sync_handler (bus, NULL, NULL, NULL);
+  gst_object_unref (bus);
+  g_mutex_lock (&standby->bus_data->lock);
+  global_tags = standby->bus_data->global_tags;
+  buffering = standby->bus_data->buffering;
+  standby->bus_data->global_tags = NULL;
+  standby->bus_data->buffering = NULL;
+  g_mutex_unlock (&standby->bus_data->lock);
+
+  g_object_get (standby->playbin, "flags", &standby_flags, NULL);
+
+  /* Swap under the lock so that application threads never see a pipeline
+   * without the current volume and mute settings */
+  g_mutex_lock (&self->lock);
+  old_playbin = self->playbin;
+  g_object_get (old_playbin, "volume", &volume, "mute", &mute,
+      "flags", &flags, NULL);
+  g_object_set (standby->playbin, "volume", volume, "mute", mute, NULL);
+  playbin_set_buffering_locked (self, standby->playbin);
+  self->playbin = standby->playbin;
+  /* The download started during the preroll is not cached */
+  g_free (self->download_key);
+  self->download_key = NULL;
+  if (self->global_tags)
+    gst_tag_list_unref (self->global_tags);
+  self->global_tags = global_tags;
+  g_mutex_unlock (&self->lock);
+
+  gst_element_set_state (old_playbin, GST_STATE_NULL);
+  gst_object_unref (old_playbin);
+
+  if (flags != standby_flags)
+    g_object_set (self->playbin, "flags", flags, NULL);
+  if (self->window_handle)
+    gst_video_overlay_set_window_handle (GST_VIDEO_OVERLAY (self->playbin),
+        self->window_handle);
+
+  playbin_attach (self);
+
+  /* The state change messages of the preroll are still queued on the bus
+   * and bring the application state up to date when dispatched, followed
+   * by the last buffering level */
+  if (buffering)
+    gst_bus_post (self->bus, buffering);
+  gst_element_get_state (self->playbin, &state, NULL, 0);
+  self->current_state = state;
+  self->is_live = standby->is_live;
+
+  emit_uri_loaded (self, standby->uri);
+
+  g_free (standby->uri);
+  g_free (standby);
+
+  if (target_state == GST_STATE_PLAYING)
+    gst_player_play_internal (self);
+  else
+    gst_player_pause_internal (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+/**
+ * gst_player_activate_preloaded:
+ * @player: #GstPlayer instance
+ * @uri: next URI to play
+ *
+ * Sets @uri as the current URI like gst_player_set_uri(). If @uri was
+ * preloaded with gst_player_preload(), the prerolled pipeline replaces the
+ * current one and playback continues immediately if the player was
+ * playing, otherwise the player is paused on the first frame. If nothing
+ * was preloaded for @uri this behaves exactly like gst_player_set_uri().
+ */
+void
+gst_player_activate_preloaded (GstPlayer * self, const gchar * uri)
+{
+  g_return_if_fail (GST_IS_PLAYER (self));
+  g_return_if_fail (uri != NULL);
+
+  g_mutex_lock (&self->lock);
+  g_free (self->uri);
+  self->uri = g_strdup (uri);
+  g_free (self->uri_validator);
+  self->uri_validator = NULL;
+  GST_DEBUG_OBJECT (self, "Set uri=%s", self->uri);
+  g_mutex_unlock (&self->lock);
+
+  gst_player_invoke (self, gst_player_activate_preloaded_internal);
+}
+
+/**
+ * gst_player_get_max_preloaded:
+ * @player: #GstPlayer instance
+ *
+ * Returns: the maximum number of pipelines kept by gst_player_preload()
+ */
+guint
+gst_player_get_max_preloaded (GstPlayer * self)
+{
+  guint val;
+
+  g_return_val_if_fail (GST_IS_PLAYER (self), DEFAULT_MAX_PRELOADED);
+
+  g_object_get (self, "max-preloaded", &val, NULL);
+
+  return val;
+}
+
+/**
+ * gst_player_set_max_preloaded:
+ * @player: #GstPlayer instance
+ * @max_preloaded: maximum number of preloaded pipelines
+ *
+ * Sets how many pipelines gst_player_preload() keeps prerolled at the same
+ * time. Each of them holds decoders and buffered data. 0 disables
+ * preloading and releases all preloaded pipelines.
+ */
+void
+gst_player_set_max_preloaded (GstPlayer * self, guint max_preloaded)
+{
+  g_return_if_fail (GST_IS_PLAYER (self));
+
+  g_object_set (self, "max-preloaded", max_preloaded, NULL);
+}
+
+/**
+ * gst_player_get_preload_memory_limit:
+ * @player: #GstPlayer instance
+ *
+ * Returns: the number of bytes all preloaded pipelines may buffer together,
+ *     or 0 for no limit
+ */
+guint64
+gst_player_get_preload_memory_limit (GstPlayer * self)
+{
+  guint64 val;
+
+  g_return_val_if_fail (GST_IS_PLAYER (self), DEFAULT_PRELOAD_MEMORY_LIMIT);
+
+  g_object_get (self, "preload-memory-limit", &val, NULL);
+
+  return val;
+}
+
+/**
+ * gst_player_set_preload_memory_limit:
+ * @player: #GstPlayer instance
+ * @limit: number of bytes, or 0 for no limit
+ *
+ * Limits how much data pipelines created by gst_player_preload() buffer.
+ * The limit is split evenly between #GstPlayer:max-preloaded pipelines and
+ * applies to pipelines preloaded afterwards.
+ */
+void
+gst_player_set_preload_memory_limit (GstPlayer * self, guint64 limit)
+{
+  g_return_if_fail (GST_IS_PLAYER (self));
+
+  g_object_set (self, "preload-memory-limit", limit, NULL);
+}
+
+static GstSeekFlags
+seek_mode_get_flags (GstPlayerSeekMode mode)
+{
+  switch (mode) {
+    case GST_PLAYER_SEEK_MODE_ACCURATE:
+      return GST_SEEK_FLAG_ACCURATE;
+    case GST_PLAYER_SEEK_MODE_KEY_UNIT:
+      return GST_SEEK_FLAG_KEY_UNIT;
+    case GST_PLAYER_SEEK_MODE_SNAP_BEFORE:
+      return GST_SEEK_FLAG_KEY_UNIT | GST_SEEK_FLAG_SNAP_BEFORE;
+    case GST_PLAYER_SEEK_MODE_SNAP_AFTER:
+      return GST_SEEK_FLAG_KEY_UNIT | GST_SEEK_FLAG_SNAP_AFTER;
+    case GST_PLAYER_SEEK_MODE_SNAP_NEAREST:
+      return GST_SEEK_FLAG_KEY_UNIT | GST_SEEK_FLAG_SNAP_NEAREST;
+    case GST_PLAYER_SEEK_MODE_DEFAULT:
+    default:
+      return GST_SEEK_FLAG_NONE;
+  }
+}
+
+/* Seeks to @position with @rate. For negative rates @position is where
+ * playback starts going backwards */
+static gboolean
+playbin_seek (GstPlayer * self, GstClockTime position, gdouble rate,
+    GstSeekFlags flags)
+{
+  gboolean ret;
+
+  if (ABS (rate) >= TRICKMODE_MIN_RATE
+      || (self->degradation_active & GST_PLAYER_DEGRADATION_FLAG_KEY_UNITS)) {
+#if GST_CHECK_VERSION(1,6,0)
+    flags |= GST_SEEK_FLAG_TRICKMODE | GST_SEEK_FLAG_TRICKMODE_KEY_UNITS |
+        GST_SEEK_FLAG_TRICKMODE_NO_AUDIO;
+#else
+    flags |= GST_SEEK_FLAG_SKIP;
+#endif
+  }
+
+  GST_DEBUG_OBJECT (self, "Seek to %" GST_TIME_FORMAT " with rate %lf",
+      GST_TIME_ARGS (position), rate);
+
+  /* Without a position backwards playback starts from the end */
+  if (rate > 0.0)
+    ret = gst_element_seek (self->playbin, rate, GST_FORMAT_TIME, flags,
+        GST_SEEK_TYPE_SET, position, GST_SEEK_TYPE_SET, GST_CLOCK_TIME_NONE);
+  else if (GST_CLOCK_TIME_IS_VALID (position))
+    ret = gst_element_seek (self->playbin, rate, GST_FORMAT_TIME, flags,
+        GST_SEEK_TYPE_SET, 0, GST_SEEK_TYPE_SET, position);
+  else
+    ret = gst_element_seek (self->playbin, rate, GST_FORMAT_TIME, flags,
+        GST_SEEK_TYPE_SET, 0, GST_SEEK_TYPE_END, 0);
+
+  if (ret)
+    position_snapshot_update_rate (self, rate);
+
+  return ret;
+}
+
+/* Must be called with lock. Remembers how long a seek took to complete and
+ * adapts the seek throttling interval to the average of the recent ones */
+static void
+seek_latency_record_locked (GstPlayer * self, GstClockTime latency)
+{
+  GstClockTime sum = 0;
+  guint i;
+
+  self->seek_latencies[self->seek_latencies_pos] = latency;
+  self->seek_latencies_pos =
+      (self->seek_latencies_pos + 1) % SEEK_LATENCY_HISTORY;
+  if (self->n_seek_latencies < SEEK_LATENCY_HISTORY)
+    self->n_seek_latencies++;
+
+  for (i = 0; i < self->n_seek_latencies; i++)
+    sum += self->seek_latencies[i];
+  self->seek_interval = CLAMP (sum / self->n_seek_latencies,
+      MIN_SEEK_INTERVAL, MAX_SEEK_INTERVAL);
+
+  GST_DEBUG_OBJECT (self, "Seek took %" GST_TIME_FORMAT ", throttling seeks "
+      "to one per %" GST_TIME_FORMAT, GST_TIME_ARGS (latency),
+      GST_TIME_ARGS (self->seek_interval));
+
+  stats_begin_write (self);
+  stats_histogram_add (self->stats.seek_latency_histogram, latency);
+  stats_end_write (self);
+}
+
+/* Must be called with lock from main context, releases lock! */
+static void
+gst_player_seek_internal_locked (GstPlayer * self)
+{
+  GstClockTime position;
+  GstSeekFlags flags;
+  gdouble rate;
+  gboolean ret;
+  GstStateChangeReturn state_ret;
+
+  if (self->seek_source) {
+    g_source_destroy (self->seek_source);
+    g_source_unref (self->seek_source);
+    self->seek_source = NULL;
+  }
+
+  /* Only seek in PAUSED */
+  if (self->current_state < GST_STATE_PAUSED) {
+    return;
+  } else if (self->current_state != GST_STATE_PAUSED) {
+    g_mutex_unlock (&self->lock);
+    state_ret = gst_element_set_state (self->playbin, GST_STATE_PAUSED);
+    if (state_ret == GST_STATE_CHANGE_FAILURE) {
+      emit_error (self, g_error_new (GST_PLAYER_ERROR, GST_PLAYER_ERROR_FAILED,
+              "Failed to seek"));
+      g_mutex_lock (&self->lock);
+      return;
+    }
+    g_mutex_lock (&self->lock);
+    return;
+  }
+
+  self->last_seek_time = gst_util_get_timestamp ();
+  position = self->seek_position;
+  self->seek_position = GST_CLOCK_TIME_NONE;
+  self->seek_pending = TRUE;
+  flags = GST_SEEK_FLAG_FLUSH | seek_mode_get_flags (self->seek_mode);
+  rate = self->rate;
+  g_mutex_unlock (&self->lock);
+
+  remove_tick_source (self);
+  self->is_eos = FALSE;
+
+  ret = playbin_seek (self, position, rate, flags);
+
+  if (!ret)
+    emit_error (self, g_error_new (GST_PLAYER_ERROR, GST_PLAYER_ERROR_FAILED,
+            "Failed to seek to %" GST_TIME_FORMAT, GST_TIME_ARGS (position)));
+  else
+    position_snapshot_update (self, position, FALSE);
+
+  g_mutex_lock (&self->lock);
+}
+
+static gboolean
+gst_player_seek_internal (gpointer user_data)
+{
+  GstPlayer *self = GST_PLAYER (user_data);
+
+  g_mutex_lock (&self->lock);
+  gst_player_seek_internal_locked (self);
+  g_mutex_unlock (&self->lock);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Must be called with lock */
+static void
+gst_player_seek_schedule_locked (GstPlayer * self)
+{
+  /* If there is no seek being dispatch to the main context currently do that,
+   * otherwise we just updated the seek position so that it will be taken by
+   * the seek handler from the main context instead of the old one.
+   */
+  if (!self->seek_source) {
+    GstClockTime now = gst_util_get_timestamp ();
+
+    /* If no seek is pending or it was started more than the seek interval ago
+     * seek immediately, otherwise wait until the interval has passed */
+    if (!self->seek_pending
+        || (now - self->last_seek_time > self->seek_interval)) {
+      self->seek_source = g_idle_source_new ();
+      g_source_set_callback (self->seek_source,
+          (GSourceFunc) gst_player_seek_internal, self, NULL);
+      GST_TRACE_OBJECT (self, "Dispatching seek to position %" GST_TIME_FORMAT,
+          GST_TIME_ARGS (self->seek_position));
+      g_source_attach (self->seek_source, self->context);
+    } else {
+      guint delay =
+          (self->seek_interval - (now - self->last_seek_time)) / GST_MSECOND;
+
+      /* Note that last_seek_time must be set to something at this point and
+       * it must be smaller than the seek interval */
+      self->seek_source = g_timeout_source_new (delay);
+      g_source_set_callback (self->seek_source,
+          (GSourceFunc) gst_player_seek_internal, self, NULL);
+
+      GST_TRACE_OBJECT (self,
+          "Delaying seek to position %" GST_TIME_FORMAT " by %u ms",
+          GST_TIME_ARGS (self->seek_position), delay);
+      g_source_attach (self->seek_source, self->context);
+    }
+  }
+}
+
+/* Must be called with lock. The new rate is applied with a seek to the
+ * current position, or once the pipeline is prerolled */
+static void
+gst_player_set_rate_internal_locked (GstPlayer * self, gdouble rate)
+{
+  GST_DEBUG_OBJECT (self, "Set rate=%lf", rate);
+  self->rate = rate;
+
+  if (!self->media_info || !self->media_info->seekable)
+    return;
+
+  if (self->seek_position == GST_CLOCK_TIME_NONE)
+    self->seek_position = position_snapshot_get (self);
+
+  gst_player_seek_schedule_locked (self);
+}
+
+void
+gst_player_seek (GstPlayer * self, GstClockTime position)
+{
+  g_return_if_fail (GST_IS_PLAYER (self));
+  g_return_if_fail (GST_CLOCK_TIME_IS_VALID (position));
+
+  g_mutex_lock (&self->lock);
+  if (self->media_info && !self->media_info->seekable) {
+    GST_DEBUG_OBJECT (self, "Media is not seekable");
+    g_mutex_unlock (&self->lock);
+    return;
+  }
+
+  self->seek_position = position;
+
+  gst_player_seek_schedule_locked (self);
+  g_mutex_unlock (&self->lock);
+}
+
+gboolean
+gst_player_get_dispatch_to_main_context (GstPlayer * self)
+{
+  gboolean val;
+
+  g_return_val_if_fail (GST_IS_PLAYER (self), FALSE);
+
+  g_object_get (self, "dispatch-to-main-context", &val, NULL);
+
+  return val;
+}
+
+void
+gst_player_set_dispatch_to_main_context (GstPlayer * self, gboolean val)
+{
+  g_return_if_fail (GST_IS_PLAYER (self));
+
+  g_object_set (self, "dispatch-to-main-context", val, NULL);
+}
+
+gchar *
+gst_player_get_uri (GstPlayer * self)
+{
+  gchar *val;
+
+  g_return_val_if_fail (GST_IS_PLAYER (self), NULL);
+
+  g_object_get (self, "uri", &val, NULL);
+
+  return val;
+}
+
+void
+gst_player_set_uri (GstPlayer * self, const gchar * val)
+{
+  g_return_if_fail (GST_IS_PLAYER (self));
+
+  g_object_set (self, "uri", val, NULL);
+}
+
+/* Publishes the cached media information of the current URI right after it
+ * was loaded. It is replaced by the real one after preroll, until then
+ * no updates are applied to it */
+static void
+media_info_cache_lookup (GstPlayer * self)
+{
+  GstPlayerMediaInfoCache *cache = NULL;
+  GstPlayerMediaInfo *info = NULL;
+  gchar *uri = NULL, *validator = NULL;
+  gboolean published = FALSE;
+
+  g_mutex_lock (&self->lock);
+  if (self->media_info_cache && self->uri) {
+    cache = g_object_ref (self->media_info_cache);
+    uri = g_strdup (self->uri);
+    validator = g_strdup (self->uri_validator);
+  }
+  g_mutex_unlock (&self->lock);
+
+  if (!cache)
+    return;
+
+  info = gst_player_media_info_cache_lookup (cache, uri, validator);
+  GST_DEBUG_OBJECT (self, "Media info of '%s' %s", uri,
+      info ? "found in cache" : "not cached");
+
+  g_mutex_lock (&self->lock);
+  if (info && !self->media_info) {
+    media_info_publish (self, info);
+    self->media_info_cached = TRUE;
+    published = TRUE;
+  } else {
+    self->media_info_uncached = TRUE;
+    if (info)
+      g_object_unref (info);
+  }
+  g_mutex_unlock (&self->lock);
+
+  if (published)
+    emit_media_info_updated_signal (self);
+
+  g_object_unref (cache);
+  g_free (uri);
+  g_free (validator);
+}
+
+/* Stores the media information after preroll if it was not cached yet */
+static void
+media_info_cache_store (GstPlayer * self)
+{
+  GstPlayerMediaInfoCache *cache = NULL;
+  GstPlayerMediaInfo *info = NULL;
+  gchar *validator = NULL;
+  GError *err = NULL;
+
+  g_mutex_lock (&self->lock);
+  if (self->media_info_uncached && self->media_info_cache
+      && self->media_info) {
+    cache = g_object_ref (self->media_info_cache);
+    info = g_object_ref (self->media_info);
+    validator = g_strdup (self->uri_validator);
+  }
+  self->media_info_uncached = FALSE;
+  g_mutex_unlock (&self->lock);
+
+  if (!cache)
+    return;
+
+  if (!gst_player_media_info_cache_store (cache, info, validator, &err)) {
+    GST_WARNING_OBJECT (self, "Failed to cache media info: %s",
+        err->message);
+    g_clear_error (&err);
+  }
+
+  g_object_unref (cache);
+  g_object_unref (info);
+  g_free (validator);
+}
+
+/**
+ * gst_player_set_uri_with_validator:
+ * @player: #GstPlayer instance
+ * @uri: the URI to play
+ * @validator: (allow-none): a string that changes whenever the resource
+ *     behind @uri changes, e.g. its ETag or modification date, or %NULL
+ *
+ * Like gst_player_set_uri() but identifies the cached download of @uri,
+ * see gst_player_set_download_cache_dir(), by @uri and @validator. A
+ * different @validator than the one of the cached file downloads the
+ * resource again.
+ */
+void
+gst_player_set_uri_with_validator (GstPlayer * self, const gchar * uri,
+    const gchar * validator)
+{
+  g_return_if_fail (GST_IS_PLAYER (self));
+
+  gst_player_set_uri_full (self, uri, validator);
+  g_object_notify_by_pspec (G_OBJECT (self), param_specs[PROP_URI]);
+}
+
+/**
+ * gst_player_get_next_uri:
+ * @player: #GstPlayer instance
+ *
+ * Returns: (transfer full): the URI that is played after the current one,
+ *     or %NULL. g_free() after usage.
+ */
+gchar *
+gst_player_get_next_uri (GstPlayer * self)
+{
+  gchar *val;
+
+  g_return_val_if_fail (GST_IS_PLAYER (self), NULL);
+
+  g_object_get (self, "next-uri", &val, NULL);
+
+  return val;
+}
+
+/**
+ * gst_player_set_next_uri:
+ * @player: #GstPlayer instance
+ * @uri: (allow-none): next URI, or %NULL to unset it
+ *
+ * Sets the URI to continue with once the current one finished. If it is set
+ * before #GstPlayer::about-to-finish is emitted, the next URI is prerolled
+ * while the current one is still playing and playback continues without
+ * gap and without going through %GST_PLAYER_STATE_STOPPED. Otherwise the
+ * player switches to it after the end of the current stream.
+ *
+ * #GstPlayer::uri-loaded is emitted once the player switched to the next
+ * URI, which also becomes the current #GstPlayer:uri. No
+ * #GstPlayer::end-of-stream is emitted in that case.
+ */
+void
+gst_player_set_next_uri (GstPlayer * self, const gchar * uri)
+{
+  g_return_if_fail (GST_IS_PLAYER (self));
+
+  g_object_set (self, "next-uri", uri, NULL);
+}
+
+/**
+ * gst_player_get_position:
+ * @player: #GstPlayer instance
+ *
+ * The position is interpolated from the pipeline clock and the position
+ * at the last state change, seek or position update, so this does not
+ * query the pipeline and is cheap to call from any thread.
+ *
+ * Returns: the current playback position
+ */
+GstClockTime
+gst_player_get_position (GstPlayer * self)
+{
+  GstClockTime val;
+
+  g_return_val_if_fail (GST_IS_PLAYER (self), GST_CLOCK_TIME_NONE);
+
+  g_object_get (self, "position", &val, NULL);
+
+  return val;
+}
+
+GstClockTime
+gst_player_get_duration (GstPlayer * self)
+{
+  GstClockTime val;
+
+  g_return_val_if_fail (GST_IS_PLAYER (self), GST_CLOCK_TIME_NONE);
+
+  g_object_get (self, "duration", &val, NULL);
+
+  return val;
+}
+
+gdouble
+gst_player_get_volume (GstPlayer * self)
+{
+  gdouble val;
+
+  g_return_val_if_fail (GST_IS_PLAYER (self), 1.0);
+
+  g_object_get (self, "volume", &val, NULL);
+
+  return val;
+}
+
+void
+gst_player_set_volume (GstPlayer * self, gdouble val)
+{
+  g_return_if_fail (GST_IS_PLAYER (self));
+
+  g_object_set (self, "volume", val, NULL);
+}
+
+gboolean
+gst_player_get_mute (GstPlayer * self)
+{
+  gboolean val;
+
+  g_return_val_if_fail (GST_IS_PLAYER (self), FALSE);
+
+  g_object_get (self, "mute", &val, NULL);
+
+  return val;
+}
+
+void
+gst_player_set_mute (GstPlayer * self, gboolean val)
+{
+  g_return_if_fail (GST_IS_PLAYER (self));
+
+  g_object_set (self, "mute", val, NULL);
+}
+
+/**
+ * gst_player_get_window_handle:
+ * @player: #GstPlayer instance
+ *
+ * Returns: (transfer none): The currently set, platform specific window
+ * handle
+ */
+gpointer
+gst_player_get_window_handle (GstPlayer * self)
+{
+  gpointer val;
+
+  g_return_val_if_fail (GST_IS_PLAYER (self), NULL);
+
+  g_object_get (self, "window-handle", &val, NULL);
+
+  return val;
+}
+
+void
+gst_player_set_window_handle (GstPlayer * self, gpointer val)
+{
+  g_return_if_fail (GST_IS_PLAYER (self));
+
+  g_object_set (self, "window-handle", val, NULL);
+}
+
+/**
+ * gst_player_get_pipeline:
+ * @player: #GstPlayer instance
+ *
+ * Returns: (transfer full): The internal playbin instance
+ */
+GstElement *
+gst_player_get_pipeline (GstPlayer * self)
+{
+  GstElement *val;
+
+  g_return_val_if_fail (GST_IS_PLAYER (self), NULL);
+
+  g_object_get (self, "pipeline", &val, NULL);
+
+  return val;
+}
+
+#if GST_CHECK_VERSION(1,6,0)
+/* Must be called with snapshot_lock */
+static void
+snapshot_reset_locked (GstPlayer * self)
+{
+  if (self->snapshot_converter) {
+    gst_video_converter_free (self->snapshot_converter);
+    self->snapshot_converter = NULL;
+  }
+  if (self->snapshot_pool) {
+    gst_buffer_pool_set_active (self->snapshot_pool, FALSE);
+    gst_object_unref (self->snapshot_pool);
+    self->snapshot_pool = NULL;
+  }
+}
+
+/* Must be called with snapshot_lock. Converts @frame to @out_info with the
+ * converter and buffer pool of the previous call if the formats did not
+ * change, so that polling snapshots does not allocate */
+static GstBuffer *
+snapshot_convert_locked (GstPlayer * self, GstVideoFrame * frame,
+    GstVideoInfo * out_info)
+{
+  GstVideoFrame out_frame;
+  GstBuffer *outbuf = NULL;
+  GstStructure *config;
+  GstCaps *caps;
+
+  if (self->snapshot_pool
+      && (!gst_video_info_is_equal (&self->snapshot_in_info, &frame->info)
+          || !gst_video_info_is_equal (&self->snapshot_out_info, out_info))) {
+    GST_DEBUG_OBJECT (self, "Snapshot format changed");
+    snapshot_reset_locked (self);
+  }
+
+  if (!self->snapshot_pool) {
+    self->snapshot_pool = gst_video_buffer_pool_new ();
+    caps = gst_video_info_to_caps (out_info);
+    config = gst_buffer_pool_get_config (self->snapshot_pool);
+    gst_buffer_pool_config_set_params (config, caps, out_info->size, 0, 0);
+    gst_caps_unref (caps);
+    if (!gst_buffer_pool_set_config (self->snapshot_pool, config)
+        || !gst_buffer_pool_set_active (self->snapshot_pool, TRUE)) {
+      GST_WARNING_OBJECT (self, "Failed to configure snapshot buffer pool");
+      snapshot_reset_locked (self);
+      return NULL;
+    }
+
+    self->snapshot_converter = gst_video_converter_new (&frame->info,
+        out_info, NULL);
+    self->snapshot_in_info = frame->info;
+    self->snapshot_out_info = *out_info;
+  }
+
+  if (gst_buffer_pool_acquire_buffer (self->snapshot_pool, &outbuf,
+          NULL) != GST_FLOW_OK)
+    return NULL;
+
+  if (!gst_video_frame_map (&out_frame, out_info, outbuf, GST_MAP_WRITE)) {
+    gst_buffer_unref (outbuf);
+    return NULL;
+  }
+  gst_video_converter_frame (self->snapshot_converter, frame, &out_frame);
+  gst_video_frame_unmap (&out_frame);
+
+  GST_BUFFER_PTS (outbuf) = GST_BUFFER_PTS (frame->buffer);
+  GST_BUFFER_DURATION (outbuf) = GST_BUFFER_DURATION (frame->buffer);
+
+  return outbuf;
+}
+#endif
+
+/**
+ * gst_player_get_video_snapshot:
+ * @player: #GstPlayer instance
+ * @format: the #GstVideoFormat of the snapshot, or
+ *     %GST_VIDEO_FORMAT_UNKNOWN to keep the format of the video sink
+ * @max_width: maximum width of the snapshot, or 0 for no limit
+ * @max_height: maximum height of the snapshot, or 0 for no limit
+ *
+ * Retrieves the frame that is currently shown. Larger frames are scaled
+ * down to fit into @max_width and @max_height, keeping their aspect ratio.
+ *
+ * If neither format nor size change, the returned sample shares the buffer
+ * of the video sink. Otherwise the frame is converted with a converter and
+ * buffer pool that are kept for the next call with the same formats, so
+ * this is cheap enough to be called many times per second.
+ *
+ * Returns: (transfer full): a #GstSample with the current frame, or %NULL
+ *     if no frame was shown yet or it could not be converted
+ */
+GstSample *
+gst_player_get_video_snapshot (GstPlayer * self, GstVideoFormat format,
+    guint max_width, guint max_height)
+{
+  GstElement *playbin;
+  GstSample *sample = NULL, *snapshot = NULL;
+  GstVideoInfo info, out_info;
+  GstCaps *caps;
+  guint width, height;
+
+  g_return_val_if_fail (GST_IS_PLAYER (self), NULL);
+
+  playbin = playbin_ref (self);
+  g_object_get (playbin, "sample", &sample, NULL);
+  gst_object_unref (playbin);
+
+  if (!sample)
+    return NULL;
+
+  caps = gst_sample_get_caps (sample);
+  if (!caps || !gst_sample_get_buffer (sample)
+      || !gst_video_info_from_caps (&info, caps)) {
+    GST_WARNING_OBJECT (self, "Invalid video sample");
+    gst_sample_unref (sample);
+    return NULL;
+  }
+
+  if (format == GST_VIDEO_FORMAT_UNKNOWN)
+    format = GST_VIDEO_INFO_FORMAT (&info);
+
+  width = GST_VIDEO_INFO_WIDTH (&info);
+  height = GST_VIDEO_INFO_HEIGHT (&info);
+  if (max_width && width > max_width) {
+    height = MAX (gst_util_uint64_scale_int (height, max_width, width), 1);
+    width = max_width;
+  }
+  if (max_height && height > max_height) {
+    width = MAX (gst_util_uint64_scale_int (width, max_height, height), 1);
+    height = max_height;
+  }
+
+  if (format == GST_VIDEO_INFO_FORMAT (&info)
+      && width == GST_VIDEO_INFO_WIDTH (&info)
+      && height == GST_VIDEO_INFO_HEIGHT (&info))
+    return sample;
+
+  gst_video_info_set_format (&out_info, format, width, height);
+  out_info.par_n = info.par_n;
+  out_info.par_d = info.par_d;
+  out_info.fps_n = info.fps_n;
+  out_info.fps_d = info.fps_d;
+
+#if GST_CHECK_VERSION(1,6,0)
+  {
+    GstVideoFrame frame;
+    GstBuffer *outbuf = NULL;
+
+    if (gst_video_frame_map (&frame, &info, gst_sample_get_buffer (sample),
+            GST_MAP_READ)) {
+      g_mutex_lock (&self->snapshot_lock);
+      outbuf = snapshot_convert_locked (self, &frame, &out_info);
+      g_mutex_unlock (&self->snapshot_lock);
+      gst_video_frame_unmap (&frame);
+    }
+
+    if (outbuf) {
+      caps = gst_video_info_to_caps (&out_info);
+      snapshot = gst_sample_new (outbuf, caps, NULL, NULL);
+      gst_caps_unref (caps);
+      gst_buffer_unref (outbuf);
+    }
+  }
+#else
+  caps = gst_video_info_to_caps (&out_info);
+  snapshot = gst_video_convert_sample (sample, caps, GST_SECOND, NULL);
+  gst_caps_unref (caps);
+#endif
+
+  if (!snapshot)
+    GST_WARNING_OBJECT (self, "Failed to convert video sample");
+  gst_sample_unref (sample);
 
-  g_mutex_lock (&self->lock);
-  gst_player_streams_info_create (self, self->media_info,
-      "n-text", GST_TYPE_PLAYER_SUBTITLE_INFO);
-  g_mutex_unlock (&self->lock);
+  return snapshot;
 }
 
-static void *
-get_title (GstTagList * tags)
+/**
+ * gst_player_get_video_frame_delivery:
+ * @player: #GstPlayer instance
+ *
+ * Returns: %TRUE if video frames are delivered to the application
+ */
+gboolean
+gst_player_get_video_frame_delivery (GstPlayer * self)
 {
-  gchar *title = NULL;
+  gboolean val;
 
-  gst_tag_list_get_string (tags, GST_TAG_TITLE, &title);
-  if (!title)
-    gst_tag_list_get_string (tags, GST_TAG_TITLE_SORTNAME, &title);
+  g_return_val_if_fail (GST_IS_PLAYER (self), DEFAULT_VIDEO_FRAME_DELIVERY);
 
-  return title;
+  g_object_get (self, "video-frame-delivery", &val, NULL);
+
+  return val;
 }
 
-static void *
-get_container_format (GstTagList * tags)
+/**
+ * gst_player_set_video_frame_delivery:
+ * @player: #GstPlayer instance
+ * @enabled: whether to deliver video frames to the application
+ *
+ * Instead of showing the video in a window, queue the decoded frames for
+ * the application to render them itself with gst_player_pull_video_frame().
+ * #GstPlayer::video-frame-available is emitted whenever a new frame was
+ * queued.
+ *
+ * The video sink is only picked up when a pipeline is built, so this has
+ * to be set before setting the URI. No URIs are preloaded in this mode.
+ */
+void
+gst_player_set_video_frame_delivery (GstPlayer * self, gboolean enabled)
 {
-  gchar *container = NULL;
-
-  gst_tag_list_get_string (tags, GST_TAG_CONTAINER_FORMAT, &container);
-
-  /* TODO: If container is not available then maybe consider
-   * parsing caps or file extension to guess the container format.
-   */
+  g_return_if_fail (GST_IS_PLAYER (self));
 
-  return container;
+  g_object_set (self, "video-frame-delivery", enabled, NULL);
 }
 
-static void *
-get_from_tags (GstPlayer * self, GstPlayerMediaInfo * media_info,
-    void *(*func) (GstTagList *))
+/**
+ * gst_player_get_video_frame_queue_size:
+ * @player: #GstPlayer instance
+ *
+ * Returns: the maximum number of frames waiting for the application
+ */
+guint
+gst_player_get_video_frame_queue_size (GstPlayer * self)
 {
-  GList *l;
-  void *ret = NULL;
+  guint val;
 
-  if (media_info->tags) {
-    ret = func (media_info->tags);
-    if (ret)
-      return ret;
-  }
+  g_return_val_if_fail (GST_IS_PLAYER (self), DEFAULT_VIDEO_FRAME_QUEUE_SIZE);
 
-  /* if global tag does not exit then try video and audio streams */
-  GST_DEBUG_OBJECT (self, "trying video tags");
-  for (l = gst_player_get_video_streams (media_info); l != NULL; l = l->next) {
-    GstTagList *tags;
+  g_object_get (self, "video-frame-queue-size", &val, NULL);
+
+  return val;
+}
 
-    tags = gst_player_stream_info_get_tags ((GstPlayerStreamInfo *) l->data);
-    if (tags)
-      ret = func (tags);
+/**
+ * gst_player_set_video_frame_queue_size:
+ * @player: #GstPlayer instance
+ * @size: maximum number of queued frames, at least 1
+ *
+ * Sets how many frames are kept for the application in
+ * #GstPlayer:video-frame-delivery mode. If the application does not pull
+ * them in time, the oldest frames are dropped so that it always gets the
+ * latest ones. The dropped frames are counted in "delivery-frames-dropped"
+ * of gst_player_get_stats().
+ */
+void
+gst_player_set_video_frame_queue_size (GstPlayer * self, guint size)
+{
+  g_return_if_fail (GST_IS_PLAYER (self));
+  g_return_if_fail (size > 0);
 
-    if (ret)
-      return ret;
-  }
+  g_object_set (self, "video-frame-queue-size", size, NULL);
+}
 
-  GST_DEBUG_OBJECT (self, "trying audio tags");
-  for (l = gst_player_get_audio_streams (media_info); l != NULL; l = l->next) {
-    GstTagList *tags;
+/**
+ * gst_player_get_video_frame_pool_size:
+ * @player: #GstPlayer instance
+ *
+ * Returns: the number of buffers proposed to the decoder, or 0 if the
+ *     decoder decides
+ */
+guint
+gst_player_get_video_frame_pool_size (GstPlayer * self)
+{
+  guint val;
 
-    tags = gst_player_stream_info_get_tags ((GstPlayerStreamInfo *) l->data);
-    if (tags)
-      ret = func (tags);
+  g_return_val_if_fail (GST_IS_PLAYER (self), DEFAULT_VIDEO_FRAME_POOL_SIZE);
 
-    if (ret)
-      return ret;
-  }
+  g_object_get (self, "video-frame-pool-size", &val, NULL);
 
-  GST_DEBUG_OBJECT (self, "failed to get the information from tags");
-  return NULL;
+  return val;
 }
 
-static void *
-get_cover_sample (GstTagList * tags)
+/**
+ * gst_player_set_video_frame_pool_size:
+ * @player: #GstPlayer instance
+ * @size: number of buffers, or 0 to let the decoder decide
+ *
+ * In #GstPlayer:video-frame-delivery mode the decoder is offered a buffer
+ * pool with exactly @size buffers, which the frames are decoded into and
+ * handed to the application without copying. Once all buffers were
+ * allocated no more allocations happen during playback. The pool has to
+ * hold the frames queued for and held by the application plus the frames
+ * the decoder needs as references, otherwise decoding stalls until the
+ * application releases a frame.
+ *
+ * Applies to the next allocation negotiation, e.g. the next URI.
+ */
+void
+gst_player_set_video_frame_pool_size (GstPlayer * self, guint size)
 {
-  GstSample *cover_sample = NULL;
-
-  gst_tag_list_get_sample (tags, GST_TAG_IMAGE, &cover_sample);
-  if (!cover_sample)
-    gst_tag_list_get_sample (tags, GST_TAG_PREVIEW_IMAGE, &cover_sample);
+  g_return_if_fail (GST_IS_PLAYER (self));
 
-  return cover_sample;
+  g_object_set (self, "video-frame-pool-size", size, NULL);
 }
 
-static GstPlayerMediaInfo *
-gst_player_media_info_create (GstPlayer * self)
+/**
+ * gst_player_pull_video_frame:
+ * @player: #GstPlayer instance
+ * @frame: (out caller-allocates): the #GstVideoFrame to map the frame into
+ *
+ * Takes the oldest queued frame in #GstPlayer:video-frame-delivery mode and
+ * maps it for reading into @frame. The frame is not copied, its buffer
+ * returns into the pool once the application called gst_video_frame_unmap()
+ * on @frame, which it has to do as soon as it does not need the frame
+ * anymore.
+ *
+ * Returns: %TRUE if a frame was mapped into @frame, %FALSE if no frame was
+ *     queued
+ */
+gboolean
+gst_player_pull_video_frame (GstPlayer * self, GstVideoFrame * frame)
 {
-  GstPlayerMediaInfo *media_info;
-  GstQuery *query;
+  GstElement *sink = NULL;
+  GstSample *sample;
+  GstVideoInfo info;
+  GstCaps *caps;
+  gboolean ret = FALSE;
 
-  GST_DEBUG_OBJECT (self, "begin");
-  media_info = gst_player_media_info_new (self->uri);
-  media_info->duration = gst_player_get_duration (self);
-  media_info->tags = self->global_tags;
-  self->global_tags = NULL;
+  g_return_val_if_fail (GST_IS_PLAYER (self), FALSE);
+  g_return_val_if_fail (frame != NULL, FALSE);
 
-  query = gst_query_new_seeking (GST_FORMAT_TIME);
-  if (gst_element_query (self->playbin, query))
-    gst_query_parse_seeking (query, NULL, &media_info->seekable, NULL, NULL);
-  gst_query_unref (query);
+  g_mutex_lock (&self->lock);
+  if (self->video_frame_sink)
+    sink = gst_object_ref (self->video_frame_sink);
+  g_mutex_unlock (&self->lock);
 
-  /* create audio/video/sub streams */
-  gst_player_streams_info_create (self, media_info, "n-video",
-      GST_TYPE_PLAYER_VIDEO_INFO);
-  gst_player_streams_info_create (self, media_info, "n-audio",
-      GST_TYPE_PLAYER_AUDIO_INFO);
-  gst_player_streams_info_create (self, media_info, "n-text",
-      GST_TYPE_PLAYER_SUBTITLE_INFO);
+  if (!sink)
+    return FALSE;
 
-  media_info->title = get_from_tags (self, media_info, get_title);
-  media_info->container =
-      get_from_tags (self, media_info, get_container_format);
-  media_info->image_sample = get_from_tags (self, media_info, get_cover_sample);
+  sample = gst_player_video_frame_sink_pull (GST_PLAYER_VIDEO_FRAME_SINK
+      (sink));
+  gst_object_unref (sink);
 
-  GST_DEBUG_OBJECT (self, "uri: %s title: %s duration: %" GST_TIME_FORMAT
-      " seekable: %s container: %s image_sample %p",
-      media_info->uri, media_info->title, GST_TIME_ARGS (media_info->duration),
-      media_info->seekable ? "yes" : "no", media_info->container,
-      media_info->image_sample);
+  if (!sample)
+    return FALSE;
 
-  GST_DEBUG_OBJECT (self, "end");
-  return media_info;
+  /* The mapped frame keeps its own reference to the buffer */
+  caps = gst_sample_get_caps (sample);
+  if (caps && gst_video_info_from_caps (&info, caps))
+    ret = gst_video_frame_map (frame, &info, gst_sample_get_buffer (sample),
+        GST_MAP_READ);
+  if (!ret)
+    GST_WARNING_OBJECT (self, "Failed to map video frame");
+
+  gst_sample_unref (sample);
+
+  return ret;
 }
 
-static void
-tags_changed_cb (GstPlayer * self, gint stream_index, GType type)
+/**
+ * gst_player_get_audio_level_interval:
+ * @player: #GstPlayer instance
+ *
+ * Returns: the interval in milliseconds between two
+ *     #GstPlayer::audio-levels signals, or 0 if disabled
+ */
+guint
+gst_player_get_audio_level_interval (GstPlayer * self)
 {
-  GstPlayerStreamInfo *s;
+  guint val;
 
-  if (!self->media_info)
-    return;
+  g_return_val_if_fail (GST_IS_PLAYER (self), DEFAULT_AUDIO_LEVEL_INTERVAL);
 
-  /* update the stream information */
-  g_mutex_lock (&self->lock);
-  s = gst_player_stream_info_find (self, self->media_info, type, stream_index);
-  gst_player_stream_info_update_tags_and_caps (self, s);
-  g_mutex_unlock (&self->lock);
+  g_object_get (self, "audio-level-interval", &val, NULL);
 
-  emit_media_info_updated_signal (self);
+  return val;
 }
 
-static void
-video_tags_changed_cb (GstElement * playbin, gint stream_index,
-    gpointer user_data)
+/**
+ * gst_player_set_audio_level_interval:
+ * @player: #GstPlayer instance
+ * @interval: interval in milliseconds, or 0 to disable
+ *
+ * Enables the analysis of the played audio. Every @interval milliseconds
+ * of audio #GstPlayer::audio-levels is emitted with a #GstStructure with
+ * these fields:
+ *
+ * - "timestamp" (#guint64): the stream time at the end of the interval,
+ *   audio is analyzed before it is played so this is usually ahead of the
+ *   position
+ * - "peak" and "rms" (#GstValueArray of #gdouble): peak and RMS level of
+ *   each channel in dB relative to full scale
+ * - "spectrum" (#GstValueArray of #gdouble): the level of each band in dB
+ *   if gst_player_set_audio_spectrum_bands() was set
+ *
+ * Levels are not lower than -100 dB. Only native endian interleaved S16
+ * and F32 audio, which is what decoders usually output, is analyzed. For
+ * other formats no signal is emitted and a warning is logged.
+ */
+void
+gst_player_set_audio_level_interval (GstPlayer * self, guint interval)
 {
-  tags_changed_cb (GST_PLAYER (user_data), stream_index,
-      GST_TYPE_PLAYER_VIDEO_INFO);
-}
+  g_return_if_fail (GST_IS_PLAYER (self));
 
-static void
-audio_tags_changed_cb (GstElement * playbin, gint stream_index,
-    gpointer user_data)
-{
-  tags_changed_cb (GST_PLAYER (user_data), stream_index,
-      GST_TYPE_PLAYER_AUDIO_INFO);
+  g_object_set (self, "audio-level-interval", interval, NULL);
 }
 
-static void
-subtitle_tags_changed_cb (GstElement * playbin, gint stream_index,
-    gpointer user_data)
+/**
+ * gst_player_get_audio_spectrum_bands:
+ * @player: #GstPlayer instance
+ *
+ * Returns: the number of spectrum bands in #GstPlayer::audio-levels
+ */
+guint
+gst_player_get_audio_spectrum_bands (GstPlayer * self)
 {
-  tags_changed_cb (GST_PLAYER (user_data), stream_index,
-      GST_TYPE_PLAYER_SUBTITLE_INFO);
-}
+  guint val;
 
-static gpointer
-gst_player_main (gpointer data)
-{
-  GstPlayer *self = GST_PLAYER (data);
-  GstBus *bus;
-  GSource *source;
-  GSource *bus_source;
+  g_return_val_if_fail (GST_IS_PLAYER (self), DEFAULT_AUDIO_SPECTRUM_BANDS);
 
-  GST_TRACE_OBJECT (self, "Starting main thread");
+  g_object_get (self, "audio-spectrum-bands", &val, NULL);
 
-  self->context = g_main_context_new ();
-  g_main_context_push_thread_default (self->context);
+  return val;
+}
 
-  self->loop = g_main_loop_new (self->context, FALSE);
+/**
+ * gst_player_set_audio_spectrum_bands:
+ * @player: #GstPlayer instance
+ * @n_bands: number of bands, or 0 for no spectrum
+ *
+ * Adds the spectrum of the last 1024 samples of each interval, split into
+ * @n_bands logarithmically spaced bands from 20 Hz to half the sample
+ * rate, to #GstPlayer::audio-levels.
+ */
+void
+gst_player_set_audio_spectrum_bands (GstPlayer * self, guint n_bands)
+{
+  g_return_if_fail (GST_IS_PLAYER (self));
 
-  source = g_idle_source_new ();
-  g_source_set_callback (source, (GSourceFunc) main_loop_running_cb, self,
-      NULL);
-  g_source_attach (source, self->context);
-  g_source_unref (source);
+  g_object_set (self, "audio-spectrum-bands", n_bands, NULL);
+}
 
-  self->playbin = gst_element_factory_make ("playbin", "playbin");
+/**
+ * gst_player_get_position_update_interval:
+ * @player: #GstPlayer instance
+ *
+ * Returns: The interval in milliseconds between two position updates while
+ * playing, or 0 if periodic position updates are disabled
+ */
+guint
+gst_player_get_position_update_interval (GstPlayer * self)
+{
+  guint val;
 
-  self->bus = bus = gst_element_get_bus (self->playbin);
-  bus_source = gst_bus_create_watch (bus);
-  g_source_set_callback (bus_source, (GSourceFunc) gst_bus_async_signal_func,
-      NULL, NULL);
-  g_source_attach (bus_source, self->context);
-
-  g_signal_connect (G_OBJECT (bus), "message::error", G_CALLBACK (error_cb),
-      self);
-  g_signal_connect (G_OBJECT (bus), "message::warning", G_CALLBACK (warning_cb),
-      self);
-  g_signal_connect (G_OBJECT (bus), "message::eos", G_CALLBACK (eos_cb), self);
-  g_signal_connect (G_OBJECT (bus), "message::state-changed",
-      G_CALLBACK (state_changed_cb), self);
-  g_signal_connect (G_OBJECT (bus), "message::buffering",
-      G_CALLBACK (buffering_cb), self);
-  g_signal_connect (G_OBJECT (bus), "message::clock-lost",
-      G_CALLBACK (clock_lost_cb), self);
-  g_signal_connect (G_OBJECT (bus), "message::duration-changed",
-      G_CALLBACK (duration_changed_cb), self);
-  g_signal_connect (G_OBJECT (bus), "message::latency",
-      G_CALLBACK (latency_cb), self);
-  g_signal_connect (G_OBJECT (bus), "message::request-state",
-      G_CALLBACK (request_state_cb), self);
-  g_signal_connect (G_OBJECT (bus), "message::element",
-      G_CALLBACK (element_cb), self);
-  g_signal_connect (G_OBJECT (bus), "message::tag", G_CALLBACK (tags_cb), self);
+  g_return_val_if_fail (GST_IS_PLAYER (self),
+      DEFAULT_POSITION_UPDATE_INTERVAL);
 
-  g_signal_connect (self->playbin, "video-changed",
-      G_CALLBACK (video_changed_cb), self);
-  g_signal_connect (self->playbin, "audio-changed",
-      G_CALLBACK (audio_changed_cb), self);
-  g_signal_connect (self->playbin, "text-changed",
-      G_CALLBACK (subtitle_changed_cb), self);
+  g_object_get (self, "position-update-interval", &val, NULL);
 
-  g_signal_connect (self->playbin, "video-tags-changed",
-      G_CALLBACK (video_tags_changed_cb), self);
-  g_signal_connect (self->playbin, "audio-tags-changed",
-      G_CALLBACK (audio_tags_changed_cb), self);
-  g_signal_connect (self->playbin, "text-tags-changed",
-      G_CALLBACK (subtitle_tags_changed_cb), self);
+  return val;
+}
 
-  self->target_state = GST_STATE_NULL;
-  self->current_state = GST_STATE_NULL;
-  change_state (self, GST_PLAYER_STATE_STOPPED);
-  self->buffering = 100;
-  self->is_eos = FALSE;
-  self->is_live = FALSE;
+/**
+ * gst_player_set_position_update_interval:
+ * @player: #GstPlayer instance
+ * @interval: interval in milliseconds
+ *
+ * Sets the interval in milliseconds between two #GstPlayer::position-updated
+ * signals while playing. 0 disables periodic position updates, the position
+ * is then only reported after state changes and seeks.
+ */
+void
+gst_player_set_position_update_interval (GstPlayer * self, guint interval)
+{
+  g_return_if_fail (GST_IS_PLAYER (self));
 
-  GST_TRACE_OBJECT (self, "Starting main loop");
-  g_main_loop_run (self->loop);
-  GST_TRACE_OBJECT (self, "Stopped main loop");
+  g_object_set (self, "position-update-interval", interval, NULL);
+}
 
-  g_main_loop_unref (self->loop);
-  self->loop = NULL;
+/**
+ * gst_player_get_position_update_flags:
+ * @player: #GstPlayer instance
+ *
+ * Returns: The flags controlling how position updates are scheduled
+ */
+GstPlayerPositionUpdateFlags
+gst_player_get_position_update_flags (GstPlayer * self)
+{
+  GstPlayerPositionUpdateFlags val;
 
-  g_source_destroy (bus_source);
-  g_source_unref (bus_source);
-  gst_object_unref (bus);
+  g_return_val_if_fail (GST_IS_PLAYER (self), DEFAULT_POSITION_UPDATE_FLAGS);
 
-  remove_tick_source (self);
-  remove_ready_timeout_source (self);
+  g_object_get (self, "position-update-flags", &val, NULL);
 
-  g_mutex_lock (&self->lock);
-  if (self->media_info) {
-    g_object_unref (self->media_info);
-    self->media_info = NULL;
-  }
+  return val;
+}
 
-  if (self->seek_source)
-    g_source_unref (self->seek_source);
-  self->seek_source = NULL;
-  g_mutex_unlock (&self->lock);
+/**
+ * gst_player_set_position_update_flags:
+ * @player: #GstPlayer instance
+ * @flags: #GstPlayerPositionUpdateFlags
+ *
+ * With %GST_PLAYER_POSITION_UPDATE_FLAG_ADAPTIVE the periodic position
+ * updates are stopped while no handler for the position is connected or
+ * the player is not #GstPlayer:visible. They are resumed by the next state
+ * change or seek, or by setting #GstPlayer:visible again, so handlers
+ * connected during playback should be followed by
+ * gst_player_set_visible(). With
+ * %GST_PLAYER_POSITION_UPDATE_FLAG_FRAME_ALIGNED position updates are
+ * delayed to the next video frame boundary.
+ */
+void
+gst_player_set_position_update_flags (GstPlayer * self,
+    GstPlayerPositionUpdateFlags flags)
+{
+  g_return_if_fail (GST_IS_PLAYER (self));
 
-  g_main_context_pop_thread_default (self->context);
-  g_main_context_unref (self->context);
-  self->context = NULL;
+  g_object_set (self, "position-update-flags", flags, NULL);
+}
 
-  self->target_state = GST_STATE_NULL;
-  self->current_state = GST_STATE_NULL;
-  if (self->playbin) {
-    gst_element_set_state (self->playbin, GST_STATE_NULL);
-    gst_object_unref (self->playbin);
-    self->playbin = NULL;
-  }
+/**
+ * gst_player_get_visible:
+ * @player: #GstPlayer instance
+ *
+ * Returns: %TRUE if the application currently shows the player
+ */
+gboolean
+gst_player_get_visible (GstPlayer * self)
+{
+  gboolean val;
 
-  GST_TRACE_OBJECT (self, "Stopped main thread");
+  g_return_val_if_fail (GST_IS_PLAYER (self), TRUE);
 
-  return NULL;
+  g_object_get (self, "visible", &val, NULL);
+
+  return val;
 }
 
-static gpointer
-gst_player_init_once (gpointer user_data)
+/**
+ * gst_player_set_visible:
+ * @player: #GstPlayer instance
+ * @visible: whether the player is currently shown to the user
+ *
+ * Tells the player whether the application currently shows it, e.g. because
+ * its window was minimized. With %GST_PLAYER_POSITION_UPDATE_FLAG_ADAPTIVE
+ * no periodic position updates happen while not visible.
+ */
+void
+gst_player_set_visible (GstPlayer * self, gboolean visible)
 {
-  gst_init (NULL, NULL);
-
-  GST_DEBUG_CATEGORY_INIT (gst_player_debug, "gst-player", 0, "GstPlayer");
-  gst_player_error_quark ();
+  g_return_if_fail (GST_IS_PLAYER (self));
 
-  return NULL;
+  g_object_set (self, "visible", visible, NULL);
 }
 
-GstPlayer *
-gst_player_new (void)
+/**
+ * gst_player_get_media_info_update_interval:
+ * @player: #GstPlayer instance
+ *
+ * Returns: time in milliseconds during which tag and caps changes are
+ *     merged into a single media info update
+ */
+guint
+gst_player_get_media_info_update_interval (GstPlayer * self)
 {
-  static GOnce once = G_ONCE_INIT;
+  guint val;
 
-  g_once (&once, gst_player_init_once, NULL);
+  g_return_val_if_fail (GST_IS_PLAYER (self),
+      DEFAULT_MEDIA_INFO_UPDATE_INTERVAL);
 
-  return g_object_new (GST_TYPE_PLAYER, NULL);
+  g_object_get (self, "media-info-update-interval", &val, NULL);
+
+  return val;
 }
 
-static gboolean
-gst_player_play_internal (gpointer user_data)
+/**
+ * gst_player_set_media_info_update_interval:
+ * @player: #GstPlayer instance
+ * @interval: time in milliseconds
+ *
+ * Tag and caps changes of the current media are not announced one by one.
+ * Instead all changes that happen within @interval milliseconds are merged
+ * into one new #GstPlayerMediaInfo and announced with a single
+ * #GstPlayer::media-info-updated signal. With 0, changes are merged once per
+ * iteration of the player's main loop.
+ */
+void
+gst_player_set_media_info_update_interval (GstPlayer * self, guint interval)
 {
-  GstPlayer *self = GST_PLAYER (user_data);
-  GstStateChangeReturn state_ret;
-
-  GST_DEBUG_OBJECT (self, "Play");
-
-  g_mutex_lock (&self->lock);
-  if (!self->uri) {
-    g_mutex_unlock (&self->lock);
-    return G_SOURCE_REMOVE;
-  }
-  g_mutex_unlock (&self->lock);
-
-  remove_ready_timeout_source (self);
-  self->target_state = GST_STATE_PLAYING;
+  g_return_if_fail (GST_IS_PLAYER (self));
 
-  if (self->current_state < GST_STATE_PAUSED)
-    change_state (self, GST_PLAYER_STATE_BUFFERING);
+  g_object_set (self, "media-info-update-interval", interval, NULL);
+}
 
-  if (self->current_state >= GST_STATE_PAUSED && !self->is_eos) {
-    state_ret = gst_element_set_state (self->playbin, GST_STATE_PLAYING);
-  } else {
-    state_ret = gst_element_set_state (self->playbin, GST_STATE_PAUSED);
-  }
+/**
+ * gst_player_get_event_stats:
+ * @player: #GstPlayer instance
+ * @coalesced: (out) (allow-none): number of events that were merged into an
+ *     already queued event of the same kind
+ * @overflowed: (out) (allow-none): number of events that did not fit into
+ *     the event queue and were delivered through the slower overflow list
+ *
+ * Retrieves counters about the events that were dispatched to the
+ * application's main context. These are only updated if
+ * #GstPlayer:dispatch-to-main-context is enabled.
+ */
+void
+gst_player_get_event_stats (GstPlayer * self, guint * coalesced,
+    guint * overflowed)
+{
+  g_return_if_fail (GST_IS_PLAYER (self));
 
-  if (state_ret == GST_STATE_CHANGE_NO_PREROLL) {
-    self->is_live = TRUE;
-    GST_DEBUG_OBJECT (self, "Pipeline is live");
-  }
+  if (coalesced)
+    *coalesced = g_atomic_int_get (&self->events_coalesced);
+  if (overflowed)
+    *overflowed = g_atomic_int_get (&self->events_overflowed);
+}
 
-  if (state_ret == GST_STATE_CHANGE_FAILURE) {
-    emit_error (self, g_error_new (GST_PLAYER_ERROR, GST_PLAYER_ERROR_FAILED,
-            "Failed to play"));
-    return G_SOURCE_REMOVE;
-  } else if (state_ret == GST_STATE_CHANGE_NO_PREROLL) {
-    self->is_live = TRUE;
-    GST_DEBUG_OBJECT (self, "Pipeline is live");
-  }
+/**
+ * gst_player_get_idle_timeout:
+ * @player: #GstPlayer instance
+ *
+ * Returns: the time in milliseconds after which a stopped pipeline releases
+ *     its resources, -1 if it never does
+ */
+gint
+gst_player_get_idle_timeout (GstPlayer * self)
+{
+  gint val;
 
-  if (self->is_eos) {
-    gboolean ret;
+  g_return_val_if_fail (GST_IS_PLAYER (self), DEFAULT_IDLE_TIMEOUT);
 
-    GST_DEBUG_OBJECT (self, "Was EOS, seeking to beginning");
-    self->is_eos = FALSE;
-    ret =
-        gst_element_seek_simple (self->playbin, GST_FORMAT_TIME,
-        GST_SEEK_FLAG_FLUSH, 0);
-    if (!ret) {
-      GST_ERROR_OBJECT (self, "Seek to beginning failed");
-      gst_element_set_state (self->playbin, GST_STATE_READY);
-      gst_player_play_internal (self);
-    }
-  }
+  g_object_get (self, "idle-timeout", &val, NULL);
 
-  return G_SOURCE_REMOVE;
+  return val;
 }
 
+/**
+ * gst_player_set_idle_timeout:
+ * @player: #GstPlayer instance
+ * @timeout: time in milliseconds, 0 to release immediately or -1 to never
+ *     release
+ *
+ * A stopped pipeline stays in READY state for @timeout milliseconds, so that
+ * playing again is faster, and then releases all its elements and the
+ * resources they hold. Pipelines that are kept can still be released with
+ * gst_player_release_idle_pipelines().
+ */
 void
-gst_player_play (GstPlayer * self)
+gst_player_set_idle_timeout (GstPlayer * self, gint timeout)
 {
   g_return_if_fail (GST_IS_PLAYER (self));
+  g_return_if_fail (timeout >= -1);
 
-  g_main_context_invoke (self->context, gst_player_play_internal, self);
+  g_object_set (self, "idle-timeout", timeout, NULL);
 }
 
-static gboolean
-gst_player_pause_internal (gpointer user_data)
+/**
+ * gst_player_release_idle_pipelines:
+ * @keep: number of idle pipelines to keep
+ *
+ * Releases the resources of all but the @keep most recently used idle
+ * pipelines of all #GstPlayer instances in the process, independent of
+ * their #GstPlayer:idle-timeout. This is meant to be called when the
+ * system is low on memory. The pipelines are released asynchronously from
+ * the players' threads.
+ *
+ * Returns: the number of pipelines that are released
+ */
+guint
+gst_player_release_idle_pipelines (guint keep)
 {
-  GstPlayer *self = GST_PLAYER (user_data);
-  GstStateChangeReturn state_ret;
-
-  GST_DEBUG_OBJECT (self, "Pause");
+  GSList *players = NULL, *l;
+  GList *link;
+  guint n = 0, n_release;
+
+  g_mutex_lock (&idle_players_lock);
+  n_release = idle_players.length > keep ? idle_players.length - keep : 0;
+  for (link = idle_players.head; link && n < n_release; link = link->next) {
+    GstPlayer *player = link->data;
+
+    /* NULL if the player is being finalized */
+    player = g_weak_ref_get (&player->idle_ref);
+    if (player) {
+      players = g_slist_prepend (players, player);
+      n++;
+    }
+  }
+  g_mutex_unlock (&idle_players_lock);
 
-  g_mutex_lock (&self->lock);
-  if (!self->uri) {
-    g_mutex_unlock (&self->lock);
-    return G_SOURCE_REMOVE;
+  for (l = players; l; l = l->next) {
+    gst_player_invoke (l->data, release_idle_pipeline_cb);
+    g_object_unref (l->data);
   }
-  g_mutex_unlock (&self->lock);
+  g_slist_free (players);
 
-  tick_cb (self);
-  remove_tick_source (self);
-  remove_ready_timeout_source (self);
+  return n;
+}
 
-  self->target_state = GST_STATE_PAUSED;
+/**
+ * gst_player_get_pipeline_reuse_stats:
+ * @player: #GstPlayer instance
+ * @warm_starts: (out) (allow-none): number of times playback started with
+ *     a pipeline that was kept in READY state
+ * @cold_starts: (out) (allow-none): number of times playback started with a
+ *     pipeline that had to be built from scratch
+ * @releases: (out) (allow-none): number of times an idle pipeline released
+ *     its resources
+ *
+ * Retrieves counters to tune #GstPlayer:idle-timeout.
+ */
+void
+gst_player_get_pipeline_reuse_stats (GstPlayer * self, guint * warm_starts,
+    guint * cold_starts, guint * releases)
+{
+  g_return_if_fail (GST_IS_PLAYER (self));
 
-  if (self->current_state < GST_STATE_PAUSED)
-    change_state (self, GST_PLAYER_STATE_BUFFERING);
+  if (warm_starts)
+    *warm_starts = g_atomic_int_get (&self->warm_starts);
+  if (cold_starts)
+    *cold_starts = g_atomic_int_get (&self->cold_starts);
+  if (releases)
+    *releases = g_atomic_int_get (&self->idle_releases);
+}
 
-  state_ret = gst_element_set_state (self->playbin, GST_STATE_PAUSED);
-  if (state_ret == GST_STATE_CHANGE_FAILURE) {
-    emit_error (self, g_error_new (GST_PLAYER_ERROR, GST_PLAYER_ERROR_FAILED,
-            "Failed to pause"));
-    return G_SOURCE_REMOVE;
-  } else if (state_ret == GST_STATE_CHANGE_NO_PREROLL) {
-    self->is_live = TRUE;
-    GST_DEBUG_OBJECT (self, "Pipeline is live");
-  }
+/**
+ * gst_player_get_seek_mode:
+ * @player: #GstPlayer instance
+ *
+ * Returns: the #GstPlayerSeekMode used for gst_player_seek()
+ */
+GstPlayerSeekMode
+gst_player_get_seek_mode (GstPlayer * self)
+{
+  GstPlayerSeekMode val;
 
-  if (self->is_eos) {
-    gboolean ret;
+  g_return_val_if_fail (GST_IS_PLAYER (self), DEFAULT_SEEK_MODE);
 
-    GST_DEBUG_OBJECT (self, "Was EOS, seeking to beginning");
-    self->is_eos = FALSE;
-    ret =
-        gst_element_seek_simple (self->playbin, GST_FORMAT_TIME,
-        GST_SEEK_FLAG_FLUSH, 0);
-    if (!ret) {
-      GST_ERROR_OBJECT (self, "Seek to beginning failed");
-      gst_element_set_state (self->playbin, GST_STATE_READY);
-      gst_player_pause_internal (self);
-    }
-  }
+  g_object_get (self, "seek-mode", &val, NULL);
 
-  return G_SOURCE_REMOVE;
+  return val;
 }
 
+/**
+ * gst_player_set_seek_mode:
+ * @player: #GstPlayer instance
+ * @mode: a #GstPlayerSeekMode
+ *
+ * Selects whether gst_player_seek() goes exactly to the requested position
+ * or to a nearby keyframe. Seeking to keyframes avoids decoding all frames
+ * since the previous keyframe and makes scrubbing much more responsive.
+ */
 void
-gst_player_pause (GstPlayer * self)
+gst_player_set_seek_mode (GstPlayer * self, GstPlayerSeekMode mode)
 {
   g_return_if_fail (GST_IS_PLAYER (self));
 
-  g_main_context_invoke (self->context, gst_player_pause_internal, self);
+  g_object_set (self, "seek-mode", mode, NULL);
 }
 
-static gboolean
-gst_player_stop_internal (gpointer user_data)
+/**
+ * gst_player_get_seek_latencies:
+ * @player: #GstPlayer instance
+ * @n_latencies: (out): the number of returned latencies
+ *
+ * Retrieves the time the most recent seeks took until the pipeline was
+ * prerolled at the new position, oldest first. Seeks are throttled to one
+ * per average of these latencies.
+ *
+ * Returns: (transfer full) (array length=n_latencies) (allow-none): the
+ *     latencies, or %NULL if no seek finished yet. g_free() after usage.
+ */
+GstClockTime *
+gst_player_get_seek_latencies (GstPlayer * self, guint * n_latencies)
 {
-  GstPlayer *self = GST_PLAYER (user_data);
-
-  GST_DEBUG_OBJECT (self, "Stop");
-
-  tick_cb (self);
-  remove_tick_source (self);
+  GstClockTime *latencies = NULL;
+  guint i, start;
 
-  add_ready_timeout_source (self);
+  g_return_val_if_fail (GST_IS_PLAYER (self), NULL);
+  g_return_val_if_fail (n_latencies != NULL, NULL);
 
-  self->target_state = GST_STATE_NULL;
-  self->current_state = GST_STATE_READY;
-  self->is_live = FALSE;
-  self->is_eos = FALSE;
-  gst_bus_set_flushing (self->bus, TRUE);
-  gst_element_set_state (self->playbin, GST_STATE_READY);
-  gst_bus_set_flushing (self->bus, FALSE);
-  change_state (self, GST_PLAYER_STATE_STOPPED);
-  self->buffering = 100;
   g_mutex_lock (&self->lock);
-  if (self->media_info) {
-    g_object_unref (self->media_info);
-    self->media_info = NULL;
-  }
-  if (self->global_tags) {
-    gst_tag_list_unref (self->global_tags);
-    self->global_tags = NULL;
-  }
-  self->seek_pending = FALSE;
-  if (self->seek_source) {
-    g_source_destroy (self->seek_source);
-    g_source_unref (self->seek_source);
-    self->seek_source = NULL;
+  *n_latencies = self->n_seek_latencies;
+  if (self->n_seek_latencies > 0) {
+    latencies = g_new (GstClockTime, self->n_seek_latencies);
+    start = self->n_seek_latencies < SEEK_LATENCY_HISTORY ? 0 :
+        self->seek_latencies_pos;
+    for (i = 0; i < self->n_seek_latencies; i++)
+      latencies[i] = self->seek_latencies[(start + i) % SEEK_LATENCY_HISTORY];
   }
-  self->seek_position = GST_CLOCK_TIME_NONE;
-  self->last_seek_time = GST_CLOCK_TIME_NONE;
   g_mutex_unlock (&self->lock);
 
-  return G_SOURCE_REMOVE;
+  return latencies;
+}
+
+/**
+ * gst_player_get_rate:
+ * @player: #GstPlayer instance
+ *
+ * Returns: the current playback rate
+ */
+gdouble
+gst_player_get_rate (GstPlayer * self)
+{
+  gdouble val;
+
+  g_return_val_if_fail (GST_IS_PLAYER (self), DEFAULT_RATE);
+
+  g_object_get (self, "rate", &val, NULL);
+
+  return val;
 }
 
+/**
+ * gst_player_set_rate:
+ * @player: #GstPlayer instance
+ * @rate: playback rate, negative to play backwards
+ *
+ * Changes the playback rate with a seek to the current position. From a
+ * rate of 4 on, in both directions, only keyframes are decoded and audio is
+ * skipped. The position is reported in stream time, so it advances by
+ * @rate times the elapsed time.
+ */
 void
-gst_player_stop (GstPlayer * self)
+gst_player_set_rate (GstPlayer * self, gdouble rate)
 {
   g_return_if_fail (GST_IS_PLAYER (self));
+  g_return_if_fail (rate != 0.0);
 
-  g_main_context_invoke (self->context, gst_player_stop_internal, self);
+  g_object_set (self, "rate", rate, NULL);
 }
 
-/* Must be called with lock from main context, releases lock! */
 static void
-gst_player_seek_internal_locked (GstPlayer * self)
+stats_set_array (GstStructure * s, const gchar * field, GType type,
+    gconstpointer values, guint n_values)
 {
-  GstClockTime position;
-  gboolean ret;
-  GstStateChangeReturn state_ret;
-
-  if (self->seek_source) {
-    g_source_destroy (self->seek_source);
-    g_source_unref (self->seek_source);
-    self->seek_source = NULL;
-  }
-
-  /* Only seek in PAUSED */
-  if (self->current_state < GST_STATE_PAUSED) {
-    return;
-  } else if (self->current_state != GST_STATE_PAUSED) {
-    g_mutex_unlock (&self->lock);
-    state_ret = gst_element_set_state (self->playbin, GST_STATE_PAUSED);
-    if (state_ret == GST_STATE_CHANGE_FAILURE) {
-      emit_error (self, g_error_new (GST_PLAYER_ERROR, GST_PLAYER_ERROR_FAILED,
-              "Failed to seek"));
-      g_mutex_lock (&self->lock);
-      return;
-    }
-    g_mutex_lock (&self->lock);
-    return;
+  GValue array = G_VALUE_INIT;
+  GValue value = G_VALUE_INIT;
+  guint i;
+
+  g_value_init (&array, GST_TYPE_ARRAY);
+  g_value_init (&value, type);
+  for (i = 0; i < n_values; i++) {
+    if (type == G_TYPE_UINT)
+      g_value_set_uint (&value, ((const guint *) values)[i]);
+    else
+      g_value_set_uint64 (&value, ((const guint64 *) values)[i]);
+    gst_value_array_append_value (&array, &value);
   }
+  gst_structure_take_value (s, field, &array);
+  g_value_unset (&value);
+}
 
-  self->last_seek_time = gst_util_get_timestamp ();
-  position = self->seek_position;
-  self->seek_position = GST_CLOCK_TIME_NONE;
-  self->seek_pending = TRUE;
-  g_mutex_unlock (&self->lock);
+/**
+ * gst_player_get_degradation_steps:
+ * @player: #GstPlayer instance
+ *
+ * Returns: the steps that may be taken when the video sink falls behind
+ */
+GstPlayerDegradationFlags
+gst_player_get_degradation_steps (GstPlayer * self)
+{
+  GstPlayerDegradationFlags val;
 
-  GST_DEBUG_OBJECT (self, "Seek to %" GST_TIME_FORMAT,
-      GST_TIME_ARGS (position));
+  g_return_val_if_fail (GST_IS_PLAYER (self), DEFAULT_DEGRADATION_STEPS);
 
-  remove_tick_source (self);
-  self->is_eos = FALSE;
+  g_object_get (self, "degradation-steps", &val, NULL);
 
-  ret =
-      gst_element_seek_simple (self->playbin, GST_FORMAT_TIME,
-      GST_SEEK_FLAG_FLUSH, position);
+  return val;
+}
 
-  if (!ret)
-    emit_error (self, g_error_new (GST_PLAYER_ERROR, GST_PLAYER_ERROR_FAILED,
-            "Failed to seek to %" GST_TIME_FORMAT, GST_TIME_ARGS (position)));
+/**
+ * gst_player_set_degradation_steps:
+ * @player: #GstPlayer instance
+ * @steps: #GstPlayerDegradationFlags
+ *
+ * Enables reducing the decoding load when the video sink reports with QoS
+ * messages that frames arrive too late. The enabled steps are taken one
+ * after another, in the order of #GstPlayerDegradationFlags, while frames
+ * stay late, and are undone in reverse order once the video sink keeps up
+ * again. Every change is announced with the #GstPlayer::degradation-changed
+ * signal. Disabled by default.
+ */
+void
+gst_player_set_degradation_steps (GstPlayer * self,
+    GstPlayerDegradationFlags steps)
+{
+  g_return_if_fail (GST_IS_PLAYER (self));
 
-  g_mutex_lock (&self->lock);
+  g_object_set (self, "degradation-steps", steps, NULL);
 }
 
-static gboolean
-gst_player_seek_internal (gpointer user_data)
+/**
+ * gst_player_get_buffer_size:
+ * @player: #GstPlayer instance
+ *
+ * Returns: the maximum number of bytes buffered for network streams, or -1
+ *     for the default
+ */
+gint
+gst_player_get_buffer_size (GstPlayer * self)
 {
-  GstPlayer *self = GST_PLAYER (user_data);
+  gint val;
 
-  g_mutex_lock (&self->lock);
-  gst_player_seek_internal_locked (self);
-  g_mutex_unlock (&self->lock);
+  g_return_val_if_fail (GST_IS_PLAYER (self), DEFAULT_BUFFER_SIZE);
 
-  return G_SOURCE_REMOVE;
+  g_object_get (self, "buffer-size", &val, NULL);
+
+  return val;
 }
 
+/**
+ * gst_player_set_buffer_size:
+ * @player: #GstPlayer instance
+ * @size: maximum number of bytes, or -1 for the default
+ *
+ * Sets how much data is buffered for network streams. In
+ * %GST_BUFFERING_TIMESHIFT mode this is also the size of the ring buffer.
+ */
 void
-gst_player_seek (GstPlayer * self, GstClockTime position)
+gst_player_set_buffer_size (GstPlayer * self, gint size)
 {
   g_return_if_fail (GST_IS_PLAYER (self));
-  g_return_if_fail (GST_CLOCK_TIME_IS_VALID (position));
 
-  g_mutex_lock (&self->lock);
-  if (self->media_info && !self->media_info->seekable) {
-    GST_DEBUG_OBJECT (self, "Media is not seekable");
-    g_mutex_unlock (&self->lock);
-    return;
-  }
+  g_object_set (self, "buffer-size", size, NULL);
+}
 
-  self->seek_position = position;
+/**
+ * gst_player_get_buffer_duration:
+ * @player: #GstPlayer instance
+ *
+ * Returns: the maximum time buffered for network streams in nanoseconds, or
+ *     -1 for the default
+ */
+gint64
+gst_player_get_buffer_duration (GstPlayer * self)
+{
+  gint64 val;
 
-  /* If there is no seek being dispatch to the main context currently do that,
-   * otherwise we just updated the seek position so that it will be taken by
-   * the seek handler from the main context instead of the old one.
-   */
-  if (!self->seek_source) {
-    GstClockTime now = gst_util_get_timestamp ();
+  g_return_val_if_fail (GST_IS_PLAYER (self), DEFAULT_BUFFER_DURATION);
 
-    /* If no seek is pending or it was started more than 250 mseconds ago seek
-     * immediately, otherwise wait until the 250 mseconds have passed */
-    if (!self->seek_pending || (now - self->last_seek_time > 250 * GST_MSECOND)) {
-      self->seek_source = g_idle_source_new ();
-      g_source_set_callback (self->seek_source,
-          (GSourceFunc) gst_player_seek_internal, self, NULL);
-      GST_TRACE_OBJECT (self, "Dispatching seek to position %" GST_TIME_FORMAT,
-          GST_TIME_ARGS (position));
-      g_source_attach (self->seek_source, self->context);
-    } else {
-      guint delay = 250000 - (now - self->last_seek_time) / 1000;
+  g_object_get (self, "buffer-duration", &val, NULL);
 
-      /* Note that last_seek_time must be set to something at this point and
-       * it must be smaller than 250 mseconds */
-      self->seek_source = g_timeout_source_new (delay);
-      g_source_set_callback (self->seek_source,
-          (GSourceFunc) gst_player_seek_internal, self, NULL);
+  return val;
+}
 
-      GST_TRACE_OBJECT (self,
-          "Delaying seek to position %" GST_TIME_FORMAT " by %u us",
-          GST_TIME_ARGS (position), delay);
-      g_source_attach (self->seek_source, self->context);
-    }
-  }
-  g_mutex_unlock (&self->lock);
+/**
+ * gst_player_set_buffer_duration:
+ * @player: #GstPlayer instance
+ * @duration: maximum time in nanoseconds, or -1 for the default
+ *
+ * Sets how much data is buffered for network streams, in time.
+ */
+void
+gst_player_set_buffer_duration (GstPlayer * self, gint64 duration)
+{
+  g_return_if_fail (GST_IS_PLAYER (self));
+
+  g_object_set (self, "buffer-duration", duration, NULL);
 }
 
-gboolean
-gst_player_get_dispatch_to_main_context (GstPlayer * self)
+/**
+ * gst_player_get_buffering_mode:
+ * @player: #GstPlayer instance
+ *
+ * Returns: the #GstBufferingMode used for network streams
+ */
+GstBufferingMode
+gst_player_get_buffering_mode (GstPlayer * self)
 {
-  gboolean val;
+  GstBufferingMode val;
 
-  g_return_val_if_fail (GST_IS_PLAYER (self), FALSE);
+  g_return_val_if_fail (GST_IS_PLAYER (self), DEFAULT_BUFFERING_MODE);
 
-  g_object_get (self, "dispatch-to-main-context", &val, NULL);
+  g_object_get (self, "buffering-mode", &val, NULL);
 
   return val;
 }
 
+/**
+ * gst_player_set_buffering_mode:
+ * @player: #GstPlayer instance
+ * @mode: a #GstBufferingMode
+ *
+ * With %GST_BUFFERING_STREAM network streams are buffered in memory. With
+ * %GST_BUFFERING_DOWNLOAD they are downloaded completely to a temporary
+ * file, and with %GST_BUFFERING_TIMESHIFT the downloaded data is kept in a
+ * ring buffer of #GstPlayer:buffer-size bytes. %GST_BUFFERING_LIVE behaves
+ * like %GST_BUFFERING_STREAM. Takes effect for the next URI.
+ */
 void
-gst_player_set_dispatch_to_main_context (GstPlayer * self, gboolean val)
+gst_player_set_buffering_mode (GstPlayer * self, GstBufferingMode mode)
 {
   g_return_if_fail (GST_IS_PLAYER (self));
 
-  g_object_set (self, "dispatch-to-main-context", val, NULL);
+  g_object_set (self, "buffering-mode", mode, NULL);
 }
 
-gchar *
-gst_player_get_uri (GstPlayer * self)
+/**
+ * gst_player_get_buffering_watermarks:
+ * @player: #GstPlayer instance
+ * @low: (out) (allow-none): the low watermark in percent
+ * @high: (out) (allow-none): the high watermark in percent
+ *
+ * Retrieves the watermarks set with gst_player_set_buffering_watermarks().
+ */
+void
+gst_player_get_buffering_watermarks (GstPlayer * self, gint * low,
+    gint * high)
 {
-  gchar *val;
+  gint l, h;
 
-  g_return_val_if_fail (GST_IS_PLAYER (self), NULL);
+  g_return_if_fail (GST_IS_PLAYER (self));
 
-  g_object_get (self, "uri", &val, NULL);
+  g_object_get (self, "low-watermark", &l, "high-watermark", &h, NULL);
 
-  return val;
+  if (low)
+    *low = l;
+  if (high)
+    *high = h;
 }
 
+/**
+ * gst_player_set_buffering_watermarks:
+ * @player: #GstPlayer instance
+ * @low: buffer fill level in percent below which playback pauses
+ * @high: buffer fill level in percent from which playback resumes
+ *
+ * By default playback pauses as soon as the buffer is not full anymore and
+ * resumes once it is full again. A lower @low keeps playing from the
+ * remaining data and a lower @high resumes earlier, which together avoid
+ * many short stalls on slow connections.
+ */
 void
-gst_player_set_uri (GstPlayer * self, const gchar * val)
+gst_player_set_buffering_watermarks (GstPlayer * self, gint low, gint high)
 {
   g_return_if_fail (GST_IS_PLAYER (self));
+  g_return_if_fail (low >= 0 && low <= high && high <= 100);
 
-  g_object_set (self, "uri", val, NULL);
+  g_object_set (self, "low-watermark", low, "high-watermark", high, NULL);
 }
 
-GstClockTime
-gst_player_get_position (GstPlayer * self)
+/**
+ * gst_player_get_buffering_early_resume:
+ * @player: #GstPlayer instance
+ *
+ * Returns: %TRUE if playback resumes as soon as buffering is estimated to
+ *     finish in time
+ */
+gboolean
+gst_player_get_buffering_early_resume (GstPlayer * self)
 {
-  GstClockTime val;
+  gboolean val;
 
-  g_return_val_if_fail (GST_IS_PLAYER (self), GST_CLOCK_TIME_NONE);
+  g_return_val_if_fail (GST_IS_PLAYER (self), DEFAULT_BUFFERING_EARLY_RESUME);
 
-  g_object_get (self, "position", &val, NULL);
+  g_object_get (self, "buffering-early-resume", &val, NULL);
 
   return val;
 }
 
-GstClockTime
-gst_player_get_duration (GstPlayer * self)
+/**
+ * gst_player_set_buffering_early_resume:
+ * @player: #GstPlayer instance
+ * @early_resume: whether to resume before the high watermark
+ *
+ * Resumes playback before the high watermark is reached if, with the
+ * current input and output rates, it is estimated not to stall again. When
+ * downloading, that is when the download finishes before playback reaches
+ * the end. When streaming, that is when data comes in faster than it is
+ * played or, if #GstPlayer:buffer-duration is set, when the buffered data
+ * lasts longer than filling the buffer takes. The estimate is announced
+ * with the #GstPlayer::buffering-time-left signal.
+ */
+void
+gst_player_set_buffering_early_resume (GstPlayer * self,
+    gboolean early_resume)
 {
-  GstClockTime val;
-
-  g_return_val_if_fail (GST_IS_PLAYER (self), GST_CLOCK_TIME_NONE);
-
-  g_object_get (self, "duration", &val, NULL);
+  g_return_if_fail (GST_IS_PLAYER (self));
 
-  return val;
+  g_object_set (self, "buffering-early-resume", early_resume, NULL);
 }
 
-gdouble
-gst_player_get_volume (GstPlayer * self)
+/**
+ * gst_player_get_download_cache_dir:
+ * @player: #GstPlayer instance
+ *
+ * Returns: (transfer full): the directory of the download cache, or %NULL
+ *     if downloads are not cached. g_free() after usage.
+ */
+gchar *
+gst_player_get_download_cache_dir (GstPlayer * self)
 {
-  gdouble val;
+  gchar *val;
 
-  g_return_val_if_fail (GST_IS_PLAYER (self), 1.0);
+  g_return_val_if_fail (GST_IS_PLAYER (self), NULL);
 
-  g_object_get (self, "volume", &val, NULL);
+  g_object_get (self, "download-cache-dir", &val, NULL);
 
   return val;
 }
 
+/**
+ * gst_player_set_download_cache_dir:
+ * @player: #GstPlayer instance
+ * @dir: (allow-none): directory for the download cache, or %NULL
+ *
+ * With %GST_BUFFERING_DOWNLOAD network streams that were downloaded
+ * completely are kept in @dir and played from there the next time the
+ * same URI is set, see gst_player_set_uri_with_validator(). Many players
+ * can share the same directory, the least recently played files are
+ * removed once it grows beyond #GstPlayer:download-cache-size.
+ */
 void
-gst_player_set_volume (GstPlayer * self, gdouble val)
+gst_player_set_download_cache_dir (GstPlayer * self, const gchar * dir)
 {
   g_return_if_fail (GST_IS_PLAYER (self));
 
-  g_object_set (self, "volume", val, NULL);
+  g_object_set (self, "download-cache-dir", dir, NULL);
 }
 
-gboolean
-gst_player_get_mute (GstPlayer * self)
+/**
+ * gst_player_get_download_cache_size:
+ * @player: #GstPlayer instance
+ *
+ * Returns: the maximum size of the download cache in bytes
+ */
+guint64
+gst_player_get_download_cache_size (GstPlayer * self)
 {
-  gboolean val;
+  guint64 val;
 
-  g_return_val_if_fail (GST_IS_PLAYER (self), FALSE);
+  g_return_val_if_fail (GST_IS_PLAYER (self), DEFAULT_DOWNLOAD_CACHE_SIZE);
 
-  g_object_get (self, "mute", &val, NULL);
+  g_object_get (self, "download-cache-size", &val, NULL);
 
   return val;
 }
 
+/**
+ * gst_player_set_download_cache_size:
+ * @player: #GstPlayer instance
+ * @size: maximum size of the download cache in bytes
+ *
+ * Limits the size of the download cache directory. The limit is applied
+ * whenever a download is added to the cache.
+ */
 void
-gst_player_set_mute (GstPlayer * self, gboolean val)
+gst_player_set_download_cache_size (GstPlayer * self, guint64 size)
 {
   g_return_if_fail (GST_IS_PLAYER (self));
 
-  g_object_set (self, "mute", val, NULL);
+  g_object_set (self, "download-cache-size", size, NULL);
 }
 
 /**
- * gst_player_get_window_handle:
+ * gst_player_get_media_info_cache:
  * @player: #GstPlayer instance
  *
- * Returns: (transfer none): The currently set, platform specific window
- * handle
+ * Returns: (transfer full): the #GstPlayerMediaInfoCache that is used, or
+ *     %NULL. g_object_unref() after usage.
  */
-gpointer
-gst_player_get_window_handle (GstPlayer * self)
+GstPlayerMediaInfoCache *
+gst_player_get_media_info_cache (GstPlayer * self)
 {
-  gpointer val;
+  GstPlayerMediaInfoCache *val;
 
   g_return_val_if_fail (GST_IS_PLAYER (self), NULL);
 
-  g_object_get (self, "window-handle", &val, NULL);
+  g_object_get (self, "media-info-cache", &val, NULL);
 
   return val;
 }
 
+/**
+ * gst_player_set_media_info_cache:
+ * @player: #GstPlayer instance
+ * @cache: (allow-none): a #GstPlayerMediaInfoCache, or %NULL
+ *
+ * Looks up the media information of every URI in @cache once it was
+ * loaded, and emits #GstPlayer::media-info-updated with it before the
+ * media is prerolled. Media information that was not cached yet is stored
+ * in @cache after preroll. The URI is identified together with the
+ * validator passed to gst_player_set_uri_with_validator(), local files
+ * by their size and modification time.
+ *
+ * The cached media information is replaced once the media is prerolled.
+ */
 void
-gst_player_set_window_handle (GstPlayer * self, gpointer val)
+gst_player_set_media_info_cache (GstPlayer * self,
+    GstPlayerMediaInfoCache * cache)
 {
   g_return_if_fail (GST_IS_PLAYER (self));
+  g_return_if_fail (cache == NULL || GST_IS_PLAYER_MEDIA_INFO_CACHE (cache));
 
-  g_object_set (self, "window-handle", val, NULL);
+  g_object_set (self, "media-info-cache", cache, NULL);
 }
 
 /**
- * gst_player_get_pipeline:
+ * gst_player_get_stats:
  * @player: #GstPlayer instance
  *
- * Returns: (transfer full): The internal playbin instance
+ * Retrieves statistics about the playback so far. This only reads counters
+ * and does not query the pipeline, so it is cheap enough to be polled
+ * regularly. The returned structure contains these fields:
+ *
+ * - "frames-rendered" and "frames-dropped" (#guint64): frames of the
+ *   current stream as reported by the last QoS message of the video sink
+ * - "jitter" (#gint64): the jitter of the last late or early frame in
+ *   nanoseconds
+ * - "time-to-first-frame" (#guint64): the time from the last
+ *   gst_player_play() on a stopped player until playback started, or
+ *   %GST_CLOCK_TIME_NONE
+ * - "rebuffer-count" (#guint): the number of times playback stalled for
+ *   buffering
+ * - "stall-time" (#guint64): the total time playback stalled for buffering
+ * - "bytes-downloaded" (#guint64): the number of bytes produced by the
+ *   source elements since the current URI was set
+ * - "time-to-first-frame-histogram" and "seek-latency-histogram"
+ *   (#GstValueArray of #guint): the number of startups and seeks that took
+ *   up to the corresponding value of "histogram-bounds", the last bucket
+ *   counts all longer ones
+ * - "histogram-bounds" (#GstValueArray of #guint64): the upper bounds of
+ *   the histogram buckets in nanoseconds
+ * - "events-coalesced" and "events-overflowed" (#guint): see
+ *   gst_player_get_event_stats()
+ * - "warm-starts", "cold-starts" and "idle-releases" (#guint): see
+ *   gst_player_get_pipeline_reuse_stats()
+ * - "delivery-frames-dropped" (#guint64): frames that were dropped in
+ *   #GstPlayer:video-frame-delivery mode because the application did not
+ *   pull them in time
+ *
+ * Returns: (transfer full): a new #GstStructure. gst_structure_free() after
+ *     usage.
  */
-GstElement *
-gst_player_get_pipeline (GstPlayer * self)
+GstStructure *
+gst_player_get_stats (GstPlayer * self)
 {
-  GstElement *val;
+  GstPlayerPlaybackStats stats;
+  GstStructure *s;
+  guint64 delivery_dropped = 0, bytes_downloaded;
+  gint seq;
 
   g_return_val_if_fail (GST_IS_PLAYER (self), NULL);
 
-  g_object_get (self, "pipeline", &val, NULL);
+  for (;;) {
+    seq = g_atomic_int_get (&self->stats_seq);
+    if (seq & 1) {
+      g_thread_yield ();
+      continue;
+    }
 
-  return val;
+    stats = self->stats;
+
+    if (g_atomic_int_get (&self->stats_seq) == seq)
+      break;
+  }
+
+  s = gst_structure_new ("application/x-gst-player-stats",
+      "frames-rendered", G_TYPE_UINT64, stats.frames_rendered,
+      "frames-dropped", G_TYPE_UINT64, stats.frames_dropped,
+      "jitter", G_TYPE_INT64, stats.jitter,
+      "time-to-first-frame", G_TYPE_UINT64, stats.time_to_first_frame,
+      "rebuffer-count", G_TYPE_UINT, stats.rebuffer_count,
+      "stall-time", G_TYPE_UINT64, stats.stall_time,
+      "events-coalesced", G_TYPE_UINT,
+      g_atomic_int_get (&self->events_coalesced),
+      "events-overflowed", G_TYPE_UINT,
+      g_atomic_int_get (&self->events_overflowed),
+      "warm-starts", G_TYPE_UINT, g_atomic_int_get (&self->warm_starts),
+      "cold-starts", G_TYPE_UINT, g_atomic_int_get (&self->cold_starts),
+      "idle-releases", G_TYPE_UINT, g_atomic_int_get (&self->idle_releases),
+      NULL);
+
+  g_mutex_lock (&self->lock);
+  bytes_downloaded = self->bytes_downloaded;
+  if (self->video_frame_sink)
+    delivery_dropped =
+        gst_player_video_frame_sink_get_dropped (GST_PLAYER_VIDEO_FRAME_SINK
+        (self->video_frame_sink));
+  g_mutex_unlock (&self->lock);
+  gst_structure_set (s, "bytes-downloaded", G_TYPE_UINT64, bytes_downloaded,
+      "delivery-frames-dropped", G_TYPE_UINT64, delivery_dropped, NULL);
+
+  stats_set_array (s, "time-to-first-frame-histogram", G_TYPE_UINT,
+      stats.time_to_first_frame_histogram, STATS_HISTOGRAM_BUCKETS);
+  stats_set_array (s, "seek-latency-histogram", G_TYPE_UINT,
+      stats.seek_latency_histogram, STATS_HISTOGRAM_BUCKETS);
+  stats_set_array (s, "histogram-bounds", G_TYPE_UINT64,
+      stats_histogram_bounds, G_N_ELEMENTS (stats_histogram_bounds));
+
+  return s;
 }
 
 /**
@@ -2604,6 +7547,9 @@ gst_player_get_pipeline (GstPlayer * self)
  * @player: #GstPlayer instance
  *
  * A Function to get the current media info #GstPlayerMediaInfo instance.
+ * The returned instance is an immutable snapshot, later changes are
+ * announced with a new instance by the #GstPlayer::media-info-updated
+ * signal.
  *
  * Returns: (transfer full): media info instance.
  *
@@ -2612,18 +7558,9 @@ gst_player_get_pipeline (GstPlayer * self)
 GstPlayerMediaInfo *
 gst_player_get_media_info (GstPlayer * self)
 {
-  GstPlayerMediaInfo *info;
-
   g_return_val_if_fail (GST_IS_PLAYER (self), NULL);
 
-  if (!self->media_info)
-    return NULL;
-
-  g_mutex_lock (&self->lock);
-  info = gst_player_media_info_copy (self->media_info);
-  g_mutex_unlock (&self->lock);
-
-  return info;
+  return media_info_ref_current (self);
 }
 
 /**
@@ -2710,6 +7647,7 @@ gboolean
 gst_player_set_audio_track (GstPlayer * self, gint stream_index)
 {
   GstPlayerStreamInfo *info;
+  GstElement *playbin;
 
   g_return_val_if_fail (GST_IS_PLAYER (self), 0);
 
@@ -2722,7 +7660,9 @@ gst_player_set_audio_track (GstPlayer * self, gint stream_index)
     return FALSE;
   }
 
-  g_object_set (G_OBJECT (self->playbin), "current-audio", stream_index, NULL);
+  playbin = playbin_ref (self);
+  g_object_set (G_OBJECT (playbin), "current-audio", stream_index, NULL);
+  gst_object_unref (playbin);
   GST_DEBUG_OBJECT (self, "set stream index '%d'", stream_index);
   return TRUE;
 }
@@ -2736,6 +7676,7 @@ gboolean
 gst_player_set_video_track (GstPlayer * self, gint stream_index)
 {
   GstPlayerStreamInfo *info;
+  GstElement *playbin;
 
   g_return_val_if_fail (GST_IS_PLAYER (self), 0);
 
@@ -2749,7 +7690,9 @@ gst_player_set_video_track (GstPlayer * self, gint stream_index)
     return FALSE;
   }
 
-  g_object_set (G_OBJECT (self->playbin), "current-video", stream_index, NULL);
+  playbin = playbin_ref (self);
+  g_object_set (G_OBJECT (playbin), "current-video", stream_index, NULL);
+  gst_object_unref (playbin);
   GST_DEBUG_OBJECT (self, "set stream index '%d'", stream_index);
   return TRUE;
 }
@@ -2763,6 +7706,7 @@ gboolean
 gst_player_set_subtitle_track (GstPlayer * self, gint stream_index)
 {
   GstPlayerStreamInfo *info;
+  GstElement *playbin;
 
   g_return_val_if_fail (GST_IS_PLAYER (self), 0);
 
@@ -2775,7 +7719,9 @@ gst_player_set_subtitle_track (GstPlayer * self, gint stream_index)
     return FALSE;
   }
 
-  g_object_set (G_OBJECT (self->playbin), "current-text", stream_index, NULL);
+  playbin = playbin_ref (self);
+  g_object_set (G_OBJECT (playbin), "current-text", stream_index, NULL);
+  gst_object_unref (playbin);
   GST_DEBUG_OBJECT (self, "set stream index '%d'", stream_index);
   return TRUE;
 }
@@ -2899,6 +7845,83 @@ gst_player_error_get_type (void)
   return (GType) id;
 }
 
+GType
+gst_player_position_update_flags_get_type (void)
+{
+  static gsize id = 0;
+  static const GFlagsValue values[] = {
+    {C_FLAGS (GST_PLAYER_POSITION_UPDATE_FLAG_NONE),
+        "GST_PLAYER_POSITION_UPDATE_FLAG_NONE", "none"},
+    {C_FLAGS (GST_PLAYER_POSITION_UPDATE_FLAG_ADAPTIVE),
+        "GST_PLAYER_POSITION_UPDATE_FLAG_ADAPTIVE", "adaptive"},
+    {C_FLAGS (GST_PLAYER_POSITION_UPDATE_FLAG_FRAME_ALIGNED),
+        "GST_PLAYER_POSITION_UPDATE_FLAG_FRAME_ALIGNED", "frame-aligned"},
+    {0, NULL, NULL}
+  };
+
+  if (g_once_init_enter (&id)) {
+    GType tmp = g_flags_register_static ("GstPlayerPositionUpdateFlags",
+        values);
+    g_once_init_leave (&id, tmp);
+  }
+
+  return (GType) id;
+}
+
+GType
+gst_player_degradation_flags_get_type (void)
+{
+  static gsize id = 0;
+  static const GFlagsValue values[] = {
+    {C_FLAGS (GST_PLAYER_DEGRADATION_FLAG_NONE),
+        "GST_PLAYER_DEGRADATION_FLAG_NONE", "none"},
+    {C_FLAGS (GST_PLAYER_DEGRADATION_FLAG_SKIP_FRAMES),
+        "GST_PLAYER_DEGRADATION_FLAG_SKIP_FRAMES", "skip-frames"},
+    {C_FLAGS (GST_PLAYER_DEGRADATION_FLAG_MAX_LATENESS),
+        "GST_PLAYER_DEGRADATION_FLAG_MAX_LATENESS", "max-lateness"},
+    {C_FLAGS (GST_PLAYER_DEGRADATION_FLAG_LOWER_VARIANT),
+        "GST_PLAYER_DEGRADATION_FLAG_LOWER_VARIANT", "lower-variant"},
+    {C_FLAGS (GST_PLAYER_DEGRADATION_FLAG_KEY_UNITS),
+        "GST_PLAYER_DEGRADATION_FLAG_KEY_UNITS", "key-units"},
+    {0, NULL, NULL}
+  };
+
+  if (g_once_init_enter (&id)) {
+    GType tmp = g_flags_register_static ("GstPlayerDegradationFlags", values);
+    g_once_init_leave (&id, tmp);
+  }
+
+  return (GType) id;
+}
+
+GType
+gst_player_seek_mode_get_type (void)
+{
+  static gsize id = 0;
+  static const GEnumValue values[] = {
+    {C_ENUM (GST_PLAYER_SEEK_MODE_DEFAULT), "GST_PLAYER_SEEK_MODE_DEFAULT",
+        "default"},
+    {C_ENUM (GST_PLAYER_SEEK_MODE_ACCURATE), "GST_PLAYER_SEEK_MODE_ACCURATE",
+        "accurate"},
+    {C_ENUM (GST_PLAYER_SEEK_MODE_KEY_UNIT), "GST_PLAYER_SEEK_MODE_KEY_UNIT",
+        "key-unit"},
+    {C_ENUM (GST_PLAYER_SEEK_MODE_SNAP_BEFORE),
+        "GST_PLAYER_SEEK_MODE_SNAP_BEFORE", "snap-before"},
+    {C_ENUM (GST_PLAYER_SEEK_MODE_SNAP_AFTER),
+        "GST_PLAYER_SEEK_MODE_SNAP_AFTER", "snap-after"},
+    {C_ENUM (GST_PLAYER_SEEK_MODE_SNAP_NEAREST),
+        "GST_PLAYER_SEEK_MODE_SNAP_NEAREST", "snap-nearest"},
+    {0, NULL, NULL}
+  };
+
+  if (g_once_init_enter (&id)) {
+    GType tmp = g_enum_register_static ("GstPlayerSeekMode", values);
+    g_once_init_leave (&id, tmp);
+  }
+
+  return (GType) id;
+}
+
 const gchar *
 gst_player_error_get_name (GstPlayerError error)
 {
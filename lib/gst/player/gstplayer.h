@@ -22,7 +22,10 @@
 #define __GST_PLAYER_H__
 
 #include <gst/gst.h>
+#include <gst/video/video.h>
 #include <gst/player/gstplayer-media-info.h>
+#include <gst/player/gstplayer-executor.h>
+#include <gst/player/gstplayer-media-info-cache.h>
 
 G_BEGIN_DECLS
 
@@ -50,6 +53,67 @@ typedef enum {
 
 const gchar *gst_player_error_get_name                (GstPlayerError error);
 
+GType        gst_player_position_update_flags_get_type
+                                                      (void);
+#define      GST_TYPE_PLAYER_POSITION_UPDATE_FLAGS    (gst_player_position_update_flags_get_type ())
+
+typedef enum
+{
+  GST_PLAYER_POSITION_UPDATE_FLAG_NONE          = 0,
+  GST_PLAYER_POSITION_UPDATE_FLAG_ADAPTIVE      = (1 << 0),
+  GST_PLAYER_POSITION_UPDATE_FLAG_FRAME_ALIGNED = (1 << 1)
+} GstPlayerPositionUpdateFlags;
+
+GType        gst_player_seek_mode_get_type            (void);
+#define      GST_TYPE_PLAYER_SEEK_MODE                (gst_player_seek_mode_get_type ())
+
+/**
+ * GstPlayerSeekMode:
+ * @GST_PLAYER_SEEK_MODE_DEFAULT: let the demuxer decide, usually accurate
+ *     but without decoding the frames before the position
+ * @GST_PLAYER_SEEK_MODE_ACCURATE: go exactly to the requested position
+ * @GST_PLAYER_SEEK_MODE_KEY_UNIT: go to the keyframe closest before or at
+ *     the requested position
+ * @GST_PLAYER_SEEK_MODE_SNAP_BEFORE: go to the keyframe before the requested
+ *     position
+ * @GST_PLAYER_SEEK_MODE_SNAP_AFTER: go to the keyframe after the requested
+ *     position
+ * @GST_PLAYER_SEEK_MODE_SNAP_NEAREST: go to the keyframe nearest to the
+ *     requested position
+ */
+typedef enum
+{
+  GST_PLAYER_SEEK_MODE_DEFAULT,
+  GST_PLAYER_SEEK_MODE_ACCURATE,
+  GST_PLAYER_SEEK_MODE_KEY_UNIT,
+  GST_PLAYER_SEEK_MODE_SNAP_BEFORE,
+  GST_PLAYER_SEEK_MODE_SNAP_AFTER,
+  GST_PLAYER_SEEK_MODE_SNAP_NEAREST
+} GstPlayerSeekMode;
+
+GType        gst_player_degradation_flags_get_type    (void);
+#define      GST_TYPE_PLAYER_DEGRADATION_FLAGS        (gst_player_degradation_flags_get_type ())
+
+/**
+ * GstPlayerDegradationFlags:
+ * @GST_PLAYER_DEGRADATION_FLAG_NONE: never degrade
+ * @GST_PLAYER_DEGRADATION_FLAG_SKIP_FRAMES: let video decoders skip B-frames
+ *     if they support it (only the libav decoders do)
+ * @GST_PLAYER_DEGRADATION_FLAG_MAX_LATENESS: let video sinks drop late
+ *     frames earlier
+ * @GST_PLAYER_DEGRADATION_FLAG_LOWER_VARIANT: switch adaptive streams to
+ *     the lowest variant
+ * @GST_PLAYER_DEGRADATION_FLAG_KEY_UNITS: only decode keyframes
+ */
+typedef enum
+{
+  GST_PLAYER_DEGRADATION_FLAG_NONE          = 0,
+  GST_PLAYER_DEGRADATION_FLAG_SKIP_FRAMES   = (1 << 0),
+  GST_PLAYER_DEGRADATION_FLAG_MAX_LATENESS  = (1 << 1),
+  GST_PLAYER_DEGRADATION_FLAG_LOWER_VARIANT = (1 << 2),
+  GST_PLAYER_DEGRADATION_FLAG_KEY_UNITS     = (1 << 3)
+} GstPlayerDegradationFlags;
+
 typedef struct _GstPlayer GstPlayer;
 typedef struct _GstPlayerClass GstPlayerClass;
 
@@ -64,6 +128,7 @@ typedef struct _GstPlayerClass GstPlayerClass;
 GType        gst_player_get_type                      (void);
 
 GstPlayer *  gst_player_new                           (void);
+GstPlayer *  gst_player_new_with_executor             (GstPlayerExecutor * executor);
 
 void         gst_player_play                          (GstPlayer    * player);
 void         gst_player_pause                         (GstPlayer    * player);
@@ -79,6 +144,26 @@ void         gst_player_set_dispatch_to_main_context  (GstPlayer    * player,
 gchar *      gst_player_get_uri                       (GstPlayer    * player);
 void         gst_player_set_uri                       (GstPlayer    * player,
                                                        const gchar  * uri);
+void         gst_player_set_uri_with_validator        (GstPlayer    * player,
+                                                       const gchar  * uri,
+                                                       const gchar  * validator);
+
+gchar *      gst_player_get_next_uri                  (GstPlayer    * player);
+void         gst_player_set_next_uri                  (GstPlayer    * player,
+                                                       const gchar  * uri);
+
+void         gst_player_preload                       (GstPlayer    * player,
+                                                       const gchar  * uri);
+void         gst_player_activate_preloaded            (GstPlayer    * player,
+                                                       const gchar  * uri);
+
+guint        gst_player_get_max_preloaded             (GstPlayer    * player);
+void         gst_player_set_max_preloaded             (GstPlayer    * player,
+                                                       guint          max_preloaded);
+
+guint64      gst_player_get_preload_memory_limit      (GstPlayer    * player);
+void         gst_player_set_preload_memory_limit      (GstPlayer    * player,
+                                                       guint64        limit);
 
 GstClockTime gst_player_get_position                  (GstPlayer    * player);
 GstClockTime gst_player_get_duration                  (GstPlayer    * player);
@@ -97,6 +182,126 @@ void         gst_player_set_window_handle             (GstPlayer    * player,
 
 GstElement * gst_player_get_pipeline                  (GstPlayer    * player);
 
+GstSample *  gst_player_get_video_snapshot            (GstPlayer    * player,
+                                                       GstVideoFormat format,
+                                                       guint          max_width,
+                                                       guint          max_height);
+
+gboolean     gst_player_get_video_frame_delivery      (GstPlayer    * player);
+void         gst_player_set_video_frame_delivery      (GstPlayer    * player,
+                                                       gboolean       enabled);
+
+guint        gst_player_get_video_frame_queue_size    (GstPlayer    * player);
+void         gst_player_set_video_frame_queue_size    (GstPlayer    * player,
+                                                       guint          size);
+
+guint        gst_player_get_video_frame_pool_size     (GstPlayer    * player);
+void         gst_player_set_video_frame_pool_size     (GstPlayer    * player,
+                                                       guint          size);
+
+gboolean     gst_player_pull_video_frame              (GstPlayer    * player,
+                                                       GstVideoFrame * frame);
+
+guint        gst_player_get_audio_level_interval      (GstPlayer    * player);
+void         gst_player_set_audio_level_interval      (GstPlayer    * player,
+                                                       guint          interval);
+
+guint        gst_player_get_audio_spectrum_bands      (GstPlayer    * player);
+void         gst_player_set_audio_spectrum_bands      (GstPlayer    * player,
+                                                       guint          n_bands);
+
+guint        gst_player_get_position_update_interval  (GstPlayer    * player);
+void         gst_player_set_position_update_interval  (GstPlayer    * player,
+                                                       guint          interval);
+
+GstPlayerPositionUpdateFlags
+             gst_player_get_position_update_flags     (GstPlayer    * player);
+void         gst_player_set_position_update_flags     (GstPlayer    * player,
+                                                       GstPlayerPositionUpdateFlags flags);
+
+gboolean     gst_player_get_visible                   (GstPlayer    * player);
+void         gst_player_set_visible                   (GstPlayer    * player,
+                                                       gboolean       visible);
+
+guint        gst_player_get_media_info_update_interval
+                                                      (GstPlayer    * player);
+void         gst_player_set_media_info_update_interval
+                                                      (GstPlayer    * player,
+                                                       guint          interval);
+
+void         gst_player_get_event_stats               (GstPlayer    * player,
+                                                       guint        * coalesced,
+                                                       guint        * overflowed);
+
+gint         gst_player_get_idle_timeout              (GstPlayer    * player);
+void         gst_player_set_idle_timeout              (GstPlayer    * player,
+                                                       gint           timeout);
+
+guint        gst_player_release_idle_pipelines        (guint          keep);
+
+void         gst_player_get_pipeline_reuse_stats      (GstPlayer    * player,
+                                                       guint        * warm_starts,
+                                                       guint        * cold_starts,
+                                                       guint        * releases);
+
+GstPlayerSeekMode
+             gst_player_get_seek_mode                 (GstPlayer    * player);
+void         gst_player_set_seek_mode                 (GstPlayer    * player,
+                                                       GstPlayerSeekMode mode);
+
+GstClockTime *
+             gst_player_get_seek_latencies            (GstPlayer    * player,
+                                                       guint        * n_latencies);
+
+gdouble      gst_player_get_rate                      (GstPlayer    * player);
+void         gst_player_set_rate                      (GstPlayer    * player,
+                                                       gdouble        rate);
+
+GstPlayerDegradationFlags
+             gst_player_get_degradation_steps         (GstPlayer    * player);
+void         gst_player_set_degradation_steps         (GstPlayer    * player,
+                                                       GstPlayerDegradationFlags steps);
+
+gint         gst_player_get_buffer_size               (GstPlayer    * player);
+void         gst_player_set_buffer_size               (GstPlayer    * player,
+                                                       gint           size);
+
+gint64       gst_player_get_buffer_duration           (GstPlayer    * player);
+void         gst_player_set_buffer_duration           (GstPlayer    * player,
+                                                       gint64         duration);
+
+GstBufferingMode
+             gst_player_get_buffering_mode            (GstPlayer    * player);
+void         gst_player_set_buffering_mode            (GstPlayer    * player,
+                                                       GstBufferingMode mode);
+
+void         gst_player_get_buffering_watermarks      (GstPlayer    * player,
+                                                       gint         * low,
+                                                       gint         * high);
+void         gst_player_set_buffering_watermarks      (GstPlayer    * player,
+                                                       gint           low,
+                                                       gint           high);
+
+gboolean     gst_player_get_buffering_early_resume    (GstPlayer    * player);
+void         gst_player_set_buffering_early_resume    (GstPlayer    * player,
+                                                       gboolean       early_resume);
+
+gchar *      gst_player_get_download_cache_dir        (GstPlayer    * player);
+void         gst_player_set_download_cache_dir        (GstPlayer    * player,
+                                                       const gchar  * dir);
+
+guint64      gst_player_get_download_cache_size       (GstPlayer    * player);
+void         gst_player_set_download_cache_size       (GstPlayer    * player,
+                                                       guint64        size);
+
+GstPlayerMediaInfoCache *
+             gst_player_get_media_info_cache          (GstPlayer    * player);
+void         gst_player_set_media_info_cache          (GstPlayer    * player,
+                                                       GstPlayerMediaInfoCache * cache);
+
+GstStructure *
+             gst_player_get_stats                     (GstPlayer    * player);
+
 void          gst_player_set_video_track_enabled      (GstPlayer    * player,
                                                        gboolean enabled);
 
@@ -23,5 +23,9 @@
 
 #include <gst/player/gstplayer.h>
 #include <gst/player/gstplayer-media-info.h>
+#include <gst/player/gstplayer-executor.h>
+#include <gst/player/gstplayer-thumbnailer.h>
+#include <gst/player/gstplayer-discoverer.h>
+#include <gst/player/gstplayer-media-info-cache.h>
 
 #endif /* __PLAYER_H__ */
@@ -0,0 +1,162 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Compares the cost of the audio analysis tap of GstPlayer with the level
+ * element. Each pipeline pushes white noise as fast as possible into a
+ * fakesink, once without analysis, once through level and once with the
+ * tap in a pad probe. The time without analysis is subtracted.
+ *
+ * Usage: benchmark-audio-level [SECONDS_OF_AUDIO]
+ */
+
+#include <gst/gst.h>
+#include <gst/player/gstplayer-audio-analysis-private.h>
+
+#include <stdlib.h>
+
+#define RATE 48000
+#define SAMPLES_PER_BUFFER 1024
+
+typedef enum
+{
+  MODE_NONE,
+  MODE_LEVEL,
+  MODE_TAP
+} BenchmarkMode;
+
+static GstPadProbeReturn
+tap_probe_cb (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  GstPlayerAudioAnalysis *analysis = user_data;
+  GstStructure *levels;
+  GstEvent *event;
+  GstCaps *caps;
+
+  if (GST_PAD_PROBE_INFO_TYPE (info) & GST_PAD_PROBE_TYPE_BUFFER) {
+    levels = gst_player_audio_analysis_process (analysis,
+        GST_PAD_PROBE_INFO_BUFFER (info));
+    if (levels)
+      gst_structure_free (levels);
+  } else {
+    event = GST_PAD_PROBE_INFO_EVENT (info);
+    if (GST_EVENT_TYPE (event) == GST_EVENT_CAPS) {
+      gst_event_parse_caps (event, &caps);
+      gst_player_audio_analysis_set_caps (analysis, caps);
+    }
+  }
+
+  return GST_PAD_PROBE_OK;
+}
+
+/* Returns the time in microseconds until EOS, or -1 */
+static gint64
+run (BenchmarkMode mode, const gchar * format, gint channels,
+    guint n_buffers, const gchar ** kernel)
+{
+  GstPlayerAudioAnalysis *analysis = NULL;
+  GstElement *pipeline, *sink;
+  GstMessage *msg;
+  GstPad *pad;
+  gchar *desc;
+  gint64 start, elapsed = -1;
+
+  desc = g_strdup_printf ("audiotestsrc wave=white-noise num-buffers=%u "
+      "samplesperbuffer=%d ! audio/x-raw,format=%s,channels=%d,rate=%d "
+      "%s ! fakesink name=sink sync=false", n_buffers, SAMPLES_PER_BUFFER,
+      format, channels, RATE,
+      mode == MODE_LEVEL ? "! level interval=50000000" : "");
+  pipeline = gst_parse_launch (desc, NULL);
+  g_free (desc);
+  if (!pipeline)
+    return -1;
+
+  if (mode == MODE_TAP) {
+    analysis = gst_player_audio_analysis_new ();
+    gst_player_audio_analysis_configure (analysis, 50 * GST_MSECOND, 0);
+    sink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+    pad = gst_element_get_static_pad (sink, "sink");
+    gst_pad_add_probe (pad,
+        GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM,
+        tap_probe_cb, analysis, NULL);
+    gst_object_unref (pad);
+    gst_object_unref (sink);
+  }
+
+  gst_element_set_state (pipeline, GST_STATE_PAUSED);
+  gst_element_get_state (pipeline, NULL, NULL, GST_CLOCK_TIME_NONE);
+
+  start = g_get_monotonic_time ();
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  msg = gst_bus_timed_pop_filtered (GST_ELEMENT_BUS (pipeline),
+      GST_CLOCK_TIME_NONE, GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  if (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_EOS)
+    elapsed = g_get_monotonic_time () - start;
+  gst_message_unref (msg);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  if (analysis) {
+    *kernel = gst_player_audio_analysis_get_kernel_name (analysis);
+    gst_player_audio_analysis_free (analysis);
+  }
+
+  return elapsed;
+}
+
+int
+main (int argc, char **argv)
+{
+  const gchar *formats[] = {
+    G_BYTE_ORDER == G_LITTLE_ENDIAN ? "S16LE" : "S16BE",
+    G_BYTE_ORDER == G_LITTLE_ENDIAN ? "F32LE" : "F32BE"
+  };
+  const gint channels[] = { 1, 2, 6 };
+  const gchar *kernel = "none";
+  guint seconds = 600, n_buffers, f, c;
+  gint64 none, level, tap;
+  gdouble n_samples;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    seconds = MAX (atoi (argv[1]), 1);
+  n_buffers = seconds * RATE / SAMPLES_PER_BUFFER;
+
+  g_print ("Analysis cost in ns per sample over %u s of audio:\n", seconds);
+  g_print ("  format channels    level      tap  kernel\n");
+
+  for (f = 0; f < G_N_ELEMENTS (formats); f++) {
+    for (c = 0; c < G_N_ELEMENTS (channels); c++) {
+      none = run (MODE_NONE, formats[f], channels[c], n_buffers, &kernel);
+      level = run (MODE_LEVEL, formats[f], channels[c], n_buffers, &kernel);
+      tap = run (MODE_TAP, formats[f], channels[c], n_buffers, &kernel);
+      if (none < 0 || level < 0 || tap < 0) {
+        g_printerr ("Failed to run pipeline\n");
+        return 1;
+      }
+
+      n_samples = (gdouble) n_buffers * SAMPLES_PER_BUFFER * channels[c];
+      g_print ("  %6s %8d %8.3f %8.3f  %s\n", formats[f], channels[c],
+          MAX (level - none, 0) * 1000.0 / n_samples,
+          MAX (tap - none, 0) * 1000.0 / n_samples, kernel);
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,173 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Measures the time from switching the URI until the player reports
+ * PLAYING, once with gst_player_set_uri() and once with a URI that was
+ * preloaded with gst_player_preload() before.
+ *
+ * Usage: benchmark-preload [ITERATIONS] [URI1 URI2]
+ */
+
+#include <gst/gst.h>
+#include <gst/player/player.h>
+
+#include <stdlib.h>
+
+typedef struct
+{
+  GMutex lock;
+  GCond cond;
+  gboolean playing;
+  gboolean error;
+} BenchmarkState;
+
+static void
+state_changed_cb (GstPlayer * player, GstPlayerState state,
+    BenchmarkState * b)
+{
+  if (state != GST_PLAYER_STATE_PLAYING)
+    return;
+
+  g_mutex_lock (&b->lock);
+  b->playing = TRUE;
+  g_cond_signal (&b->cond);
+  g_mutex_unlock (&b->lock);
+}
+
+static void
+error_cb (GstPlayer * player, GError * err, BenchmarkState * b)
+{
+  g_printerr ("Error: %s\n", err->message);
+
+  g_mutex_lock (&b->lock);
+  b->error = TRUE;
+  g_cond_signal (&b->cond);
+  g_mutex_unlock (&b->lock);
+}
+
+/* Returns the time in microseconds until PLAYING was reached, or -1 */
+static gint64
+wait_playing (BenchmarkState * b, gint64 start)
+{
+  gint64 elapsed;
+
+  g_mutex_lock (&b->lock);
+  while (!b->playing && !b->error)
+    g_cond_wait (&b->cond, &b->lock);
+  elapsed = b->error ? -1 : g_get_monotonic_time () - start;
+  b->playing = FALSE;
+  g_mutex_unlock (&b->lock);
+
+  return elapsed;
+}
+
+static gint64
+switch_cold (GstPlayer * player, BenchmarkState * b, const gchar * uri)
+{
+  gint64 start = g_get_monotonic_time ();
+
+  gst_player_set_uri (player, uri);
+  gst_player_play (player);
+
+  return wait_playing (b, start);
+}
+
+static gint64
+switch_preloaded (GstPlayer * player, BenchmarkState * b, const gchar * uri)
+{
+  gint64 start;
+
+  gst_player_preload (player, uri);
+  /* Give the background pipeline time to preroll */
+  g_usleep (G_USEC_PER_SEC);
+
+  start = g_get_monotonic_time ();
+  gst_player_activate_preloaded (player, uri);
+
+  return wait_playing (b, start);
+}
+
+static gchar *
+test_uri (const gchar * file)
+{
+  gchar *path, *uri;
+
+  path = g_build_filename (TEST_PATH, file, NULL);
+  uri = gst_filename_to_uri (path, NULL);
+  g_free (path);
+
+  return uri;
+}
+
+int
+main (int argc, char **argv)
+{
+  BenchmarkState b = { 0, };
+  GstPlayer *player;
+  gchar *uris[2];
+  guint iterations = 10, i;
+  gint64 cold = 0, preloaded = 0, t;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    iterations = MAX (atoi (argv[1]), 1);
+  if (argc > 3) {
+    uris[0] = g_strdup (argv[2]);
+    uris[1] = g_strdup (argv[3]);
+  } else {
+    uris[0] = test_uri ("audio-video.ogg");
+    uris[1] = test_uri ("audio.ogg");
+  }
+
+  g_mutex_init (&b.lock);
+  g_cond_init (&b.cond);
+
+  player = gst_player_new ();
+  g_signal_connect (player, "state-changed", G_CALLBACK (state_changed_cb),
+      &b);
+  g_signal_connect (player, "error", G_CALLBACK (error_cb), &b);
+
+  for (i = 0; i < iterations; i++) {
+    t = switch_cold (player, &b, uris[i % 2]);
+    if (t < 0)
+      goto error;
+    cold += t;
+  }
+
+  for (i = 0; i < iterations; i++) {
+    t = switch_preloaded (player, &b, uris[i % 2]);
+    if (t < 0)
+      goto error;
+    preloaded += t;
+  }
+
+  g_print ("Average time until playing over %u switches:\n", iterations);
+  g_print ("  set-uri:   %8.3f ms\n", cold / 1000.0 / iterations);
+  g_print ("  preloaded: %8.3f ms\n", preloaded / 1000.0 / iterations);
+
+error:
+  gst_player_stop (player);
+  g_object_unref (player);
+  g_free (uris[0]);
+  g_free (uris[1]);
+  g_mutex_clear (&b.lock);
+  g_cond_clear (&b.cond);
+
+  return b.error ? 1 : 0;
+}
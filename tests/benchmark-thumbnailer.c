@@ -0,0 +1,120 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Measures how many thumbnails per second GstPlayerThumbnailer extracts
+ * with one worker per core and with a single worker.
+ *
+ * Usage: benchmark-thumbnailer [N_THUMBNAILS] [URI...]
+ */
+
+#include <gst/gst.h>
+#include <gst/player/player.h>
+#include <glib/gstdio.h>
+
+#include <stdlib.h>
+#include <unistd.h>
+
+static gchar *
+test_uri (const gchar * file)
+{
+  gchar *path, *uri;
+
+  path = g_build_filename (TEST_PATH, file, NULL);
+  uri = gst_filename_to_uri (path, NULL);
+  g_free (path);
+
+  return uri;
+}
+
+/* Returns the thumbnails per second, or -1 on errors */
+static gdouble
+run (guint n_workers, const gchar * uri, guint n_thumbnails,
+    const gchar * location)
+{
+  GstPlayerThumbnailer *thumbnailer;
+  GError *err = NULL;
+  gint64 start, elapsed;
+
+  thumbnailer = gst_player_thumbnailer_new (n_workers);
+
+  start = g_get_monotonic_time ();
+  if (!gst_player_thumbnailer_generate (thumbnailer, uri, n_thumbnails, 0,
+          location, &err)) {
+    g_printerr ("Error: %s\n", err->message);
+    g_clear_error (&err);
+    g_object_unref (thumbnailer);
+    return -1;
+  }
+  elapsed = g_get_monotonic_time () - start;
+
+  g_object_unref (thumbnailer);
+
+  return n_thumbnails * (gdouble) G_USEC_PER_SEC / MAX (elapsed, 1);
+}
+
+int
+main (int argc, char **argv)
+{
+  gchar **uris;
+  gchar *location;
+  guint n_thumbnails = 32, n_cores, i;
+  gdouble single, parallel;
+  gint fd, ret = 0, j;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    n_thumbnails = MAX (atoi (argv[1]), 1);
+  if (argc > 2) {
+    uris = g_new0 (gchar *, argc - 1);
+    for (j = 2; j < argc; j++)
+      uris[j - 2] = g_strdup (argv[j]);
+  } else {
+    uris = g_new0 (gchar *, 3);
+    uris[0] = test_uri ("audio-video.ogg");
+    uris[1] = test_uri ("audio-video-short.ogg");
+  }
+
+  fd = g_file_open_tmp ("benchmark-thumbnailer-XXXXXX", &location, NULL);
+  if (fd == -1)
+    return 1;
+  close (fd);
+
+  n_cores = MAX (g_get_num_processors (), 1);
+  g_print ("%u thumbnails per file, %u cores:\n", n_thumbnails, n_cores);
+
+  for (i = 0; uris[i]; i++) {
+    single = run (1, uris[i], n_thumbnails, location);
+    parallel = run (n_cores, uris[i], n_thumbnails, location);
+    if (single < 0 || parallel < 0) {
+      ret = 1;
+      break;
+    }
+
+    g_print ("%s\n", uris[i]);
+    g_print ("  1 worker:   %8.1f thumbnails/s\n", single);
+    g_print ("  %u workers: %8.1f thumbnails/s, %.1f per core\n", n_cores,
+        parallel, parallel / n_cores);
+  }
+
+  g_unlink (location);
+  g_free (location);
+  g_strfreev (uris);
+
+  return ret;
+}
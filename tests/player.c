@@ -58,7 +58,12 @@ G_STMT_START {                                                          \
     "'" #a "' (%s) is not equal to '" #b "' (%s)", first, second);      \
 } G_STMT_END;
 
+#include <gst/base/gstbasesink.h>
 #include <gst/player/gstplayer.h>
+#include <gst/player/gstplayer-thumbnailer.h>
+#include <gst/player/gstplayer-discoverer.h>
+#include <glib/gstdio.h>
+#include <unistd.h>
 
 GST_DEBUG_CATEGORY_STATIC (test_debug);
 #define GST_CAT_DEFAULT test_debug
@@ -74,6 +79,29 @@ START_TEST (test_create_and_free)
 
 END_TEST;
 
+START_TEST (test_create_and_free_with_executor)
+{
+  GstPlayerExecutor *executor;
+  GstPlayer *players[4];
+  guint i;
+
+  executor = gst_player_executor_new (2);
+  fail_unless (executor != NULL);
+  fail_unless_equals_int (gst_player_executor_get_n_threads (executor), 2);
+
+  for (i = 0; i < G_N_ELEMENTS (players); i++) {
+    players[i] = gst_player_new_with_executor (executor);
+    fail_unless (players[i] != NULL);
+  }
+
+  g_object_unref (executor);
+
+  for (i = 0; i < G_N_ELEMENTS (players); i++)
+    g_object_unref (players[i]);
+}
+
+END_TEST;
+
 START_TEST (test_set_and_get_uri)
 {
   GstPlayer *player;
@@ -94,6 +122,504 @@ START_TEST (test_set_and_get_uri)
 
 END_TEST;
 
+START_TEST (test_set_and_get_next_uri)
+{
+  GstPlayer *player;
+  gchar *uri;
+
+  player = gst_player_new ();
+
+  fail_unless (player != NULL);
+
+  uri = gst_player_get_next_uri (player);
+  fail_unless (uri == NULL);
+
+  gst_player_set_next_uri (player, "file:///path/to/another/file");
+  uri = gst_player_get_next_uri (player);
+
+  fail_unless (g_strcmp0 (uri, "file:///path/to/another/file") == 0);
+  g_free (uri);
+
+  gst_player_set_next_uri (player, NULL);
+  uri = gst_player_get_next_uri (player);
+  fail_unless (uri == NULL);
+
+  g_object_unref (player);
+}
+
+END_TEST;
+
+START_TEST (test_set_and_get_rate)
+{
+  GstPlayer *player;
+
+  player = gst_player_new ();
+
+  fail_unless (player != NULL);
+
+  fail_unless (gst_player_get_rate (player) == 1.0);
+  gst_player_set_rate (player, -8.0);
+  fail_unless (gst_player_get_rate (player) == -8.0);
+
+  /* A rate of 0 is rejected and keeps the previous one */
+  g_object_set (player, "rate", 0.0, NULL);
+  fail_unless (gst_player_get_rate (player) == -8.0);
+
+  g_object_unref (player);
+}
+
+END_TEST;
+
+START_TEST (test_get_video_snapshot_without_video)
+{
+  GstPlayer *player;
+
+  player = gst_player_new ();
+
+  fail_unless (player != NULL);
+
+  fail_unless (gst_player_get_video_snapshot (player,
+          GST_VIDEO_FORMAT_UNKNOWN, 0, 0) == NULL);
+  fail_unless (gst_player_get_video_snapshot (player,
+          GST_VIDEO_FORMAT_RGBx, 160, 120) == NULL);
+
+  g_object_unref (player);
+}
+
+END_TEST;
+
+static void
+test_video_frame_delivery_cb (GstPlayer * player, GMainLoop * loop)
+{
+  g_main_loop_quit (loop);
+}
+
+START_TEST (test_video_frame_delivery)
+{
+  GstPlayer *player;
+  GstVideoFrame frame;
+  GstStructure *stats;
+  GMainLoop *loop;
+  guint64 dropped;
+  gchar *uri;
+
+  loop = g_main_loop_new (NULL, FALSE);
+  player = gst_player_new ();
+  fail_unless (player != NULL);
+  g_signal_connect (player, "video-frame-available",
+      G_CALLBACK (test_video_frame_delivery_cb), loop);
+
+  fail_if (gst_player_pull_video_frame (player, &frame));
+
+  gst_player_set_video_frame_delivery (player, TRUE);
+  gst_player_set_video_frame_queue_size (player, 2);
+  gst_player_set_video_frame_pool_size (player, 6);
+  fail_unless (gst_player_get_video_frame_delivery (player));
+  fail_unless_equals_int (gst_player_get_video_frame_queue_size (player), 2);
+  fail_unless_equals_int (gst_player_get_video_frame_pool_size (player), 6);
+
+  uri = gst_filename_to_uri (TEST_PATH "/audio-video-short.ogg", NULL);
+  fail_unless (uri != NULL);
+  gst_player_set_uri (player, uri);
+  g_free (uri);
+
+  gst_player_pause (player);
+  g_main_loop_run (loop);
+
+  fail_unless (gst_player_pull_video_frame (player, &frame));
+  fail_unless (GST_VIDEO_FRAME_WIDTH (&frame) > 0);
+  fail_unless (GST_VIDEO_FRAME_PLANE_DATA (&frame, 0) != NULL);
+  gst_video_frame_unmap (&frame);
+
+  stats = gst_player_get_stats (player);
+  fail_unless (gst_structure_get_uint64 (stats, "delivery-frames-dropped",
+          &dropped));
+  /* The queue holds more than the single prerolled frame */
+  fail_unless_equals_uint64 (dropped, 0);
+  gst_structure_free (stats);
+
+  gst_player_stop (player);
+  g_object_unref (player);
+  g_main_loop_unref (loop);
+}
+
+END_TEST;
+
+typedef struct
+{
+  GMainLoop *loop;
+  GstStructure *levels;
+} TestAudioLevelsState;
+
+static void
+test_audio_levels_cb (GstPlayer * player, const GstStructure * levels,
+    TestAudioLevelsState * state)
+{
+  GstStructure *copy = gst_structure_copy (levels);
+
+  /* Emitted from the streaming thread, only keep the first one */
+  if (!g_atomic_pointer_compare_and_exchange (&state->levels, NULL, copy))
+    gst_structure_free (copy);
+  g_main_loop_quit (state->loop);
+}
+
+START_TEST (test_audio_levels)
+{
+  TestAudioLevelsState state = { NULL, NULL };
+  GstPlayer *player;
+  const GValue *peak, *spectrum;
+  guint64 timestamp;
+  gchar *uri;
+
+  state.loop = g_main_loop_new (NULL, FALSE);
+  player = gst_player_new ();
+  fail_unless (player != NULL);
+  g_signal_connect (player, "audio-levels",
+      G_CALLBACK (test_audio_levels_cb), &state);
+
+  fail_unless_equals_int (gst_player_get_audio_level_interval (player), 0);
+  gst_player_set_audio_level_interval (player, 50);
+  gst_player_set_audio_spectrum_bands (player, 8);
+  fail_unless_equals_int (gst_player_get_audio_level_interval (player), 50);
+  fail_unless_equals_int (gst_player_get_audio_spectrum_bands (player), 8);
+
+  uri = gst_filename_to_uri (TEST_PATH "/audio-short.ogg", NULL);
+  fail_unless (uri != NULL);
+  gst_player_set_uri (player, uri);
+  g_free (uri);
+
+  gst_player_play (player);
+  g_main_loop_run (state.loop);
+  gst_player_stop (player);
+
+  fail_unless (state.levels != NULL);
+  fail_unless (gst_structure_get_uint64 (state.levels, "timestamp",
+          &timestamp));
+  peak = gst_structure_get_value (state.levels, "peak");
+  fail_unless (peak != NULL);
+  fail_unless (gst_value_array_get_size (peak) > 0);
+  fail_unless (gst_structure_has_field (state.levels, "rms"));
+  spectrum = gst_structure_get_value (state.levels, "spectrum");
+  fail_unless (spectrum != NULL);
+  fail_unless_equals_int (gst_value_array_get_size (spectrum), 8);
+
+  gst_structure_free (state.levels);
+  g_object_unref (player);
+  g_main_loop_unref (state.loop);
+}
+
+END_TEST;
+
+START_TEST (test_thumbnailer)
+{
+  GstPlayerThumbnailer *thumbnailer;
+  GstPlayerThumbnails *thumbnails;
+  GstSample *sample;
+  GstStructure *s;
+  GError *err = NULL;
+  gchar *uri, *location;
+  gint fd, width;
+
+  uri = gst_filename_to_uri (TEST_PATH "/audio-video.ogg", NULL);
+  fail_unless (uri != NULL);
+  fd = g_file_open_tmp ("gst-player-test-XXXXXX", &location, NULL);
+  fail_unless (fd != -1);
+  close (fd);
+
+  thumbnailer = gst_player_thumbnailer_new (2);
+  fail_unless_equals_int (gst_player_thumbnailer_get_n_workers (thumbnailer),
+      2);
+  gst_player_thumbnailer_set_width (thumbnailer, 64);
+  fail_unless (gst_player_thumbnailer_generate (thumbnailer, uri, 4, 0,
+          location, &err));
+  g_object_unref (thumbnailer);
+
+  thumbnails = gst_player_thumbnails_open (location, uri, &err);
+  fail_unless (thumbnails != NULL);
+  fail_unless_equals_int (gst_player_thumbnails_get_n_thumbnails (thumbnails),
+      4);
+
+  sample = gst_player_thumbnails_get_sample (thumbnails, 5 * GST_SECOND);
+  fail_unless (sample != NULL);
+  s = gst_caps_get_structure (gst_sample_get_caps (sample), 0);
+  fail_unless (gst_structure_get_int (s, "width", &width));
+  fail_unless_equals_int (width, 64);
+  gst_sample_unref (sample);
+  g_object_unref (thumbnails);
+
+  /* Thumbnails of another URI are rejected */
+  fail_unless (gst_player_thumbnails_open (location, "file:///other.ogg",
+          &err) == NULL);
+  fail_unless (err != NULL);
+  g_clear_error (&err);
+
+  g_unlink (location);
+  g_free (location);
+  g_free (uri);
+}
+
+END_TEST;
+
+typedef struct
+{
+  guint n_calls;
+  guint n_errors;
+  guint last_done;
+  GstClockTime duration;
+  guint n_audio;
+} TestDiscoverState;
+
+static void
+test_discover_batch_cb (const gchar * uri, guint index,
+    GstPlayerMediaInfo * info, const GError * error, guint n_done,
+    guint n_total, gpointer user_data)
+{
+  TestDiscoverState *state = user_data;
+
+  state->n_calls++;
+  fail_unless_equals_int (n_total, 2);
+  fail_unless_equals_int (n_done, state->n_calls);
+  state->last_done = n_done;
+
+  if (index == 0) {
+    fail_unless (info != NULL);
+    fail_unless (error == NULL);
+    fail_unless_equals_string (gst_player_media_info_get_uri (info), uri);
+    state->duration = gst_player_media_info_get_duration (info);
+    state->n_audio = g_list_length (gst_player_get_audio_streams (info));
+  } else {
+    fail_unless (info == NULL);
+    fail_unless (error != NULL);
+    state->n_errors++;
+  }
+}
+
+START_TEST (test_discover_batch)
+{
+  TestDiscoverState state = { 0, };
+  GCancellable *cancellable;
+  GError *err = NULL;
+  gchar *uris[3];
+
+  uris[0] = gst_filename_to_uri (TEST_PATH "/audio.ogg", NULL);
+  uris[1] = g_strdup ("foo://bar");
+  uris[2] = NULL;
+
+  fail_unless (gst_player_discover_batch ((const gchar * const *) uris, 2,
+          GST_CLOCK_TIME_NONE, test_discover_batch_cb, &state, NULL, &err));
+  fail_unless (err == NULL);
+  fail_unless_equals_int (state.n_calls, 2);
+  fail_unless_equals_int (state.n_errors, 1);
+  fail_unless_equals_int (state.last_done, 2);
+  fail_unless (GST_CLOCK_TIME_IS_VALID (state.duration));
+  fail_unless (state.duration > 0);
+  fail_unless_equals_int (state.n_audio, 1);
+
+  /* Nothing is discovered after cancellation */
+  memset (&state, 0, sizeof (state));
+  cancellable = g_cancellable_new ();
+  g_cancellable_cancel (cancellable);
+  fail_if (gst_player_discover_batch ((const gchar * const *) uris, 0,
+          GST_CLOCK_TIME_NONE, test_discover_batch_cb, &state, cancellable,
+          &err));
+  fail_unless (g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED));
+  fail_unless_equals_int (state.n_calls, 0);
+  g_clear_error (&err);
+  g_object_unref (cancellable);
+
+  g_free (uris[0]);
+  g_free (uris[1]);
+}
+
+END_TEST;
+
+static void
+test_media_info_cache_discover_cb (const gchar * uri, guint index,
+    GstPlayerMediaInfo * info, const GError * error, guint n_done,
+    guint n_total, gpointer user_data)
+{
+  GstPlayerMediaInfo **result = user_data;
+
+  fail_unless (info != NULL);
+  *result = g_object_ref (info);
+}
+
+START_TEST (test_media_info_cache)
+{
+  GstPlayerMediaInfoCache *cache;
+  GstPlayerMediaInfo *info = NULL, *cached;
+  GstPlayer *player;
+  GError *err = NULL;
+  gchar *uris[2], *dir, *foreign;
+
+  uris[0] = gst_filename_to_uri (TEST_PATH "/audio-video.ogg", NULL);
+  uris[1] = NULL;
+  fail_unless (gst_player_discover_batch ((const gchar * const *) uris, 1,
+          GST_CLOCK_TIME_NONE, test_media_info_cache_discover_cb, &info, NULL,
+          NULL));
+  fail_unless (info != NULL);
+
+  dir = g_dir_make_tmp ("gst-player-test-XXXXXX", NULL);
+  fail_unless (dir != NULL);
+  cache = gst_player_media_info_cache_new (dir, 1024 * 1024);
+  fail_unless (gst_player_media_info_cache_lookup (cache, uris[0],
+          NULL) == NULL);
+  fail_unless (gst_player_media_info_cache_store (cache, info, NULL, &err));
+  fail_unless (err == NULL);
+
+  cached = gst_player_media_info_cache_lookup (cache, uris[0], NULL);
+  fail_unless (cached != NULL);
+  fail_unless_equals_string (gst_player_media_info_get_uri (cached),
+      uris[0]);
+  fail_unless_equals_uint64 (gst_player_media_info_get_duration (cached),
+      gst_player_media_info_get_duration (info));
+  fail_unless_equals_int (gst_player_media_info_is_seekable (cached),
+      gst_player_media_info_is_seekable (info));
+  fail_unless_equals_int (g_list_length (gst_player_get_video_streams
+          (cached)), g_list_length (gst_player_get_video_streams (info)));
+  fail_unless_equals_int (g_list_length (gst_player_get_audio_streams
+          (cached)), g_list_length (gst_player_get_audio_streams (info)));
+  g_object_unref (cached);
+
+  /* Another validator does not match the entry */
+  fail_unless (gst_player_media_info_cache_lookup (cache, uris[0],
+          "other") == NULL);
+
+  player = gst_player_new ();
+  gst_player_set_media_info_cache (player, cache);
+  g_object_unref (cache);
+  cache = gst_player_get_media_info_cache (player);
+  fail_unless (cache != NULL);
+  fail_unless_equals_string (gst_player_media_info_cache_get_location (cache),
+      dir);
+  g_object_unref (cache);
+  g_object_unref (player);
+
+  /* Nothing is kept beyond the maximum size, but files that were not
+   * created by the cache are never removed */
+  foreign = g_build_filename (dir, "da39a3ee5e6b4b0d3255bfef95601890afd80709",
+      NULL);
+  fail_unless (g_file_set_contents (foreign, "data", -1, NULL));
+  cache = gst_player_media_info_cache_new (dir, 0);
+  fail_unless (gst_player_media_info_cache_store (cache, info, NULL, &err));
+  fail_unless (gst_player_media_info_cache_lookup (cache, uris[0],
+          NULL) == NULL);
+  g_object_unref (cache);
+  fail_unless (g_file_test (foreign, G_FILE_TEST_IS_REGULAR));
+  g_unlink (foreign);
+  g_free (foreign);
+
+  g_object_unref (info);
+  g_rmdir (dir);
+  g_free (dir);
+  g_free (uris[0]);
+}
+
+END_TEST;
+
+static void
+test_download_cache_uri_loaded_cb (GstPlayer * player, const gchar * uri,
+    GMainLoop * loop)
+{
+  g_main_loop_quit (loop);
+}
+
+static gchar *
+test_download_cache_load (GstPlayer * player, GMainLoop * loop,
+    const gchar * uri, const gchar * validator)
+{
+  GstElement *pipeline;
+  gchar *playbin_uri;
+
+  gst_player_set_uri_with_validator (player, uri, validator);
+  g_main_loop_run (loop);
+
+  pipeline = gst_player_get_pipeline (player);
+  g_object_get (pipeline, "uri", &playbin_uri, NULL);
+  gst_object_unref (pipeline);
+
+  return playbin_uri;
+}
+
+START_TEST (test_download_cache)
+{
+  const gchar *uri = "http://127.0.0.1/media.ogg";
+  GstPlayer *player;
+  GMainLoop *loop;
+  gchar *dir, *key, *name, *path, *cached_uri, *playbin_uri;
+
+  dir = g_dir_make_tmp ("gst-player-test-XXXXXX", NULL);
+  fail_unless (dir != NULL);
+
+  /* Cache entries are named by the checksum of URI and validator */
+  key = g_compute_checksum_for_string (G_CHECKSUM_SHA1,
+      "http://127.0.0.1/media.ogg\nv1", -1);
+  name = g_strconcat (key, ".download", NULL);
+  path = g_build_filename (dir, name, NULL);
+  fail_unless (g_file_set_contents (path, "", 0, NULL));
+  cached_uri = g_filename_to_uri (path, NULL, NULL);
+
+  loop = g_main_loop_new (NULL, FALSE);
+  player = gst_player_new ();
+  fail_unless (player != NULL);
+  g_signal_connect (player, "uri-loaded",
+      G_CALLBACK (test_download_cache_uri_loaded_cb), loop);
+
+  fail_unless (gst_player_get_download_cache_dir (player) == NULL);
+  gst_player_set_download_cache_dir (player, dir);
+  gst_player_set_download_cache_size (player, 1024 * 1024);
+  fail_unless_equals_uint64 (gst_player_get_download_cache_size (player),
+      1024 * 1024);
+  gst_player_set_buffering_mode (player, GST_BUFFERING_DOWNLOAD);
+
+  playbin_uri = test_download_cache_load (player, loop, uri, "v1");
+  fail_unless_equals_string (playbin_uri, cached_uri);
+  g_free (playbin_uri);
+
+  playbin_uri = test_download_cache_load (player, loop, uri, "v2");
+  fail_unless_equals_string (playbin_uri, uri);
+  g_free (playbin_uri);
+
+  g_object_unref (player);
+  g_main_loop_unref (loop);
+
+  g_unlink (path);
+  g_rmdir (dir);
+  g_free (cached_uri);
+  g_free (path);
+  g_free (name);
+  g_free (key);
+  g_free (dir);
+}
+
+END_TEST;
+
+START_TEST (test_set_and_get_position_update_interval)
+{
+  GstPlayer *player;
+
+  player = gst_player_new ();
+
+  fail_unless (player != NULL);
+
+  fail_unless_equals_int (gst_player_get_position_update_interval (player),
+      100);
+  gst_player_set_position_update_interval (player, 0);
+  fail_unless_equals_int (gst_player_get_position_update_interval (player),
+      0);
+
+  gst_player_set_position_update_flags (player,
+      GST_PLAYER_POSITION_UPDATE_FLAG_ADAPTIVE |
+      GST_PLAYER_POSITION_UPDATE_FLAG_FRAME_ALIGNED);
+  fail_unless_equals_int (gst_player_get_position_update_flags (player),
+      GST_PLAYER_POSITION_UPDATE_FLAG_ADAPTIVE |
+      GST_PLAYER_POSITION_UPDATE_FLAG_FRAME_ALIGNED);
+
+  g_object_unref (player);
+}
+
+END_TEST;
+
 typedef enum
 {
   STATE_CHANGE_BUFFERING,
@@ -724,6 +1250,1118 @@ START_TEST (test_play_error_invalid_uri_and_play)
 
 END_TEST;
 
+static void
+test_play_until_eos_cb (GstPlayer * player, TestPlayerStateChange change,
+    TestPlayerState * old_state, TestPlayerState * new_state)
+{
+  if (change == STATE_CHANGE_END_OF_STREAM || change == STATE_CHANGE_ERROR)
+    g_main_loop_quit (new_state->loop);
+}
+
+static void
+test_get_stats_uri_loaded_cb (GstPlayer * player, const gchar * uri,
+    TestPlayerState * state)
+{
+  g_main_loop_quit (state->loop);
+}
+
+START_TEST (test_get_stats)
+{
+  GstPlayer *player;
+  TestPlayerState state;
+  GstStructure *stats;
+  const GValue *histogram;
+  GStatBuf st;
+  guint64 bytes, stall_time;
+  guint rebuffer_count;
+  gchar *uri;
+
+  memset (&state, 0, sizeof (state));
+  state.loop = g_main_loop_new (NULL, FALSE);
+  state.test_callback = test_play_until_eos_cb;
+
+  player = test_player_new (&state);
+
+  uri = gst_filename_to_uri (TEST_PATH "/audio-short.ogg", NULL);
+  fail_unless (uri != NULL);
+  gst_player_set_uri (player, uri);
+  g_free (uri);
+
+  gst_player_play (player);
+  g_main_loop_run (state.loop);
+  fail_if (state.error);
+
+  /* The whole file went through the source, some of it maybe twice */
+  fail_unless (g_stat (TEST_PATH "/audio-short.ogg", &st) == 0);
+  stats = gst_player_get_stats (player);
+  fail_unless (stats != NULL);
+  fail_unless (gst_structure_get_uint64 (stats, "bytes-downloaded", &bytes));
+  fail_unless (bytes >= (guint64) st.st_size);
+
+  /* A local file never stalls */
+  fail_unless (gst_structure_get_uint (stats, "rebuffer-count",
+          &rebuffer_count));
+  fail_unless_equals_int (rebuffer_count, 0);
+  fail_unless (gst_structure_get_uint64 (stats, "stall-time", &stall_time));
+  fail_unless_equals_uint64 (stall_time, 0);
+
+  histogram = gst_structure_get_value (stats, "seek-latency-histogram");
+  fail_unless (histogram != NULL);
+  fail_unless_equals_int (gst_value_array_get_size (histogram),
+      gst_value_array_get_size (gst_structure_get_value (stats,
+              "histogram-bounds")) + 1);
+  gst_structure_free (stats);
+
+  /* Counting starts again for the next URI */
+  g_signal_connect (player, "uri-loaded",
+      G_CALLBACK (test_get_stats_uri_loaded_cb), &state);
+  uri = gst_filename_to_uri (TEST_PATH "/audio-video-short.ogg", NULL);
+  fail_unless (uri != NULL);
+  gst_player_set_uri (player, uri);
+  g_free (uri);
+  g_main_loop_run (state.loop);
+
+  stats = gst_player_get_stats (player);
+  fail_unless (gst_structure_get_uint64 (stats, "bytes-downloaded", &bytes));
+  fail_unless_equals_uint64 (bytes, 0);
+  gst_structure_free (stats);
+
+  g_object_unref (player);
+  g_main_loop_unref (state.loop);
+}
+
+END_TEST;
+
+typedef struct
+{
+  gchar *next_uri;
+  gboolean set_late;
+  guint uri_loaded;
+  gchar *loaded_uri;
+  guint end_of_stream;
+  gboolean stopped;
+} TestNextUriState;
+
+static void
+test_next_uri_cb (GstPlayer * player, TestPlayerStateChange change,
+    TestPlayerState * old_state, TestPlayerState * new_state)
+{
+  TestNextUriState *data = new_state->test_data;
+
+  if (change == STATE_CHANGE_STATE_CHANGED
+      && new_state->state == GST_PLAYER_STATE_STOPPED
+      && data->end_of_stream == 0)
+    data->stopped = TRUE;
+
+  if (change == STATE_CHANGE_END_OF_STREAM) {
+    data->end_of_stream++;
+    g_main_loop_quit (new_state->loop);
+  }
+}
+
+static void
+test_next_uri_uri_loaded_cb (GstPlayer * player, const gchar * uri,
+    TestNextUriState * data)
+{
+  data->uri_loaded++;
+  g_free (data->loaded_uri);
+  data->loaded_uri = g_strdup (uri);
+}
+
+static void
+test_next_uri_about_to_finish_cb (GstPlayer * player, TestNextUriState * data)
+{
+  /* Too late for a gapless switch, the player has to continue after EOS */
+  if (data->set_late && data->next_uri) {
+    gst_player_set_next_uri (player, data->next_uri);
+    g_free (data->next_uri);
+    data->next_uri = NULL;
+  }
+}
+
+static void
+test_next_uri_run (gboolean set_late, TestNextUriState * data)
+{
+  GstPlayer *player;
+  TestPlayerState state;
+  gchar *uri, *next_uri, *current_uri;
+
+  memset (&state, 0, sizeof (state));
+  memset (data, 0, sizeof (TestNextUriState));
+  state.loop = g_main_loop_new (NULL, FALSE);
+  state.test_callback = test_next_uri_cb;
+  state.test_data = data;
+
+  player = test_player_new (&state);
+  g_signal_connect (player, "uri-loaded",
+      G_CALLBACK (test_next_uri_uri_loaded_cb), data);
+  g_signal_connect (player, "about-to-finish",
+      G_CALLBACK (test_next_uri_about_to_finish_cb), data);
+
+  uri = gst_filename_to_uri (TEST_PATH "/audio-short.ogg", NULL);
+  fail_unless (uri != NULL);
+  next_uri = gst_filename_to_uri (TEST_PATH "/audio.ogg", NULL);
+  fail_unless (next_uri != NULL);
+
+  gst_player_set_uri (player, uri);
+  data->set_late = set_late;
+  if (set_late)
+    data->next_uri = g_strdup (next_uri);
+  else
+    gst_player_set_next_uri (player, next_uri);
+
+  gst_player_play (player);
+  g_main_loop_run (state.loop);
+
+  /* Only the end of the next URI finishes playback */
+  fail_unless_equals_string (data->loaded_uri, next_uri);
+  current_uri = gst_player_get_uri (player);
+  fail_unless_equals_string (current_uri, next_uri);
+  g_free (current_uri);
+  fail_unless (gst_player_get_next_uri (player) == NULL);
+
+  g_object_unref (player);
+  g_main_loop_unref (state.loop);
+  g_free (data->loaded_uri);
+  g_free (data->next_uri);
+  g_free (next_uri);
+  g_free (uri);
+}
+
+START_TEST (test_play_next_uri_gapless)
+{
+  TestNextUriState data;
+
+  test_next_uri_run (FALSE, &data);
+
+  /* Once for the first URI, once for the handover */
+  fail_unless_equals_int (data.uri_loaded, 2);
+  fail_unless_equals_int (data.end_of_stream, 1);
+  fail_if (data.stopped);
+}
+
+END_TEST;
+
+START_TEST (test_play_next_uri_after_eos)
+{
+  TestNextUriState data;
+
+  test_next_uri_run (TRUE, &data);
+
+  fail_unless_equals_int (data.uri_loaded, 2);
+  fail_unless_equals_int (data.end_of_stream, 1);
+}
+
+END_TEST;
+
+typedef struct
+{
+  guint end_of_stream;
+  GstClockTime max_position;
+  GstClockTime last_position;
+} TestReverseState;
+
+static void
+test_play_reverse_cb (GstPlayer * player, TestPlayerStateChange change,
+    TestPlayerState * old_state, TestPlayerState * new_state)
+{
+  TestReverseState *data = new_state->test_data;
+
+  if (change == STATE_CHANGE_POSITION_UPDATED
+      && new_state->state == GST_PLAYER_STATE_PLAYING) {
+    if (!GST_CLOCK_TIME_IS_VALID (data->max_position)
+        || new_state->position > data->max_position)
+      data->max_position = new_state->position;
+    data->last_position = new_state->position;
+  } else if (change == STATE_CHANGE_END_OF_STREAM) {
+    data->end_of_stream++;
+    g_main_loop_quit (new_state->loop);
+  }
+}
+
+START_TEST (test_play_reverse)
+{
+  GstPlayer *player;
+  TestPlayerState state;
+  TestReverseState data;
+  gchar *uri;
+
+  memset (&state, 0, sizeof (state));
+  data.end_of_stream = 0;
+  data.max_position = data.last_position = GST_CLOCK_TIME_NONE;
+  state.loop = g_main_loop_new (NULL, FALSE);
+  state.test_callback = test_play_reverse_cb;
+  state.test_data = &data;
+
+  player = test_player_new (&state);
+  gst_player_set_position_update_interval (player, 20);
+
+  uri = gst_filename_to_uri (TEST_PATH "/audio-short.ogg", NULL);
+  fail_unless (uri != NULL);
+  gst_player_set_uri (player, uri);
+  g_free (uri);
+
+  gst_player_set_rate (player, -1.0);
+  gst_player_play (player);
+  g_main_loop_run (state.loop);
+
+  /* Playback went from the end towards the beginning */
+  fail_unless_equals_int (data.end_of_stream, 1);
+  fail_unless (GST_CLOCK_TIME_IS_VALID (data.last_position));
+  fail_unless (data.last_position < data.max_position);
+
+  /* Playing again after EOS starts from the end of the stream */
+  data.max_position = data.last_position = GST_CLOCK_TIME_NONE;
+  gst_player_play (player);
+  g_main_loop_run (state.loop);
+
+  fail_unless_equals_int (data.end_of_stream, 2);
+  fail_unless (GST_CLOCK_TIME_IS_VALID (data.last_position));
+  fail_unless (data.last_position < data.max_position);
+
+  g_object_unref (player);
+  g_main_loop_unref (state.loop);
+}
+
+END_TEST;
+
+/* Classified as a video sink, so that QoS messages posted on its behalf
+ * drive the degradation controller */
+typedef GstBaseSink TestVideoSink;
+typedef GstBaseSinkClass TestVideoSinkClass;
+
+static GType test_video_sink_get_type (void);
+G_DEFINE_TYPE (TestVideoSink, test_video_sink, GST_TYPE_BASE_SINK);
+
+static GstStaticPadTemplate test_video_sink_template =
+GST_STATIC_PAD_TEMPLATE ("sink", GST_PAD_SINK, GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+static void
+test_video_sink_class_init (TestVideoSinkClass * klass)
+{
+  GstElementClass *element_class = GST_ELEMENT_CLASS (klass);
+
+  gst_element_class_set_static_metadata (element_class, "Test video sink",
+      "Sink/Video", "Discards video frames", "GStreamer");
+  gst_element_class_add_pad_template (element_class,
+      gst_static_pad_template_get (&test_video_sink_template));
+}
+
+static void
+test_video_sink_init (TestVideoSink * sink)
+{
+}
+
+typedef struct
+{
+  GstElement *sink;
+  GstPlayerDegradationFlags degradation;
+} TestDegradationState;
+
+static void
+test_degradation_cb (GstPlayer * player, TestPlayerStateChange change,
+    TestPlayerState * old_state, TestPlayerState * new_state)
+{
+  TestDegradationState *data = new_state->test_data;
+  GstMessage *msg;
+  guint i;
+
+  if (change == STATE_CHANGE_STATE_CHANGED
+      && new_state->state == GST_PLAYER_STATE_PLAYING) {
+    /* Pretend that the video sink falls behind */
+    for (i = 0; i < 5; i++) {
+      msg = gst_message_new_qos (GST_OBJECT (data->sink), FALSE,
+          GST_CLOCK_TIME_NONE, GST_CLOCK_TIME_NONE, GST_CLOCK_TIME_NONE,
+          GST_CLOCK_TIME_NONE);
+      gst_message_set_qos_values (msg, 10 * GST_MSECOND, 2.0, 500000);
+      gst_element_post_message (data->sink, msg);
+    }
+  } else if (change == STATE_CHANGE_END_OF_STREAM
+      || change == STATE_CHANGE_ERROR) {
+    g_main_loop_quit (new_state->loop);
+  }
+}
+
+static void
+test_degradation_changed_cb (GstPlayer * player,
+    GstPlayerDegradationFlags degradation, TestPlayerState * state)
+{
+  TestDegradationState *data = state->test_data;
+
+  data->degradation = degradation;
+  g_main_loop_quit (state->loop);
+}
+
+START_TEST (test_degradation)
+{
+  GstPlayer *player;
+  TestPlayerState state;
+  TestDegradationState data;
+  GstElement *playbin;
+  gint64 max_lateness;
+  gchar *uri;
+
+  memset (&state, 0, sizeof (state));
+  state.loop = g_main_loop_new (NULL, FALSE);
+  state.test_callback = test_degradation_cb;
+  state.test_data = &data;
+
+  player = test_player_new (&state);
+  fail_unless_equals_int (gst_player_get_degradation_steps (player),
+      GST_PLAYER_DEGRADATION_FLAG_NONE);
+  gst_player_set_degradation_steps (player,
+      GST_PLAYER_DEGRADATION_FLAG_MAX_LATENESS);
+  g_signal_connect (player, "degradation-changed",
+      G_CALLBACK (test_degradation_changed_cb), &state);
+
+  playbin = gst_player_get_pipeline (player);
+  data.sink = g_object_new (test_video_sink_get_type (), "sync", TRUE, NULL);
+  data.degradation = GST_PLAYER_DEGRADATION_FLAG_NONE;
+  g_object_set (playbin, "video-sink", data.sink, NULL);
+
+  uri = gst_filename_to_uri (TEST_PATH "/audio-video.ogg", NULL);
+  fail_unless (uri != NULL);
+  gst_player_set_uri (player, uri);
+  g_free (uri);
+
+  gst_player_play (player);
+  g_main_loop_run (state.loop);
+  fail_if (state.error);
+
+  /* Late frames enabled the only allowed step on the video sink */
+  fail_unless_equals_int (data.degradation,
+      GST_PLAYER_DEGRADATION_FLAG_MAX_LATENESS);
+  g_object_get (data.sink, "max-lateness", &max_lateness, NULL);
+  fail_unless_equals_uint64 (max_lateness, 5 * GST_MSECOND);
+
+#if GST_CHECK_VERSION(1,10,0)
+  {
+    GstElement *sink;
+
+    /* And on elements added to the pipeline afterwards */
+    sink = g_object_new (test_video_sink_get_type (), NULL);
+    gst_bin_add (GST_BIN (playbin), sink);
+    g_object_get (sink, "max-lateness", &max_lateness, NULL);
+    gst_bin_remove (GST_BIN (playbin), sink);
+    fail_unless_equals_uint64 (max_lateness, 5 * GST_MSECOND);
+  }
+#endif
+
+  gst_object_unref (playbin);
+  g_object_unref (player);
+  g_main_loop_unref (state.loop);
+}
+
+END_TEST;
+
+typedef struct
+{
+  gboolean posted;
+  GString *events;
+} TestWatermarksState;
+
+static void
+test_buffering_watermarks_cb (GstPlayer * player,
+    TestPlayerStateChange change, TestPlayerState * old_state,
+    TestPlayerState * new_state)
+{
+  TestWatermarksState *data = new_state->test_data;
+  static const gint levels[] = { 50, 5, 50, 60 };
+  GstElement *playbin;
+  guint i;
+
+  if (change == STATE_CHANGE_BUFFERING) {
+    g_string_append_printf (data->events, "%d%% %s, ",
+        new_state->buffering_percent,
+        gst_player_state_get_name (new_state->state));
+  } else if (change == STATE_CHANGE_STATE_CHANGED
+      && new_state->state == GST_PLAYER_STATE_PLAYING) {
+    if (data->posted) {
+      g_main_loop_quit (new_state->loop);
+      return;
+    }
+
+    /* A local file does not buffer, pretend it does */
+    playbin = gst_player_get_pipeline (player);
+    for (i = 0; i < G_N_ELEMENTS (levels); i++)
+      gst_element_post_message (playbin,
+          gst_message_new_buffering (GST_OBJECT (playbin), levels[i]));
+    gst_object_unref (playbin);
+    data->posted = TRUE;
+  } else if (change == STATE_CHANGE_END_OF_STREAM
+      || change == STATE_CHANGE_ERROR) {
+    g_main_loop_quit (new_state->loop);
+  }
+}
+
+START_TEST (test_buffering_watermarks)
+{
+  GstPlayer *player;
+  TestPlayerState state;
+  TestWatermarksState data;
+  gint low, high;
+  gchar *uri;
+
+  memset (&state, 0, sizeof (state));
+  data.posted = FALSE;
+  data.events = g_string_new (NULL);
+  state.loop = g_main_loop_new (NULL, FALSE);
+  state.test_callback = test_buffering_watermarks_cb;
+  state.test_data = &data;
+
+  player = test_player_new (&state);
+  gst_player_get_buffering_watermarks (player, &low, &high);
+  fail_unless_equals_int (low, 100);
+  fail_unless_equals_int (high, 100);
+  gst_player_set_buffering_watermarks (player, 10, 60);
+
+  uri = gst_filename_to_uri (TEST_PATH "/audio.ogg", NULL);
+  fail_unless (uri != NULL);
+  gst_player_set_uri (player, uri);
+  g_free (uri);
+
+  gst_player_play (player);
+  g_main_loop_run (state.loop);
+  fail_if (state.error);
+
+  /* Playback only pauses below the low watermark and only continues from
+   * the high one */
+  fail_unless_equals_string (data.events->str, "50% playing, 5% buffering, "
+      "50% buffering, 60% buffering, ");
+  fail_unless_equals_int (state.state, GST_PLAYER_STATE_PLAYING);
+
+  g_object_unref (player);
+  g_main_loop_unref (state.loop);
+  g_string_free (data.events, TRUE);
+}
+
+END_TEST;
+
+static void
+test_paused_cb (GstPlayer * player, TestPlayerStateChange change,
+    TestPlayerState * old_state, TestPlayerState * new_state)
+{
+  if ((change == STATE_CHANGE_STATE_CHANGED
+          && new_state->state == GST_PLAYER_STATE_PAUSED)
+      || change == STATE_CHANGE_ERROR)
+    g_main_loop_quit (new_state->loop);
+}
+
+static GstBuffer *
+test_video_snapshot_check (GstPlayer * player)
+{
+  GstSample *snapshot;
+  GstBuffer *buffer;
+  GstVideoInfo info;
+
+  snapshot = gst_player_get_video_snapshot (player, GST_VIDEO_FORMAT_RGBx,
+      160, 0);
+  fail_unless (snapshot != NULL);
+  fail_unless (gst_video_info_from_caps (&info,
+          gst_sample_get_caps (snapshot)));
+  fail_unless_equals_int (GST_VIDEO_INFO_FORMAT (&info),
+      GST_VIDEO_FORMAT_RGBx);
+  /* Scaled down from 320x240 with the aspect ratio kept */
+  fail_unless_equals_int (GST_VIDEO_INFO_WIDTH (&info), 160);
+  fail_unless_equals_int (GST_VIDEO_INFO_HEIGHT (&info), 120);
+
+  buffer = gst_sample_get_buffer (snapshot);
+  fail_unless (gst_buffer_get_size (buffer) >= GST_VIDEO_INFO_SIZE (&info));
+  gst_buffer_ref (buffer);
+  gst_sample_unref (snapshot);
+
+  return buffer;
+}
+
+START_TEST (test_get_video_snapshot)
+{
+  GstPlayer *player;
+  TestPlayerState state;
+  GstBuffer *first, *second;
+  gchar *uri;
+
+  memset (&state, 0, sizeof (state));
+  state.loop = g_main_loop_new (NULL, FALSE);
+  state.test_callback = test_paused_cb;
+
+  player = test_player_new (&state);
+
+  uri = gst_filename_to_uri (TEST_PATH "/audio-video-short.ogg", NULL);
+  fail_unless (uri != NULL);
+  gst_player_set_uri (player, uri);
+  g_free (uri);
+
+  gst_player_pause (player);
+  g_main_loop_run (state.loop);
+  fail_if (state.error);
+
+  first = test_video_snapshot_check (player);
+  second = test_video_snapshot_check (player);
+#if GST_CHECK_VERSION(1,6,0)
+  /* Both conversions used the same buffer pool */
+  fail_unless (first->pool != NULL);
+  fail_unless (first->pool == second->pool);
+#endif
+  gst_buffer_unref (first);
+  gst_buffer_unref (second);
+
+  g_object_unref (player);
+  g_main_loop_unref (state.loop);
+}
+
+END_TEST;
+
+#define TEST_TAG_UPDATES 10
+
+typedef struct
+{
+  gboolean posted;
+  guint updates;
+  guint n_merged;
+  gboolean intermediate;
+} TestTagUpdatesState;
+
+static void
+test_tag_updates_cb (GstPlayer * player, TestPlayerStateChange change,
+    TestPlayerState * old_state, TestPlayerState * new_state)
+{
+  TestTagUpdatesState *data = new_state->test_data;
+  GstElement *playbin;
+  GstTagList *tags;
+  const gchar *title;
+  gchar *name;
+  guint i;
+
+  if (change == STATE_CHANGE_STATE_CHANGED
+      && new_state->state == GST_PLAYER_STATE_PLAYING && !data->posted) {
+    /* Like a radio stream that updates its title over and over */
+    playbin = gst_player_get_pipeline (player);
+    for (i = 0; i < TEST_TAG_UPDATES; i++) {
+      tags = gst_tag_list_new_empty ();
+      gst_tag_list_set_scope (tags, GST_TAG_SCOPE_GLOBAL);
+      name = g_strdup_printf ("Title %u", i);
+      gst_tag_list_add (tags, GST_TAG_MERGE_REPLACE, GST_TAG_TITLE, name,
+          NULL);
+      g_free (name);
+      gst_element_post_message (playbin,
+          gst_message_new_tag (GST_OBJECT (playbin), tags));
+    }
+    gst_object_unref (playbin);
+    data->posted = TRUE;
+  } else if (change == STATE_CHANGE_MEDIA_INFO_UPDATED && data->posted) {
+    data->updates++;
+    title = gst_player_media_info_get_title (new_state->media_info);
+    if (!title || !g_str_has_prefix (title, "Title "))
+      return;
+
+    name = g_strdup_printf ("Title %u", TEST_TAG_UPDATES - 1);
+    if (strcmp (title, name) == 0) {
+      data->n_merged =
+          gst_player_media_info_get_n_merged_updates (new_state->media_info);
+      g_main_loop_quit (new_state->loop);
+    } else {
+      data->intermediate = TRUE;
+    }
+    g_free (name);
+  } else if (change == STATE_CHANGE_END_OF_STREAM
+      || change == STATE_CHANGE_ERROR) {
+    g_main_loop_quit (new_state->loop);
+  }
+}
+
+START_TEST (test_media_info_tag_updates)
+{
+  GstPlayer *player;
+  TestPlayerState state;
+  TestTagUpdatesState data;
+  gchar *uri;
+
+  memset (&state, 0, sizeof (state));
+  memset (&data, 0, sizeof (data));
+  state.loop = g_main_loop_new (NULL, FALSE);
+  state.test_callback = test_tag_updates_cb;
+  state.test_data = &data;
+
+  player = test_player_new (&state);
+  fail_unless_equals_int (gst_player_get_media_info_update_interval (player),
+      0);
+  gst_player_set_media_info_update_interval (player, 500);
+
+  uri = gst_filename_to_uri (TEST_PATH "/audio.ogg", NULL);
+  fail_unless (uri != NULL);
+  gst_player_set_uri (player, uri);
+  g_free (uri);
+
+  gst_player_play (player);
+  g_main_loop_run (state.loop);
+  fail_if (state.error);
+
+  /* All title changes arrived merged into a single update */
+  fail_if (data.intermediate);
+  fail_unless_equals_int (data.updates, 1);
+  fail_unless (data.n_merged >= TEST_TAG_UPDATES);
+
+  g_object_unref (player);
+  g_main_loop_unref (state.loop);
+}
+
+END_TEST;
+
+static void
+test_playing_cb (GstPlayer * player, TestPlayerStateChange change,
+    TestPlayerState * old_state, TestPlayerState * new_state)
+{
+  if ((change == STATE_CHANGE_STATE_CHANGED
+          && new_state->state == GST_PLAYER_STATE_PLAYING)
+      || change == STATE_CHANGE_ERROR)
+    g_main_loop_quit (new_state->loop);
+}
+
+START_TEST (test_idle_timeout)
+{
+  GstPlayer *player;
+  TestPlayerState state;
+  guint warm_starts, cold_starts, releases;
+  guint i;
+  gchar *uri;
+
+  memset (&state, 0, sizeof (state));
+  state.loop = g_main_loop_new (NULL, FALSE);
+  state.test_callback = test_playing_cb;
+
+  player = test_player_new (&state);
+  fail_unless_equals_int (gst_player_get_idle_timeout (player), 60000);
+  gst_player_set_idle_timeout (player, -1);
+
+  uri = gst_filename_to_uri (TEST_PATH "/audio.ogg", NULL);
+  fail_unless (uri != NULL);
+  gst_player_set_uri (player, uri);
+  g_free (uri);
+
+  gst_player_play (player);
+  g_main_loop_run (state.loop);
+  fail_if (state.error);
+
+  /* The stopped pipeline is kept and only needs to be restarted */
+  gst_player_stop (player);
+  gst_player_play (player);
+  g_main_loop_run (state.loop);
+  fail_if (state.error);
+
+  gst_player_get_pipeline_reuse_stats (player, &warm_starts, &cold_starts,
+      &releases);
+  fail_unless_equals_int (cold_starts, 1);
+  fail_unless_equals_int (warm_starts, 1);
+  fail_unless_equals_int (releases, 0);
+
+  /* Without a timeout it is released right after stopping */
+  gst_player_set_idle_timeout (player, 0);
+  gst_player_stop (player);
+  for (i = 0; i < 500 && releases == 0; i++) {
+    g_usleep (10 * 1000);
+    gst_player_get_pipeline_reuse_stats (player, NULL, NULL, &releases);
+  }
+  fail_unless_equals_int (releases, 1);
+
+  gst_player_play (player);
+  g_main_loop_run (state.loop);
+  fail_if (state.error);
+
+  gst_player_get_pipeline_reuse_stats (player, &warm_starts, &cold_starts,
+      &releases);
+  fail_unless_equals_int (cold_starts, 2);
+  fail_unless_equals_int (warm_starts, 1);
+
+  g_object_unref (player);
+  g_main_loop_unref (state.loop);
+}
+
+END_TEST;
+
+static void
+test_seek_mode_cb (GstPlayer * player, TestPlayerStateChange change,
+    TestPlayerState * old_state, TestPlayerState * new_state)
+{
+  gboolean *seeking = new_state->test_data;
+
+  if (change == STATE_CHANGE_STATE_CHANGED
+      && new_state->state == GST_PLAYER_STATE_PAUSED && !*seeking) {
+    g_main_loop_quit (new_state->loop);
+  } else if (change == STATE_CHANGE_POSITION_UPDATED && *seeking
+      && new_state->position > 0) {
+    g_main_loop_quit (new_state->loop);
+  } else if (change == STATE_CHANGE_ERROR) {
+    g_main_loop_quit (new_state->loop);
+  }
+}
+
+START_TEST (test_seek_mode)
+{
+  GstPlayer *player;
+  TestPlayerState state;
+  GstClockTime *latencies;
+  guint n_latencies;
+  gboolean seeking = FALSE;
+  gchar *uri;
+
+  memset (&state, 0, sizeof (state));
+  state.loop = g_main_loop_new (NULL, FALSE);
+  state.test_callback = test_seek_mode_cb;
+  state.test_data = &seeking;
+
+  player = test_player_new (&state);
+  fail_unless_equals_int (gst_player_get_seek_mode (player),
+      GST_PLAYER_SEEK_MODE_DEFAULT);
+  gst_player_set_seek_mode (player, GST_PLAYER_SEEK_MODE_ACCURATE);
+
+  uri = gst_filename_to_uri (TEST_PATH "/audio.ogg", NULL);
+  fail_unless (uri != NULL);
+  gst_player_set_uri (player, uri);
+  g_free (uri);
+
+  gst_player_pause (player);
+  g_main_loop_run (state.loop);
+  fail_if (state.error);
+
+  latencies = gst_player_get_seek_latencies (player, &n_latencies);
+  fail_unless (latencies == NULL);
+  fail_unless_equals_int (n_latencies, 0);
+
+  seeking = TRUE;
+  gst_player_seek (player, 2 * GST_SECOND);
+  g_main_loop_run (state.loop);
+  fail_if (state.error);
+
+  /* An accurate seek does not snap to a keyframe */
+  fail_unless_equals_uint64 (state.position, 2 * GST_SECOND);
+
+  latencies = gst_player_get_seek_latencies (player, &n_latencies);
+  fail_unless_equals_int (n_latencies, 1);
+  fail_unless (latencies[0] > 0);
+  fail_unless (GST_CLOCK_TIME_IS_VALID (latencies[0]));
+  g_free (latencies);
+
+  g_object_unref (player);
+  g_main_loop_unref (state.loop);
+}
+
+END_TEST;
+
+static void
+test_preload_cb (GstPlayer * player, TestPlayerStateChange change,
+    TestPlayerState * old_state, TestPlayerState * new_state)
+{
+  gboolean *activated = new_state->test_data;
+
+  if ((change == STATE_CHANGE_STATE_CHANGED && !*activated
+          && new_state->state == GST_PLAYER_STATE_PLAYING)
+      || change == STATE_CHANGE_END_OF_STREAM
+      || change == STATE_CHANGE_ERROR)
+    g_main_loop_quit (new_state->loop);
+}
+
+START_TEST (test_preload_and_activate)
+{
+  GstPlayer *player;
+  TestPlayerState state;
+  GstElement *playbin, *preloaded;
+  gboolean activated = FALSE;
+  gchar *uri, *dir, *path;
+
+  memset (&state, 0, sizeof (state));
+  state.loop = g_main_loop_new (NULL, FALSE);
+  state.test_callback = test_preload_cb;
+  state.test_data = &activated;
+
+  player = test_player_new (&state);
+  fail_unless_equals_int (gst_player_get_max_preloaded (player), 1);
+
+  uri = gst_filename_to_uri (TEST_PATH "/audio.ogg", NULL);
+  fail_unless (uri != NULL);
+  gst_player_set_uri (player, uri);
+  g_free (uri);
+
+  gst_player_play (player);
+  g_main_loop_run (state.loop);
+  fail_if (state.error);
+  playbin = gst_player_get_pipeline (player);
+
+  /* The preloaded pipeline replaces the playing one and plays on */
+  uri = gst_filename_to_uri (TEST_PATH "/audio-short.ogg", NULL);
+  fail_unless (uri != NULL);
+  gst_player_preload (player, uri);
+  activated = TRUE;
+  gst_player_activate_preloaded (player, uri);
+  g_main_loop_run (state.loop);
+  fail_if (state.error);
+  fail_unless (state.end_of_stream);
+  fail_unless (state.media_info != NULL);
+  fail_unless_equals_string (gst_player_media_info_get_uri (state.media_info),
+      uri);
+  g_free (uri);
+
+  preloaded = gst_player_get_pipeline (player);
+  fail_unless (preloaded != playbin);
+  gst_object_unref (playbin);
+
+  /* A pipeline that fails to preroll is dropped, the URI is then loaded
+   * and fails like any other */
+  dir = g_dir_make_tmp ("gst-player-test-XXXXXX", NULL);
+  fail_unless (dir != NULL);
+  path = g_build_filename (dir, "garbage", NULL);
+  fail_unless (g_file_set_contents (path, "not a media file", -1, NULL));
+  uri = gst_filename_to_uri (path, NULL);
+  fail_unless (uri != NULL);
+
+  gst_player_preload (player, uri);
+  g_usleep (G_USEC_PER_SEC);
+  gst_player_activate_preloaded (player, uri);
+  gst_player_play (player);
+  g_main_loop_run (state.loop);
+  fail_unless (state.error);
+
+  playbin = gst_player_get_pipeline (player);
+  fail_unless (playbin == preloaded);
+  gst_object_unref (playbin);
+  gst_object_unref (preloaded);
+
+  g_object_unref (player);
+  g_main_loop_unref (state.loop);
+  g_unlink (path);
+  g_rmdir (dir);
+  g_free (uri);
+  g_free (path);
+  g_free (dir);
+}
+
+END_TEST;
+
+#define TEST_EVENTS_URIS 100
+
+typedef struct
+{
+  gchar *uri;
+  guint uris_loaded;
+  guint coalesced, overflowed;
+} TestEventsState;
+
+static void
+test_events_cb (GstPlayer * player, TestPlayerStateChange change,
+    TestPlayerState * old_state, TestPlayerState * new_state)
+{
+  TestEventsState *data = new_state->test_data;
+  guint i;
+
+  if (change == STATE_CHANGE_STATE_CHANGED
+      && new_state->state == GST_PLAYER_STATE_PLAYING && !data->coalesced) {
+    /* Position updates pile up while the application is busy */
+    g_usleep (500 * 1000);
+    gst_player_get_event_stats (player, &data->coalesced, NULL);
+
+    /* More URI changes than fit into the event queue */
+    data->uris_loaded = 0;
+    for (i = 0; i < TEST_EVENTS_URIS; i++)
+      gst_player_set_uri (player, data->uri);
+    g_usleep (500 * 1000);
+    gst_player_get_event_stats (player, NULL, &data->overflowed);
+  } else if (change == STATE_CHANGE_ERROR) {
+    g_main_loop_quit (new_state->loop);
+  }
+}
+
+static void
+test_events_uri_loaded_cb (GstPlayer * player, const gchar * uri,
+    TestPlayerState * state)
+{
+  TestEventsState *data = state->test_data;
+
+  if (++data->uris_loaded == TEST_EVENTS_URIS && data->overflowed)
+    g_main_loop_quit (state->loop);
+}
+
+START_TEST (test_event_coalescing)
+{
+  GstPlayer *player;
+  TestPlayerState state;
+  TestEventsState data;
+  guint coalesced, overflowed;
+
+  memset (&state, 0, sizeof (state));
+  memset (&data, 0, sizeof (data));
+  state.loop = g_main_loop_new (NULL, FALSE);
+  state.test_callback = test_events_cb;
+  state.test_data = &data;
+
+  player = test_player_new (&state);
+  gst_player_set_position_update_interval (player, 10);
+  g_signal_connect (player, "uri-loaded",
+      G_CALLBACK (test_events_uri_loaded_cb), &state);
+
+  gst_player_get_event_stats (player, &coalesced, &overflowed);
+  fail_unless_equals_int (coalesced, 0);
+  fail_unless_equals_int (overflowed, 0);
+
+  data.uri = gst_filename_to_uri (TEST_PATH "/audio.ogg", NULL);
+  fail_unless (data.uri != NULL);
+  gst_player_set_uri (player, data.uri);
+
+  gst_player_play (player);
+  g_main_loop_run (state.loop);
+  fail_if (state.error);
+
+  /* Position updates were merged, URI changes took the overflow list but
+   * none of them got lost */
+  fail_unless (data.coalesced > 0);
+  fail_unless (data.overflowed > 0);
+  fail_unless_equals_int (data.uris_loaded, TEST_EVENTS_URIS);
+
+  g_object_unref (player);
+  g_main_loop_unref (state.loop);
+  g_free (data.uri);
+}
+
+END_TEST;
+
+typedef struct
+{
+  GstPlayerMediaInfo *old;
+  GList *old_list;
+  GstPlayerStreamInfo *old_audio, *old_video;
+  gboolean checked;
+} TestSnapshotState;
+
+/* Checks that the list views of @info agree with each other and with the
+ * stream indexes */
+static void
+test_media_info_views (GstPlayerMediaInfo * info)
+{
+  GList *lists[3], *l;
+  guint i, n = 0;
+  gint index;
+
+  lists[0] = gst_player_get_video_streams (info);
+  lists[1] = gst_player_get_audio_streams (info);
+  lists[2] = gst_player_get_subtitle_streams (info);
+
+  for (i = 0; i < G_N_ELEMENTS (lists); i++) {
+    index = 0;
+    for (l = lists[i]; l != NULL; l = l->next) {
+      fail_unless_equals_int (gst_player_stream_info_get_index (l->data),
+          index++);
+      fail_unless (g_list_find (gst_player_media_info_get_stream_list (info),
+              l->data) != NULL);
+      n++;
+    }
+  }
+
+  fail_unless_equals_int (g_list_length (gst_player_media_info_get_stream_list
+          (info)), n);
+
+  /* The views are only built once */
+  fail_unless (gst_player_get_audio_streams (info) == lists[1]);
+  fail_unless (gst_player_get_video_streams (info) == lists[0]);
+}
+
+static void
+test_snapshot_cb (GstPlayer * player, TestPlayerStateChange change,
+    TestPlayerState * old_state, TestPlayerState * new_state)
+{
+  TestSnapshotState *data = new_state->test_data;
+  GstPlayerMediaInfo *info;
+  GstPlayerAudioInfo *audio;
+  GstPlayerVideoInfo *video;
+  GstElement *playbin;
+  GList *l;
+
+  if (change == STATE_CHANGE_STATE_CHANGED
+      && new_state->state == GST_PLAYER_STATE_PLAYING && !data->old) {
+    data->old = gst_player_get_media_info (player);
+    fail_unless (data->old != NULL);
+    test_media_info_views (data->old);
+
+    data->old_list = gst_player_media_info_get_stream_list (data->old);
+    data->old_audio = gst_player_get_audio_streams (data->old)->data;
+    data->old_video = gst_player_get_video_streams (data->old)->data;
+
+    audio = gst_player_get_current_audio_track (player);
+    fail_unless (audio == (GstPlayerAudioInfo *) data->old_audio);
+    g_object_unref (audio);
+
+    /* Makes the player replace the audio stream in a new snapshot */
+    playbin = gst_player_get_pipeline (player);
+    g_signal_emit_by_name (playbin, "audio-tags-changed", 0);
+    gst_object_unref (playbin);
+  } else if (change == STATE_CHANGE_MEDIA_INFO_UPDATED && data->old) {
+    info = new_state->media_info;
+    l = gst_player_get_audio_streams (info);
+    if (info == data->old || !l || l->data == data->old_audio)
+      return;
+
+    test_media_info_views (info);
+
+    /* Only the changed stream was replaced */
+    fail_unless (gst_player_get_video_streams (info)->data ==
+        data->old_video);
+
+    audio = gst_player_get_current_audio_track (player);
+    fail_unless (audio == l->data);
+    g_object_unref (audio);
+    video = gst_player_get_current_video_track (player);
+    fail_unless (video == (GstPlayerVideoInfo *) data->old_video);
+    g_object_unref (video);
+
+    /* The old snapshot is unchanged */
+    test_media_info_views (data->old);
+    fail_unless (gst_player_media_info_get_stream_list (data->old) ==
+        data->old_list);
+    fail_unless (gst_player_get_audio_streams (data->old)->data ==
+        data->old_audio);
+    fail_unless (gst_player_get_video_streams (data->old)->data ==
+        data->old_video);
+    fail_unless (g_list_find (data->old_list, data->old_audio) != NULL);
+    fail_unless (g_list_find (data->old_list, l->data) == NULL);
+
+    data->checked = TRUE;
+    g_main_loop_quit (new_state->loop);
+  } else if (change == STATE_CHANGE_END_OF_STREAM
+      || change == STATE_CHANGE_ERROR) {
+    g_main_loop_quit (new_state->loop);
+  }
+}
+
+START_TEST (test_media_info_snapshot)
+{
+  GstPlayer *player;
+  TestPlayerState state;
+  TestSnapshotState data;
+  gchar *uri;
+
+  memset (&state, 0, sizeof (state));
+  memset (&data, 0, sizeof (data));
+  state.loop = g_main_loop_new (NULL, FALSE);
+  state.test_callback = test_snapshot_cb;
+  state.test_data = &data;
+
+  player = test_player_new (&state);
+
+  uri = gst_filename_to_uri (TEST_PATH "/audio-video.ogg", NULL);
+  fail_unless (uri != NULL);
+  gst_player_set_uri (player, uri);
+  g_free (uri);
+
+  gst_player_play (player);
+  g_main_loop_run (state.loop);
+  fail_if (state.error);
+  fail_unless (data.checked);
+
+  g_object_unref (data.old);
+  g_object_unref (player);
+  g_main_loop_unref (state.loop);
+}
+
+END_TEST;
+
 static Suite *
 player_suite (void)
 {
@@ -734,11 +2372,35 @@ player_suite (void)
   tcase_set_timeout (tc_general, 120);
 
   tcase_add_test (tc_general, test_create_and_free);
+  tcase_add_test (tc_general, test_create_and_free_with_executor);
   tcase_add_test (tc_general, test_set_and_get_uri);
+  tcase_add_test (tc_general, test_set_and_get_next_uri);
+  tcase_add_test (tc_general, test_set_and_get_position_update_interval);
+  tcase_add_test (tc_general, test_set_and_get_rate);
+  tcase_add_test (tc_general, test_download_cache);
+  tcase_add_test (tc_general, test_thumbnailer);
+  tcase_add_test (tc_general, test_discover_batch);
+  tcase_add_test (tc_general, test_media_info_cache);
+  tcase_add_test (tc_general, test_get_video_snapshot_without_video);
+  tcase_add_test (tc_general, test_video_frame_delivery);
+  tcase_add_test (tc_general, test_audio_levels);
   tcase_add_test (tc_general, test_play_audio_eos);
   tcase_add_test (tc_general, test_play_audio_video_eos);
   tcase_add_test (tc_general, test_play_error_invalid_uri);
   tcase_add_test (tc_general, test_play_error_invalid_uri_and_play);
+  tcase_add_test (tc_general, test_get_stats);
+  tcase_add_test (tc_general, test_play_next_uri_gapless);
+  tcase_add_test (tc_general, test_play_next_uri_after_eos);
+  tcase_add_test (tc_general, test_play_reverse);
+  tcase_add_test (tc_general, test_degradation);
+  tcase_add_test (tc_general, test_buffering_watermarks);
+  tcase_add_test (tc_general, test_get_video_snapshot);
+  tcase_add_test (tc_general, test_media_info_tag_updates);
+  tcase_add_test (tc_general, test_idle_timeout);
+  tcase_add_test (tc_general, test_seek_mode);
+  tcase_add_test (tc_general, test_preload_and_activate);
+  tcase_add_test (tc_general, test_event_coalescing);
+  tcase_add_test (tc_general, test_media_info_snapshot);
 
   suite_add_tcase (s, tc_general);
 